@@ -9,11 +9,16 @@
 // specific language governing permissions and limitations under the License.
 
 #include <argp.h>
+#include <stdlib.h>
 #include "spiloader.h"
 
 /* The options we understand. */
 static struct argp_option options[] = {
   {"timeout", 't', "0", OPTION_ARG_OPTIONAL, "Timeout in seconds. 0 means no timeout" },
+  {"tty",     'd', "DEV",  0, "Serial port PULPino's UART is connected to" },
+  {"spidev",  's', "DEV",  0, "SPI device PULPino's SPI slave is connected to" },
+  {"log",     'l', "FILE", 0, "Write the timestamped console output to FILE" },
+  {"records", 'r', "FILE", 0, "Write binary records found in the console output to FILE" },
   { 0 }
 };
 
@@ -32,6 +37,22 @@ parse_opt (int key, char *arg, struct argp_state *state)
       arguments->timeout = atoi(arg);
     break;
 
+  case 'd':
+    arguments->tty = arg;
+    break;
+
+  case 's':
+    arguments->spidev = arg;
+    break;
+
+  case 'l':
+    arguments->log = arg;
+    break;
+
+  case 'r':
+    arguments->bin = arg;
+    break;
+
   case ARGP_KEY_ARG:
     arguments->stim = arg;
     break;
@@ -39,6 +60,10 @@ parse_opt (int key, char *arg, struct argp_state *state)
   case ARGP_KEY_INIT:
     // default values
     arguments->timeout = 0;
+    arguments->tty     = NULL;
+    arguments->spidev  = NULL;
+    arguments->log     = NULL;
+    arguments->bin     = NULL;
     break;
 
   case ARGP_KEY_FINI:
@@ -15,85 +15,354 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
-#include <signal.h>
+
+#include "spiloader.h"
+
+// <sys/ioctl.h> clashes with <asm/termios.h> which we need for termios2
+int ioctl(int fd, unsigned long request, ...);
+
+#ifdef ZYBO
+#define CONSOLE_TTY "/dev/ttyPS1"
+#else
+#define CONSOLE_TTY "/dev/ttyPS0"
+#endif
+
+#define CONSOLE_BAUDRATE  156250
+#define CONSOLE_READ_LEN  4096
+// how often the reader wakes up to check if it should stop
+#define CONSOLE_POLL_MS   100
+
+enum {
+  CONSOLE_TEXT,
+  CONSOLE_MAGIC,
+  CONSOLE_HDR,
+  CONSOLE_PAYLOAD,
+  CONSOLE_SUM
+};
+
+struct console_ctx_t {
+  const char*     tty;
+  FILE*           log;
+  FILE*           bin;
+  struct timespec start;
+};
 
 pthread_t g_thread;
-int g_should_exit;
+volatile int g_should_exit;
 
-void read_port()
+static struct console_ctx_t    g_ctx;
+static struct console_parser_t g_parser;
+
+////////////////////////////////////////////////////////////////////////////////
+// stream parser, splits the UART stream into text lines and binary records
+////////////////////////////////////////////////////////////////////////////////
+
+void console_parser_init(struct console_parser_t* p) {
+  p->state      = CONSOLE_TEXT;
+  p->pos        = 0;
+  p->line_len   = 0;
+  p->frames     = 0;
+  p->bad_frames = 0;
+}
+
+static void console_parser_text(struct console_parser_t* p, char c) {
+  if (c == '\n' || p->line_len == (CONSOLE_LINE_LEN - 1)) {
+    // drop the carriage return of \r\n line endings
+    if (p->line_len > 0 && p->line[p->line_len - 1] == '\r')
+      p->line_len--;
+
+    p->line[p->line_len] = '\0';
+    p->on_line(p->ctx, p->line, p->line_len);
+    p->line_len = 0;
+
+    if (c == '\n')
+      return;
+  }
+
+  p->line[p->line_len++] = c;
+}
+
+void console_parser_feed(struct console_parser_t* p, const uint8_t* buf, size_t len) {
+  unsigned int i;
+  uint8_t c;
+
+  while (len--) {
+    c = *buf++;
+
+    switch (p->state) {
+      case CONSOLE_TEXT:
+        if (c == CONSOLE_FRAME_MAGIC0) {
+          p->frame[0] = c;
+          p->pos      = 1;
+          p->state    = CONSOLE_MAGIC;
+        } else {
+          console_parser_text(p, c);
+        }
+        break;
+
+      case CONSOLE_MAGIC:
+        if (c != (p->pos == 1 ? CONSOLE_FRAME_MAGIC1 : CONSOLE_FRAME_MAGIC2)) {
+          // not a record after all, hand everything back to the text path
+          for (i = 0; i < p->pos; i++)
+            console_parser_text(p, p->frame[i]);
+
+          p->state = CONSOLE_TEXT;
+          p->pos   = 0;
+
+          if (c == CONSOLE_FRAME_MAGIC0) {
+            p->frame[0] = c;
+            p->pos      = 1;
+            p->state    = CONSOLE_MAGIC;
+          } else {
+            console_parser_text(p, c);
+          }
+          break;
+        }
+
+        p->frame[p->pos++] = c;
+        if (p->pos == 3) {
+          p->sum   = 0;
+          p->state = CONSOLE_HDR;
+        }
+        break;
+
+      case CONSOLE_HDR:
+        p->frame[p->pos++] = c;
+        p->sum += c;
+
+        if (p->pos == CONSOLE_FRAME_HDR_LEN) {
+          p->type  = p->frame[3];
+          p->len   = p->frame[4] | (p->frame[5] << 8);
+          p->state = p->len ? CONSOLE_PAYLOAD : CONSOLE_SUM;
+        }
+        break;
+
+      case CONSOLE_PAYLOAD:
+        p->frame[p->pos++] = c;
+        p->sum += c;
+
+        if (p->pos == CONSOLE_FRAME_HDR_LEN + p->len)
+          p->state = CONSOLE_SUM;
+        break;
+
+      case CONSOLE_SUM:
+        p->frame[p->pos++] = c;
+
+        if (p->pos == CONSOLE_FRAME_HDR_LEN + p->len + 2) {
+          if ((p->frame[p->pos - 2] | (p->frame[p->pos - 1] << 8)) == p->sum) {
+            p->frames++;
+            p->on_frame(p->ctx, p->type, p->frame, p->pos);
+          } else {
+            p->bad_frames++;
+          }
+
+          p->state = CONSOLE_TEXT;
+          p->pos   = 0;
+        }
+        break;
+    }
+  }
+}
+
+void console_parser_flush(struct console_parser_t* p) {
+  if (p->line_len > 0) {
+    p->line[p->line_len] = '\0';
+    p->on_line(p->ctx, p->line, p->line_len);
+    p->line_len = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// output handling
+////////////////////////////////////////////////////////////////////////////////
+
+static void console_timestamp(struct console_ctx_t* ctx, char* buf, size_t len) {
+  struct timespec now, diff;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  diff = timespec_sub(now, ctx->start);
+
+  snprintf(buf, len, "[%4ld.%06ld]", (long)diff.tv_sec, diff.tv_nsec / 1000);
+}
+
+static void console_print_line(void* ptr, const char* line, size_t len) {
+  struct console_ctx_t* ctx = (struct console_ctx_t*)ptr;
+  char ts[32];
+
+  console_timestamp(ctx, ts, sizeof(ts));
+
+  printf("%s PULPino: %s\n", ts, line);
+
+  if (ctx->log)
+    fprintf(ctx->log, "%s PULPino: %s\n", ts, line);
+}
+
+static void console_store_frame(void* ptr, uint8_t type, const uint8_t* rec, size_t rec_len) {
+  struct console_ctx_t* ctx = (struct console_ctx_t*)ptr;
+  char ts[32];
+
+  console_timestamp(ctx, ts, sizeof(ts));
+
+  printf("%s PULPino: <record type %u, %u bytes>\n", ts, type,
+         (unsigned int)(rec_len - CONSOLE_FRAME_HDR_LEN - 2));
+
+  if (ctx->log)
+    fprintf(ctx->log, "%s PULPino: <record type %u, %u bytes>\n", ts, type,
+            (unsigned int)(rec_len - CONSOLE_FRAME_HDR_LEN - 2));
+
+  // records are stored as received, so they can be split again offline
+  if (ctx->bin)
+    fwrite(rec, 1, rec_len, ctx->bin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// serial port
+////////////////////////////////////////////////////////////////////////////////
+
+static int open_port(const char* tty)
 {
-  char buffer[256];
   struct termios2 tio;
   int fd;
-  unsigned int i;
-  int n;
-  char c;
 
-#ifdef ZYBO
-  if ((fd = open("/dev/ttyPS1", O_RDONLY | O_NOCTTY) ) < 0) {
-    perror("open_port: Unable to open /dev/ttyPS0");
-    return;
-  }
-#else
-  if ((fd = open("/dev/ttyPS0", O_RDONLY | O_NOCTTY) ) < 0) {
-    perror("open_port: Unable to open /dev/ttyPS0");
-    return;
+  if ((fd = open(tty, O_RDONLY | O_NOCTTY | O_NONBLOCK) ) < 0) {
+    fprintf(stderr, "open_port: Unable to open %s: %s\n", tty, strerror(errno));
+    return -1;
   }
-#endif
 
-  // set baudrate
+  // set baudrate and raw mode, so that binary records pass unchanged
   ioctl(fd, TCGETS2, &tio);
-  tio.c_cflag &= ~CBAUD;
-  tio.c_cflag |= BOTHER;
-  tio.c_ispeed = 156250;
-  tio.c_ospeed = 156250;
+  tio.c_cflag &= ~(CBAUD | CSIZE | PARENB);
+  tio.c_cflag |= BOTHER | CS8 | CREAD | CLOCAL;
+  tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+  tio.c_oflag &= ~OPOST;
+  tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+  tio.c_cc[VMIN]  = 1;
+  tio.c_cc[VTIME] = 0;
+  tio.c_ispeed = CONSOLE_BAUDRATE;
+  tio.c_ospeed = CONSOLE_BAUDRATE;
 
   if (ioctl(fd, TCSETS2, &tio) != 0) {
     perror("ioctl failed to set baudrate");
-    return;
+    close(fd);
+    return -1;
   }
 
+  return fd;
+}
 
-  i = 0;
-  while (!g_should_exit) {
-    int n = read(fd, &c, 1);
+void read_port()
+{
+  uint8_t buffer[CONSOLE_READ_LEN];
+  struct pollfd pfd;
+  int fd;
+  int n;
 
-    if (n == EINTR) {
-      // we were interrupted, so we assume we should exit
+  if ((fd = open_port(g_ctx.tty)) < 0)
+    return;
+
+  pfd.fd     = fd;
+  pfd.events = POLLIN;
+
+  while (1) {
+    // once we are asked to stop, drain what is left without waiting
+    n = poll(&pfd, 1, g_should_exit ? 0 : CONSOLE_POLL_MS);
+
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+
+      perror("poll failed");
       break;
+    }
 
-    } else if (n < 0) {
-      printf("read failed!\n");
-
-    } else if (n > 0) {
-      if (i == (sizeof(buffer) - 1) || c == '\n') {
-        buffer[i] = '\0';
-        printf("PULPino: %s\n", buffer);
-        i = 0;
-      } else {
-        buffer[i] = c;
-        i++;
-      }
+    if (n == 0) {
+      if (g_should_exit)
+        break;
+
+      continue;
     }
+
+    n = read(fd, buffer, sizeof(buffer));
+
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      perror("read failed");
+      break;
+    }
+
+    if (n == 0)
+      break;
+
+    console_parser_feed(&g_parser, buffer, n);
+
+    fflush(stdout);
   }
 
+  console_parser_flush(&g_parser);
+
   close(fd);
 }
 
 void* console_thread(void* ptr) {
   read_port();
+
+  return NULL;
+}
+
+static void console_files_close() {
+  if (g_ctx.log)
+    fclose(g_ctx.log);
+
+  if (g_ctx.bin)
+    fclose(g_ctx.bin);
+
+  g_ctx.log = NULL;
+  g_ctx.bin = NULL;
 }
 
-void console_thread_start() {
+int console_thread_start(struct cmd_arguments_t* arguments) {
+  g_ctx.tty = arguments->tty ? arguments->tty : CONSOLE_TTY;
+  g_ctx.log = NULL;
+  g_ctx.bin = NULL;
+
+  if (arguments->log && (g_ctx.log = fopen(arguments->log, "w")) == NULL) {
+    fprintf(stderr, "Unable to open log file %s: %s\n", arguments->log, strerror(errno));
+    return -1;
+  }
+
+  if (arguments->bin && (g_ctx.bin = fopen(arguments->bin, "wb")) == NULL) {
+    fprintf(stderr, "Unable to open record file %s: %s\n", arguments->bin, strerror(errno));
+    console_files_close();
+    return -1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &g_ctx.start);
+
+  console_parser_init(&g_parser);
+  g_parser.on_line  = console_print_line;
+  g_parser.on_frame = console_store_frame;
+  g_parser.ctx      = &g_ctx;
+
   g_should_exit = 0;
   if (pthread_create (&g_thread, NULL, console_thread, NULL) ) {
     printf("Error creating console listening thread\n");
+    console_files_close();
+    return -1;
   }
+
+  return 0;
 }
 
 void console_thread_stop() {
   g_should_exit = 1;
-  pthread_kill(g_thread, SIGINT);
   pthread_join(g_thread, NULL);
+
+  if (g_parser.frames || g_parser.bad_frames)
+    printf("Received %lu records, %lu corrupted\n", g_parser.frames, g_parser.bad_frames);
+
+  console_files_close();
 }
@@ -25,12 +25,15 @@
 #include <sys/mman.h>
 
 #include "spiloader.h"
+#include "spi_mem.h"
 
-#define SPIDEV               "/dev/spidev32766.0"
 #define CLKING_AXI_ADDR      0x51010000
 #define PULP_CTRL_AXI_ADDR   0x51000000
 
 
+// SPI device of PULPino's SPI slave, can be changed with --spidev
+const char* g_spidev = SPIDEV;
+
 #define MAP_SIZE 4096UL
 #define MAP_MASK (MAP_SIZE - 1)
 
@@ -142,6 +145,7 @@ int wait_eoc(unsigned int timeout) {
 
     if (spec_diff.tv_sec >= timeout) {
       printf ("Timeout reached!\n");
+      retval = 1;
       break;
     }
   }
@@ -167,7 +171,7 @@ int spi_read_reg(unsigned int addr) {
 
 
   // open spidev
-  fd = open(SPIDEV, O_RDWR);
+  fd = open(g_spidev, O_RDWR);
   if (fd <= 0) {
     perror("Device not found\n");
 
@@ -238,7 +242,7 @@ int set_boot_addr(uint32_t boot_addr) {
   wr_buf[8] = boot_addr;
 
   // open spidev
-  fd = open(SPIDEV, O_RDWR);
+  fd = open(g_spidev, O_RDWR);
   if (fd <= 0) {
     perror("Device not found\n");
 
@@ -300,7 +304,7 @@ int spi_load(uint32_t addr, char* in_buf, size_t in_size) {
   memcpy(wr_buf + 5, in_buf, in_size);
 
   // open spidev
-  fd = open(SPIDEV, O_RDWR);
+  fd = open(g_spidev, O_RDWR);
   if (fd <= 0) {
     perror("Device not found\n");
 
@@ -386,10 +390,14 @@ int main(int argc, char **argv)
   char* buffer;
   unsigned int size;
   int i;
+  int retval;
   struct cmd_arguments_t arguments;
 
   cmd_parsing(argc, argv, &arguments);
 
+  if (arguments.spidev)
+    g_spidev = arguments.spidev;
+
   clock_manager();
 
   // open binary and get data
@@ -432,11 +440,19 @@ int main(int argc, char **argv)
   free(buffer);
   close(fd);
 
+  // make sure a results descriptor of a previous run is not mistaken for ours
+  fd = spi_mem_open(g_spidev);
+  if (fd >= 0) {
+    spi_mem_clear_results(fd);
+    spi_mem_close(fd);
+  }
+
   // Start device and wait for timeout (if any)
   set_boot_addr(0x00000000);
 
   if (arguments.timeout > 0) {
-    console_thread_start();
+    if (console_thread_start(&arguments) != 0)
+      return 1;
     sleep(1);
   }
 
@@ -446,11 +462,15 @@ int main(int argc, char **argv)
   if (arguments.timeout > 0) {
     printf("Waiting for EOC...\n");
 
-    wait_eoc(arguments.timeout);
+    retval = wait_eoc(arguments.timeout);
 
     // wait for a moment to also let UART communication finish
     sleep(1);
     console_thread_stop();
+
+    // tell scripts driving us that the board did not reach EOC in time
+    if (retval > 0)
+      return SPILOAD_EXIT_TIMEOUT;
   }
 
   return 0;
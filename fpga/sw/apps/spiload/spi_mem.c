@@ -0,0 +1,197 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Bulk access to PULPino's memories through the SPI slave. Writes use command
+// 0x02, reads use command 0x0B which returns the data after 4 dummy bytes,
+// shifted by one bit.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/types.h>
+#include <linux/spi/spidev.h>
+
+#include "spi_mem.h"
+
+int spi_mem_open(const char* dev) {
+  int fd;
+
+  fd = open(dev ? dev : SPIDEV, O_RDWR);
+  if (fd < 0)
+    perror("Device not found");
+
+  return fd;
+}
+
+void spi_mem_close(int fd) {
+  if (fd >= 0)
+    close(fd);
+}
+
+static int spi_mem_read_burst(int fd, uint32_t addr, uint8_t* buf, size_t len) {
+  uint8_t wr_buf[SPI_MEM_MAX_TRANSFER];
+  uint8_t rd_buf[SPI_MEM_MAX_TRANSFER];
+  size_t size = (len + 3) & ~0x3;
+  unsigned int i;
+
+  struct spi_ioc_transfer transfer = {
+    .tx_buf        = (unsigned long)wr_buf,
+    .rx_buf        = (unsigned long)rd_buf,
+    .len           = size + SPI_MEM_RD_OVERHEAD,
+    .delay_usecs   = 0,
+    .speed_hz      = 0,
+    .bits_per_word = 0,
+  };
+
+  memset(wr_buf, 0, transfer.len);
+  memset(rd_buf, 0, transfer.len);
+
+  wr_buf[0] = 0x0B; // read command
+  // address
+  wr_buf[1] = addr >> 24;
+  wr_buf[2] = addr >> 16;
+  wr_buf[3] = addr >> 8;
+  wr_buf[4] = addr;
+
+  if (ioctl(fd, SPI_IOC_MESSAGE(1), &transfer) < 0) {
+    perror("SPI_IOC_MESSAGE");
+    return -1;
+  }
+
+  // shift everything by one bit, only the part we are going to use
+  for(i = 9; i < 9 + len; i++)
+    buf[i - 9] = (rd_buf[i] << 1) | ((rd_buf[i+1] & 0x80) >> 7);
+
+  return 0;
+}
+
+int spi_mem_read(int fd, uint32_t addr, void* buf, size_t len) {
+  uint8_t* dst = (uint8_t*)buf;
+  size_t burst;
+
+  while (len > 0) {
+    burst = len < SPI_MEM_MAX_BURST ? len : SPI_MEM_MAX_BURST;
+
+    if (spi_mem_read_burst(fd, addr, dst, burst) != 0)
+      return -1;
+
+    addr += burst;
+    dst  += burst;
+    len  -= burst;
+  }
+
+  return 0;
+}
+
+int spi_mem_write(int fd, uint32_t addr, const void* buf, size_t len) {
+  uint8_t wr_buf[SPI_MEM_MAX_TRANSFER];
+  const uint8_t* src = (const uint8_t*)buf;
+  size_t burst, size;
+
+  while (len > 0) {
+    burst = len < SPI_MEM_MAX_BURST ? len : SPI_MEM_MAX_BURST;
+    // transfers have to be 32 bit aligned
+    size  = (burst + 3) & ~0x3;
+
+    memset(wr_buf, 0, size + SPI_MEM_WR_OVERHEAD);
+
+    wr_buf[0] = 0x02; // write command
+    // address
+    wr_buf[1] = addr >> 24;
+    wr_buf[2] = addr >> 16;
+    wr_buf[3] = addr >> 8;
+    wr_buf[4] = addr;
+
+    memcpy(wr_buf + SPI_MEM_WR_OVERHEAD, src, burst);
+
+    if (write(fd, wr_buf, size + SPI_MEM_WR_OVERHEAD) != (size + SPI_MEM_WR_OVERHEAD)) {
+      perror("Write Error");
+      return -1;
+    }
+
+    addr += burst;
+    src  += burst;
+    len  -= burst;
+  }
+
+  return 0;
+}
+
+// the descriptor is read in PULPino's byte order (little endian), as is the
+// ARM host of the ZYNQ
+int spi_mem_read_results(int fd, struct results_desc_t* desc, uint8_t** buf) {
+  *buf = NULL;
+
+  if (spi_mem_read(fd, RESULTS_DESC_ADDR, desc, sizeof(*desc)) != 0)
+    return -1;
+
+  if (desc->magic != RESULTS_MAGIC) {
+    printf("No results published (descriptor magic is %08X)\n", desc->magic);
+    return -1;
+  }
+
+  *buf = (uint8_t*)malloc(desc->len ? desc->len : 1);
+  if (*buf == NULL) {
+    printf("Unable to allocate %u bytes for the results\n", desc->len);
+    return -1;
+  }
+
+  if (spi_mem_read(fd, desc->addr, *buf, desc->len) != 0) {
+    free(*buf);
+    *buf = NULL;
+    return -1;
+  }
+
+  return 0;
+}
+
+int spi_mem_clear_results(int fd) {
+  struct results_desc_t desc;
+
+  memset(&desc, 0, sizeof(desc));
+
+  return spi_mem_write(fd, RESULTS_DESC_ADDR, &desc, sizeof(desc));
+}
+
+// compares word by word and prints the first max_report mismatching words,
+// returns the number of mismatching words
+size_t mem_compare(uint32_t addr, const uint8_t* actual, const uint8_t* expected,
+                   size_t len, unsigned int max_report) {
+  size_t errors = 0;
+  size_t i, j, n;
+  uint32_t act, exp;
+
+  for (i = 0; i < len; i += 4) {
+    n = (len - i) < 4 ? (len - i) : 4;
+
+    if (memcmp(actual + i, expected + i, n) == 0)
+      continue;
+
+    if (errors < max_report) {
+      act = exp = 0;
+      for (j = 0; j < n; j++) {
+        act |= actual[i + j]   << (8 * j);
+        exp |= expected[i + j] << (8 * j);
+      }
+
+      printf("Mismatch at %08X: expected %08X, got %08X\n", (unsigned int)(addr + i), exp, act);
+    }
+
+    errors++;
+  }
+
+  if (errors > max_report)
+    printf("... %u more mismatching words\n", (unsigned int)(errors - max_report));
+
+  return errors;
+}
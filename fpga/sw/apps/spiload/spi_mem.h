@@ -0,0 +1,53 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef SPI_MEM_H
+#define SPI_MEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPIDEV               "/dev/spidev32766.0"
+
+// spidev limits a single transfer to its bufsiz (4096 bytes by default), each
+// transfer carries the command, address and dummy bytes plus one spare word
+// needed to undo the one bit shift of the read data
+#ifndef SPI_MEM_MAX_TRANSFER
+#define SPI_MEM_MAX_TRANSFER 4096
+#endif
+
+#define SPI_MEM_RD_OVERHEAD  (9 + 4)
+#define SPI_MEM_WR_OVERHEAD  5
+#define SPI_MEM_MAX_BURST    ((SPI_MEM_MAX_TRANSFER - SPI_MEM_RD_OVERHEAD) & ~0x3)
+
+// has to match RESULTS_DESC_ADDR and RESULTS_MAGIC in sys_lib/inc/results.h
+#define RESULTS_DESC_ADDR    0x00105FF0
+#define RESULTS_MAGIC        0x50524553
+
+struct results_desc_t {
+  uint32_t magic;
+  uint32_t addr;
+  uint32_t len;
+  uint32_t seq;
+};
+
+int  spi_mem_open(const char* dev);
+void spi_mem_close(int fd);
+
+int spi_mem_read(int fd, uint32_t addr, void* buf, size_t len);
+int spi_mem_write(int fd, uint32_t addr, const void* buf, size_t len);
+
+int spi_mem_read_results(int fd, struct results_desc_t* desc, uint8_t** buf);
+int spi_mem_clear_results(int fd);
+
+size_t mem_compare(uint32_t addr, const uint8_t* actual, const uint8_t* expected,
+                   size_t len, unsigned int max_report);
+
+#endif
@@ -0,0 +1,197 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Reads memory regions of PULPino through the SPI slave, optionally writes
+// them to a file and compares them against an expected image.
+//
+//   spidump --addr=0x100000 --len=4096 --out=dump.bin
+//   spidump --addr=0x100000 --expect=golden.bin
+//   spidump --results --out=results.bin
+
+#include <argp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "spiloader.h"
+#include "spi_mem.h"
+
+struct dump_arguments_t {
+  char*        dev;
+  uint32_t     addr;
+  size_t       len;
+  char*        out;
+  char*        expect;
+  int          results;
+  unsigned int max_report;
+};
+
+static struct argp_option options[] = {
+  {"dev",        'd', "DEV",  0, "SPI device PULPino's SPI slave is connected to" },
+  {"addr",       'a', "ADDR", 0, "Start address of the region to read" },
+  {"len",        'n', "LEN",  0, "Number of bytes to read, defaults to the size of the expected image" },
+  {"out",        'o', "FILE", 0, "Write the memory contents to FILE" },
+  {"expect",     'e', "FILE", 0, "Compare the memory contents against FILE" },
+  {"results",    'r', 0,      0, "Read the region published by the application through results_publish" },
+  {"max-report", 'm', "N",    0, "Report at most N mismatching words (default 16)" },
+  { 0 }
+};
+
+static error_t
+parse_opt (int key, char *arg, struct argp_state *state)
+{
+  struct dump_arguments_t *arguments = (struct dump_arguments_t*)state->input;
+
+  switch (key)
+  {
+  case 'd': arguments->dev        = arg;                     break;
+  case 'a': arguments->addr       = strtoul(arg, NULL, 0);   break;
+  case 'n': arguments->len        = strtoul(arg, NULL, 0);   break;
+  case 'o': arguments->out        = arg;                     break;
+  case 'e': arguments->expect     = arg;                     break;
+  case 'r': arguments->results    = 1;                       break;
+  case 'm': arguments->max_report = strtoul(arg, NULL, 0);   break;
+
+  case ARGP_KEY_INIT:
+    memset(arguments, 0, sizeof(*arguments));
+    arguments->max_report = 16;
+    break;
+
+  case ARGP_KEY_END:
+    if (!arguments->results && arguments->len == 0 && arguments->expect == NULL)
+      argp_error(state, "either --len, --expect or --results is needed");
+    break;
+
+  default:
+    return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+static struct argp argp = { options, parse_opt, 0, "Read and compare PULPino memory over SPI" };
+
+static uint8_t* read_file(const char* name, size_t* size) {
+  FILE* f;
+  uint8_t* buf;
+
+  if ((f = fopen(name, "rb")) == NULL) {
+    perror(name);
+    return NULL;
+  }
+
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  buf = (uint8_t*)malloc(*size ? *size : 1);
+  if (buf == NULL || fread(buf, 1, *size, f) != *size) {
+    printf("Unable to read %s\n", name);
+    free(buf);
+    buf = NULL;
+  }
+
+  fclose(f);
+  return buf;
+}
+
+int main(int argc, char **argv)
+{
+  struct dump_arguments_t arguments;
+  struct results_desc_t desc;
+  struct timespec spec_start, spec_end, spec_diff;
+  uint8_t* expected = NULL;
+  uint8_t* data = NULL;
+  size_t expected_len = 0;
+  size_t errors;
+  double secs;
+  int retval = 1;
+  int fd;
+  FILE* f;
+
+  argp_parse (&argp, argc, argv, 0, 0, &arguments);
+
+  if (arguments.expect) {
+    expected = read_file(arguments.expect, &expected_len);
+    if (expected == NULL)
+      return 1;
+
+    if (arguments.len == 0)
+      arguments.len = expected_len;
+  }
+
+  if ((fd = spi_mem_open(arguments.dev)) < 0)
+    goto fail;
+
+  clock_gettime(CLOCK_MONOTONIC, &spec_start);
+
+  if (arguments.results) {
+    if (spi_mem_read_results(fd, &desc, &data) != 0)
+      goto fail;
+
+    arguments.addr = desc.addr;
+    arguments.len  = desc.len;
+
+    printf("Results #%u at %08X, %u bytes\n", desc.seq, desc.addr, desc.len);
+  } else {
+    data = (uint8_t*)malloc(arguments.len);
+    if (data == NULL) {
+      printf("Unable to allocate %u bytes\n", (unsigned int)arguments.len);
+      goto fail;
+    }
+
+    if (spi_mem_read(fd, arguments.addr, data, arguments.len) != 0)
+      goto fail;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &spec_end);
+  spec_diff = timespec_sub(spec_end, spec_start);
+  secs = spec_diff.tv_sec + spec_diff.tv_nsec * 1e-9;
+
+  printf("Read %u bytes from %08X in %.3f s (%.1f kB/s)\n", (unsigned int)arguments.len,
+         arguments.addr, secs, secs > 0 ? arguments.len / secs / 1000 : 0.0);
+
+  if (arguments.out) {
+    if ((f = fopen(arguments.out, "wb")) == NULL) {
+      perror(arguments.out);
+      goto fail;
+    }
+
+    fwrite(data, 1, arguments.len, f);
+    fclose(f);
+  }
+
+  retval = 0;
+
+  if (expected) {
+    if (expected_len != arguments.len) {
+      printf("Size mismatch: expected %u bytes, got %u\n", (unsigned int)expected_len, (unsigned int)arguments.len);
+      retval = 1;
+    }
+
+    errors = mem_compare(arguments.addr, data, expected,
+                         expected_len < arguments.len ? expected_len : arguments.len,
+                         arguments.max_report);
+
+    if (errors) {
+      printf("Compare failed: %u mismatching words\n", (unsigned int)errors);
+      retval = 1;
+    } else {
+      printf("Compare passed\n");
+    }
+  }
+
+fail:
+  spi_mem_close(fd);
+  free(data);
+  free(expected);
+
+  return retval;
+}
@@ -12,6 +12,8 @@
 #define SPILOADER_H
 
 #include <time.h>
+#include <stdint.h>
+#include <stddef.h>
 
 static inline struct timespec timespec_sub(struct timespec lhs, struct timespec rhs) {
   struct timespec ret;
@@ -29,12 +31,58 @@ static inline struct timespec timespec_sub(struct timespec lhs, struct timespec
   return ret;
 }
 
+// exit code of spiload when EOC was not seen before the timeout
+#define SPILOAD_EXIT_TIMEOUT 2
+
 struct cmd_arguments_t {
   char* stim;
   unsigned int timeout;
+  char* spidev;
+  char* tty;
+  char* log;
+  char* bin;
 };
 
+// Binary records may be embedded in the UART stream, see uart_send_frame in
+// sys_lib. A record looks like
+//   ESC 'P' 'F' | type | len[7:0] | len[15:8] | payload | sum[7:0] | sum[15:8]
+// where sum is the 16 bit sum over type, both length bytes and the payload.
+#define CONSOLE_FRAME_MAGIC0   0x1B
+#define CONSOLE_FRAME_MAGIC1   'P'
+#define CONSOLE_FRAME_MAGIC2   'F'
+#define CONSOLE_FRAME_HDR_LEN  6
+#define CONSOLE_FRAME_MAX_LEN  65535
+
+#define CONSOLE_LINE_LEN       256
+
+struct console_parser_t {
+  int            state;
+  unsigned int   pos;
+
+  char           line[CONSOLE_LINE_LEN];
+  unsigned int   line_len;
+
+  uint8_t        type;
+  uint16_t       len;
+  uint16_t       sum;
+  uint8_t        frame[CONSOLE_FRAME_HDR_LEN + CONSOLE_FRAME_MAX_LEN + 2];
+
+  unsigned long  frames;
+  unsigned long  bad_frames;
+
+  void (*on_line) (void* ctx, const char* line, size_t len);
+  void (*on_frame)(void* ctx, uint8_t type, const uint8_t* rec, size_t rec_len);
+  void*          ctx;
+};
+
+void console_parser_init(struct console_parser_t* p);
+void console_parser_feed(struct console_parser_t* p, const uint8_t* buf, size_t len);
+void console_parser_flush(struct console_parser_t* p);
+
+void cmd_parsing(int argc, char* argv[], struct cmd_arguments_t* arguments);
+
 void* console_thread(void* ptr);
+int  console_thread_start(struct cmd_arguments_t* arguments);
 void console_thread_stop();
 
 #endif
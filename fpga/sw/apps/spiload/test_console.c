@@ -0,0 +1,240 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Host test for the console capture. A pseudo terminal stands in for the
+// UART, the test writes text lines and binary records into it as fast as the
+// pty accepts them and then checks that the log and record files contain
+// every single byte.
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+#include "spiloader.h"
+
+#define NUM_LINES   20000
+#define RECORD_LEN  1000
+
+static char*  g_stream;
+static size_t g_stream_len;
+static char*  g_records;
+static size_t g_records_len;
+
+static void append(char** buf, size_t* len, const void* data, size_t n) {
+  *buf = realloc(*buf, *len + n);
+  memcpy(*buf + *len, data, n);
+  *len += n;
+}
+
+static void append_record(uint8_t type, const uint8_t* data, uint16_t len, int corrupt) {
+  uint8_t hdr[CONSOLE_FRAME_HDR_LEN] = { CONSOLE_FRAME_MAGIC0, CONSOLE_FRAME_MAGIC1, CONSOLE_FRAME_MAGIC2,
+                                         type, len & 0xFF, len >> 8 };
+  uint16_t sum = type + (len & 0xFF) + (len >> 8);
+  uint8_t  trailer[2];
+  unsigned int i;
+
+  for (i = 0; i < len; i++)
+    sum += data[i];
+
+  if (corrupt)
+    sum ^= 0x1;
+
+  trailer[0] = sum & 0xFF;
+  trailer[1] = sum >> 8;
+
+  append(&g_stream, &g_stream_len, hdr, sizeof(hdr));
+  append(&g_stream, &g_stream_len, data, len);
+  append(&g_stream, &g_stream_len, trailer, sizeof(trailer));
+
+  if (!corrupt) {
+    append(&g_records, &g_records_len, hdr, sizeof(hdr));
+    append(&g_records, &g_records_len, data, len);
+    append(&g_records, &g_records_len, trailer, sizeof(trailer));
+  }
+}
+
+static void build_stream(void) {
+  uint8_t data[RECORD_LEN];
+  char line[128];
+  unsigned int i, j;
+
+  for (i = 0; i < NUM_LINES; i++) {
+    // an escape character that does not start a record must stay text
+    if (i % 1000 == 500)
+      snprintf(line, sizeof(line), "line %d \x1bX not a record\r\n", i);
+    else
+      snprintf(line, sizeof(line), "line %d abcdefghijklmnopqrstuvwxyz0123456789\n", i);
+
+    append(&g_stream, &g_stream_len, line, strlen(line));
+
+    if (i % 100 == 99) {
+      for (j = 0; j < RECORD_LEN; j++)
+        data[j] = (i + j) & 0xFF;
+
+      // records may contain newlines and escape characters
+      data[0] = '\n';
+      data[1] = CONSOLE_FRAME_MAGIC0;
+
+      append_record(i / 100, data, RECORD_LEN, i == 999);
+    }
+  }
+}
+
+static char* read_file(const char* name, size_t* len) {
+  FILE* f = fopen(name, "rb");
+  char* buf;
+
+  if (f == NULL)
+    return NULL;
+
+  fseek(f, 0, SEEK_END);
+  *len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  buf = malloc(*len + 1);
+  if (fread(buf, 1, *len, f) != *len) {
+    fclose(f);
+    free(buf);
+    return NULL;
+  }
+  buf[*len] = '\0';
+  fclose(f);
+
+  return buf;
+}
+
+static int check_log(const char* log) {
+  char expected[128];
+  char* line;
+  char* save;
+  unsigned int n = 0, records = 0;
+  int errors = 0;
+
+  for (line = strtok_r((char*)log, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+    char* text = strstr(line, "PULPino: ");
+
+    if (line[0] != '[' || text == NULL) {
+      printf("Malformed log line: %s\n", line);
+      errors++;
+      continue;
+    }
+    text += strlen("PULPino: ");
+
+    if (strncmp(text, "<record", 7) == 0) {
+      records++;
+      continue;
+    }
+
+    if (n % 1000 == 500)
+      snprintf(expected, sizeof(expected), "line %d \x1bX not a record", n);
+    else
+      snprintf(expected, sizeof(expected), "line %d abcdefghijklmnopqrstuvwxyz0123456789", n);
+
+    if (strcmp(text, expected) != 0) {
+      printf("Line %d: expected \"%s\", got \"%s\"\n", n, expected, text);
+      errors++;
+    }
+    n++;
+  }
+
+  if (n != NUM_LINES) {
+    printf("Expected %d lines, got %d\n", NUM_LINES, n);
+    errors++;
+  }
+
+  if (records != NUM_LINES / 100 - 1) {
+    printf("Expected %d records, got %d\n", NUM_LINES / 100 - 1, records);
+    errors++;
+  }
+
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  char log_name[] = "/tmp/spiload_test_logXXXXXX";
+  char bin_name[] = "/tmp/spiload_test_binXXXXXX";
+  struct cmd_arguments_t arguments;
+  struct termios tio;
+  char* log;
+  char* bin;
+  size_t log_len, bin_len;
+  size_t pos;
+  ssize_t n;
+  int master, slave;
+  int errors = 0;
+
+  build_stream();
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("Unable to create pty");
+    return 1;
+  }
+
+  // keep the slave side open and in raw mode for the whole test, so nothing
+  // is mangled before the console thread has configured the port
+  slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  close(mkstemp(log_name));
+  close(mkstemp(bin_name));
+
+  memset(&arguments, 0, sizeof(arguments));
+  arguments.tty = ptsname(master);
+  arguments.log = log_name;
+  arguments.bin = bin_name;
+
+  if (console_thread_start(&arguments) != 0)
+    return 1;
+
+  // push the whole stream, write blocks whenever the reader falls behind
+  for (pos = 0; pos < g_stream_len; pos += n) {
+    n = write(master, g_stream + pos, g_stream_len - pos);
+    if (n < 0) {
+      perror("write");
+      return 1;
+    }
+  }
+
+  tcdrain(master);
+  console_thread_stop();
+
+  log = read_file(log_name, &log_len);
+  bin = read_file(bin_name, &bin_len);
+
+  if (log == NULL || bin == NULL) {
+    printf("Unable to read back log files\n");
+    return 1;
+  }
+
+  errors += check_log(log);
+
+  if (bin_len != g_records_len || memcmp(bin, g_records, bin_len) != 0) {
+    printf("Record file mismatch: expected %u bytes, got %u\n",
+           (unsigned int)g_records_len, (unsigned int)bin_len);
+    errors++;
+  }
+
+  unlink(log_name);
+  unlink(bin_name);
+  close(slave);
+  close(master);
+
+  printf("==== %u bytes: %s\n", (unsigned int)g_stream_len, errors ? "FAIL" : "SUCCESS");
+
+  return errors ? 1 : 0;
+}
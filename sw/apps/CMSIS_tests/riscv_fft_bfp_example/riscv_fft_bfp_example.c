@@ -0,0 +1,237 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Compares the block floating point Q15 FFTs with the floating point CFFT.
+// The same signal is transformed at full scale and at two small levels, where
+// riscv_cfft_q15 has shifted most of it out by the last stage. The SNR of the
+// block floating point version has to stay the same at every level.
+
+#include <stdio.h>
+#include <math.h>
+#include "bench.h"
+#include "timer.h"
+#include "riscv_math.h"
+#include "riscv_const_structs.h"
+
+#define FFT_LEN   256
+#define RFFT_LEN  512
+#define MIN_SNR   50.0     // dB, 256 points keep about 58 dB
+
+static q15_t     buf_q15[2 * FFT_LEN]    __attribute__ ((section(".heapsram"), aligned (4)));
+static q15_t     bfp_q15[2 * FFT_LEN]    __attribute__ ((section(".heapsram"), aligned (4)));
+static float32_t ref_f32[2 * FFT_LEN]    __attribute__ ((section(".heapsram")));
+
+static q15_t     x_q15[RFFT_LEN]         __attribute__ ((section(".heapsram")));
+static q15_t     in_q15[RFFT_LEN + 2]    __attribute__ ((section(".heapsram"), aligned (4)));
+static q15_t     spec_q15[2 * RFFT_LEN]  __attribute__ ((section(".heapsram"), aligned (4)));
+static q15_t     out_q15[2 * RFFT_LEN]   __attribute__ ((section(".heapsram"), aligned (4)));
+
+static const int levels[] = { 32000, 512, 16 };
+
+void check_cfft   (testresult_t *result, void (*start)(), void (*stop)());
+void check_rfft   (testresult_t *result, void (*start)(), void (*stop)());
+void check_cost   (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "cfft", .test = check_cfft },
+  { .name = "rfft", .test = check_rfft },
+  { .name = "cost", .test = check_cost },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// two tones and some noise, scaled to peak at level
+static void make_signal(q15_t* pDst, uint32_t len, int level)
+{
+  uint32_t seed = 1;
+  uint32_t i;
+  float32_t v;
+
+  for (i = 0; i < len; i++) {
+    seed = seed * 1103515245u + 12345u;
+    v = 0.5f * sinf(0.19f * i) + 0.3f * cosf(1.37f * i) + 0.2f * ((int32_t)(seed >> 16) - 32768) / 32768.0f;
+    pDst[i] = (q15_t) (v * level);
+  }
+}
+
+// SNR of pTest * 2^exp against pRef in dB
+static double snr(const float32_t* pRef, const q15_t* pTest, int32_t exp, uint32_t len)
+{
+  double s = 0.0, e = 0.0, d;
+  uint32_t i;
+
+  for (i = 0; i < len; i++) {
+    d  = pRef[i] - ldexp(pTest[i], exp);
+    s += (double) pRef[i] * pRef[i];
+    e += d * d;
+  }
+
+  return e == 0.0 ? 200.0 : 10.0 * log10(s / e);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// complex
+////////////////////////////////////////////////////////////////////////////////
+
+void check_cfft(testresult_t *result, void (*start)(), void (*stop)()) {
+  double s_bfp, s_q15;
+  int32_t exp;
+  uint32_t l, i;
+
+  for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+    make_signal(buf_q15, 2 * FFT_LEN, levels[l]);
+
+    for (i = 0; i < 2 * FFT_LEN; i++) {
+      ref_f32[i] = buf_q15[i];
+      bfp_q15[i] = buf_q15[i];
+    }
+
+    riscv_cfft_f32(&riscv_cfft_sR_f32_len256, ref_f32, 0, 1);
+    exp = riscv_cfft_bfp_q15(&riscv_cfft_sR_q15_len256, bfp_q15, 0, 1);
+
+    // riscv_cfft_q15 divides by the length
+    riscv_cfft_q15(&riscv_cfft_sR_q15_len256, buf_q15, 0, 1);
+
+    s_bfp = snr(ref_f32, bfp_q15, exp, 2 * FFT_LEN);
+    s_q15 = snr(ref_f32, buf_q15, 8, 2 * FFT_LEN);
+
+    printf("Level %5d: block floating point %d dB (exponent %d), q15 %d dB\n",
+           levels[l], (int) s_bfp, (int) exp, (int) s_q15);
+
+    if (s_bfp < MIN_SNR) {
+      printf("Level %d: SNR too low\n", levels[l]);
+      result->errors++;
+    }
+
+    if (levels[l] < 1000 && s_bfp < s_q15 + 20.0) {
+      printf("Level %d: no better than riscv_cfft_q15\n", levels[l]);
+      result->errors++;
+    }
+  }
+
+  // the inverse of the forward transform is the input times the length
+  make_signal(buf_q15, 2 * FFT_LEN, levels[2]);
+
+  for (i = 0; i < 2 * FFT_LEN; i++) {
+    ref_f32[i] = buf_q15[i] * (float32_t) FFT_LEN;
+    bfp_q15[i] = buf_q15[i];
+  }
+
+  exp  = riscv_cfft_bfp_q15(&riscv_cfft_sR_q15_len256, bfp_q15, 0, 1);
+  exp += riscv_cfft_bfp_q15(&riscv_cfft_sR_q15_len256, bfp_q15, 1, 1);
+
+  s_bfp = snr(ref_f32, bfp_q15, exp, 2 * FFT_LEN);
+  printf("Round trip: %d dB\n", (int) s_bfp);
+
+  if (s_bfp < MIN_SNR - 3.0) {
+    printf("Round trip: SNR too low\n");
+    result->errors++;
+  }
+
+  // all zero in, all zero out
+  for (i = 0; i < 2 * FFT_LEN; i++)
+    bfp_q15[i] = 0;
+
+  check_uint32(result, "zero exponent", riscv_cfft_bfp_q15(&riscv_cfft_sR_q15_len256, bfp_q15, 0, 1), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// real
+////////////////////////////////////////////////////////////////////////////////
+
+void check_rfft(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_rfft_instance_q15 S_fwd, S_inv;
+  double s;
+  int32_t exp;
+  uint32_t l, i;
+
+  riscv_rfft_init_q15(&S_fwd, RFFT_LEN, 0, 1);
+  riscv_rfft_init_q15(&S_inv, RFFT_LEN, 1, 1);
+
+  for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+    make_signal(x_q15, RFFT_LEN, levels[l]);
+
+    for (i = 0; i < RFFT_LEN; i++)
+      in_q15[i] = x_q15[i];
+
+    exp = riscv_rfft_bfp_q15(&S_fwd, in_q15, spec_q15);
+
+    // the even bins of the RFFT are the FFT_LEN point spectrum of the sum
+    // of both halves of the signal, which serves as the reference
+    for (i = 0; i < FFT_LEN; i++) {
+      ref_f32[2 * i]     = x_q15[i] + x_q15[i + FFT_LEN];
+      ref_f32[2 * i + 1] = 0.0f;
+    }
+
+    riscv_cfft_f32(&riscv_cfft_sR_f32_len256, ref_f32, 0, 1);
+
+    for (i = 0; i < FFT_LEN; i++) {
+      buf_q15[2 * i]     = spec_q15[4 * i];
+      buf_q15[2 * i + 1] = spec_q15[4 * i + 1];
+    }
+
+    s = snr(ref_f32, buf_q15, exp, 2 * FFT_LEN);
+    printf("Level %5d: RFFT %d dB (exponent %d)\n", levels[l], (int) s, (int) exp);
+
+    if (s < MIN_SNR - 3.0) {
+      printf("Level %d: RFFT SNR too low\n", levels[l]);
+      result->errors++;
+    }
+
+    // and back, RIFFT returns the signal times the length
+    for (i = 0; i < RFFT_LEN + 2; i++)
+      in_q15[i] = spec_q15[i];
+
+    exp += riscv_rfft_bfp_q15(&S_inv, in_q15, out_q15);
+
+    for (i = 0; i < RFFT_LEN; i++)
+      ref_f32[i] = x_q15[i] * (float32_t) RFFT_LEN;
+
+    s = snr(ref_f32, out_q15, exp, RFFT_LEN);
+    printf("Level %5d: RIFFT %d dB\n", levels[l], (int) s);
+
+    if (s < MIN_SNR - 6.0) {
+      printf("Level %d: RIFFT SNR too low\n", levels[l]);
+      result->errors++;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cost
+////////////////////////////////////////////////////////////////////////////////
+
+void check_cost(testresult_t *result, void (*start)(), void (*stop)()) {
+  int bfp, ref;
+
+  make_signal(buf_q15, 2 * FFT_LEN, levels[1]);
+
+  start();
+  riscv_cfft_bfp_q15(&riscv_cfft_sR_q15_len256, buf_q15, 0, 1);
+  stop();
+
+  bfp = get_time();
+  printf("Block floating point, %d points: %d cycles\n", FFT_LEN, bfp);
+
+  make_signal(buf_q15, 2 * FFT_LEN, levels[1]);
+
+  start();
+  riscv_cfft_q15(&riscv_cfft_sR_q15_len256, buf_q15, 0, 1);
+  stop();
+
+  ref = get_time();
+  printf("riscv_cfft_q15, %d points: %d cycles\n", FFT_LEN, ref);
+  if (ref > 0)
+    printf("Block floating point takes %d%% of the cycles of riscv_cfft_q15\n", 100 * bfp / ref);
+}
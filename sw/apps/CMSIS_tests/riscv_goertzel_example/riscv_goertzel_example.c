@@ -0,0 +1,333 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Tone detection with the Goertzel filter banks and the sliding DFT. Decodes
+// a DTMF sequence fed in blocks that do not line up with the windows, checks
+// the reported powers against a floating point DFT, follows a tone that is
+// switched on and off with the sliding DFT, and compares the cycles for K
+// tones with a full real FFT of the same window.
+
+#include <stdio.h>
+#include <math.h>
+#include "bench.h"
+#include "timer.h"
+#include "riscv_math.h"
+
+#define FS          8000
+#define DTMF_LEN    205                 // window of the classic DTMF detector
+#define BLOCK       80                  // 10 ms blocks
+#define SIG_LEN     (7 * 3 * DTMF_LEN)
+#define COST_LEN    256
+#define MAX_TONES   16
+
+static q15_t x_q15[SIG_LEN]             __attribute__ ((section(".heapsram")));
+static q31_t x_q31[COST_LEN]            __attribute__ ((section(".heapsram")));
+static q31_t power[8 * SIG_LEN / DTMF_LEN + MAX_TONES];
+static q31_t coeffs[3 * MAX_TONES];
+static q31_t state[2 * MAX_TONES];
+static q15_t delay[COST_LEN]            __attribute__ ((section(".heapsram")));
+static q15_t fft_in[COST_LEN]           __attribute__ ((section(".heapsram")));
+static q15_t fft_out[2 * COST_LEN]      __attribute__ ((section(".heapsram")));
+static q15_t mag[COST_LEN]              __attribute__ ((section(".heapsram")));
+
+static const int dtmf_freqs[8] = { 697, 770, 852, 941, 1209, 1336, 1477, 1633 };
+static const char keys[4][4] = {
+  { '1', '2', '3', 'A' },
+  { '4', '5', '6', 'B' },
+  { '7', '8', '9', 'C' },
+  { '*', '0', '#', 'D' }
+};
+static const char digits[] = "159#0*D";
+
+void check_dtmf   (testresult_t *result, void (*start)(), void (*stop)());
+void check_power  (testresult_t *result, void (*start)(), void (*stop)());
+void check_sdft   (testresult_t *result, void (*start)(), void (*stop)());
+void check_cost   (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "dtmf",  .test = check_dtmf  },
+  { .name = "power", .test = check_power },
+  { .name = "sdft",  .test = check_sdft  },
+  { .name = "cost",  .test = check_cost  },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// f / fs in 1.31 format
+static q31_t freq_q31(float32_t f)
+{
+  return (q31_t) (f / FS * 2147483648.0f);
+}
+
+static uint32_t noise(uint32_t* seed)
+{
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 16;
+}
+
+// power of (|DFT| / len)^2 at f, the way the detectors report it
+static float32_t dft_power(const q15_t* pSrc, uint32_t len, float32_t f)
+{
+  float32_t re = 0.0f, im = 0.0f;
+  uint32_t i;
+
+  for (i = 0; i < len; i++) {
+    re += pSrc[i] / 32768.0f * cosf(2.0f * (float32_t) M_PI * f / FS * i);
+    im += pSrc[i] / 32768.0f * sinf(2.0f * (float32_t) M_PI * f / FS * i);
+  }
+
+  return (re * re + im * im) / ((float32_t) len * len);
+}
+
+static float32_t to_db(float32_t p)
+{
+  return 10.0f * log10f(p > 1e-12f ? p : 1e-12f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DTMF
+////////////////////////////////////////////////////////////////////////////////
+
+void check_dtmf(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_goertzel_instance_q15 S;
+  q31_t freqs[8];
+  char decoded[sizeof(digits)];
+  uint32_t windows, w, i, n, d, row, col, seed = 7;
+  int last = -1;
+  uint32_t count = 0;
+
+  // every digit lasts two windows and is followed by one window of silence
+  for (d = 0; d < sizeof(digits) - 1; d++) {
+    for (i = 0; i < 16 && keys[i / 4][i % 4] != digits[d]; i++)
+      ;
+    row = i / 4;
+    col = i % 4;
+
+    for (i = 0; i < 3 * DTMF_LEN; i++) {
+      n = d * 3 * DTMF_LEN + i;
+      x_q15[n] = (q15_t) (((int32_t) noise(&seed) - 32768) >> 7);
+
+      if (i < 2 * DTMF_LEN)
+        x_q15[n] += (q15_t) (10000.0f * sinf(2.0f * (float32_t) M_PI * dtmf_freqs[row] / FS * n)
+                           + 10000.0f * sinf(2.0f * (float32_t) M_PI * dtmf_freqs[4 + col] / FS * n));
+    }
+  }
+
+  for (i = 0; i < 8; i++)
+    freqs[i] = freq_q31(dtmf_freqs[i]);
+
+  check_uint32(result, "init", riscv_goertzel_init_q15(&S, 8, freqs, coeffs, state, DTMF_LEN),
+               RISCV_MATH_SUCCESS);
+
+  start();
+  windows = 0;
+  for (i = 0; i < SIG_LEN; i += BLOCK) {
+    n = (SIG_LEN - i < BLOCK) ? SIG_LEN - i : BLOCK;
+    windows += riscv_goertzel_q15(&S, &x_q15[i], n, &power[8 * windows]);
+  }
+  stop();
+
+  check_uint32(result, "windows", windows, SIG_LEN / DTMF_LEN);
+  printf("%d windows of %d samples: %d cycles\n", windows, DTMF_LEN, get_time());
+
+  // strongest row and column tone, both clearly above the noise
+  for (w = 0; w < windows; w++) {
+    row = 0;
+    col = 4;
+    for (i = 1; i < 4; i++) {
+      if (power[8 * w + i] > power[8 * w + row])
+        row = i;
+      if (power[8 * w + 4 + i] > power[8 * w + col])
+        col = 4 + i;
+    }
+
+    if (power[8 * w + row] > 0x01000000 && power[8 * w + col] > 0x01000000) {
+      if ((int) (4 * row + col) != last && count < sizeof(digits) - 1)
+        decoded[count++] = keys[row][col - 4];
+      last = 4 * row + col;
+    } else {
+      last = -1;
+    }
+  }
+  decoded[count] = 0;
+
+  printf("Decoded \"%s\"\n", decoded);
+
+  for (d = 0; d < sizeof(digits); d++) {
+    if (decoded[d] != digits[d]) {
+      printf("Digit %d: expected %c, got %c\n", d, digits[d], decoded[d]);
+      result->errors++;
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// power
+////////////////////////////////////////////////////////////////////////////////
+
+void check_power(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_goertzel_instance_q15 S15;
+  riscv_goertzel_instance_q31 S31;
+  static const int levels[] = { 32000, 3000, 30 };
+  static const float32_t freqs_f[4] = { 440.0f, 1000.0f, 1234.5f, 3100.0f };
+  q31_t freqs[4], p15[4], p31[4];
+  float32_t ref, e15, e31;
+  uint32_t l, i, k;
+
+  for (k = 0; k < 4; k++)
+    freqs[k] = freq_q31(freqs_f[k]);
+
+  for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+    // a tone at 1000 Hz and a second one 20 dB lower off bin at 1234.5 Hz
+    for (i = 0; i < COST_LEN; i++) {
+      x_q15[i] = (q15_t) (0.9f * levels[l] * sinf(2.0f * (float32_t) M_PI * 1000.0f / FS * i)
+                        + 0.09f * levels[l] * sinf(2.0f * (float32_t) M_PI * 1234.5f / FS * i + 1.0f));
+      x_q31[i] = (q31_t) x_q15[i] * 65536;
+    }
+
+    riscv_goertzel_init_q15(&S15, 4, freqs, coeffs, state, COST_LEN);
+    riscv_goertzel_q15(&S15, x_q15, COST_LEN, p15);
+
+    riscv_goertzel_init_q31(&S31, 4, freqs, coeffs, state, COST_LEN);
+    riscv_goertzel_q31(&S31, x_q31, COST_LEN, p31);
+
+    for (k = 0; k < 4; k++) {
+      ref = dft_power(x_q15, COST_LEN, freqs_f[k]);
+      e15 = to_db(p15[k] / 2147483648.0f) - to_db(ref);
+      e31 = to_db(p31[k] / 2147483648.0f) - to_db(ref);
+
+      printf("Level %5d, %6d Hz: %4d dB, q15 %+d.%02d dB, q31 %+d.%02d dB\n", levels[l],
+             (int) freqs_f[k], (int) to_db(ref), (int) e15, (int) (fabsf(e15) * 100) % 100,
+             (int) e31, (int) (fabsf(e31) * 100) % 100);
+
+      // the Q31 bank is exact down to where the 1.31 power has few bits left
+      if (to_db(ref) > -80.0f && fabsf(e31) > 0.5f) {
+        printf("Level %d, %d Hz: q31 power off\n", levels[l], (int) freqs_f[k]);
+        result->errors++;
+      }
+
+      // the Q15 bank the tones of the two upper levels
+      if (l < 2 && (k == 1 || k == 2) && fabsf(e15) > 1.0f) {
+        printf("Level %d, %d Hz: q15 power off\n", levels[l], (int) freqs_f[k]);
+        result->errors++;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// sliding DFT
+////////////////////////////////////////////////////////////////////////////////
+
+void check_sdft(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_sdft_instance_q15 S;
+  q31_t freqs[2], p[2];
+  uint32_t i, seed = 3;
+  int on, peak = 0, off = 0;
+
+  freqs[0] = freq_q31(1000.0f);
+  freqs[1] = freq_q31(2000.0f);
+
+  check_uint32(result, "init", riscv_sdft_init_q15(&S, 2, freqs, coeffs, state, delay, COST_LEN),
+               RISCV_MATH_SUCCESS);
+
+  // 1000 Hz at half scale from 500 to 1500, noise throughout
+  for (i = 0; i < 2500; i++) {
+    on = (i >= 500 && i < 1500);
+    x_q15[0] = (q15_t) (((int32_t) noise(&seed) - 32768) >> 6);
+    if (on)
+      x_q15[0] += (q15_t) (16000.0f * sinf(2.0f * (float32_t) M_PI * 1000.0f / FS * i));
+
+    riscv_sdft_q15(&S, x_q15, 1);
+    riscv_sdft_power_q15(&S, p);
+
+    // a half scale tone reads 1/16 once it fills the window
+    if (i == 1499 && (p[0] < 0x07000000 || p[0] > 0x09000000)) {
+      printf("Tone on: power %d\n", p[0]);
+      result->errors++;
+    }
+
+    if (p[0] > peak)
+      peak = p[0];
+
+    // one window after the tone is gone it is gone from the bins
+    if (i >= 1500 + COST_LEN && p[0] > off)
+      off = p[0];
+
+    if (p[1] > 0x00100000) {
+      printf("Sample %d: 2000 Hz power %d\n", i, p[1]);
+      result->errors++;
+      break;
+    }
+  }
+
+  printf("Sliding DFT peak %d dB, after the tone %d dB\n",
+         (int) to_db(peak / 2147483648.0f), (int) to_db(off / 2147483648.0f));
+
+  if (off > 0x00100000) {
+    printf("Tone still visible after it ended\n");
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cost
+////////////////////////////////////////////////////////////////////////////////
+
+void check_cost(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_goertzel_instance_q15 S;
+  riscv_sdft_instance_q15 D;
+  riscv_rfft_instance_q15 R;
+  q31_t freqs[MAX_TONES];
+  uint32_t i, k, t_goertzel, t_sdft;
+
+  for (i = 0; i < COST_LEN; i++)
+    x_q15[i] = (q15_t) (8000.0f * sinf(0.37f * i) + 4000.0f * sinf(1.91f * i));
+
+  for (k = 0; k < MAX_TONES; k++)
+    freqs[k] = (q31_t) (0x3F000000 / MAX_TONES) * (k + 1);
+
+  // the FFT path: all bins of the window and their squared magnitudes
+  riscv_rfft_init_q15(&R, COST_LEN, 0, 1);
+
+  for (i = 0; i < COST_LEN; i++)
+    fft_in[i] = x_q15[i];
+
+  start();
+  riscv_rfft_q15(&R, fft_in, fft_out);
+  riscv_cmplx_mag_squared_q15(fft_out, mag, COST_LEN / 2 + 1);
+  stop();
+
+  printf("riscv_rfft_q15 + magnitudes, %d samples: %d cycles\n", COST_LEN, get_time());
+
+  for (k = 1; k <= MAX_TONES; k <<= 1) {
+    riscv_goertzel_init_q15(&S, k, freqs, coeffs, state, COST_LEN);
+
+    start();
+    riscv_goertzel_q15(&S, x_q15, COST_LEN, power);
+    stop();
+    t_goertzel = get_time();
+
+    riscv_sdft_init_q15(&D, k, freqs, coeffs, state, delay, COST_LEN);
+
+    start();
+    riscv_sdft_q15(&D, x_q15, COST_LEN);
+    riscv_sdft_power_q15(&D, power);
+    stop();
+    t_sdft = get_time();
+
+    printf("K = %2d: Goertzel %6d cycles, sliding DFT %6d cycles\n", k, t_goertzel, t_sdft);
+  }
+}
@@ -0,0 +1,187 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// PDM to PCM conversion. A second order sigma delta modulator turns a 1 kHz
+// sine into a 3.072 MHz bit stream, which is decimated to 16 kHz by a fourth
+// order CIC with R = 96 and a 61 tap compensation filter with M = 2. The
+// stream is fed in chunks that match neither the CIC nor the FIR blocks.
+// The PCM sine has to come out at the right level and clean. The cycles per
+// PCM sample are reported for common microphone rates.
+
+#include <stdio.h>
+#include <math.h>
+#include "bench.h"
+#include "timer.h"
+#include "riscv_math.h"
+
+#define CIC_ORDER   4
+#define FIR_TAPS    61
+#define FIR_M       2
+#define BLOCK       32                          // CIC samples per FIR call
+#define PCM_LEN     256
+#define MAX_WORDS   (PCM_LEN * FIR_M * 96 / 32) // 3.072 MHz to 16 kHz
+#define SKIP        64                          // settling of CIC and FIR
+#define MIN_SNR     70.0                        // dB
+
+// Least squares design for the CIC above at its output rate: pass band to
+// 0.2 with the inverse CIC response, stop band from 0.3 with about 84 dB
+// including the CIC. The response hardly depends on R for R >= 32, the same
+// filter serves all rates below.
+static q15_t fir_coeffs[FIR_TAPS] = {
+      1,     0,    -3,    -3,     8,    10,   -17,   -25,    31,    54,
+    -50,  -103,    76,   182,  -107,  -305,   142,   486,  -176,  -751,
+    202,  1139,  -205, -1727,   151,  2710,    80, -4721, -1203, 11245,
+  18527, 11245, -1203, -4721,    80,  2710,   151, -1727,  -205,  1139,
+    202,  -751,  -176,   486,   142,  -305,  -107,   182,    76,  -103,
+    -50,    54,    31,   -25,   -17,    10,     8,    -3,    -3,     0,
+      1
+};
+
+static uint32_t pdm[MAX_WORDS]                      __attribute__ ((section(".heapsram")));
+static q15_t    pcm[PCM_LEN + BLOCK / FIR_M]        __attribute__ ((section(".heapsram")));
+static q15_t    fir_state[FIR_TAPS + BLOCK - 1]     __attribute__ ((section(".heapsram")));
+static q15_t    cic_buf[BLOCK]                      __attribute__ ((section(".heapsram")));
+static q31_t    cic_state[2 * CIC_ORDER];
+
+void check_quality  (testresult_t *result, void (*start)(), void (*stop)());
+void check_cost     (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "quality", .test = check_quality },
+  { .name = "cost",    .test = check_cost    },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// sine of amplitude/32768 at freq/fs in 1.31, the earliest bit in the MSB
+static void modulate(uint32_t* pDst, uint32_t numWords, q31_t amplitude, q31_t freq)
+{
+  q31_t e1 = 0, e2 = 0, x, w, y;
+  uint32_t phase = 0, word, i, b;
+
+  for (i = 0; i < numWords; i++) {
+    word = 0;
+
+    for (b = 0; b < 32; b++) {
+      x = (q31_t) (((q63_t) amplitude * riscv_sin_q31(phase & 0x7FFFFFFF)) >> 31);
+      phase += freq;
+
+      // error feedback, the noise is shaped by (1 - z^-1)^2
+      w = x + 2 * e1 - e2;
+      y = (w >= 0) ? 32768 : -32768;
+      e2 = e1;
+      e1 = w - y;
+
+      word = (word << 1) | (w >= 0);
+    }
+
+    pDst[i] = word;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// quality
+////////////////////////////////////////////////////////////////////////////////
+
+void check_quality(testresult_t *result, void (*start)(), void (*stop)()) {
+  riscv_pdm_pcm_instance_q15 S;
+  float32_t re = 0.0f, im = 0.0f, noise = 0.0f, mean = 0.0f, d, level, snr;
+  uint32_t i, n, pos, numOut;
+
+  // half scale, 1 kHz at 3.072 MHz
+  modulate(pdm, MAX_WORDS, 16384, (q31_t) (2147483648.0 * 1000.0 / 3072000.0));
+
+  check_uint32(result, "init",
+               riscv_pdm_pcm_init_q15(&S, CIC_ORDER, 96, cic_state, FIR_TAPS, FIR_M,
+                                      fir_coeffs, fir_state, cic_buf, BLOCK),
+               RISCV_MATH_SUCCESS);
+
+  numOut = 0;
+  for (pos = 0; pos < MAX_WORDS; pos += n) {
+    n = (MAX_WORDS - pos < 37) ? MAX_WORDS - pos : 37;
+    numOut += riscv_pdm_pcm_q15(&S, &pdm[pos], n, &pcm[numOut]);
+  }
+
+  check_uint32(result, "samples", numOut, PCM_LEN);
+
+  // fit 12 periods of 1 kHz at 16 kHz after settling, the rest is noise
+  for (i = SKIP; i < PCM_LEN; i++)
+    mean += pcm[i];
+  mean /= PCM_LEN - SKIP;
+
+  for (i = SKIP; i < PCM_LEN; i++) {
+    re += (pcm[i] - mean) * cosf(2.0f * (float32_t) M_PI * (i % 16) / 16.0f);
+    im += (pcm[i] - mean) * sinf(2.0f * (float32_t) M_PI * (i % 16) / 16.0f);
+  }
+
+  re *= 2.0f / (PCM_LEN - SKIP);
+  im *= 2.0f / (PCM_LEN - SKIP);
+
+  for (i = SKIP; i < PCM_LEN; i++) {
+    d = pcm[i] - mean - re * cosf(2.0f * (float32_t) M_PI * (i % 16) / 16.0f)
+                      - im * sinf(2.0f * (float32_t) M_PI * (i % 16) / 16.0f);
+    noise += d * d;
+  }
+
+  level = sqrtf(re * re + im * im);
+  snr   = 10.0f * log10f(level * level / 2.0f * (PCM_LEN - SKIP) / noise);
+
+  printf("1 kHz at %d (16384 expected), SNR %d dB\n", (int) level, (int) snr);
+
+  if (level < 16000.0f || level > 16800.0f) {
+    printf("Level wrong\n");
+    result->errors++;
+  }
+
+  if (snr < MIN_SNR) {
+    printf("SNR too low\n");
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cost
+////////////////////////////////////////////////////////////////////////////////
+
+void check_cost(testresult_t *result, void (*start)(), void (*stop)()) {
+  static const struct {
+    const char *name;
+    uint16_t R;
+  } rates[] = {
+    { "3.072 MHz -> 16 kHz", 96 },
+    { "2.048 MHz -> 16 kHz", 64 },
+    { "1.024 MHz -> 16 kHz", 32 },
+    { "3.072 MHz -> 48 kHz", 32 },
+  };
+  riscv_pdm_pcm_instance_q15 S;
+  uint32_t r, numWords, numOut, cycles;
+
+  for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+    riscv_pdm_pcm_init_q15(&S, CIC_ORDER, rates[r].R, cic_state, FIR_TAPS, FIR_M,
+                           fir_coeffs, fir_state, cic_buf, BLOCK);
+
+    // the cost per sample does not depend on the bit rate, only on R
+    numWords = PCM_LEN * FIR_M * rates[r].R / 32;
+
+    start();
+    numOut = riscv_pdm_pcm_q15(&S, pdm, numWords, pcm);
+    stop();
+    cycles = get_time();
+
+    check_uint32(result, "samples", numOut, PCM_LEN);
+
+    printf("%s (R = %d, M = %d): %d cycles per PCM sample\n", rates[r].name,
+           rates[r].R, FIR_M, cycles / PCM_LEN);
+  }
+}
@@ -0,0 +1,405 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the QR-RLS filters against a batch least-squares solution. The
+// reference accumulates the exponentially weighted normal equations in double
+// precision and solves them from scratch, so it shares nothing with the
+// recursive Givens updates. The input is a strongly coloured AR(1) process,
+// whose correlation matrix is badly conditioned, which is where conventional
+// RLS loses its positive definiteness in single precision.
+
+#include "bench.h"
+#include "timer.h"
+#include "riscv_math.h"
+
+#define TAPS     8
+#define BLOCK    16
+#define SAMPLES  768
+#define LAMBDA   0.99f
+#define DELTA    0.01f
+
+static float32_t x_f32[SAMPLES]   __attribute__ ((section(".heapsram")));
+static float32_t d_f32[SAMPLES]   __attribute__ ((section(".heapsram")));
+static q31_t     x_q31[SAMPLES]   __attribute__ ((section(".heapsram")));
+static q31_t     d_q31[SAMPLES]   __attribute__ ((section(".heapsram")));
+
+static float32_t state_f32[RISCV_RLS_QR_MAX_TAPS + BLOCK - 1]                        __attribute__ ((section(".heapsram")));
+static float32_t coeffs_f32[RISCV_RLS_QR_MAX_TAPS]                                  __attribute__ ((section(".heapsram")));
+static float32_t r_f32[RISCV_RLS_QR_MAX_TAPS * (RISCV_RLS_QR_MAX_TAPS + 1) / 2]      __attribute__ ((section(".heapsram")));
+static float32_t z_f32[RISCV_RLS_QR_MAX_TAPS]                                       __attribute__ ((section(".heapsram")));
+static float32_t out_f32[BLOCK]                                                     __attribute__ ((section(".heapsram")));
+static float32_t err_f32[BLOCK]                                                     __attribute__ ((section(".heapsram")));
+
+static q31_t     state_q31[TAPS + BLOCK - 1]             __attribute__ ((section(".heapsram")));
+static q31_t     coeffs_q31[TAPS]                        __attribute__ ((section(".heapsram")));
+static q31_t     r_q31[TAPS * (TAPS + 1) / 2]            __attribute__ ((section(".heapsram")));
+static q31_t     z_q31[TAPS]                             __attribute__ ((section(".heapsram")));
+static q31_t     out_q31[BLOCK]                          __attribute__ ((section(".heapsram")));
+static q31_t     err_q31[BLOCK]                          __attribute__ ((section(".heapsram")));
+
+// weighted normal equations of the batch reference, A * b = g
+static double    ref_A[TAPS * TAPS];
+static double    ref_g[TAPS];
+static double    ref_b[TAPS];
+
+// unknown system, changes halfway through for the tracking test
+static const float32_t h_sys[2][TAPS] = {
+  { 0.50f, -0.30f,  0.20f,  0.10f, -0.05f,  0.25f, -0.15f,  0.05f },
+  { -0.20f, 0.40f,  0.10f, -0.30f,  0.15f,  0.05f,  0.20f, -0.10f }
+};
+
+void check_batch_f32 (testresult_t *result, void (*start)(), void (*stop)());
+void check_track_f32 (testresult_t *result, void (*start)(), void (*stop)());
+void check_batch_q31 (testresult_t *result, void (*start)(), void (*stop)());
+void check_cost      (testresult_t *result, void (*start)(), void (*stop)());
+void check_errors    (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "batch_f32", .test = check_batch_f32 },
+  { .name = "track_f32", .test = check_track_f32 },
+  { .name = "batch_q31", .test = check_batch_q31 },
+  { .name = "cost",      .test = check_cost      },
+  { .name = "errors",    .test = check_errors    },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// signals and reference
+////////////////////////////////////////////////////////////////////////////////
+
+static unsigned int seed;
+
+// uniform in [-1, 1)
+static float32_t noise(void)
+{
+  seed = seed * 1103515245 + 12345;
+  return (float32_t)((int)(seed >> 8) - (1 << 23)) / (1 << 23);
+}
+
+// AR(1) input with pole 0.95 and the output of the unknown system plus a
+// little measurement noise, the system switches at sample `change`
+static void init_signals(int change)
+{
+  float32_t s = 0.0f, y;
+  int       n, k;
+
+  seed = 2017;
+
+  for (n = 0; n < SAMPLES; n++) {
+    s        = 0.95f * s + 0.05f * noise();
+    x_f32[n] = s;
+  }
+
+  for (n = 0; n < SAMPLES; n++) {
+    const float32_t* h = h_sys[n >= change];
+
+    y = 0.001f * noise();
+    for (k = 0; k < TAPS && k <= n; k++)
+      y += h[k] * x_f32[n - k];
+
+    d_f32[n] = y;
+    x_q31[n] = (q31_t)(x_f32[n] * 2147483648.0f);
+    d_q31[n] = (q31_t)(d_f32[n] * 2147483648.0f);
+  }
+}
+
+// regressor of sample n in the order of the state buffer, oldest first
+static double regressor(int n, int k)
+{
+  int i = n - (TAPS - 1) + k;
+
+  return i >= 0 ? x_f32[i] : 0.0;
+}
+
+static void ref_init(void)
+{
+  int i;
+
+  for (i = 0; i < TAPS * TAPS; i++)
+    ref_A[i] = 0.0;
+
+  for (i = 0; i < TAPS; i++) {
+    ref_A[i * TAPS + i] = (double)DELTA * DELTA;
+    ref_g[i]            = 0.0;
+  }
+}
+
+// A = lambda * A + (1 - lambda) * u * u', g likewise, the same weighting as
+// the filters including the decaying regularization delta^2 * I
+static void ref_update(int n, double lambda)
+{
+  double u[TAPS];
+  int    i, j;
+
+  for (i = 0; i < TAPS; i++)
+    u[i] = regressor(n, i);
+
+  for (i = 0; i < TAPS; i++) {
+    for (j = 0; j < TAPS; j++)
+      ref_A[i * TAPS + j] = lambda * ref_A[i * TAPS + j] + (1.0 - lambda) * u[i] * u[j];
+
+    ref_g[i] = lambda * ref_g[i] + (1.0 - lambda) * d_f32[n] * u[i];
+  }
+}
+
+// Gaussian elimination with partial pivoting on a copy of the system
+static void ref_solve(void)
+{
+  double M[TAPS][TAPS + 1];
+  double t;
+  int    i, j, k, p;
+
+  for (i = 0; i < TAPS; i++) {
+    for (j = 0; j < TAPS; j++)
+      M[i][j] = ref_A[i * TAPS + j];
+    M[i][TAPS] = ref_g[i];
+  }
+
+  for (k = 0; k < TAPS; k++) {
+    p = k;
+    for (i = k + 1; i < TAPS; i++)
+      if (fabs(M[i][k]) > fabs(M[p][k]))
+        p = i;
+
+    for (j = k; j <= TAPS; j++) {
+      t       = M[k][j];
+      M[k][j] = M[p][j];
+      M[p][j] = t;
+    }
+
+    for (i = k + 1; i < TAPS; i++) {
+      t = M[i][k] / M[k][k];
+      for (j = k; j <= TAPS; j++)
+        M[i][j] -= t * M[k][j];
+    }
+  }
+
+  for (k = TAPS - 1; k >= 0; k--) {
+    t = M[k][TAPS];
+    for (j = k + 1; j < TAPS; j++)
+      t -= M[k][j] * ref_b[j];
+    ref_b[k] = t / M[k][k];
+  }
+}
+
+// largest coefficient difference, Q31 coefficients are scaled by 2^-shift
+static double max_diff_f32(void)
+{
+  double d, m = 0.0;
+  int    k;
+
+  for (k = 0; k < TAPS; k++) {
+    d = fabs(coeffs_f32[k] - ref_b[k]);
+    m = d > m ? d : m;
+  }
+
+  return m;
+}
+
+static double max_diff_q31(int shift)
+{
+  double d, m = 0.0;
+  int    k;
+
+  for (k = 0; k < TAPS; k++) {
+    d = fabs(coeffs_q31[k] / 2147483648.0 * (1 << shift) - ref_b[k]);
+    m = d > m ? d : m;
+  }
+
+  return m;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// floating point
+////////////////////////////////////////////////////////////////////////////////
+
+static riscv_rls_qr_instance_f32 S_f32;
+static riscv_rls_qr_instance_q31 S_q31;
+
+// runs the float filter over all samples and compares with the batch solution
+// after every block, returns the number of blocks that differ by more than tol
+static int run_f32(double tol, int print)
+{
+  double m, worst = 0.0;
+  int    n, i, errors = 0;
+
+  for (i = 0; i < TAPS; i++)
+    coeffs_f32[i] = 0.0f;
+
+  riscv_rls_qr_init_f32(&S_f32, TAPS, coeffs_f32, state_f32, r_f32, z_f32, LAMBDA, DELTA, BLOCK);
+  ref_init();
+
+  for (n = 0; n < SAMPLES; n += BLOCK) {
+    riscv_rls_qr_f32(&S_f32, x_f32 + n, d_f32 + n, out_f32, err_f32, BLOCK);
+
+    for (i = n; i < n + BLOCK; i++)
+      ref_update(i, LAMBDA);
+    ref_solve();
+
+    m     = max_diff_f32();
+    worst = m > worst ? m : worst;
+
+    if (m > tol) {
+      if (print)
+        printf("Sample %d: coefficients off by %d ppm\n", n + BLOCK, (int)(m * 1e6));
+      errors++;
+    }
+  }
+
+  if (print)
+    printf("Largest difference %d ppm\n", (int)(worst * 1e6));
+
+  return errors;
+}
+
+void check_batch_f32(testresult_t *result, void (*start)(), void (*stop)()) {
+  int k;
+
+  init_signals(SAMPLES);
+  result->errors += run_f32(1e-4, 1);
+
+  // and the batch solution is the system itself up to the measurement noise,
+  // the coefficients are stored in time reversed order
+  for (k = 0; k < TAPS; k++) {
+    if (fabsf(coeffs_f32[TAPS - 1 - k] - h_sys[0][k]) > 0.05f) {
+      printf("Coefficient %d: %d/1000, expected %d/1000\n", k,
+             (int)(coeffs_f32[TAPS - 1 - k] * 1000), (int)(h_sys[0][k] * 1000));
+      result->errors++;
+    }
+  }
+}
+
+// the system changes halfway, the filter has to forget the old one
+void check_track_f32(testresult_t *result, void (*start)(), void (*stop)()) {
+  float32_t p = 0.0f;
+  int       k;
+
+  init_signals(SAMPLES / 2);
+  result->errors += run_f32(1e-4, 1);
+
+  for (k = 0; k < TAPS; k++) {
+    if (fabsf(coeffs_f32[TAPS - 1 - k] - h_sys[1][k]) > 0.05f) {
+      printf("Coefficient %d: %d/1000, expected %d/1000\n", k,
+             (int)(coeffs_f32[TAPS - 1 - k] * 1000), (int)(h_sys[1][k] * 1000));
+      result->errors++;
+    }
+  }
+
+  // the a priori error of the last block is down at the noise floor
+  for (k = 0; k < BLOCK; k++)
+    p += err_f32[k] * err_f32[k];
+
+  if (p / BLOCK > 1e-6f) {
+    printf("Residual power %d e-9\n", (int)(p / BLOCK * 1e9f));
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fixed point
+////////////////////////////////////////////////////////////////////////////////
+
+#define POST_SHIFT 1
+
+void check_batch_q31(testresult_t *result, void (*start)(), void (*stop)()) {
+  double m, worst = 0.0;
+  int    n, i;
+
+  init_signals(SAMPLES);
+
+  for (i = 0; i < TAPS; i++)
+    coeffs_q31[i] = 0;
+
+  riscv_rls_qr_init_q31(&S_q31, TAPS, coeffs_q31, state_q31, r_q31, z_q31,
+                        (q31_t)(LAMBDA * 2147483648.0), (q31_t)(DELTA * 2147483648.0), BLOCK, POST_SHIFT);
+  ref_init();
+
+  for (n = 0; n < SAMPLES; n += BLOCK) {
+    riscv_rls_qr_q31(&S_q31, x_q31 + n, d_q31 + n, out_q31, err_q31, BLOCK);
+
+    for (i = n; i < n + BLOCK; i++)
+      ref_update(i, LAMBDA);
+    ref_solve();
+
+    m     = max_diff_q31(POST_SHIFT);
+    worst = m > worst ? m : worst;
+
+    // Q31 resolution of R limits the accuracy on this ill-conditioned input
+    if (m > 1e-3) {
+      printf("Sample %d: coefficients off by %d ppm\n", n + BLOCK, (int)(m * 1e6));
+      result->errors++;
+    }
+  }
+
+  printf("Largest difference %d ppm\n", (int)(worst * 1e6));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cost and parameters
+////////////////////////////////////////////////////////////////////////////////
+
+// cycles per sample grow with the square of the number of taps
+void check_cost(testresult_t *result, void (*start)(), void (*stop)()) {
+  int taps, i;
+
+  init_signals(SAMPLES);
+
+  for (taps = 4; taps <= 16; taps *= 2) {
+    for (i = 0; i < taps; i++)
+      coeffs_f32[i] = 0.0f;
+
+    riscv_rls_qr_init_f32(&S_f32, taps, coeffs_f32, state_f32, r_f32, z_f32, LAMBDA, DELTA, BLOCK);
+
+    start();
+    riscv_rls_qr_f32(&S_f32, x_f32, d_f32, out_f32, err_f32, BLOCK);
+    stop();
+
+    printf("f32, %d taps: %d cycles per sample\n", taps, get_time() / BLOCK);
+
+    for (i = 0; i < taps * (taps + 1) / 2; i++) {
+      if (!(r_f32[i] == r_f32[i])) {
+        printf("f32, %d taps: R is not a number\n", taps);
+        result->errors++;
+        break;
+      }
+    }
+  }
+
+  riscv_rls_qr_init_q31(&S_q31, TAPS, coeffs_q31, state_q31, r_q31, z_q31,
+                        (q31_t)(LAMBDA * 2147483648.0), (q31_t)(DELTA * 2147483648.0), BLOCK, POST_SHIFT);
+
+  start();
+  riscv_rls_qr_q31(&S_q31, x_q31, d_q31, out_q31, err_q31, BLOCK);
+  stop();
+
+  printf("q31, %d taps: %d cycles per sample\n", TAPS, get_time() / BLOCK);
+}
+
+void check_errors(testresult_t *result, void (*start)(), void (*stop)()) {
+  if (riscv_rls_qr_init_f32(&S_f32, 0, coeffs_f32, state_f32, r_f32, z_f32, LAMBDA, DELTA, BLOCK) != RISCV_MATH_ARGUMENT_ERROR ||
+      riscv_rls_qr_init_f32(&S_f32, RISCV_RLS_QR_MAX_TAPS + 1, coeffs_f32, state_f32, r_f32, z_f32, LAMBDA, DELTA, BLOCK) != RISCV_MATH_ARGUMENT_ERROR ||
+      riscv_rls_qr_init_f32(&S_f32, TAPS, coeffs_f32, state_f32, r_f32, z_f32, 1.0f, DELTA, BLOCK) != RISCV_MATH_ARGUMENT_ERROR ||
+      riscv_rls_qr_init_f32(&S_f32, TAPS, coeffs_f32, state_f32, r_f32, z_f32, LAMBDA, 0.0f, BLOCK) != RISCV_MATH_ARGUMENT_ERROR) {
+    printf("Invalid f32 parameters accepted\n");
+    result->errors++;
+  }
+
+  if (riscv_rls_qr_init_q31(&S_q31, TAPS, coeffs_q31, state_q31, r_q31, z_q31, 0x7FFFFFFF, 0x100000, BLOCK, 0) != RISCV_MATH_ARGUMENT_ERROR ||
+      riscv_rls_qr_init_q31(&S_q31, TAPS, coeffs_q31, state_q31, r_q31, z_q31, 0x7F000000, 0, BLOCK, 0) != RISCV_MATH_ARGUMENT_ERROR ||
+      riscv_rls_qr_init_q31(&S_q31, TAPS, coeffs_q31, state_q31, r_q31, z_q31, 0x7F000000, 0x100000, BLOCK, 31) != RISCV_MATH_ARGUMENT_ERROR) {
+    printf("Invalid q31 parameters accepted\n");
+    result->errors++;
+  }
+}
@@ -0,0 +1,173 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// D = A * B + C on a batch of 4x4 matrices, with the fused and fully unrolled
+// expressions of smallmat.h or, with SMALLMAT_RUNTIME, with the loops of
+// ../matmul followed by an addition. The check also covers transpose() and,
+// for float, inverse(), neither of which is timed.
+
+#include "common.h"
+#include "smallmat.h"
+#ifdef SMALLMAT_RUNTIME
+#include "../matmul/matmul_impl.h"
+#endif
+
+using namespace smallmat;
+
+#define NUM_MAT 16
+#define DIM     4
+
+#if defined(SMALLMAT_Q15)
+typedef q15 type;
+#elif defined(SMALLMAT_Q31)
+typedef q31 type;
+#else
+typedef float type;
+#endif
+
+#if defined(SMALLMAT_RUNTIME) && (defined(SMALLMAT_Q15) || defined(SMALLMAT_Q31))
+#error "the runtime matmul has no fixed-point arithmetic"
+#endif
+
+typedef traits<type>::elem_t elem_t;
+typedef traits<type>::acc_t  acc_t;
+typedef mat<type, DIM, DIM>  mat_t;
+
+static mat_t mA[NUM_MAT] __sram;
+static mat_t mB[NUM_MAT] __sram;
+static mat_t mC[NUM_MAT] __sram;
+static mat_t mD[NUM_MAT] __sram;
+
+// r in [-2048, 2047], mapped to about [-0.4, 0.4] so sums of products stay
+// well within range of the fixed-point accumulators
+static inline void set(float& x, int32_t r)   { x = r / 5120.0f; }
+static inline void set(int16_t& x, int32_t r) { x = r * 6; }
+static inline void set(int32_t& x, int32_t r) { x = r * 393216; }
+
+static void init(mat_t* m, uint32_t& seed) {
+  for (int n = 0; n < NUM_MAT; n++) {
+    for (int i = 0; i < DIM * DIM; i++) {
+      seed = seed * 1664525 + 1013904223;
+      set(m[n].v[i], (int32_t)seed >> 20);
+    }
+  }
+}
+
+extern "C" void test_setup() {
+  uint32_t seed = 1;
+
+  init(mA, seed);
+  init(mB, seed);
+  init(mC, seed);
+}
+
+extern "C" void test_clear() {}
+
+extern "C" void test_run(int) {
+  for (int n = 0; n < NUM_MAT; n++) {
+#ifdef SMALLMAT_RUNTIME
+    matmul<elem_t>(mA[n].v, mB[n].v, mD[n].v, DIM, DIM, DIM);
+    for (int i = 0; i < DIM * DIM; i++)
+      mD[n].v[i] += mC[n].v[i];
+#else
+    mD[n].assign(mA[n] * mB[n] + mC[n]);
+#endif
+  }
+}
+
+static inline int equal(float x, float y)     { return (x - y) < 1e-5f && (y - x) < 1e-5f; }
+static inline int equal(int16_t x, int16_t y) { return x == y; }
+static inline int equal(int32_t x, int32_t y) { return x == y; }
+
+// transpose(A) on its own and as the left operand of a product, which reads
+// A by reference instead of evaluating it first
+static int check_transpose() {
+  for (int n = 0; n < NUM_MAT; n++) {
+    mat_t t;
+
+    t.assign(transpose(mA[n]));
+    for (int i = 0; i < DIM; i++)
+      for (int j = 0; j < DIM; j++)
+        if (!equal(t(i, j), mA[n](j, i)))
+          return 0;
+
+    t.assign(transpose(mA[n]) * mB[n] + mC[n]);
+    for (int i = 0; i < DIM; i++) {
+      for (int j = 0; j < DIM; j++) {
+        acc_t acc = traits<type>::widen(mC[n](i, j));
+
+        for (int k = 0; k < DIM; k++)
+          acc += traits<type>::mul(mA[n](k, i), mB[n](k, j));
+
+        if (!equal(t(i, j), traits<type>::narrow(acc)))
+          return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+#if defined(SMALLMAT_Q15) || defined(SMALLMAT_Q31)
+static int check_inverse() { return 1; }
+#else
+// upper left N x N block of A plus 2 on the diagonal, which keeps it
+// diagonally dominant, so A * inverse(A) has to come out close to identity;
+// with column 1 cleared the pivot or determinant is exactly zero instead
+template<int N> static int check_inverse(const mat_t& a) {
+  mat<float, N, N> m, inv, p;
+
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+      m(i, j) = a(i, j) + (i == j ? 2.0f : 0.0f);
+
+  if (!inverse(m, inv))
+    return 0;
+
+  p.assign(m * inv);
+  for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++)
+      if (!(p(i, j) - (i == j) < 1e-4f && (i == j) - p(i, j) < 1e-4f))
+        return 0;
+
+  for (int i = 0; i < N; i++)
+    m(i, 1) = 0.0f;
+
+  return !inverse(m, inv);
+}
+
+static int check_inverse() {
+  for (int n = 0; n < NUM_MAT; n++) {
+    if (!check_inverse<2>(mA[n]) || !check_inverse<3>(mA[n]) ||
+        !check_inverse<DIM>(mA[n]))
+      return 0;
+  }
+
+  return 1;
+}
+#endif
+
+extern "C" int test_check() {
+  for (int n = 0; n < NUM_MAT; n++) {
+    for (int i = 0; i < DIM; i++) {
+      for (int j = 0; j < DIM; j++) {
+        acc_t acc = traits<type>::widen(mC[n](i, j));
+
+        for (int k = 0; k < DIM; k++)
+          acc += traits<type>::mul(mA[n](i, k), mB[n](k, j));
+
+        if (!equal(mD[n](i, j), traits<type>::narrow(acc)))
+          return 0;
+      }
+    }
+  }
+
+  return check_transpose() && check_inverse();
+}
@@ -55,14 +55,14 @@ int main()
   spi_setup_cmd_addr(0x06, 8, 0, 0);
   spi_set_datalen(0);
   spi_start_transaction(SPI_CMD_WR, SPI_CSN0);
-  while ((spi_get_status() & 0xFFFF) != 1);
+  spi_wait_idle();
 
   // enables QPI
   // cmd 0x71 write any register
   spi_setup_cmd_addr(0x71, 8, 0x80000348, 32);
   spi_set_datalen(0);
   spi_start_transaction(SPI_CMD_WR, SPI_CSN0);
-  while ((spi_get_status() & 0xFFFF) != 1);
+  spi_wait_idle();
 
   //-----------------------------------------------------------
   // Read header
@@ -111,7 +111,7 @@ int main()
     uart_send_block_done(i);
   }
 
-  while ((spi_get_status() & 0xFFFF) != 1);
+  spi_wait_idle();
 
   //-----------------------------------------------------------
   // Read Data RAM
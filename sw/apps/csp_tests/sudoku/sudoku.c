@@ -0,0 +1,267 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Solves sudokus and graph colorings with the constraint search library. The
+// first puzzle is the one of sequential_tests/sudokusolver, the second one
+// needs a lot of search. Prints the cycles per search node and the stack used
+// by the solver.
+
+#include <stdio.h>
+#include "bench.h"
+#include "timer.h"
+#include "csp.h"
+
+#define N 81
+
+// digit d is value bit d - 1
+#define DIGITS 0x1FF
+
+void check_easy(testresult_t *result, void (*start)(), void (*stop)());
+void check_hard(testresult_t *result, void (*start)(), void (*stop)());
+void check_many(testresult_t *result, void (*start)(), void (*stop)());
+void check_unsat(testresult_t *result, void (*start)(), void (*stop)());
+void check_coloring(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "easy",      .test = check_easy      },
+  { .name = "hard",      .test = check_hard      },
+  { .name = "many",      .test = check_many      },
+  { .name = "unsat",     .test = check_unsat     },
+  { .name = "coloring",  .test = check_coloring  },
+  {0, 0}
+};
+
+static csp_t csp __attribute__ ((section(".heapsram")));
+
+static const char easy[N + 1] =
+  ".931.564."
+  "7.......5"
+  "5.12.93.7"
+  "2.......3"
+  ".369.752."
+  "9.......1"
+  "3.24.81.9"
+  "6.......4"
+  ".473.285.";
+
+static const char easy_solved[N + 1] =
+  "893175642"
+  "724836915"
+  "561249387"
+  "215684793"
+  "436917528"
+  "978523461"
+  "352468179"
+  "689751234"
+  "147392856";
+
+static const char hard[N + 1] =
+  "8........"
+  "..36....."
+  ".7..9.2.."
+  ".5...7..."
+  "....457.."
+  "...1...3."
+  "..1....68"
+  "..85...1."
+  ".9....4..";
+
+static const char hard_solved[N + 1] =
+  "812753649"
+  "943682175"
+  "675491283"
+  "154237896"
+  "369845721"
+  "287169534"
+  "521974368"
+  "438526917"
+  "796318452";
+
+// two 5s in the first row
+static const char unsat[N + 1] =
+  "5...5...."
+  "........."
+  "........."
+  "........."
+  "........."
+  "........."
+  "........."
+  "........."
+  ".........";
+
+int main() {
+  return run_suite(testcases);
+}
+
+static void sudoku_setup(const char* puzzle) {
+  uint8_t vars[9];
+  int i, k;
+
+  csp_init(&csp, N, DIGITS);
+
+  for (i = 0; i < N; i++)
+    if (puzzle[i] != '.')
+      csp_restrict(&csp, i, 1 << (puzzle[i] - '1'));
+
+  for (i = 0; i < 9; i++) {
+    for (k = 0; k < 9; k++)
+      vars[k] = i * 9 + k;
+    csp_add_group(&csp, vars, 9, 1);
+
+    for (k = 0; k < 9; k++)
+      vars[k] = k * 9 + i;
+    csp_add_group(&csp, vars, 9, 1);
+
+    for (k = 0; k < 9; k++)
+      vars[k] = (i / 3 * 3 + k / 3) * 9 + i % 3 * 3 + k % 3;
+    csp_add_group(&csp, vars, 9, 1);
+  }
+}
+
+static void sudoku_compare(testresult_t *result, const char* solved) {
+  int i;
+
+  for (i = 0; i < N; i++) {
+    if (csp_value(&csp, i) + '1' != solved[i]) {
+      printf("Cell %d: got %d, expected %c\n", i, csp_value(&csp, i) + 1, solved[i]);
+      result->errors++;
+      return;
+    }
+  }
+}
+
+// every row, column and box holds every digit once
+static int sudoku_valid(void) {
+  uint32_t row, col, box;
+  int i, k;
+
+  for (i = 0; i < 9; i++) {
+    row = col = box = 0;
+    for (k = 0; k < 9; k++) {
+      row |= csp.dom[i * 9 + k];
+      col |= csp.dom[k * 9 + i];
+      box |= csp.dom[(i / 3 * 3 + k / 3) * 9 + i % 3 * 3 + k % 3];
+    }
+
+    if (row != DIGITS || col != DIGITS || box != DIGITS)
+      return 0;
+  }
+
+  return 1;
+}
+
+static void sudoku_run(testresult_t *result, void (*start)(), void (*stop)(),
+                       const char* puzzle, const char* solved) {
+  int r, cycles;
+
+  sudoku_setup(puzzle);
+
+  stack_paint();
+  start();
+  r = csp_solve(&csp);
+  stop();
+  cycles = get_time();
+
+  printf("%d nodes, %d fails, depth %d, trail %d: %d cycles, %d per node, %d bytes of stack\n",
+         csp.stats.nodes, csp.stats.fails, csp.stats.max_depth, csp.stats.max_trail,
+         cycles, cycles / (csp.stats.nodes ? csp.stats.nodes : 1), stack_used());
+
+  check_uint32(result, "solve", r, CSP_SAT);
+  sudoku_compare(result, solved);
+
+  // a proper puzzle has a single solution
+  check_uint32(result, "next", csp_next(&csp), CSP_UNSAT);
+}
+
+void check_easy(testresult_t *result, void (*start)(), void (*stop)()) {
+  sudoku_run(result, start, stop, easy, easy_solved);
+}
+
+void check_hard(testresult_t *result, void (*start)(), void (*stop)()) {
+  sudoku_run(result, start, stop, hard, hard_solved);
+}
+
+// every solution of a puzzle with just two givens has to be a valid sudoku
+void check_many(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t prev[N];
+  int i, k, r, same;
+
+  sudoku_setup("1...............................................................................2");
+  r = csp_solve(&csp);
+
+  for (k = 0; k < 4 && r == CSP_SAT; k++) {
+    same = 1;
+    for (i = 0; i < N; i++) {
+      same &= prev[i] == csp.dom[i];
+      prev[i] = csp.dom[i];
+    }
+
+    if (!sudoku_valid()) {
+      printf("Solution %d is not a sudoku\n", k);
+      result->errors++;
+    }
+
+    if (k > 0 && same) {
+      printf("Solution %d repeated\n", k);
+      result->errors++;
+    }
+
+    if (csp_value(&csp, 0) != 0 || csp_value(&csp, 80) != 1) {
+      printf("Solution %d lost the givens\n", k);
+      result->errors++;
+    }
+
+    r = csp_next(&csp);
+  }
+
+  check_uint32(result, "solutions", k, 4);
+}
+
+void check_unsat(testresult_t *result, void (*start)(), void (*stop)()) {
+  sudoku_setup(unsat);
+  check_uint32(result, "solve", csp_solve(&csp), CSP_UNSAT);
+  check_uint32(result, "next", csp_next(&csp), CSP_UNSAT);
+}
+
+//----------------------------------------------------------------------------
+// slot assignment as graph coloring, every edge is a group of two
+//----------------------------------------------------------------------------
+
+// Petersen graph, 3 colorable
+static const uint8_t petersen[15][2] = {
+  {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0},
+  {0, 5}, {1, 6}, {2, 7}, {3, 8}, {4, 9},
+  {5, 7}, {7, 9}, {9, 6}, {6, 8}, {8, 5}
+};
+
+static int color(int nodes, const uint8_t (*edges)[2], int nedges, int colors) {
+  int i;
+
+  csp_init(&csp, nodes, (1 << colors) - 1);
+  for (i = 0; i < nedges; i++)
+    csp_add_group(&csp, edges[i], 2, 0);
+
+  return csp_solve(&csp);
+}
+
+void check_coloring(testresult_t *result, void (*start)(), void (*stop)()) {
+  int i;
+
+  check_uint32(result, "3 colors", color(10, petersen, 15, 3), CSP_SAT);
+
+  for (i = 0; i < 15; i++) {
+    if (csp.dom[petersen[i][0]] == csp.dom[petersen[i][1]]) {
+      printf("Edge %d-%d has one color\n", petersen[i][0], petersen[i][1]);
+      result->errors++;
+    }
+  }
+
+  check_uint32(result, "2 colors", color(10, petersen, 15, 2), CSP_UNSAT);
+}
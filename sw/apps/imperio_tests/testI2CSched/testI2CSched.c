@@ -0,0 +1,177 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Runs the I2C acquisition scheduler against the EEPROM of the testbench.
+// Two register blocks of the EEPROM act as sensors with different periods,
+// a third sensor has an address nobody answers to.
+
+#include <i2c.h>
+#include <i2c_sched.h>
+#include <int.h>
+#include <timer.h>
+#include <bench.h>
+#include <stdio.h>
+
+#define I2C_PRESCALER 0x63 //(soc_freq/(5*i2cfreq))-1 with i2cfreq = 100Khz
+
+#define EEPROM_ADDR   0x50
+#define NOBODY_ADDR   0x23
+
+void check_compile(testresult_t *result, void (*start)(), void (*stop)());
+void check_eeprom(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "compile", .test = check_compile },
+  { .name = "eeprom",  .test = check_eeprom  },
+  {0, 0}
+};
+
+static i2c_sched_t  sched;
+static i2c_sensor_t sn_a, sn_b, sn_n;
+
+static uint32_t buf_a[4 * I2C_FRAME_WORDS(4)];
+static uint32_t buf_b[4 * I2C_FRAME_WORDS(8)];
+static uint32_t buf_n[2 * I2C_FRAME_WORDS(2)];
+
+int main() {
+  return run_suite(testcases);
+}
+
+void check_compile(testresult_t *result, void (*start)(), void (*stop)()) {
+  i2c_sched_init(&sched);
+
+  i2c_sensor_init(&sn_a, 0x10, 0x3B, I2C_SENSOR_REG8, 6, buf_a, 4);
+  i2c_sensor_init(&sn_b, 0x11, 0x28, I2C_SENSOR_REG8, 6, buf_b, 4);
+  i2c_sensor_init(&sn_n, 0x12, 0x00, I2C_SENSOR_NOREG, 2, buf_n, 2);
+
+  check_uint32(result, "add a", i2c_sched_add(&sched, &sn_a, 2), 0);
+  check_uint32(result, "add b", i2c_sched_add(&sched, &sn_b, 2), 1);
+  check_uint32(result, "add n", i2c_sched_add(&sched, &sn_n, 3), 2);
+
+  // START+W, register, START+R, 5 reads, READ+NACK+STOP
+  check_uint32(result, "ops a",  sn_a.count, 9);
+  check_uint32(result, "ops n",  sn_n.count, 3);
+  check_uint32(result, "last",   sched.ops[sn_a.first + sn_a.count - 1].cmd, I2C_STOP_READ | I2C_NACK);
+  check_uint32(result, "read",   sched.ops[sn_n.first].data, (0x12 << 1) | 1);
+
+  check_uint32(result, "compile", i2c_sched_compile(&sched), 0);
+  check_uint32(result, "slots",   sched.num_slots, 6);
+
+  // the two sensors of the same period end up in different slots
+  check_uint32(result, "phase a", sn_a.phase, 0);
+  check_uint32(result, "phase b", sn_b.phase, 1);
+  check_uint32(result, "slot 0",  sched.slots[0], 0x5);
+  check_uint32(result, "slot 1",  sched.slots[1], 0x2);
+  check_uint32(result, "slot 3",  sched.slots[3], 0x6);
+  check_uint32(result, "slot 4",  sched.slots[4], 0x1);
+
+  // 2 * 17 slots do not fit the slot table
+  i2c_sensor_init(&sn_n, 0x12, 0x00, I2C_SENSOR_NOREG, 2, buf_n, 2);
+  i2c_sched_add(&sched, &sn_n, 17);
+  check_uint32(result, "too long", i2c_sched_compile(&sched), -1);
+}
+
+static void eeprom_fill(void) {
+  i2c_send_data(EEPROM_ADDR << 1);
+  i2c_send_command(I2C_START_WRITE);
+  i2c_get_ack();
+
+  i2c_send_data(0x00); // addr MSBs
+  i2c_send_command(I2C_WRITE);
+  i2c_get_ack();
+
+  i2c_send_data(0x00); // addr LSBs
+  i2c_send_command(I2C_WRITE);
+  i2c_get_ack();
+
+  for (int i = 0; i < 16; i++) {
+    i2c_send_data(0x40 + i);
+    i2c_send_command(I2C_WRITE);
+    i2c_get_ack();
+  }
+
+  i2c_send_command(I2C_STOP);
+  while(i2c_busy());
+
+  // acknowledge polling
+  do {
+    i2c_send_data(EEPROM_ADDR << 1);
+    i2c_send_command(I2C_START_WRITE);
+  } while (!i2c_get_ack());
+
+  i2c_send_command(I2C_STOP);
+  while(i2c_busy());
+}
+
+void check_eeprom(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint8_t  data[8];
+  uint32_t time, prev = 0;
+  int i, j, n;
+
+  i2c_setup(I2C_PRESCALER, I2C_CTR_EN);
+  eeprom_fill();
+
+  // the EEPROM takes a 16 bit address and needs a STOP before the read
+  i2c_sched_init(&sched);
+  i2c_sensor_init(&sn_a, EEPROM_ADDR, 0x0000, I2C_SENSOR_REG16 | I2C_SENSOR_STOP, 4, buf_a, 4);
+  i2c_sensor_init(&sn_b, EEPROM_ADDR, 0x0008, I2C_SENSOR_REG16 | I2C_SENSOR_STOP, 8, buf_b, 4);
+  i2c_sensor_init(&sn_n, NOBODY_ADDR, 0x00,   I2C_SENSOR_REG8, 2, buf_n, 2);
+
+  i2c_sched_add(&sched, &sn_a, 1);
+  i2c_sched_add(&sched, &sn_b, 2);
+  i2c_sched_add(&sched, &sn_n, 4);
+  check_uint32(result, "compile", i2c_sched_compile(&sched), 0);
+
+  int_init();
+  TOCRB = 100;
+  i2c_sched_start(&sched);
+  int_enable();
+
+  check_uint32(result, "TOCRB", TOCRB, TIMER_FREE_RUN);
+
+  for (i = 0; i < 4; i++) {
+    int_disable();
+    i2c_sched_tick(&sched);
+    int_enable();
+
+    while (i2c_sched_busy(&sched));
+  }
+
+  i2c_sched_stop(&sched);
+  int_disable();
+
+  check_uint32(result, "cycles",   sched.cycles, 4);
+  check_uint32(result, "overruns", sched.overruns, 0);
+  check_uint32(result, "frames a", i2c_sensor_count(&sn_a), 4);
+  check_uint32(result, "frames b", i2c_sensor_count(&sn_b), 2);
+  check_uint32(result, "frames n", i2c_sensor_count(&sn_n), 0);
+  check_uint32(result, "errors n", sn_n.errors, 1);
+  check_uint32(result, "errors a", sn_a.errors, 0);
+
+  for (n = 0; i2c_sensor_get(&sn_a, &time, data); n++) {
+    for (j = 0; j < 4; j++)
+      check_uint32(result, "data a", data[j], 0x40 + j);
+
+    if (n > 0 && (int)(time - prev) <= 0) {
+      printf("Timestamps not increasing: %d after %d\n", time, prev);
+      result->errors++;
+    }
+    prev = time;
+  }
+
+  while (i2c_sensor_get(&sn_b, &time, data))
+    for (j = 0; j < 8; j++)
+      check_uint32(result, "data b", data[j], 0x48 + j);
+
+  n = i2c_sched_utilization(&sched);
+  printf("Bus utilization %d permille\n", n);
+  if (n == 0 || n > 1000)
+    result->errors++;
+}
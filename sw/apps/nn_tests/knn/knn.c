@@ -0,0 +1,264 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Classifies a batch of feature vectors from three Gaussian clusters against
+// reference vectors from the same clusters, in float as the reference and
+// with the q15 and q7 kernels, and reports the throughput of every path. A
+// small hand-made set checks the vote and its tie break.
+
+#include <math.h>
+
+#include "bench.h"
+#include "timer.h"
+#include "knn.h"
+
+#define DIM     8
+#define NCLASS  3
+#define NREF    48
+#define NX      64
+#define K       5
+
+// core clock assumed for the classifications per second
+#define CLOCK_HZ  50000000
+
+static float   ref_f[NREF * DIM]  __attribute__ ((section(".heapsram")));
+static float   x_f[NX * DIM]      __attribute__ ((section(".heapsram")));
+static int16_t ref_q15[NREF * DIM] __attribute__ ((section(".heapsram")));
+static int16_t x_q15[NX * DIM]    __attribute__ ((section(".heapsram")));
+static int8_t  ref_q7[NREF * DIM] __attribute__ ((section(".heapsram"), aligned (4)));
+static int8_t  x_q7[NX * DIM]     __attribute__ ((section(".heapsram"), aligned (4)));
+static uint8_t ref_label[NREF]    __attribute__ ((section(".heapsram")));
+static uint8_t labels_f[NX]       __attribute__ ((section(".heapsram")));
+static uint8_t labels[NX]         __attribute__ ((section(".heapsram")));
+static int32_t mem[NREF + 4 * K]  __attribute__ ((section(".heapsram")));
+
+void check_float (testresult_t *result, void (*start)(), void (*stop)());
+void check_q15   (testresult_t *result, void (*start)(), void (*stop)());
+void check_q7    (testresult_t *result, void (*start)(), void (*stop)());
+void check_vote  (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "float", .test = check_float },
+  { .name = "q15",   .test = check_q15   },
+  { .name = "q7",    .test = check_q7    },
+  { .name = "vote",  .test = check_vote  },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+static uint32_t seed = 1;
+
+// roughly normal with standard deviation 0.04, sum of four uniforms
+static float noise(void)
+{
+  float s = 0.0f;
+  int   i;
+
+  for (i = 0; i < 4; i++) {
+    seed = seed * 1664525 + 1013904223;
+    s += (seed >> 8) * (1.0f / (1 << 24)) - 0.5f;
+  }
+
+  return s * 0.07f;
+}
+
+// cluster centres in [-0.15, 0.15], features clipped to [-0.3, 0.3] keep the
+// norms below 1.0 for eight features
+static void sample(float* v, int c)
+{
+  float f;
+  int   i;
+
+  for (i = 0; i < DIM; i++) {
+    f = 0.15f * (((c * 5 + i * 3) % 7) - 3) / 3.0f + noise();
+    v[i] = f > 0.3f ? 0.3f : (f < -0.3f ? -0.3f : f);
+  }
+}
+
+static void init_data(void)
+{
+  int i;
+
+  for (i = 0; i < NREF; i++) {
+    ref_label[i] = i % NCLASS;
+    sample(&ref_f[i * DIM], ref_label[i]);
+  }
+
+  for (i = 0; i < NX; i++)
+    sample(&x_f[i * DIM], i % NCLASS);
+
+  for (i = 0; i < NREF * DIM; i++) {
+    ref_q15[i] = lrintf(ref_f[i] * 32768.0f);
+    ref_q7[i]  = lrintf(ref_f[i] * 128.0f);
+  }
+
+  for (i = 0; i < NX * DIM; i++) {
+    x_q15[i] = lrintf(x_f[i] * 32768.0f);
+    x_q7[i]  = lrintf(x_f[i] * 128.0f);
+  }
+}
+
+// insertion into a sorted list of the k nearest, then a plain vote
+static void classify_float(void)
+{
+  float   dist[K], d;
+  int     idx[K], votes[NCLASS];
+  int     i, j, f, n, p, best;
+
+  for (i = 0; i < NX; i++) {
+    n = 0;
+
+    for (j = 0; j < NREF; j++) {
+      d = 0.0f;
+      for (f = 0; f < DIM; f++)
+        d += (x_f[i * DIM + f] - ref_f[j * DIM + f]) * (x_f[i * DIM + f] - ref_f[j * DIM + f]);
+
+      if (n == K && d >= dist[K - 1])
+        continue;
+
+      for (p = n < K ? n++ : K - 1; p > 0 && dist[p - 1] > d; p--) {
+        dist[p] = dist[p - 1];
+        idx[p]  = idx[p - 1];
+      }
+      dist[p] = d;
+      idx[p]  = j;
+    }
+
+    for (p = 0; p < NCLASS; p++)
+      votes[p] = 0;
+    for (p = 0; p < K; p++)
+      votes[ref_label[idx[p]]]++;
+
+    best = ref_label[idx[0]];
+    for (p = 1; p < K; p++) {
+      if (votes[ref_label[idx[p]]] > votes[best])
+        best = ref_label[idx[p]];
+    }
+
+    labels_f[i] = best;
+  }
+}
+
+static void report(const char* name)
+{
+  int cycles = get_time() / NX;
+
+  printf("%s: %d cycles per vector, %d vectors/s at %d MHz\n", name, cycles,
+         CLOCK_HZ / (cycles ? cycles : 1), CLOCK_HZ / 1000000);
+}
+
+// the quantized paths may only flip labels where neighbours are nearly tied,
+// which the clusters make rare
+static void compare(testresult_t *result, int max_diff)
+{
+  int i, diff = 0;
+
+  for (i = 0; i < NX; i++)
+    diff += labels[i] != labels_f[i];
+
+  if (diff > max_diff) {
+    printf("%d labels differ from the float path\n", diff);
+    result->errors++;
+  }
+}
+
+void check_float(testresult_t *result, void (*start)(), void (*stop)())
+{
+  int i, correct = 0;
+
+  init_data();
+
+  start();
+  classify_float();
+  stop();
+
+  report("float");
+
+  for (i = 0; i < NX; i++)
+    correct += labels_f[i] == i % NCLASS;
+
+  if (correct < NX - 2) {
+    printf("Float path classified %d of %d correctly\n", correct, NX);
+    result->errors++;
+  }
+}
+
+void check_q15(testresult_t *result, void (*start)(), void (*stop)())
+{
+  knn_t c;
+
+  if (knn_init_q15(&c, ref_q15, ref_label, NREF, DIM, NCLASS, K, mem) != 0) {
+    printf("knn_init_q15 failed\n");
+    result->errors++;
+    return;
+  }
+
+  start();
+  knn_classify_q15(&c, x_q15, NX, labels);
+  stop();
+
+  report("q15");
+  compare(result, 0);
+}
+
+void check_q7(testresult_t *result, void (*start)(), void (*stop)())
+{
+  knn_t c;
+
+  if (knn_init_q7(&c, ref_q7, ref_label, NREF, DIM, NCLASS, K, mem) != 0) {
+    printf("knn_init_q7 failed\n");
+    result->errors++;
+    return;
+  }
+
+  start();
+  knn_classify_q7(&c, x_q7, NX, labels);
+  stop();
+
+  report("q7");
+  compare(result, 2);
+}
+
+// references on the first axis, labels by position
+void check_vote(testresult_t *result, void (*start)(), void (*stop)())
+{
+  static int16_t line[6 * 2] __attribute__ ((aligned (4))) = {
+    1000, 0,  2000, 0,  3000, 0,  9000, 0,  9500, 0,  20000, 0
+  };
+  static int16_t query[3 * 2] __attribute__ ((aligned (4))) = {
+    0, 0,  2600, 0,  9200, 0
+  };
+  static const uint8_t line_label[6] = { 0, 1, 1, 2, 0, 2 };
+  static const uint8_t expected[3]   = { 1, 1, 2 };
+  knn_t c;
+  int   i;
+
+  // the last query has 9000 (2), 9500 (0) and 3000 (1) as its three
+  // nearest, a three-way tie won by the nearest
+  knn_init_q15(&c, line, line_label, 6, 2, 3, 3, mem);
+  knn_classify_q15(&c, query, 3, labels);
+
+  for (i = 0; i < 3; i++) {
+    if (labels[i] != expected[i]) {
+      printf("Query %d: label %d, expected %d\n", i, labels[i], expected[i]);
+      result->errors++;
+    }
+  }
+
+  if (knn_init_q15(&c, line, line_label, 6, 2, 3, 7, mem) != -1 ||
+      knn_classify_q7(&c, x_q7, 1, labels) != -1) {
+    printf("Invalid parameters accepted\n");
+    result->errors++;
+  }
+}
@@ -0,0 +1,396 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Runs LSTM and GRU cells with pseudo random weights over a sequence of
+// sines, in float as the reference and with the q15 and q7 kernels, whose
+// hidden states have to follow it at every step. The reference uses the
+// quantized weights and inputs, the difference is the error of the fixed
+// point activations and states. The cost case prints the cycles per time
+// step for several hidden sizes.
+
+#include <math.h>
+
+#include "bench.h"
+#include "timer.h"
+#include "rnn.h"
+
+#define NX      8
+#define NH      16
+#define T       48
+#define WEXP    1       // weights up to 2.0
+
+// largest cost case, 4 x 32 x (16 + 32) q15 or 4 x 48 x (16 + 48) q7 weights
+#define WBUF    12288
+
+static int8_t  wbuf[WBUF]            __attribute__ ((section(".heapsram"), aligned (4)));
+static int16_t w_ih[4 * NH * NX]     __attribute__ ((section(".heapsram")));
+static int16_t w_hh[4 * NH * NH]     __attribute__ ((section(".heapsram")));
+static int32_t bias[4 * 48]          __attribute__ ((section(".heapsram")));
+static int16_t x_q15[T * NX]         __attribute__ ((section(".heapsram")));
+static int8_t  x_q7[T * NX]          __attribute__ ((section(".heapsram"), aligned (4)));
+static float   h_ref[T * NH]         __attribute__ ((section(".heapsram")));
+static int16_t h[48]                 __attribute__ ((section(".heapsram")));
+static int16_t c[48]                 __attribute__ ((section(".heapsram")));
+static int32_t mem[24]               __attribute__ ((section(".heapsram")));
+
+void check_act      (testresult_t *result, void (*start)(), void (*stop)());
+void check_lstm_q15 (testresult_t *result, void (*start)(), void (*stop)());
+void check_lstm_q7  (testresult_t *result, void (*start)(), void (*stop)());
+void check_gru_q15  (testresult_t *result, void (*start)(), void (*stop)());
+void check_gru_q7   (testresult_t *result, void (*start)(), void (*stop)());
+void check_cost     (testresult_t *result, void (*start)(), void (*stop)());
+void check_errors   (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "act",      .test = check_act      },
+  { .name = "lstm_q15", .test = check_lstm_q15 },
+  { .name = "lstm_q7",  .test = check_lstm_q7  },
+  { .name = "gru_q15",  .test = check_gru_q15  },
+  { .name = "gru_q7",   .test = check_gru_q7   },
+  { .name = "cost",     .test = check_cost     },
+  { .name = "errors",   .test = check_errors   },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// uniform in [-0.8, 0.8], the same for every call with the same arguments
+static float weight(int part, int row, int k)
+{
+  uint32_t s = (part * 7919 + row) * 104729 + k;
+
+  s = s * 2654435761u;
+  s ^= s >> 15;
+  s = s * 2246822519u;
+  s ^= s >> 13;
+
+  return ((s >> 8) * (1.0f / (1 << 24)) - 0.5f) * 1.6f;
+}
+
+static float input(int t, int k)
+{
+  return 0.7f * sinf(0.2f * t * (k + 1) + k);
+}
+
+// scale of the stored weights
+static float wscale(int q7)
+{
+  return q7 ? (1 << (7 - WEXP)) : (1 << (15 - WEXP));
+}
+
+// weights, biases and inputs of a cell with ng gates; the LSTM forget gate
+// starts with a bias of 1.0
+static void init_data(int ng, int q7)
+{
+  int8_t* w8_ih = (int8_t*)w_ih;
+  int8_t* w8_hh = (int8_t*)w_hh;
+  float   s = wscale(q7);
+  int     i, k;
+
+  for (i = 0; i < ng * NH; i++) {
+    for (k = 0; k < NX; k++) {
+      if (q7)
+        w8_ih[i * NX + k] = lrintf(weight(0, i, k) * s);
+      else
+        w_ih[i * NX + k] = lrintf(weight(0, i, k) * s);
+    }
+
+    for (k = 0; k < NH; k++) {
+      if (q7)
+        w8_hh[i * NH + k] = lrintf(weight(1, i, k) * s);
+      else
+        w_hh[i * NH + k] = lrintf(weight(1, i, k) * s);
+    }
+  }
+
+  for (i = 0; i < 4 * NH; i++)
+    bias[i] = lrintf(weight(2, i, 0) * 0.4f * 4096.0f);
+
+  if (ng == 4) {
+    for (i = NH; i < 2 * NH; i++)
+      bias[i] += 4096;
+  }
+
+  for (i = 0; i < T * NX; i++) {
+    x_q15[i] = lrintf(input(i / NX, i % NX) * 32768.0f);
+    x_q7[i]  = lrintf(input(i / NX, i % NX) * 128.0f);
+  }
+}
+
+static float sigmoidf(float x)
+{
+  return 1.0f / (1.0f + expf(-x));
+}
+
+// float cell with the quantized weights, biases and inputs
+static void run_ref(int gru, int q7)
+{
+  int8_t* w8_ih = (int8_t*)w_ih;
+  int8_t* w8_hh = (int8_t*)w_hh;
+  float   hs[NH], cs[NH], hn[NH], xs[NX], sx[4], sh[4];
+  float   s = wscale(q7), i, f, g, o, r, z, n;
+  int     ng = gru ? 3 : 4;
+  int     t, j, gi, k, row;
+
+  for (j = 0; j < NH; j++)
+    hs[j] = cs[j] = 0.0f;
+
+  for (t = 0; t < T; t++) {
+    for (k = 0; k < NX; k++)
+      xs[k] = q7 ? x_q7[t * NX + k] / 128.0f : x_q15[t * NX + k] / 32768.0f;
+
+    for (j = 0; j < NH; j++) {
+      for (gi = 0; gi < ng; gi++) {
+        row = gi * NH + j;
+        sx[gi] = sh[gi] = 0.0f;
+
+        for (k = 0; k < NX; k++)
+          sx[gi] += (q7 ? w8_ih[row * NX + k] : w_ih[row * NX + k]) / s * xs[k];
+        for (k = 0; k < NH; k++)
+          sh[gi] += (q7 ? w8_hh[row * NH + k] : w_hh[row * NH + k]) / s * hs[k];
+      }
+
+      if (gru) {
+        r = sigmoidf(sx[0] + sh[0] + bias[j] / 4096.0f);
+        z = sigmoidf(sx[1] + sh[1] + bias[NH + j] / 4096.0f);
+        n = tanhf(sx[2] + bias[2 * NH + j] / 4096.0f + r * (sh[2] + bias[3 * NH + j] / 4096.0f));
+        hn[j] = (1.0f - z) * n + z * hs[j];
+      } else {
+        i = sigmoidf(sx[0] + sh[0] + bias[j] / 4096.0f);
+        f = sigmoidf(sx[1] + sh[1] + bias[NH + j] / 4096.0f);
+        g = tanhf(sx[2] + sh[2] + bias[2 * NH + j] / 4096.0f);
+        o = sigmoidf(sx[3] + sh[3] + bias[3 * NH + j] / 4096.0f);
+        cs[j] = f * cs[j] + i * g;
+        hn[j] = o * tanhf(cs[j]);
+      }
+    }
+
+    for (j = 0; j < NH; j++)
+      h_ref[t * NH + j] = hs[j] = hn[j];
+  }
+}
+
+// runs the fixed point cell a step at a time against the reference
+static void compare(testresult_t *result, rnn_t* r, const char* name, float tol,
+                    void (*start)(), void (*stop)())
+{
+  float d, worst = 0.0f;
+  int   t, j, cycles = 0;
+
+  rnn_reset(r);
+
+  for (t = 0; t < T; t++) {
+    start();
+    if (r->q7)
+      rnn_step_q7(r, &x_q7[t * NX], 1);
+    else
+      rnn_step_q15(r, &x_q15[t * NX], 1);
+    stop();
+    cycles += get_time();
+
+    for (j = 0; j < NH; j++) {
+      d = (r->q7 ? ((int8_t*)h)[j] / 128.0f : h[j] / 32768.0f) - h_ref[t * NH + j];
+      if (d < 0.0f)
+        d = -d;
+      if (d > worst)
+        worst = d;
+    }
+  }
+
+  printf("%s: %d cycles per step, largest error %d ppm\n", name, cycles / T, (int)(worst * 1e6f));
+
+  if (worst > tol) {
+    printf("%s: hidden state off by more than %d ppm\n", name, (int)(tol * 1e6f));
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// activations
+////////////////////////////////////////////////////////////////////////////////
+
+void check_act(testresult_t *result, void (*start)(), void (*stop)())
+{
+  float   f, d, worst_t = 0.0f, worst_s = 0.0f;
+  int32_t x;
+
+  for (x = -20 * 4096; x <= 20 * 4096; x += 37) {
+    f = x / 4096.0f;
+
+    d = fabsf(rnn_tanh(x) / 32768.0f - tanhf(f));
+    if (d > worst_t)
+      worst_t = d;
+
+    d = fabsf(rnn_sigmoid(x) / 32768.0f - sigmoidf(f));
+    if (d > worst_s)
+      worst_s = d;
+  }
+
+  printf("tanh within %d, sigmoid within %d LSB\n", (int)ceilf(worst_t * 32768.0f),
+         (int)ceilf(worst_s * 32768.0f));
+
+  if (worst_t > 4.0f / 32768.0f || worst_s > 4.0f / 32768.0f) {
+    printf("Activation error above 4 LSB\n");
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cells against the reference
+////////////////////////////////////////////////////////////////////////////////
+
+void check_lstm_q15(testresult_t *result, void (*start)(), void (*stop)())
+{
+  rnn_t r;
+
+  init_data(4, 0);
+  run_ref(0, 0);
+
+  rnn_pack_lstm_q15(w_ih, w_hh, NX, NH, (int16_t*)wbuf);
+  if (lstm_init_q15(&r, (int16_t*)wbuf, bias, NX, NH, WEXP, h, c, mem) != 0) {
+    printf("lstm_init_q15 failed\n");
+    result->errors++;
+    return;
+  }
+
+  compare(result, &r, "lstm q15", 0.002f, start, stop);
+}
+
+void check_lstm_q7(testresult_t *result, void (*start)(), void (*stop)())
+{
+  rnn_t r;
+
+  init_data(4, 1);
+  run_ref(0, 1);
+
+  rnn_pack_lstm_q7((int8_t*)w_ih, (int8_t*)w_hh, NX, NH, wbuf);
+  if (lstm_init_q7(&r, wbuf, bias, NX, NH, WEXP, (int8_t*)h, c, mem) != 0) {
+    printf("lstm_init_q7 failed\n");
+    result->errors++;
+    return;
+  }
+
+  compare(result, &r, "lstm q7", 0.03f, start, stop);
+}
+
+void check_gru_q15(testresult_t *result, void (*start)(), void (*stop)())
+{
+  rnn_t r;
+
+  init_data(3, 0);
+  run_ref(1, 0);
+
+  rnn_pack_gru_q15(w_ih, w_hh, NX, NH, (int16_t*)wbuf);
+  if (gru_init_q15(&r, (int16_t*)wbuf, bias, NX, NH, WEXP, h, mem) != 0) {
+    printf("gru_init_q15 failed\n");
+    result->errors++;
+    return;
+  }
+
+  compare(result, &r, "gru q15", 0.002f, start, stop);
+}
+
+void check_gru_q7(testresult_t *result, void (*start)(), void (*stop)())
+{
+  rnn_t r;
+
+  init_data(3, 1);
+  run_ref(1, 1);
+
+  rnn_pack_gru_q7((int8_t*)w_ih, (int8_t*)w_hh, NX, NH, wbuf);
+  if (gru_init_q7(&r, wbuf, bias, NX, NH, WEXP, (int8_t*)h, mem) != 0) {
+    printf("gru_init_q7 failed\n");
+    result->errors++;
+    return;
+  }
+
+  compare(result, &r, "gru q7", 0.03f, start, stop);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cost
+////////////////////////////////////////////////////////////////////////////////
+
+void check_cost(testresult_t *result, void (*start)(), void (*stop)())
+{
+  static const struct {
+    int q7;
+    int nh;
+  } sizes[] = {
+    { 0, 8 }, { 0, 16 }, { 0, 32 },
+    { 1, 16 }, { 1, 32 }, { 1, 48 },
+  };
+  rnn_t r;
+  int   i, s, gru, cycles;
+
+  // the cost does not depend on the weights, any small ones do
+  for (i = 0; i < WBUF; i++)
+    wbuf[i] = ((i * 37) & 7) - 4;
+
+  for (i = 0; i < 4 * 48; i++)
+    bias[i] = 0;
+
+  for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (gru = 0; gru < 2; gru++) {
+      if (sizes[s].q7) {
+        if (gru)
+          gru_init_q7(&r, wbuf, bias, 16, sizes[s].nh, 0, (int8_t*)h, mem);
+        else
+          lstm_init_q7(&r, wbuf, bias, 16, sizes[s].nh, 0, (int8_t*)h, c, mem);
+      } else {
+        if (gru)
+          gru_init_q15(&r, (int16_t*)wbuf, bias, 16, sizes[s].nh, 0, h, mem);
+        else
+          lstm_init_q15(&r, (int16_t*)wbuf, bias, 16, sizes[s].nh, 0, h, c, mem);
+      }
+
+      rnn_reset(&r);
+
+      start();
+      if (sizes[s].q7)
+        rnn_step_q7(&r, x_q7, 4);
+      else
+        rnn_step_q15(&r, x_q15, 4);
+      stop();
+      cycles = get_time() / 4;
+
+      printf("%s %s, 16 inputs, %d hidden: %d cycles per step\n", gru ? "gru" : "lstm",
+             sizes[s].q7 ? "q7" : "q15", sizes[s].nh, cycles);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// errors
+////////////////////////////////////////////////////////////////////////////////
+
+void check_errors(testresult_t *result, void (*start)(), void (*stop)())
+{
+  rnn_t r;
+
+  // sizes that do not fill whole words, weight exponents out of range
+  if (rnn_pack_lstm_q15(w_ih, w_hh, NX - 1, NH, (int16_t*)wbuf) != -1 ||
+      rnn_pack_gru_q7((int8_t*)w_ih, (int8_t*)w_hh, NX, NH - 2, wbuf) != -1 ||
+      lstm_init_q15(&r, (int16_t*)wbuf, bias, NX, NH - 1, WEXP, h, c, mem) != -1 ||
+      gru_init_q7(&r, wbuf, bias, NX - 2, NH, WEXP, (int8_t*)h, mem) != -1 ||
+      gru_init_q15(&r, (int16_t*)wbuf, bias, NX, NH, 8, h, mem) != -1) {
+    printf("Invalid sizes accepted\n");
+    result->errors++;
+  }
+
+  gru_init_q15(&r, (int16_t*)wbuf, bias, NX, NH, WEXP, h, mem);
+  if (rnn_step_q7(&r, x_q7, 1) != -1) {
+    printf("q7 inputs accepted by a q15 cell\n");
+    result->errors++;
+  }
+}
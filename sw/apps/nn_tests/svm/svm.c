@@ -0,0 +1,300 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Classifies a batch of feature vectors from three Gaussian clusters with an
+// RBF classifier whose support vectors are drawn from the same clusters, in
+// float as the reference and with the q15 and q7 kernels, which have to
+// agree with it. Every path reports its throughput.
+
+#include <math.h>
+
+#include "bench.h"
+#include "timer.h"
+#include "svm.h"
+
+#define DIM     8
+#define NCLASS  3
+#define NSV     24
+#define NX      64
+#define GAMMA   20.0f
+
+// core clock assumed for the classifications per second
+#define CLOCK_HZ  50000000
+
+static float   sv_f[NSV * DIM]      __attribute__ ((section(".heapsram")));
+static float   x_f[NX * DIM]        __attribute__ ((section(".heapsram")));
+static float   coef_f[NCLASS * NSV] __attribute__ ((section(".heapsram")));
+static float   dec_f[NX * NCLASS]   __attribute__ ((section(".heapsram")));
+static int16_t sv_q15[NSV * DIM]    __attribute__ ((section(".heapsram")));
+static int16_t x_q15[NX * DIM]      __attribute__ ((section(".heapsram")));
+static int8_t  sv_q7[NSV * DIM]     __attribute__ ((section(".heapsram"), aligned (4)));
+static int8_t  x_q7[NX * DIM]       __attribute__ ((section(".heapsram"), aligned (4)));
+static int16_t coef[NCLASS * NSV]   __attribute__ ((section(".heapsram")));
+static int32_t dec[NX * NCLASS]     __attribute__ ((section(".heapsram")));
+static uint8_t labels_f[NX]         __attribute__ ((section(".heapsram")));
+static uint8_t labels[NX]           __attribute__ ((section(".heapsram")));
+static int32_t mem[2 * NSV]         __attribute__ ((section(".heapsram")));
+
+static const int32_t bias[NCLASS] = { 0, 0, 0 };
+
+void check_float  (testresult_t *result, void (*start)(), void (*stop)());
+void check_q15    (testresult_t *result, void (*start)(), void (*stop)());
+void check_q7     (testresult_t *result, void (*start)(), void (*stop)());
+void check_binary (testresult_t *result, void (*start)(), void (*stop)());
+void check_errors (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "float",  .test = check_float  },
+  { .name = "q15",    .test = check_q15    },
+  { .name = "q7",     .test = check_q7     },
+  { .name = "binary", .test = check_binary },
+  { .name = "errors", .test = check_errors },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+static uint32_t seed = 1;
+
+// roughly normal with standard deviation 0.04, sum of four uniforms
+static float noise(void)
+{
+  float s = 0.0f;
+  int   i;
+
+  for (i = 0; i < 4; i++) {
+    seed = seed * 1664525 + 1013904223;
+    s += (seed >> 8) * (1.0f / (1 << 24)) - 0.5f;
+  }
+
+  return s * 0.07f;
+}
+
+// cluster centres in [-0.15, 0.15], features clipped to [-0.3, 0.3] keep the
+// norms below 1.0 for eight features
+static void sample(float* v, int c)
+{
+  float f;
+  int   i;
+
+  for (i = 0; i < DIM; i++) {
+    f = 0.15f * (((c * 5 + i * 3) % 7) - 3) / 3.0f + noise();
+    v[i] = f > 0.3f ? 0.3f : (f < -0.3f ? -0.3f : f);
+  }
+}
+
+static void init_data(void)
+{
+  int i, c;
+
+  for (i = 0; i < NSV; i++)
+    sample(&sv_f[i * DIM], i % NCLASS);
+
+  for (i = 0; i < NX; i++)
+    sample(&x_f[i * DIM], i % NCLASS);
+
+  for (i = 0; i < NSV * DIM; i++) {
+    sv_q15[i] = lrintf(sv_f[i] * 32768.0f);
+    sv_q7[i]  = lrintf(sv_f[i] * 128.0f);
+  }
+
+  for (i = 0; i < NX * DIM; i++) {
+    x_q15[i] = lrintf(x_f[i] * 32768.0f);
+    x_q7[i]  = lrintf(x_f[i] * 128.0f);
+  }
+
+  // one-vs-rest weights, every class row sums to 1.0 in absolute value
+  for (c = 0; c < NCLASS; c++) {
+    for (i = 0; i < NSV; i++) {
+      coef_f[c * NSV + i] = i % NCLASS == c ? 1.0f / 16 : -1.0f / 32;
+      coef[c * NSV + i]   = lrintf(coef_f[c * NSV + i] * 32767.0f);
+    }
+  }
+}
+
+static void classify_float(void)
+{
+  float d, k, best;
+  int   i, j, c, f;
+
+  for (i = 0; i < NX; i++) {
+    for (c = 0; c < NCLASS; c++)
+      dec_f[i * NCLASS + c] = 0.0f;
+
+    for (j = 0; j < NSV; j++) {
+      d = 0.0f;
+      for (f = 0; f < DIM; f++)
+        d += (x_f[i * DIM + f] - sv_f[j * DIM + f]) * (x_f[i * DIM + f] - sv_f[j * DIM + f]);
+
+      k = expf(-GAMMA * d);
+      for (c = 0; c < NCLASS; c++)
+        dec_f[i * NCLASS + c] += coef_f[c * NSV + j] * k;
+    }
+
+    labels_f[i] = 0;
+    best = dec_f[i * NCLASS];
+    for (c = 1; c < NCLASS; c++) {
+      if (dec_f[i * NCLASS + c] > best) {
+        best = dec_f[i * NCLASS + c];
+        labels_f[i] = c;
+      }
+    }
+  }
+}
+
+static void report(const char* name)
+{
+  int cycles = get_time() / NX;
+
+  printf("%s: %d cycles per vector, %d vectors/s at %d MHz\n", name, cycles,
+         CLOCK_HZ / (cycles ? cycles : 1), CLOCK_HZ / 1000000);
+}
+
+// labels may only differ where the float decision is close, the decision
+// values within tol
+static void compare(testresult_t *result, int nclass, float tol)
+{
+  float d, gap;
+  int   i, c;
+
+  for (i = 0; i < NX; i++) {
+    for (c = 0; c < nclass; c++) {
+      d = dec[i * nclass + c] * (1.0f / (1 << 30)) - dec_f[i * NCLASS + c];
+      if (d > tol || d < -tol) {
+        printf("Vector %d class %d: decision off by %d ppm\n", i, c, (int)(d * 1e6f));
+        result->errors++;
+      }
+    }
+
+    if (nclass > 1 && labels[i] != labels_f[i]) {
+      gap = dec_f[i * NCLASS + labels_f[i]] - dec_f[i * NCLASS + labels[i]];
+      if (gap > 2 * tol) {
+        printf("Vector %d: label %d, float %d\n", i, labels[i], labels_f[i]);
+        result->errors++;
+      }
+    }
+  }
+}
+
+void check_float(testresult_t *result, void (*start)(), void (*stop)())
+{
+  int i, correct = 0;
+
+  init_data();
+
+  start();
+  classify_float();
+  stop();
+
+  report("float");
+
+  // the clusters are well apart, the reference has to get them right
+  for (i = 0; i < NX; i++)
+    correct += labels_f[i] == i % NCLASS;
+
+  if (correct < NX - 2) {
+    printf("Float path classified %d of %d correctly\n", correct, NX);
+    result->errors++;
+  }
+}
+
+void check_q15(testresult_t *result, void (*start)(), void (*stop)())
+{
+  svm_t s;
+
+  if (svm_init_q15(&s, sv_q15, NSV, DIM, coef, bias, NCLASS, (uint32_t)(GAMMA * 65536), mem) != 0) {
+    printf("svm_init_q15 failed\n");
+    result->errors++;
+    return;
+  }
+
+  start();
+  svm_classify_q15(&s, x_q15, NX, labels, dec);
+  stop();
+
+  report("q15");
+  compare(result, NCLASS, 0.002f);
+}
+
+void check_q7(testresult_t *result, void (*start)(), void (*stop)())
+{
+  svm_t s;
+
+  if (svm_init_q7(&s, sv_q7, NSV, DIM, coef, bias, NCLASS, (uint32_t)(GAMMA * 65536), mem) != 0) {
+    printf("svm_init_q7 failed\n");
+    result->errors++;
+    return;
+  }
+
+  start();
+  svm_classify_q7(&s, x_q7, NX, labels, dec);
+  stop();
+
+  report("q7");
+  compare(result, NCLASS, 0.02f);
+}
+
+// class 0 against the rest, an odd batch exercises the unpaired last vector
+void check_binary(testresult_t *result, void (*start)(), void (*stop)())
+{
+  svm_t s;
+  int   i;
+
+  svm_init_q15(&s, sv_q15, NSV, DIM, coef, bias, 1, (uint32_t)(GAMMA * 65536), mem);
+
+  start();
+  svm_classify_q15(&s, x_q15, NX - 1, labels, dec);
+  stop();
+
+  for (i = 0; i < NX - 1; i++) {
+    if (labels[i] != (dec[i] >= 0)) {
+      printf("Vector %d: label %d for decision %d\n", i, labels[i], dec[i]);
+      result->errors++;
+    }
+
+    if (labels[i] != (i % NCLASS == 0) && (dec_f[i * NCLASS] > 0.004f || dec_f[i * NCLASS] < -0.004f)) {
+      printf("Vector %d: label %d, float decision %d ppm\n", i, labels[i], (int)(dec_f[i * NCLASS] * 1e6f));
+      result->errors++;
+    }
+  }
+}
+
+void check_errors(testresult_t *result, void (*start)(), void (*stop)())
+{
+  static int16_t big[DIM] __attribute__ ((aligned (4)));
+  svm_t s;
+  int   i;
+
+  // odd numbers of support vectors or features
+  if (svm_init_q15(&s, sv_q15, NSV - 1, DIM, coef, bias, NCLASS, 1 << 16, mem) != -1 ||
+      svm_init_q15(&s, sv_q15, NSV, DIM - 1, coef, bias, NCLASS, 1 << 16, mem) != -1 ||
+      svm_init_q7(&s, sv_q7, NSV, DIM - 2, coef, bias, NCLASS, 1 << 16, mem) != -1) {
+    printf("Invalid sizes accepted\n");
+    result->errors++;
+  }
+
+  // four features of 0.5 give a norm of 1.0
+  for (i = 0; i < DIM; i++)
+    big[i] = 16384;
+
+  if (svm_init_q15(&s, big, 2, DIM / 2, coef, bias, 1, 1 << 16, mem) != -1) {
+    printf("Norm above 1.0 accepted\n");
+    result->errors++;
+  }
+
+  svm_init_q15(&s, sv_q15, NSV, DIM, coef, bias, NCLASS, 1 << 16, mem);
+  if (svm_classify_q7(&s, x_q7, NX, labels, 0) != -1) {
+    printf("q7 vectors accepted by a q15 classifier\n");
+    result->errors++;
+  }
+}
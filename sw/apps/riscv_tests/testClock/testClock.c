@@ -0,0 +1,127 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the FLL settings and peripheral divisors of clock.c. Frequency
+// switches are only tested when the FLL is there, FPGA and RTL simulation
+// have none.
+
+#include <stdio.h>
+#include "bench.h"
+#include "clock.h"
+#include "uart.h"
+#include "spi.h"
+#include "timer.h"
+
+void check_fll_cfg(testresult_t *result, void (*start)(), void (*stop)());
+void check_divisors(testresult_t *result, void (*start)(), void (*stop)());
+void check_switch(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "fll_cfg",  .test = check_fll_cfg  },
+  { .name = "divisors", .test = check_divisors },
+  { .name = "switch",   .test = check_switch   },
+  {0, 0}
+};
+
+int main() {
+  return run_suite(testcases);
+}
+
+void check_fll_cfg(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t hz, f, mult, div, err;
+
+  for (hz = 1000000; hz <= 200000000; hz += hz / 3) {
+    f   = fll_freq_cfg(hz, &mult, &div);
+    err = f > hz ? f - hz : hz - f;
+
+    // within 0.1%
+    if (err > hz / 1000) {
+      printf("%d Hz: got %d Hz\n", hz, f);
+      result->errors++;
+    }
+
+    if (mult == 0 || mult > FLL_CONF1_MULT_MASK || div < 2 || div > 15) {
+      printf("%d Hz: factor %d, divider %d\n", hz, mult, div);
+      result->errors++;
+    }
+
+    // the DCO has to stay in its range
+    if (((uint64_t)FLL_REF_CLK_HZ * mult) >> FLL_LOG2_MAXDCO) {
+      printf("%d Hz: DCO out of range\n", hz);
+      result->errors++;
+    }
+  }
+}
+
+void check_divisors(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_uint32(result, "uart 115200", clk_uart_counter(50000000, 115200), 26);
+  check_uint32(result, "uart slow",   clk_uart_counter(1000000, 115200), 1);
+  check_uint32(result, "i2c 100k",    clk_i2c_pre(50000000, 100000), 0x63);
+  check_uint32(result, "spi 4M",      clk_spi_div(50000000, 4000000), 6);
+  check_uint32(result, "spi fast",    clk_spi_div(50000000, 50000000), 0);
+  check_uint32(result, "spi slow",    clk_spi_div(50000000, 1000), 255);
+}
+
+static int events[4];
+static int num_events;
+
+static void record(int event, uint32_t old_hz, uint32_t new_hz, void* arg) {
+  if (num_events < 4)
+    events[num_events] = event;
+  num_events++;
+}
+
+void check_switch(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t hz, f, ocra;
+
+  // a fixed clock never changes
+  clk_init(CLK_FIXED, 25000000);
+  clk_register(record, 0);
+  check_uint32(result, "fixed", clk_set_freq(50000000), 25000000);
+  check_uint32(result, "no events", num_events, 0);
+
+  CGREG |= (1 << CGFLL);
+  if ((FLL_STATUS & FLL_CONF1_MULT_MASK) == 0) {
+    printf("No FLL, switching not tested\n");
+    clk_unregister(record, 0);
+    return;
+  }
+
+  clk_init(CLK_FLL, 0);
+  hz = clk_get_freq();
+  printf("FLL at %d Hz\n", hz);
+
+  clk_keep_uart_baud(115200);
+  clk_keep_spi_rate(1000000);
+  clk_keep_timer_rates(CLK_TIMER_B);
+
+  // timer B is scaled, timer A is the time base of the bench and stays
+  TOCRB = 0x100000;
+  TIRB  = 0;
+  TPRB  = 0x1;
+  ocra  = TOCRA;
+
+  f = clk_set_freq(hz / 2);
+  TPRB = 0x0;
+  printf("switched to %d Hz\n", f);
+
+  check_uint32(result, "events", num_events, 2);
+  check_uint32(result, "pre",    events[0], CLK_PRE_CHANGE);
+  check_uint32(result, "post",   events[1], CLK_POST_CHANGE);
+  check_uint32(result, "freq",   clk_get_freq(), f);
+  check_uint32(result, "spi",    SPI_CLKDIV, clk_spi_div(f, 1000000));
+  check_uint32(result, "timer b", TOCRB, (uint32_t)(((uint64_t)0x100000 * f) / hz));
+  check_uint32(result, "timer a", TOCRA, ocra);
+
+  // the UART has to work at the new frequency
+  printf("back to %d Hz\n", clk_set_freq(hz));
+
+  clk_unregister(record, 0);
+}
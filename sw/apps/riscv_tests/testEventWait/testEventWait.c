@@ -0,0 +1,195 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks event_wait: an event that is already pending, a timeout without an
+// event, a timeout while timer B runs as a time base and a wake up by the
+// timer A compare event while the core sleeps.
+
+#include <stdio.h>
+#include "bench.h"
+#include "event.h"
+#include "timer.h"
+
+#define SW_EVENT  5   // a line without a peripheral, only set through ESP
+
+void check_pending(testresult_t *result, void (*start)(), void (*stop)());
+void check_timeout(testresult_t *result, void (*start)(), void (*stop)());
+void check_time_base(testresult_t *result, void (*start)(), void (*stop)());
+void check_wake(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "pending", .test = check_pending },
+  { .name = "timeout", .test = check_timeout },
+  { .name = "base",    .test = check_time_base },
+  { .name = "wake",    .test = check_wake    },
+  {0, 0}
+};
+
+int main() {
+  return run_suite(testcases);
+}
+
+void check_pending(testresult_t *result, void (*start)(), void (*stop)()) {
+  ECP = 0xFFFFFFFF;
+  EER = 0;
+
+  ESP = 1u << SW_EVENT;
+  check_uint32(result, "pending",  event_wait(1u << SW_EVENT, 0), 1u << SW_EVENT);
+  check_uint32(result, "cleared",  EPR & (1u << SW_EVENT), 0);
+  check_uint32(result, "EER",      EER, 0);
+
+  // only lines of the mask are returned and cleared
+  ESP = (1u << SW_EVENT) | (1u << (SW_EVENT + 1));
+  check_uint32(result, "masked",   event_wait(1u << SW_EVENT, 100), 1u << SW_EVENT);
+  check_uint32(result, "other",    EPR & (1u << (SW_EVENT + 1)), 1u << (SW_EVENT + 1));
+
+  ECP = 0xFFFFFFFF;
+}
+
+void check_timeout(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t t;
+
+  // stopped, with a prescaler set up that the wait must not lose
+  ECP   = 0xFFFFFFFF;
+  TPRB  = 0x1C;
+  TIRB  = 77;
+  TOCRB = 1234;
+
+  // timer A measures the wait
+  TPRA  = 0x0;
+  TIRA  = 0x0;
+  TOCRA = 0xFFFFFFFF;
+  TPRA  = 0x1;
+
+  check_uint32(result, "timeout", event_wait(1u << SW_EVENT, 2000), 0);
+  t = TIRA;
+  TPRA = 0x0;
+
+  if (t < 2000) {
+    printf("Woke up after %d cycles\n", t);
+    result->errors++;
+  }
+
+  // timer B is back as it was
+  check_uint32(result, "TIRB",  TIRB, 77);
+  check_uint32(result, "TOCRB", TOCRB, 1234);
+  check_uint32(result, "TPRB",  TPRB, 0x1C);
+  check_uint32(result, "event", EPR & (1u << TIMER_B_OUTPUT_CMP), 0);
+  TPRB = 0;
+
+  // the polling loop of the drivers ends as well
+  t = 0;
+  EVENT_WAIT_UNTIL(++t == 3, 0);
+  check_uint32(result, "loop", t, 3);
+}
+
+void check_time_base(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t t0, t1;
+
+  ECP = 0xFFFFFFFF;
+
+  // a free running timer B must neither be reset nor get a compare value
+  TPRB  = 0;
+  TIRB  = 0;
+  TOCRB = 0xFFFFFFFF;
+  TPRB  = 0x1;
+
+  t0 = TIRB;
+  check_uint32(result, "timeout", event_wait(1u << SW_EVENT, 2000), 0);
+  t1 = TIRB;
+
+  check_uint32(result, "TOCRB", TOCRB, 0xFFFFFFFF);
+  check_uint32(result, "TPRB",  TPRB, 1);
+
+  if (t1 < t0) {
+    printf("Timer B went back from %d to %d\n", t0, t1);
+    result->errors++;
+  }
+
+  // a pending event is still returned
+  ESP = 1u << SW_EVENT;
+  check_uint32(result, "pending", event_wait(1u << SW_EVENT, 2000), 1u << SW_EVENT);
+
+  TPRB = 0;
+  ECP  = 0xFFFFFFFF;
+}
+
+void check_wake(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "pending", .test = check_pending },
+  { .name = "timeout", .test = check_timeout },
+  { .name = "base",    .test = check_time_base },
+  { .name = "wake",    .test = check_wake    },
+  {0, 0}
+};
+
+int main() {
+  return run_suite(testcases);
+}
+
+void check_pending(testresult_t *result, void (*start)(), void (*stop)()) {
+  ECP = 0xFFFFFFFF;
+  EER = 0;
+
+  ESP = 1u << SW_EVENT;
+  check_uint32(result, "pending",  event_wait(1u << SW_EVENT, 0), 1u << SW_EVENT);
+  check_uint32(result, "cleared",  EPR & (1u << SW_EVENT), 0);
+  check_uint32(result, "EER",      EER, 0);
+
+  // only lines of the mask are returned and cleared
+  ESP = (1u << SW_EVENT) | (1u << (SW_EVENT + 1));
+  check_uint32(result, "masked",   event_wait(1u << SW_EVENT, 100), 1u << SW_EVENT);
+  check_uint32(result, "other",    EPR & (1u << (SW_EVENT + 1)), 1u << (SW_EVENT + 1));
+
+  ECP = 0xFFFFFFFF;
+}
+
+void check_timeout(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t t0, t1;
+
+  ECP   = 0xFFFFFFFF;
+  TPRB  = 0;
+  TOCRB = 1234;
+
+  t0 = TIRB;
+  check_uint32(result, "timeout", event_wait(1u << SW_EVENT, 2000), 0);
+  t1 = TIRB;
+
+  // timer B ran for the wait only
+  if (t1 - t0 < 2000) {
+    printf("Woke up after %d ticks\n", t1 - t0);
+    result->errors++;
+  }
+
+  check_uint32(result, "TOCRB", TOCRB, 1234);
+  check_uint32(result, "TPRB",  TPRB, 0);
+}
+
+void check_wake(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t t;
+
+  ECP = 0xFFFFFFFF;
+
+  // timer A raises its compare event after 3000 cycles
+  TPRA  = 0x0;
+  TIRA  = 0x0;
+  TOCRA = 3000;
+  TPRA  = 0x1;
+
+  check_uint32(result, "event", event_wait(1u << TIMER_A_OUTPUT_CMP, 0), 1u << TIMER_A_OUTPUT_CMP);
+  t = TIRA;
+  TPRA = 0x0;
+
+  if (t < 3000) {
+    printf("Woke up at %d\n", t);
+    result->errors++;
+  }
+}
@@ -0,0 +1,303 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Tests the GPIO edge capture ring and its decoders on synthetic records, and
+// measures the interrupt entry and exit cost by raising the GPIO interrupt
+// through the set pending register, the testbench does not toggle the pads.
+
+#include <stdio.h>
+#include "bench.h"
+#include "timer.h"
+#include "event.h"
+#include "int.h"
+#include "gpio_capture.h"
+
+#define RING_SIZE   8
+#define NUM_IRQ     16
+// four frames of 68 edges and three repeat codes of 4
+#define NUM_EDGES   288
+
+// 25 MHz timer, the usual FPGA clock
+#define TICKS_PER_US  25
+
+#define PIN_A   3
+#define PIN_B   4
+#define PIN_IR  7
+
+void check_ring(testresult_t *result, void (*start)(), void (*stop)());
+void check_quad(testresult_t *result, void (*start)(), void (*stop)());
+void check_pulse(testresult_t *result, void (*start)(), void (*stop)());
+void check_nec(testresult_t *result, void (*start)(), void (*stop)());
+void check_isr(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "ring",   .test = check_ring   },
+  { .name = "quad",   .test = check_quad   },
+  { .name = "pulse",  .test = check_pulse  },
+  { .name = "nec",    .test = check_nec    },
+  { .name = "isr",    .test = check_isr    },
+  {0, 0}
+};
+
+gpio_edge_t    g_buf[RING_SIZE]   __attribute__ ((section(".heapsram")));
+gpio_capture_t g_cap              __attribute__ ((section(".heapsram")));
+gpio_edge_t    g_edges[NUM_EDGES] __attribute__ ((section(".heapsram")));
+
+int main() {
+  return run_suite(testcases);
+}
+
+//----------------------------------------------------------------------------
+// ring buffer
+//----------------------------------------------------------------------------
+
+void check_ring(testresult_t *result, void (*start)(), void (*stop)()) {
+  gpio_edge_t e;
+  unsigned int i, n, next = 0;
+
+  if (gpio_capture_init(&g_cap, g_buf, 6, 1) != -1 || gpio_capture_init(&g_cap, g_buf, 1, 1) != -1) {
+    printf("Ring sizes that are no power of two accepted\n");
+    result->errors++;
+  }
+
+  gpio_capture_init(&g_cap, g_buf, RING_SIZE, 1);
+
+  // fill and drain in uneven steps, so the indices wrap many times
+  for (i = 0, n = 0; i < 40; i++) {
+    for (; gpio_capture_count(&g_cap) < (i % RING_SIZE) + 1; n++)
+      gpio_capture_put(&g_cap, n, 1, n & 1);
+
+    while (gpio_capture_count(&g_cap) > i % 3) {
+      gpio_capture_get(&g_cap, &e);
+      if (e.time != next || e.level != (next & 1)) {
+        printf("Record %d: got time %d\n", next, e.time);
+        result->errors++;
+      }
+      next++;
+    }
+  }
+
+  while (gpio_capture_get(&g_cap, &e))
+    next++;
+
+  if (next != n || g_cap.dropped != 0) {
+    printf("Took %d of %d records, %d dropped\n", next, n, g_cap.dropped);
+    result->errors++;
+  }
+
+  // a full ring drops new records and keeps the old ones
+  for (i = 0; i < RING_SIZE + 3; i++) {
+    if (gpio_capture_put(&g_cap, i, 1, 0) != (i < RING_SIZE)) {
+      printf("Put %d into a ring with %d records\n", i, gpio_capture_count(&g_cap));
+      result->errors++;
+    }
+  }
+
+  if (g_cap.dropped != 3 || !gpio_capture_get(&g_cap, &e) || e.time != 0) {
+    printf("Overflow: %d dropped, oldest record %d\n", g_cap.dropped, e.time);
+    result->errors++;
+  }
+}
+
+//----------------------------------------------------------------------------
+// quadrature encoder
+//----------------------------------------------------------------------------
+
+// gray code sequence of (A, B) while A leads
+static const uint32_t g_quad_seq[4] = { 0, 1 << PIN_A, (1 << PIN_A) | (1 << PIN_B), 1 << PIN_B };
+
+void check_quad(testresult_t *result, void (*start)(), void (*stop)()) {
+  gpio_quad_t q;
+  gpio_edge_t e;
+  uint32_t level = g_quad_seq[0];
+  int i, pos = 0, sum = 0;
+
+  gpio_quad_init(&q, PIN_A, PIN_B, level | (1 << PIN_IR));
+
+  // 100 quarter steps forward, 37 back, interleaved with another pin
+  for (i = 0; i < 137; i++) {
+    pos += (i < 100) ? 1 : -1;
+
+    e.time  = i;
+    e.level = g_quad_seq[pos & 3];
+    e.pins  = e.level ^ level;
+    level   = e.level;
+    sum    += gpio_quad_feed(&q, &e);
+
+    if (i % 10 == 0) {
+      e.pins  = 1 << PIN_IR;
+      e.level = level | (i & 1 ? 1 << PIN_IR : 0);
+      sum    += gpio_quad_feed(&q, &e);
+    }
+  }
+
+  // a skipped state is counted as an error and not as a step
+  e.level = g_quad_seq[(pos + 2) & 3];
+  e.pins  = e.level ^ level;
+  sum    += gpio_quad_feed(&q, &e);
+
+  check_uint32(result, "count", q.count, 63);
+  check_uint32(result, "sum", sum, 63);
+  check_uint32(result, "errors", q.errors, 1);
+}
+
+//----------------------------------------------------------------------------
+// pulse width
+//----------------------------------------------------------------------------
+
+void check_pulse(testresult_t *result, void (*start)(), void (*stop)()) {
+  gpio_pulse_t p;
+  gpio_edge_t e;
+  uint32_t width, t = 0xFFFFF000;
+  int i, level, n = 0;
+
+  gpio_pulse_init(&p, PIN_IR);
+
+  // the timer wraps in the middle of the pulse train
+  for (i = 0; i < 20; i++) {
+    e.time  = t;
+    e.pins  = 1 << PIN_IR;
+    e.level = (i & 1) ? 0 : 1 << PIN_IR;
+    t += 1000 + 100 * i;
+
+    if (!gpio_pulse_feed(&p, &e, &width, &level))
+      continue;
+
+    n++;
+    if (width != 1000 + 100 * (uint32_t)(i - 1) || level != (i & 1)) {
+      printf("Pulse %d: width %d level %d\n", i, width, level);
+      result->errors++;
+    }
+  }
+
+  check_uint32(result, "pulses", n, 19);
+}
+
+//----------------------------------------------------------------------------
+// NEC infrared, active low receiver
+//----------------------------------------------------------------------------
+
+static unsigned int nec_edge(unsigned int n, uint32_t* t, int level, uint32_t us) {
+  // alternate +-8% timing errors, the decoder accepts 25%
+  uint32_t ticks = us * TICKS_PER_US;
+  ticks += (n % 3 == 0) ? ticks / 12 : (n % 3 == 1) ? -(ticks / 12) : 0;
+
+  g_edges[n].time  = *t;
+  g_edges[n].pins  = 1 << PIN_IR;
+  g_edges[n].level = level ? 1 << PIN_IR : 0;
+  *t += ticks;
+
+  return n + 1;
+}
+
+static unsigned int nec_frame(unsigned int n, uint32_t* t, uint32_t data) {
+  int i;
+
+  // the pin goes low at the start of each burst
+  n = nec_edge(n, t, 0, 9000);
+  n = nec_edge(n, t, 1, 4500);
+  for (i = 0; i < 32; i++) {
+    n = nec_edge(n, t, 0, 560);
+    n = nec_edge(n, t, 1, (data >> i) & 1 ? 1690 : 560);
+  }
+  n = nec_edge(n, t, 0, 560);
+  return nec_edge(n, t, 1, 40000);
+}
+
+static unsigned int nec_repeat(unsigned int n, uint32_t* t) {
+  n = nec_edge(n, t, 0, 9000);
+  n = nec_edge(n, t, 1, 2250);
+  n = nec_edge(n, t, 0, 560);
+  return nec_edge(n, t, 1, 96000);
+}
+
+void check_nec(testresult_t *result, void (*start)(), void (*stop)()) {
+  gpio_nec_t nec;
+  uint32_t t = 12345;
+  unsigned int i, n = 0;
+  int frames = 0, repeats = 0, r;
+
+  n = nec_repeat(n, &t);                       // repeat without a frame
+  n = nec_frame(n, &t, 0xF708FB04);            // address 0x04, command 0x08
+  n = nec_repeat(n, &t);
+  n = nec_repeat(n, &t);
+  n = nec_frame(n, &t, 0xAA55FB04 ^ 0x1);      // broken address is extended
+  n = nec_frame(n, &t, 0xAB551234 & ~0x1);     // broken command
+  n = nec_frame(n, &t, 0xAA551234);            // extended address 0x1234
+
+  gpio_nec_init(&nec, PIN_IR, TICKS_PER_US, 0);
+
+  for (i = 0; i < n; i++) {
+    r = gpio_nec_feed(&nec, &g_edges[i]);
+
+    if (r == GPIO_NEC_REPEAT) {
+      repeats++;
+    } else if (r == GPIO_NEC_FRAME) {
+      static const uint32_t addr[3] = { 0x04, 0xFB05, 0x1234 };
+      static const uint32_t cmd[3]  = { 0x08, 0x55,   0x55   };
+
+      if (frames < 3 && (nec.addr != addr[frames] || nec.cmd != cmd[frames])) {
+        printf("Frame %d: address %x command %x\n", frames, nec.addr, nec.cmd);
+        result->errors++;
+      }
+      frames++;
+    }
+  }
+
+  check_uint32(result, "frames", frames, 3);
+  check_uint32(result, "repeats", repeats, 2);
+  check_uint32(result, "errors", nec.errors, 1);
+}
+
+//----------------------------------------------------------------------------
+// interrupt path, spurious interrupts must not produce records
+//----------------------------------------------------------------------------
+
+void check_isr(testresult_t *result, void (*start)(), void (*stop)()) {
+  int i, t0, t1;
+
+  gpio_capture_init(&g_cap, g_buf, RING_SIZE, 0);
+  gpio_capture_start(&g_cap);
+  int_enable();
+
+  // the empty loop is measured first, the difference is the interrupt
+  t0 = get_time();
+  for (i = 0; i < NUM_IRQ; i++)
+    asm volatile ("nop");
+  t0 = get_time() - t0;
+
+  t1 = get_time();
+  for (i = 0; i < NUM_IRQ; i++) {
+    ISP = 1 << GPIO_EVENT;
+    asm volatile ("nop");
+  }
+  t1 = get_time() - t1;
+
+  int_disable();
+  gpio_capture_stop(&g_cap);
+
+  printf("GPIO interrupt entry, handler and exit: %d cycles\n", (t1 - t0) / NUM_IRQ);
+
+  check_uint32(result, "records", gpio_capture_count(&g_cap), 0);
+  check_uint32(result, "pending", IPR & (1 << GPIO_EVENT), 0);
+
+  // timer B runs freely, timestamps only wrap at 2^32
+  check_uint32(result, "TOCRB", TOCRB, TIMER_FREE_RUN);
+
+  // an interrupt that arrives after the capture stopped is ignored
+  IER |= 1 << GPIO_EVENT;
+  int_enable();
+  ISP = 1 << GPIO_EVENT;
+  asm volatile ("nop");
+  int_disable();
+  IER &= ~(1 << GPIO_EVENT);
+
+  check_uint32(result, "stopped", gpio_capture_count(&g_cap), 0);
+}
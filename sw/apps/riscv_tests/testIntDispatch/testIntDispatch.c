@@ -0,0 +1,267 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the interrupt dispatcher of int.c and compares it with one handler
+// per vector under bursts of interrupts. Three lines go through int_dispatch
+// (GPIO, SPIM0 and SPIM1) and three have their own ISR_* function (I2C and
+// both timer B lines). All handlers do the same work and are raised through
+// the set pending register while interrupts are disabled, so a burst of n
+// lines costs n full entries and exits with the own handlers and a single
+// one with the dispatcher.
+
+#include <stdio.h>
+#include "bench.h"
+#include "timer.h"
+#include "event.h"
+#include "int.h"
+
+#define NUM_LINES   3
+#define NUM_BURSTS  64
+
+static const int dispatch_irqs[NUM_LINES] = { GPIO_EVENT, 26, 27 };
+static const int direct_irqs[NUM_LINES]   = { 23, TIMER_B_OVERFLOW, TIMER_B_OUTPUT_CMP };
+
+void check_dispatch(testresult_t *result, void (*start)(), void (*stop)());
+void check_chain(testresult_t *result, void (*start)(), void (*stop)());
+void check_burst(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "dispatch", .test = check_dispatch },
+  { .name = "chain",    .test = check_chain    },
+  { .name = "burst",    .test = check_burst    },
+  {0, 0}
+};
+
+volatile uint32_t hits[32];
+
+int main() {
+  return run_suite(testcases);
+}
+
+#define DIRECT(name, irq)   \
+  void name(void) {         \
+    ICP = 1u << (irq);      \
+    hits[irq]++;            \
+  }
+
+DIRECT(ISR_I2C,    23)
+DIRECT(ISR_TB_OVF, TIMER_B_OVERFLOW)
+DIRECT(ISR_TB_CMP, TIMER_B_OUTPUT_CMP)
+
+// the dispatcher clears the pending bit itself
+static void count(void* arg) {
+  (*(volatile uint32_t*)arg)++;
+}
+
+#define WAIT_IRQ "nop\n nop\n nop\n nop\n nop\n nop\n nop\n nop\n"
+
+// raises all lines of mask at once and returns the cycles until the
+// interrupted code continues
+static uint32_t burst(uint32_t mask) {
+  uint32_t t0, t1;
+
+  ISP = mask;
+  t0 = TIRA;
+  int_enable();
+  asm volatile (WAIT_IRQ);
+  int_disable();
+  t1 = TIRA;
+
+  return t1 - t0;
+}
+
+static uint32_t lines(const int* irqs, int set) {
+  uint32_t mask = 0;
+  int i;
+
+  for (i = 0; i < NUM_LINES; i++)
+    if (set & (1 << i))
+      mask |= 1u << irqs[i];
+
+  return mask;
+}
+
+static void setup(void) {
+  int i;
+
+  int_disable();
+  int_init();
+  ICP = 0xFFFFFFFF;
+
+  for (i = 0; i < 32; i++)
+    hits[i] = 0;
+
+  for (i = 0; i < NUM_LINES; i++) {
+    int_add(dispatch_irqs[i], count, (void*)&hits[dispatch_irqs[i]]);
+    IER |= 1u << direct_irqs[i];
+  }
+}
+
+static void teardown(void) {
+  int_disable();
+  int_init();
+  IER = 0;
+  ICP = 0xFFFFFFFF;
+}
+
+//----------------------------------------------------------------------------
+// registration
+//----------------------------------------------------------------------------
+
+static volatile int order[8];
+static volatile int num_order;
+
+static void log_irq(void* arg) {
+  order[num_order++] = (int)arg;
+}
+
+void check_dispatch(testresult_t *result, void (*start)(), void (*stop)()) {
+  int i;
+
+  setup();
+
+  check_uint32(result, "invalid line", int_add(32, count, 0), -1);
+  check_uint32(result, "no handler",   int_add(GPIO_EVENT, 0, 0), -1);
+  check_uint32(result, "IER", IER & lines(dispatch_irqs, 7), lines(dispatch_irqs, 7));
+
+  // every line alone and then all of them
+  for (i = 0; i < NUM_LINES; i++)
+    burst(1u << dispatch_irqs[i]);
+  burst(lines(dispatch_irqs, 7));
+
+  for (i = 0; i < NUM_LINES; i++)
+    check_uint32(result, "handler calls", hits[dispatch_irqs[i]], 2);
+
+  // higher lines first, with the argument given to int_add
+  num_order = 0;
+  for (i = 0; i < NUM_LINES; i++)
+    int_add(dispatch_irqs[i], log_irq, (void*)dispatch_irqs[i]);
+  burst(lines(dispatch_irqs, 7));
+
+  check_uint32(result, "calls", num_order, NUM_LINES);
+  for (i = 0; i < NUM_LINES; i++)
+    check_uint32(result, "order", order[i], dispatch_irqs[NUM_LINES - 1 - i]);
+
+  // a removed line is disabled and stays pending
+  check_uint32(result, "remove", int_remove(26), 0);
+  num_order = 0;
+  burst(1u << 26);
+  check_uint32(result, "removed line", num_order, 0);
+  check_uint32(result, "still pending", (IPR >> 26) & 1, 1);
+
+  teardown();
+}
+
+//----------------------------------------------------------------------------
+// tail-chaining
+//----------------------------------------------------------------------------
+
+static volatile uint32_t t_raise;
+static volatile uint32_t t_chain;
+
+// SPIM1 raises GPIO, which becomes pending while the dispatcher runs
+static void raise_gpio(void* arg) {
+  t_raise = TIRA;
+  ISP = 1u << GPIO_EVENT;
+}
+
+static void chained(void* arg) {
+  t_chain = TIRA;
+}
+
+void check_chain(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t base, single, gap;
+
+  setup();
+  start();
+
+  base   = burst(0);
+  single = burst(1u << 27) - base;
+
+  int_add(27, raise_gpio, 0);
+  int_add(GPIO_EVENT, chained, 0);
+
+  t_chain = 0;
+  burst(1u << 27);
+  gap = t_chain - t_raise;
+
+  stop();
+  teardown();
+
+  if (t_chain == 0) {
+    printf("GPIO handler not called\n");
+    result->errors++;
+    return;
+  }
+
+  printf("one interrupt %d cycles, raised to chained handler %d cycles\n", single, gap);
+
+  // a new entry would need the full exit and entry of the stub
+  if (gap >= single) {
+    printf("Not chained\n");
+    result->errors++;
+  }
+}
+
+//----------------------------------------------------------------------------
+// bursts
+//----------------------------------------------------------------------------
+
+void check_burst(testresult_t *result, void (*start)(), void (*stop)()) {
+  uint32_t direct[NUM_LINES + 1]   = { 0 };
+  uint32_t dispatch[NUM_LINES + 1] = { 0 };
+  int      bursts[NUM_LINES + 1]   = { 0 };
+  uint32_t lfsr = 0xACE1, base;
+  int i, j, set, n, total = 0;
+
+  setup();
+  start();
+
+  base = burst(0);
+
+  for (i = 0; i < NUM_BURSTS; i++) {
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+    set  = lfsr % 7 + 1;
+
+    for (j = 0, n = 0; j < NUM_LINES; j++)
+      n += (set >> j) & 1;
+
+    direct[n]   += burst(lines(direct_irqs, set)) - base;
+    dispatch[n] += burst(lines(dispatch_irqs, set)) - base;
+    bursts[n]++;
+    total += n;
+  }
+
+  stop();
+  teardown();
+
+  printf("lines  bursts  own handlers  dispatcher  (cycles per burst)\n");
+  for (n = 1; n <= NUM_LINES; n++) {
+    if (bursts[n] == 0)
+      continue;
+
+    printf("%5d  %6d  %12d  %10d\n", n, bursts[n],
+           direct[n] / bursts[n], dispatch[n] / bursts[n]);
+  }
+
+  for (j = 0, n = 0, i = 0; j < NUM_LINES; j++) {
+    n += hits[direct_irqs[j]];
+    i += hits[dispatch_irqs[j]];
+  }
+  check_uint32(result, "own handler calls", n, total);
+  check_uint32(result, "dispatched calls",  i, total);
+
+  for (n = 2; n <= NUM_LINES; n++) {
+    if (bursts[n] != 0 && dispatch[n] >= direct[n]) {
+      printf("Dispatcher not faster for bursts of %d\n", n);
+      result->errors++;
+    }
+  }
+}
@@ -0,0 +1,197 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Measures the interrupt entry and exit cost of the crt0 stub and of two
+// generated stubs: one that skips the hardware loops and one that only saves
+// what a small leaf handler uses. All three handlers are the same and are
+// raised through the set pending register. Also checks that the interrupted
+// code gets all its registers back.
+
+#include <stdio.h>
+#include "bench.h"
+#include "timer.h"
+#include "event.h"
+#include "int.h"
+
+#define IRQ_FULL    TIMER_B_OVERFLOW    // crt0 stub
+#define IRQ_CALLER  TIMER_B_OUTPUT_CMP  // ISR TB_CMP
+#define IRQ_LEAF    26                  // ISR SPIM0:a0-a5
+
+#define RUNS 4
+
+void check_timing(testresult_t *result, void (*start)(), void (*stop)());
+void check_regs(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "timing",  .test = check_timing  },
+  { .name = "regs",    .test = check_regs    },
+  {0, 0}
+};
+
+volatile uint32_t t_enter;
+volatile uint32_t t_leave;
+
+int main() {
+  return run_suite(testcases);
+}
+
+#define HANDLER(name, irq)  \
+  void name(void) {         \
+    t_enter = TIRA;         \
+    ICP = 1u << (irq);      \
+    t_leave = TIRA;         \
+  }
+
+HANDLER(ISR_TB_OVF, IRQ_FULL)
+HANDLER(ISR_TB_CMP, IRQ_CALLER)
+HANDLER(ISR_SPIM0,  IRQ_LEAF)
+
+#define WAIT_IRQ "nop\n nop\n nop\n nop\n nop\n nop\n nop\n nop\n"
+
+//----------------------------------------------------------------------------
+// timing
+//----------------------------------------------------------------------------
+
+// cycles from the trigger to the handler and from the handler back to the
+// interrupted code, best of a few runs
+static uint32_t measure(int irq, uint32_t* entry, uint32_t* leave) {
+  uint32_t t0, t1, base, best = ~0u;
+  int i;
+
+  for (i = 0; i < RUNS; i++) {
+    // the same code without an interrupt
+    t0 = TIRA;
+    ISP = 0;
+    asm volatile (WAIT_IRQ);
+    t1 = TIRA;
+    base = t1 - t0;
+
+    t_enter = 0;
+    t0 = TIRA;
+    ISP = 1u << irq;
+    asm volatile (WAIT_IRQ);
+    t1 = TIRA;
+
+    if (t_enter == 0)
+      return 0;
+
+    if (t1 - t0 - base < best) {
+      best   = t1 - t0 - base;
+      *entry = t_enter - t0;
+      *leave = t1 - t_leave;
+    }
+  }
+
+  return best;
+}
+
+void check_timing(testresult_t *result, void (*start)(), void (*stop)()) {
+  static const char* names[3] = { "crt0", "caller", "leaf" };
+  static const int   irqs[3]  = { IRQ_FULL, IRQ_CALLER, IRQ_LEAF };
+  uint32_t total[3], entry, leave;
+  int i;
+
+  start();
+  ECP = 0xFFFFFFFF;
+  ICP = 0xFFFFFFFF;
+  IER = (1u << IRQ_FULL) | (1u << IRQ_CALLER) | (1u << IRQ_LEAF);
+  int_enable();
+
+  for (i = 0; i < 3; i++) {
+    total[i] = measure(irqs[i], &entry, &leave);
+
+    if (total[i] == 0) {
+      printf("%s: handler not called\n", names[i]);
+      result->errors++;
+      continue;
+    }
+
+    printf("%-6s stub: entry %3d, exit %3d, %3d cycles added to the interrupted code\n",
+           names[i], entry, leave, total[i]);
+  }
+
+  int_disable();
+  IER = 0;
+  stop();
+
+  if (!(total[2] < total[1] && total[1] < total[0])) {
+    printf("Smaller stubs are not faster\n");
+    result->errors++;
+  }
+}
+
+//----------------------------------------------------------------------------
+// registers
+//----------------------------------------------------------------------------
+
+#ifdef RV32E
+#define NUM_REGS 9
+#else
+#define NUM_REGS 15
+#endif
+
+// fills every caller-saved register, raises the interrupt and stores the
+// registers in the order t0-t2, a0-a7, t3-t6
+static int regs_intact(int irq) {
+  static const uint8_t regs[15] = { 5, 6, 7, 10, 11, 12, 13, 14, 15, 16, 17, 28, 29, 30, 31 };
+  uint32_t out[NUM_REGS];
+  int i, errors = 0;
+
+  asm volatile (
+    "li t0, 0x105\n li t1, 0x106\n li t2, 0x107\n"
+    "li a0, 0x10A\n li a1, 0x10B\n li a2, 0x10C\n li a3, 0x10D\n li a4, 0x10E\n li a5, 0x10F\n"
+#ifndef RV32E
+    "li a6, 0x110\n li a7, 0x111\n"
+    "li t3, 0x11C\n li t4, 0x11D\n li t5, 0x11E\n li t6, 0x11F\n"
+#endif
+    "sw %[bit], 0(%[isp])\n"
+    WAIT_IRQ
+    "sw t0, 0x00(%[out])\n sw t1, 0x04(%[out])\n sw t2, 0x08(%[out])\n"
+    "sw a0, 0x0C(%[out])\n sw a1, 0x10(%[out])\n sw a2, 0x14(%[out])\n"
+    "sw a3, 0x18(%[out])\n sw a4, 0x1C(%[out])\n sw a5, 0x20(%[out])\n"
+#ifndef RV32E
+    "sw a6, 0x24(%[out])\n sw a7, 0x28(%[out])\n"
+    "sw t3, 0x2C(%[out])\n sw t4, 0x30(%[out])\n sw t5, 0x34(%[out])\n sw t6, 0x38(%[out])\n"
+#endif
+    : : [isp] "r" (&ISP), [bit] "r" (1u << irq), [out] "r" (out)
+    : "t0", "t1", "t2", "a0", "a1", "a2", "a3", "a4", "a5",
+#ifndef RV32E
+      "a6", "a7", "t3", "t4", "t5", "t6",
+#endif
+      "memory");
+
+  for (i = 0; i < NUM_REGS; i++) {
+    if (out[i] != 0x100u + regs[i]) {
+      printf("x%d: %x after the interrupt\n", regs[i], out[i]);
+      errors++;
+    }
+  }
+
+  return errors;
+}
+
+void check_regs(testresult_t *result, void (*start)(), void (*stop)()) {
+  ICP = 0xFFFFFFFF;
+  IER = (1u << IRQ_FULL) | (1u << IRQ_CALLER) | (1u << IRQ_LEAF);
+  int_enable();
+
+  t_enter = 0;
+  result->errors += regs_intact(IRQ_FULL);
+  result->errors += regs_intact(IRQ_CALLER);
+  result->errors += regs_intact(IRQ_LEAF);
+
+  int_disable();
+  IER = 0;
+
+  if (t_enter == 0) {
+    printf("No interrupt was taken\n");
+    result->errors++;
+  }
+}
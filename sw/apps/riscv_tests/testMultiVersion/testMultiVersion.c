@@ -0,0 +1,175 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the feature probe of cpu_features.c and the multiversioned CMSIS
+// kernels of riscv_mv.h. Every variant the core supports is selected in turn
+// and its results are compared with the plain versions, the floating point
+// kernels have to match bit for bit.
+
+#include <stdio.h>
+#include "bench.h"
+#include "cpu_features.h"
+#include "riscv_mv.h"
+
+#define N     37    // odd, so the unrolled loops have a tail
+#define TAPS  8
+#define BLOCK 16
+
+void check_features(testresult_t *result, void (*start)(), void (*stop)());
+void check_kernels(testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "features", .test = check_features },
+  { .name = "kernels",  .test = check_kernels  },
+  {0, 0}
+};
+
+int main() {
+  return run_suite(testcases);
+}
+
+//----------------------------------------------------------------------------
+// probe
+//----------------------------------------------------------------------------
+
+void check_features(testresult_t *result, void (*start)(), void (*stop)()) {
+  unsigned int feat = cpu_features();
+  unsigned int need = 0;
+
+#ifdef IMAGE_M
+  need |= CPU_FEAT_M;
+#endif
+#ifdef IMAGE_XPULP
+  need |= CPU_FEAT_XPULP;
+#endif
+#ifdef IMAGE_F
+  need |= CPU_FEAT_F;
+#endif
+
+  printf("features %X, variants %X\n", feat, riscv_mv_variants);
+
+  check_uint32(result, "image", feat & need, need);
+  check_uint32(result, "cached", cpu_features(), feat);
+
+  // the constructor selected from the probe, never more than it found
+  check_uint32(result, "variants", riscv_mv_variants & ~feat, 0);
+  check_uint32(result, "select", riscv_mv_select(feat), riscv_mv_variants);
+  check_uint32(result, "plain", riscv_mv_select(0), 0);
+  check_uint32(result, "plain table", (uint32_t)riscv_mv.dot_prod_q15,
+               (uint32_t)riscv_dot_prod_q15_base);
+
+  riscv_mv_select(feat);
+}
+
+//----------------------------------------------------------------------------
+// kernels
+//----------------------------------------------------------------------------
+
+static q7_t      a7[N], b7[N];
+static q15_t     a15[N], b15[N], d15[N], r15[N];
+static q15_t     coeffs[TAPS], state[TAPS + BLOCK - 1];
+static float32_t af[N], bf[N], df[N], rf[N];
+
+static void fill(void) {
+  uint32_t x = 12345;
+  int i;
+
+  for (i = 0; i < N; i++) {
+    x = x * 1103515245 + 12345;
+    a15[i] = x >> 16;
+    a7[i]  = x >> 24;
+    af[i]  = (float32_t)(int16_t)(x >> 16) / 1024.0f;
+
+    x = x * 1103515245 + 12345;
+    b15[i] = x >> 16;
+    b7[i]  = x >> 24;
+    bf[i]  = (float32_t)(int16_t)(x >> 16) / 1024.0f;
+  }
+
+  // saturate some of the sums
+  a15[0] = b15[0] = 0x7FFF;
+  a15[1] = b15[1] = 0x8000;
+
+  for (i = 0; i < TAPS; i++)
+    coeffs[i] = a15[i] >> 2;
+}
+
+static uint32_t word(float32_t f) {
+  union { float32_t f; uint32_t u; } v;
+  v.f = f;
+  return v.u;
+}
+
+static void compare(testresult_t *result, const char* variant) {
+  riscv_fir_instance_q15 fir;
+  q31_t dot7, ref7;
+  q63_t dot15, ref15;
+  float32_t dotf, reff;
+  int i;
+
+  riscv_mv.dot_prod_q7(a7, b7, N, &dot7);
+  riscv_dot_prod_q7_base(a7, b7, N, &ref7);
+  check_uint32(result, variant, dot7, ref7);
+
+  riscv_mv.dot_prod_q15(a15, b15, N, &dot15);
+  riscv_dot_prod_q15_base(a15, b15, N, &ref15);
+  check_uint32(result, variant, (uint32_t)dot15, (uint32_t)ref15);
+  check_uint32(result, variant, (uint32_t)(dot15 >> 32), (uint32_t)(ref15 >> 32));
+
+  riscv_mv.mult_q15(a15, b15, d15, N);
+  riscv_mult_q15_base(a15, b15, r15, N);
+  for (i = 0; i < N; i++)
+    check_uint32(result, variant, d15[i], r15[i]);
+
+  riscv_mv.add_q15(a15, b15, d15, N);
+  riscv_add_q15_base(a15, b15, r15, N);
+  for (i = 0; i < N; i++)
+    check_uint32(result, variant, d15[i], r15[i]);
+
+  riscv_fir_init_q15(&fir, TAPS, coeffs, state, BLOCK);
+  riscv_mv.fir_q15(&fir, a15, d15, BLOCK);
+  riscv_fir_init_q15(&fir, TAPS, coeffs, state, BLOCK);
+  riscv_fir_q15_base(&fir, a15, r15, BLOCK);
+  for (i = 0; i < BLOCK; i++)
+    check_uint32(result, variant, d15[i], r15[i]);
+
+  riscv_mv.dot_prod_f32(af, bf, N, &dotf);
+  riscv_dot_prod_f32_base(af, bf, N, &reff);
+  check_uint32(result, variant, word(dotf), word(reff));
+
+  riscv_mv.mult_f32(af, bf, df, N);
+  riscv_mult_f32_base(af, bf, rf, N);
+  for (i = 0; i < N; i++)
+    check_uint32(result, variant, word(df[i]), word(rf[i]));
+
+  riscv_mv.add_f32(af, bf, df, N);
+  riscv_add_f32_base(af, bf, rf, N);
+  for (i = 0; i < N; i++)
+    check_uint32(result, variant, word(df[i]), word(rf[i]));
+}
+
+void check_kernels(testresult_t *result, void (*start)(), void (*stop)()) {
+  unsigned int feat = cpu_features();
+
+  fill();
+
+  start();
+
+  if (riscv_mv_select(feat & RISCV_MV_XPULP) & RISCV_MV_XPULP)
+    compare(result, "xpulp");
+
+  if (riscv_mv_select(feat & RISCV_MV_FPU) & RISCV_MV_FPU)
+    compare(result, "fpu");
+
+  riscv_mv_select(feat);
+  compare(result, "selected");
+
+  stop();
+}
@@ -0,0 +1,131 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Median filters a noisy signal with spikes, compared against sorting every
+// window with insertion sort.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "running_median.h"
+
+#define N      1024
+#define W_MAX  63
+
+static int16_t  in[N]              __attribute__ ((section(".heapsram")));
+static int16_t  out[N]             __attribute__ ((section(".heapsram")));
+static int16_t  ref[N]             __attribute__ ((section(".heapsram")));
+static int16_t  window[W_MAX]      __attribute__ ((section(".heapsram")));
+static uint32_t mem[2 * W_MAX + 2] __attribute__ ((section(".heapsram")));
+
+void check_naive_w15 (testresult_t *result, void (*start)(), void (*stop)());
+void check_rmed_w15  (testresult_t *result, void (*start)(), void (*stop)());
+void check_rmed_w16  (testresult_t *result, void (*start)(), void (*stop)());
+void check_rmed_w63  (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "naive_w15", .test = check_naive_w15 },
+  { .name = "rmed_w15",  .test = check_rmed_w15  },
+  { .name = "rmed_w16",  .test = check_rmed_w16  },
+  { .name = "rmed_w63",  .test = check_rmed_w63  },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// a slow ramp with noise and one spike in every 16 samples
+static void init_signal(void)
+{
+  uint32_t x = 0xBEEF;
+  int      i;
+
+  for (i = 0; i < N; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    in[i] = 4 * i - 2000 + (int)(x % 64) - 32;
+
+    if ((x >> 8) % 16 == 0)
+      in[i] += (x & 0x10000) ? 20000 : -20000;
+  }
+}
+
+// median of the last w samples, sorting the window every time
+static void naive(int w)
+{
+  int i, j, k, m;
+  int16_t v;
+
+  for (i = 0; i < N; i++) {
+    m = i + 1 < w ? i + 1 : w;
+
+    for (j = 0; j < m; j++) {
+      v = in[i - j];
+      for (k = j; k > 0 && window[k - 1] > v; k--)
+        window[k] = window[k - 1];
+      window[k] = v;
+    }
+
+    if (m & 1)
+      ref[i] = window[m / 2];
+    else
+      ref[i] = (window[m / 2 - 1] + window[m / 2]) >> 1;
+  }
+}
+
+static void check_rmed(testresult_t *result, void (*start)(), void (*stop)(), int w)
+{
+  int i;
+
+  init_signal();
+  naive(w);
+
+  if (rmed_size(w) > sizeof(mem)) {
+    printf("Window does not fit\n");
+    result->errors++;
+    return;
+  }
+
+  stack_paint();
+  start();
+  rmed_filter_i16(in, out, N, w, mem);
+  stop();
+  printf("rmed_filter_i16: %d bytes of stack\n", stack_used());
+
+  for (i = 0; i < N; i++) {
+    if (out[i] != ref[i]) {
+      printf("Sample %d: %d, expected %d\n", i, out[i], ref[i]);
+      result->errors++;
+      return;
+    }
+  }
+}
+
+void check_naive_w15(testresult_t *result, void (*start)(), void (*stop)()) {
+  init_signal();
+
+  start();
+  naive(15);
+  stop();
+}
+
+void check_rmed_w15(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_rmed(result, start, stop, 15);
+}
+
+void check_rmed_w16(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_rmed(result, start, stop, 16);
+}
+
+void check_rmed_w63(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_rmed(result, start, stop, 63);
+}
@@ -0,0 +1,156 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Median and top-k of random arrays, once with the selection routines and
+// once the obvious way by sorting everything, with the stack both need.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "sort.h"
+#include "topk.h"
+
+#define N 1024
+#define K 8
+
+static int32_t     data[N] __attribute__ ((section(".heapsram")));
+static int32_t     ref[N]  __attribute__ ((section(".heapsram")));
+static topk_item_t heap[K] __attribute__ ((section(".heapsram")));
+
+void check_median_sort   (testresult_t *result, void (*start)(), void (*stop)());
+void check_median_select (testresult_t *result, void (*start)(), void (*stop)());
+void check_topk_sort     (testresult_t *result, void (*start)(), void (*stop)());
+void check_topk_heap     (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "median_sort",   .test = check_median_sort   },
+  { .name = "median_select", .test = check_median_select },
+  { .name = "topk_sort",     .test = check_topk_sort     },
+  { .name = "topk_heap",     .test = check_topk_heap     },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// random data and a sorted copy as reference
+static void init_data(void)
+{
+  uint32_t x = 0xCAFE1234;
+  int      i;
+
+  for (i = 0; i < N; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    data[i] = (int32_t)x >> 12;
+    ref[i]  = data[i];
+  }
+
+  radix_sort_i32(ref, N);
+}
+
+void check_median_sort(testresult_t *result, void (*start)(), void (*stop)()) {
+  int32_t m;
+
+  init_data();
+
+  stack_paint();
+  start();
+  intro_sort_i32(data, N);
+  m = data[N / 2];
+  stop();
+  printf("intro_sort_i32: %d bytes of stack\n", stack_used());
+
+  if (m != ref[N / 2]) {
+    printf("Median %d, expected %d\n", m, ref[N / 2]);
+    result->errors++;
+  }
+}
+
+void check_median_select(testresult_t *result, void (*start)(), void (*stop)()) {
+  int32_t m;
+  int     i;
+
+  init_data();
+
+  stack_paint();
+  start();
+  m = select_i32(data, N, N / 2);
+  stop();
+  printf("select_i32: %d bytes of stack\n", stack_used());
+
+  if (m != ref[N / 2]) {
+    printf("Median %d, expected %d\n", m, ref[N / 2]);
+    result->errors++;
+  }
+
+  for (i = 0; i < N; i++) {
+    if ((i < N / 2 && data[i] > m) || (i > N / 2 && data[i] < m)) {
+      printf("Not partitioned at %d\n", i);
+      result->errors++;
+      return;
+    }
+  }
+}
+
+void check_topk_sort(testresult_t *result, void (*start)(), void (*stop)()) {
+  int i;
+
+  init_data();
+
+  start();
+  radix_sort_i32(data, N);
+  stop();
+
+  for (i = 0; i < K; i++) {
+    if (data[N - 1 - i] != ref[N - 1 - i]) {
+      printf("Item %d: %d, expected %d\n", i, data[N - 1 - i], ref[N - 1 - i]);
+      result->errors++;
+    }
+  }
+}
+
+void check_topk_heap(testresult_t *result, void (*start)(), void (*stop)()) {
+  topk_t t;
+  int    i, n;
+
+  init_data();
+
+  stack_paint();
+  start();
+  topk_init(&t, heap, K);
+  topk_push_i32(&t, data, N, 0);
+  n = topk_sort(&t);
+  stop();
+  printf("topk: %d bytes of stack\n", stack_used());
+
+  if (n != K) {
+    printf("%d items, expected %d\n", n, K);
+    result->errors++;
+    return;
+  }
+
+  for (i = 0; i < K; i++) {
+    if (heap[i].value != ref[N - 1 - i] || data[heap[i].index] != heap[i].value) {
+      printf("Item %d: %d at %d, expected %d\n", i, heap[i].value, heap[i].index, ref[N - 1 - i]);
+      result->errors++;
+    }
+  }
+
+  // an empty selection keeps nothing and never touches the heap
+  topk_init(&t, heap, 0);
+  topk_push(&t, 1, 0);
+  if (topk_sort(&t) != 0) {
+    printf("k = 0 kept an item\n");
+    result->errors++;
+  }
+}
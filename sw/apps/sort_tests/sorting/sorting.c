@@ -0,0 +1,181 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Sorts random arrays of every key type with the radix and the introsort
+// variants and reports the stack each of them needs, the cycles are in the
+// timing of the test case.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "sort.h"
+
+#define N 1024
+
+typedef struct {
+  int32_t  key;
+  uint16_t id;
+  uint16_t pad;
+} record_t;
+
+static uint32_t buf[N] __attribute__ ((section(".heapsram")));
+
+void check_radix_u8  (testresult_t *result, void (*start)(), void (*stop)());
+void check_radix_u16 (testresult_t *result, void (*start)(), void (*stop)());
+void check_radix_i16 (testresult_t *result, void (*start)(), void (*stop)());
+void check_radix_u32 (testresult_t *result, void (*start)(), void (*stop)());
+void check_radix_i32 (testresult_t *result, void (*start)(), void (*stop)());
+void check_intro_u16 (testresult_t *result, void (*start)(), void (*stop)());
+void check_intro_i32 (testresult_t *result, void (*start)(), void (*stop)());
+void check_records   (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "radix_u8",   .test = check_radix_u8  },
+  { .name = "radix_u16",  .test = check_radix_u16 },
+  { .name = "radix_i16",  .test = check_radix_i16 },
+  { .name = "radix_u32",  .test = check_radix_u32 },
+  { .name = "radix_i32",  .test = check_radix_i32 },
+  { .name = "intro_u16",  .test = check_intro_u16 },
+  { .name = "intro_i32",  .test = check_intro_i32 },
+  { .name = "records",    .test = check_records   },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+static int32_t key(const void* a, int i, int size, int sign)
+{
+  switch (size) {
+    case 1:  return ((const uint8_t*)a)[i];
+    case 2:  return sign ? ((const int16_t*)a)[i] : ((const uint16_t*)a)[i];
+    default: return ((const int32_t*)a)[i];
+  }
+}
+
+static uint32_t rand_state;
+
+static uint32_t rand32(void)
+{
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 17;
+  rand_state ^= rand_state << 5;
+
+  return rand_state;
+}
+
+// random keys, returns their sum to check that sorting did not lose any
+static uint32_t fill(int n, int size, int sign)
+{
+  uint32_t sum = 0;
+  uint32_t x;
+  int      i;
+
+  rand_state = 0x12345678;
+
+  for (i = 0; i < n; i++) {
+    x = rand32();
+
+    switch (size) {
+      case 1:  ((uint8_t*)buf)[i]  = x; break;
+      case 2:  ((uint16_t*)buf)[i] = x; break;
+      default: buf[i] = x;              break;
+    }
+
+    sum += key(buf, i, size, sign);
+  }
+
+  return sum;
+}
+
+static void check_sorted(testresult_t *result, int n, int size, int sign, uint32_t sum)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    sum -= key(buf, i, size, sign);
+
+    if (i > 0 && (size == 4 && !sign ? buf[i - 1] > buf[i] : key(buf, i - 1, size, sign) > key(buf, i, size, sign))) {
+      printf("Not sorted at %d\n", i);
+      result->errors++;
+      return;
+    }
+  }
+
+  if (sum != 0) {
+    printf("Keys changed\n");
+    result->errors++;
+  }
+}
+
+#define SORT_TEST(name, fn, type, sign)                                          \
+  void check_##name(testresult_t *result, void (*start)(), void (*stop)()) {     \
+    uint32_t sum = fill(N, sizeof(type), sign);                                  \
+                                                                                 \
+    stack_paint();                                                               \
+    start();                                                                     \
+    fn((type*)buf, N);                                                           \
+    stop();                                                                      \
+    printf(#fn ": %d bytes of stack\n", stack_used());                           \
+                                                                                 \
+    check_sorted(result, N, sizeof(type), sign, sum);                            \
+  }
+
+SORT_TEST(radix_u8,  radix_sort_u8,  uint8_t,  0)
+SORT_TEST(radix_u16, radix_sort_u16, uint16_t, 0)
+SORT_TEST(radix_i16, radix_sort_i16, int16_t,  1)
+SORT_TEST(radix_u32, radix_sort_u32, uint32_t, 0)
+SORT_TEST(radix_i32, radix_sort_i32, int32_t,  1)
+SORT_TEST(intro_u16, intro_sort_u16, uint16_t, 0)
+SORT_TEST(intro_i32, intro_sort_i32, int32_t,  1)
+
+static int compare_records(const void* a, const void* b)
+{
+  const record_t* ra = (const record_t*)a;
+  const record_t* rb = (const record_t*)b;
+
+  return (ra->key > rb->key) - (ra->key < rb->key);
+}
+
+void check_records(testresult_t *result, void (*start)(), void (*stop)()) {
+  record_t* r = (record_t*)buf;
+  uint32_t  ids = 0;
+  int       i;
+
+  // few distinct keys, many duplicates
+  rand_state = 0x12345678;
+  for (i = 0; i < N / 2; i++) {
+    r[i].key = (int32_t)rand32() >> 28;
+    r[i].id  = i;
+  }
+
+  stack_paint();
+  start();
+  intro_sort(r, N / 2, sizeof(record_t), compare_records);
+  stop();
+  printf("intro_sort: %d bytes of stack\n", stack_used());
+
+  for (i = 0; i < N / 2; i++) {
+    ids ^= r[i].id;
+
+    if (i > 0 && r[i - 1].key > r[i].key) {
+      printf("Not sorted at %d\n", i);
+      result->errors++;
+      return;
+    }
+  }
+
+  // xor of 0..511
+  if (ids != 0) {
+    printf("Records lost\n");
+    result->errors++;
+  }
+}
@@ -0,0 +1,237 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Validates the fixed-point bilateral filter against the results of
+// ml_tests/mlBilat and checks the streaming and grid variants against the
+// direct filter on whole images.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "bilateral.h"
+#include "bilateral_data.h"
+
+#define W  48
+#define H  32
+
+static uint8_t  src[W * H] __attribute__ ((section(".heapsram")));
+static uint8_t  dst[W * H] __attribute__ ((section(".heapsram")));
+static uint8_t  ref[W * H] __attribute__ ((section(".heapsram")));
+static uint8_t  ring[W * (2 * BILAT_MAX_RADIUS + 2)] __attribute__ ((section(".heapsram")));
+static uint32_t grid_mem[1792] __attribute__ ((section(".heapsram")));
+static bilat_t  filter __attribute__ ((section(".heapsram")));
+
+void check_mlbilat (testresult_t *result, void (*start)(), void (*stop)());
+void check_stream  (testresult_t *result, void (*start)(), void (*stop)());
+void check_edge    (testresult_t *result, void (*start)(), void (*stop)());
+void check_radius3 (testresult_t *result, void (*start)(), void (*stop)());
+void check_radius7 (testresult_t *result, void (*start)(), void (*stop)());
+void check_grid    (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "mlbilat",  .test = check_mlbilat },
+  { .name = "stream",   .test = check_stream  },
+  { .name = "edge",     .test = check_edge    },
+  { .name = "radius3",  .test = check_radius3 },
+  { .name = "radius7",  .test = check_radius7 },
+  { .name = "grid",     .test = check_grid    },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// two flat regions with a vertical edge, a gentle ramp and noise
+static void init_image(void)
+{
+  unsigned int seed = 12345;
+  int x, y;
+
+  for (y = 0; y < H; y++) {
+    for (x = 0; x < W; x++) {
+      seed = seed * 1103515245 + 12345;
+      src[y * W + x] = (x < W / 2 ? 60 : 180) + y + (int)((seed >> 24) % 21) - 10;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mlBilat
+////////////////////////////////////////////////////////////////////////////////
+
+// mlBilat uses a 7x7 window, sigma_s = 1 and sigma_r = 0.05 on images in
+// [0, 1]. Its generated code clamps the distance of neighbours after the
+// centre pixel to zero (an unsigned underflow guard), so their spatial
+// weight is 1. The same weights are set up here, sum and variance then agree
+// up to the quantization of the 8 bit images.
+void check_mlbilat(testresult_t *result, void (*start)(), void (*stop)()) {
+  const int n = BILAT_IMAGE_DIM * BILAT_IMAGE_DIM;
+  uint16_t  wx[7];
+  int       i, k, sum, diff;
+  int64_t   sq, var, golden;
+
+  bilat_init(&filter, 3, 256, 3264);   // sigma_r = 0.05 * 255 in Q8
+
+  for (i = 0; i < 7; i++)
+    wx[i] = i <= 3 ? filter.wx[i] : 0xFFFF;
+
+  bilat_set_weights(&filter, 3, wx, wx, filter.wr);
+
+  for (k = 0; k < BILAT_NUM_IMAGES; k++) {
+    bilat_u8(&filter, mlbilat_images[k], dst, BILAT_IMAGE_DIM, BILAT_IMAGE_DIM);
+
+    sum = 0;
+    sq  = 0;
+    for (i = 0; i < n; i++) {
+      sum += dst[i];
+      sq  += dst[i] * dst[i];
+    }
+
+    // variance * n * (n - 1), compared in hundredths with 2% tolerance
+    var    = 100 * (n * sq - (int64_t)sum * sum);
+    golden = (int64_t)mlbilat_var[k] * n * (n - 1);
+    diff   = sum - mlbilat_sum[k];
+
+    if (diff < -16 || diff > 16) {
+      printf("Image %d: sum %d, expected %d\n", k, sum, mlbilat_sum[k]);
+      result->errors++;
+    }
+
+    if ((var > golden ? var - golden : golden - var) * 50 > golden) {
+      printf("Image %d: variance %d, expected %d\n", k,
+             (int)(var / (n * (n - 1))), mlbilat_var[k]);
+      result->errors++;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// direct filter
+////////////////////////////////////////////////////////////////////////////////
+
+static void store_row(void* ctx, int y, const uint8_t* row)
+{
+  memcpy((uint8_t*)ctx + y * W, row, W);
+}
+
+void check_stream(testresult_t *result, void (*start)(), void (*stop)()) {
+  bilat_stage_t stage;
+  int           i, y, frame;
+
+  init_image();
+  bilat_init(&filter, 4, 2 * 256, 20 * 256);
+  bilat_u8(&filter, src, ref, W, H);
+
+  bilat_stage_init(&stage, &filter, W, ring, store_row, dst);
+
+  // two frames through the same stage
+  for (frame = 0; frame < 2; frame++) {
+    for (i = 0; i < W * H; i++)
+      dst[i] = 0;
+
+    for (y = 0; y < H; y++)
+      bilat_push(&stage, src + y * W);
+    bilat_flush(&stage);
+
+    for (i = 0; i < W * H; i++) {
+      if (dst[i] != ref[i]) {
+        printf("Frame %d: pixel %d is %d, expected %d\n", frame, i, dst[i], ref[i]);
+        result->errors++;
+        break;
+      }
+    }
+  }
+}
+
+// without noise and with a small range sigma the edge has to stay sharp and
+// the flat regions must not change
+void check_edge(testresult_t *result, void (*start)(), void (*stop)()) {
+  int x, y;
+
+  for (y = 0; y < H; y++)
+    for (x = 0; x < W; x++)
+      src[y * W + x] = x < W / 2 ? 40 : 200;
+
+  bilat_init(&filter, 5, 3 * 256, 10 * 256);
+  bilat_u8(&filter, src, dst, W, H);
+
+  for (x = 0; x < W * H; x++) {
+    if (dst[x] != src[x]) {
+      printf("Pixel %d is %d, expected %d\n", x, dst[x], src[x]);
+      result->errors++;
+      break;
+    }
+  }
+}
+
+static void time_direct(testresult_t *result, void (*start)(), void (*stop)(), int radius)
+{
+  int i, sum_in = 0, sum_out = 0;
+
+  init_image();
+  bilat_init(&filter, radius, radius * 128, 20 * 256);
+
+  start();
+  bilat_u8(&filter, src, dst, W, H);
+  stop();
+
+  // smoothing must keep the mean
+  for (i = 0; i < W * H; i++) {
+    sum_in  += src[i];
+    sum_out += dst[i];
+  }
+
+  if (sum_out - sum_in > W * H / 4 || sum_in - sum_out > W * H / 4)
+    result->errors++;
+}
+
+void check_radius3(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_direct(result, start, stop, 3);
+}
+
+void check_radius7(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_direct(result, start, stop, 7);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// grid
+////////////////////////////////////////////////////////////////////////////////
+
+void check_grid(testresult_t *result, void (*start)(), void (*stop)()) {
+  int i, d, total = 0;
+
+  init_image();
+
+  if (bilat_grid_size(W, H, 8, 20) > sizeof(grid_mem)) {
+    printf("Grid does not fit\n");
+    result->errors++;
+    return;
+  }
+
+  bilat_init(&filter, 7, 8 * 256, 20 * 256);
+  bilat_u8(&filter, src, ref, W, H);
+
+  start();
+  bilat_grid_u8(src, dst, W, H, 8, 20, grid_mem);
+  stop();
+
+  // the grid is an approximation, on average it has to be within two grey
+  // levels of the direct filter (the noise in the image is +-10)
+  for (i = 0; i < W * H; i++) {
+    d = dst[i] - ref[i];
+    total += d < 0 ? -d : d;
+  }
+
+  if (total > 2 * W * H) {
+    printf("Mean absolute difference to the direct filter %d/%d\n", total, W * H);
+    result->errors++;
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Input images and golden results of ml_tests/mlBilat. The images are the
+// float images of mlBilat scaled by 255 and rounded, the golden sum and
+// variance are the centres of the mlBilat ranges in grey levels, the variance
+// in hundredths of a grey level squared.
+
+#define BILAT_NUM_IMAGES  4
+#define BILAT_IMAGE_DIM   15
+
+static const uint8_t mlbilat_images[BILAT_NUM_IMAGES][BILAT_IMAGE_DIM * BILAT_IMAGE_DIM] = {
+  {
+     64,  46,  63,  33,  46,  52,  42,  64,  43,  22,  63,  19,  35,  37,  45,
+     44,  60,  53,  41,  56,  45,  53,  51,  45,  76,  33,  42,  43,  56,  42,
+     62,  34,  74,  59,  50,  32,  32,  38,  13,  41,  30,  60,  68,  37,  47,
+     50,  32,  59,  37,  15,  45,  37,  38,  24,  47,  40,  39,  35,  49,  62,
+     25,  50,  40,  39,  53,  44,  40,  57,  40,  39,  69,  32,  38,  58,  64,
+     37,  28,  57,  51,  53,  41,  62,  36,  51,  43,  36,  62,  56,  64,  53,
+     66,  55,  41,  38,  53,  55,  58,  31,  34,  68,  51,  52,  48,  58,  58,
+     61,  52,  45,  46,  37,  23,  65,  60,  49,  60,  86,  68, 112,  79,  81,
+     68,  63,  51,  55,  28,  68,  87,  83,  83,  66,  96,  93, 125, 105,  97,
+     24,  43,  55,  50,  86,  99,  93, 112, 119, 100,  88,  86, 111,  92,  95,
+     46,  57,  42,  95, 108, 100,  92, 107,  71,  83,  96,  83,  98, 114, 105,
+     51,  45, 102, 121,  97, 100, 103,  98, 126,  94,  72,  63, 105, 103, 115,
+     39,  52, 108, 108, 115, 102, 124, 102,  88,  91,  69,  94, 102, 106, 100,
+     76,  78,  91, 103, 120, 115,  79, 102, 114, 110, 111,  94,  91, 108, 131,
+     58,  72,  85, 112, 134,  86,  81,  86, 105, 109, 104,  87,  65, 121, 109
+  },
+  {
+     62,  57,  70,  93, 112, 103, 115, 119,  76,  85,  81,  73,  90,  97, 102,
+     50,  82, 101, 103, 108, 120,  81,  84,  86,  91,  84,  86,  86,  91,  88,
+     31,  77, 114, 128, 105, 115,  92,  97,  91,  87,  66,  80,  90,  90, 123,
+     28,  52, 122, 122, 104, 112, 108, 105, 100,  94,  89,  70,  79, 105, 108,
+     47, 102, 123, 130, 131,  98, 118,  86, 100,  95,  73,  69,  91, 108, 108,
+     62,  92, 105, 122, 177, 114,  93,  74, 110, 113, 101,  80,  66,  76,  93,
+     73, 106, 114, 114, 124, 114, 115, 106, 116,  97, 109,  81,  95,  96,  88,
+     84, 116,  82, 111, 113, 120, 107,  85, 111, 112,  95, 112,  87,  65,  81,
+     75, 119, 126, 126, 107, 102, 104,  93, 110, 122, 105,  94,  92,  99,  83,
+     64, 108, 122, 118, 116, 110, 101, 119, 114, 106, 128,  83,  78,  96,  85,
+     71, 107, 121, 144, 120, 124, 126, 143, 132, 121, 104,  96,  87,  93,  58,
+     98, 104, 125, 129, 125, 107, 144, 194, 154, 119, 116,  91,  77,  68,  92,
+     98, 126, 114, 125, 150, 122, 135, 144, 119, 125, 118,  59,  66,  44,  60,
+     87, 126, 158, 150, 126, 132, 155, 175, 143, 123,  79,  74,  88,  93,  68,
+     41,  96, 129, 128, 113, 153, 153, 158, 141, 112,  74, 104,  65,  71,  77
+  },
+  {
+     79,  83,  79, 144, 118,  99, 142, 186, 145, 136, 120, 105,  82,  79,  67,
+     95, 127, 116, 117, 131, 113, 118, 177, 133, 112, 126,  94,  47,  61,  64,
+    103, 138, 114, 154, 147, 113, 124, 174, 155, 138, 103,  73,  49,  77,  48,
+     80, 137, 118, 127, 129, 144, 145, 165, 164, 112,  52,  64,  69,  71, 100,
+     25,  78, 109,  85, 143, 168, 157, 146, 143, 109,  81,  99,  56,  94,  95,
+     61, 120, 131, 142, 114, 132, 166, 144, 131, 105,  93,  98,  73,  79,  51,
+     98, 130, 144, 141, 112, 128, 175, 138, 134, 103, 109, 124,  86,  88,  78,
+     77, 123, 157, 163, 128, 104, 100, 129, 132,  96, 110, 119,  93,  83,  73,
+     70, 124, 124,  89, 113, 123,  95, 133, 125, 104,  98,  76,  72,  68,  86,
+     42,  98, 122, 110, 115, 121, 130, 125, 160,  93,  70,  64,  79,  70,  75,
+     53,  89, 114, 113, 125, 102, 126, 163, 146, 107,  99,  74,  93,  84,  48,
+     32,  31,  78,  86,  98, 128, 117, 141, 106, 109, 103,  72,  66,  57,  73,
+     36,  46,  49, 109, 106, 107,  84, 119,  88,  92,  64,  69,  57,  52,  55,
+     50,  66,  23,  47,  89,  90,  98,  87, 129,  79,  79,  59,  70,  59,  36,
+     42,  77,  50,  94, 101,  80, 112, 102,  68,  69,  67,  55,  69,  76,  62
+  },
+  {
+     27,  81,  75, 135, 104, 113, 134, 175, 149,  91,  91,  82,  47,  90,  59,
+     55,  68,  85, 103, 123, 120,  99, 118, 149,  90,  75,  74,  70,  67,  56,
+     48,  42,  62, 108,  91, 101, 111, 110, 104, 101,  89,  61,  50,  62,  77,
+     43,  47,  33,  51, 118, 109,  96,  86,  99,  62,  70,  74,  54,  60,  71,
+     65,  55,  43,  80,  82, 122,  95,  88,  95,  79,  84,  63,  85,  71,  55,
+     45,  22,  31,  92,  78,  63, 103,  84,  98,  89,  71,  61,  52,  69,  50,
+     66,  55,  63,  81, 102,  99,  49,  75,  71,  58,  67,  55,  73,  45,  23,
+     68,  42,  29,  54,  75,  74,  44,  59,  61,  78,  45,  42,  41,  65,  25,
+     65, 101, 122, 127,  74,  66,  44,  53,  50,  33,  48,  40,  18,  41,  37,
+    159, 187, 144, 141, 102,  56,  20,  20,  37,  25,  38,  42,  49,  26,  29,
+    202, 190, 191, 160, 136,  87,  25,  28,  37,  46,  38,  63,  16,  32,  55,
+    228, 208, 173, 174, 148,  74,  41,  35,  53,  34,  53,  40,  24,  45,  61,
+    220, 219, 196, 176, 151,  95,  94,  43,  82,  85,  78,  68,  45,  64,  63,
+    229, 228, 205, 204, 157, 152,  89,  59,  90,  84,  73,  54,  49,  44, 108,
+    240, 228, 212, 186, 167, 139, 101, 119, 108,  98, 104,  73,  56,  94, 105
+  }
+};
+
+static const int mlbilat_sum[BILAT_NUM_IMAGES] = { 15488, 23004, 22321, 19075 };
+static const int mlbilat_var[BILAT_NUM_IMAGES] = { 70079, 56595, 100998, 233264 };
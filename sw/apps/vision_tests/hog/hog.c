@@ -0,0 +1,354 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the orientation bins against the gradient directions of
+// ml_tests/mlGradDir and the fused descriptor pipeline against a float
+// implementation that takes the usual three passes over full-size gradient
+// images.
+
+#include <math.h>
+
+#include "bench.h"
+#include "string_lib.h"
+#include "timer.h"
+#include "hog.h"
+#include "hog_data.h"
+
+#define W     64
+#define H     48
+#define CELL  8
+#define NBX   (W / CELL - 1)
+#define NBY   (H / CELL - 1)
+
+// odd height, the last four rows are not part of the descriptor
+#define H2    44
+
+static uint8_t  src[W * H]                     __attribute__ ((section(".heapsram")));
+static uint16_t desc[NBX * NBY * HOG_BLOCK_LEN] __attribute__ ((section(".heapsram")));
+static uint16_t ref[NBX * NBY * HOG_BLOCK_LEN]  __attribute__ ((section(".heapsram")));
+static float    gx[W * H]                      __attribute__ ((section(".heapsram")));
+static float    gy[W * H]                      __attribute__ ((section(".heapsram")));
+static float    hist[(H / CELL) * (W / CELL) * HOG_BINS] __attribute__ ((section(".heapsram")));
+static uint32_t stage_mem[1024]                __attribute__ ((section(".heapsram")));
+
+void check_mlgraddir (testresult_t *result, void (*start)(), void (*stop)());
+void check_desc      (testresult_t *result, void (*start)(), void (*stop)());
+void check_stream    (testresult_t *result, void (*start)(), void (*stop)());
+void check_errors    (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "mlgraddir", .test = check_mlgraddir },
+  { .name = "desc",      .test = check_desc      },
+  { .name = "stream",    .test = check_stream    },
+  { .name = "errors",    .test = check_errors    },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+// a bright disc on a ramp with noise, gradients in every direction
+static void init_image(void)
+{
+  unsigned int seed = 4711;
+  int x, y, dx, dy;
+
+  for (y = 0; y < H; y++) {
+    for (x = 0; x < W; x++) {
+      seed = seed * 1103515245 + 12345;
+      dx   = x - 28;
+      dy   = y - 22;
+
+      src[y * W + x] = 40 + x + y / 2 + (dx * dx + dy * dy < 225 ? 100 : 0)
+                     + (int)((seed >> 24) % 9) - 4;
+    }
+  }
+}
+
+// bin of atan2(gy, gx), unsigned, in 20 degree steps
+static int ref_bin(float fx, float fy)
+{
+  float a = atan2f(fy, fx) * (180.0f / 3.14159265f);
+
+  if (a < 0.0f)
+    a += 180.0f;
+  if (a >= 180.0f)
+    a -= 180.0f;
+
+  return (int)(a / 20.0f) % HOG_BINS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mlGradDir
+////////////////////////////////////////////////////////////////////////////////
+
+// mlGradDir takes atan2 of Sobel gradients of the interior pixels. Its image
+// is column-major, so in the row-major view of the same memory its a is the
+// vertical and its b_a the horizontal gradient. The bins of the 8 bit image
+// may only differ where quantization moves a gradient across a bin border,
+// and then only to the neighbouring bin.
+void check_mlgraddir(testresult_t *result, void (*start)(), void (*stop)()) {
+  const int n = MLGRAD_DIM;
+  uint8_t   img[MLGRAD_DIM * MLGRAD_DIM];
+  uint16_t  mag[MLGRAD_DIM];
+  uint8_t   bin[MLGRAD_DIM];
+  const float* I = mlgrad_image;
+  float     a, b_a;
+  int       x, y, i, k, d, same = 0;
+  int       ix, iy, m, e;
+
+  for (i = 0; i < n * n; i++)
+    img[i] = (uint8_t)(I[i] * 255.0f + 0.5f);
+
+  for (x = 0; x < n - 2; x++) {
+    start();
+    hog_grad_row(img + x * n, img + (x + 1) * n, img + (x + 2) * n, mag, bin, n);
+    stop();
+
+    for (y = 0; y < n - 2; y++) {
+      a   = (I[y+n*(2+x)] - I[y+n*x]) + 2*(I[y+n*(2+x)+1] - I[y+n*x+1]) + I[y+n*(2+x)+2] - I[y+n*x+2];
+      b_a = (I[y+n*x+2] - I[y+n*x]) + 2*(I[y+n*(1+x)+2] - I[y+n*(1+x)]) + I[y+n*(2+x)+2] - I[y+n*(2+x)];
+
+      k = ref_bin(b_a, a);
+      d = bin[y + 1] - k;
+      d = d < 0 ? -d : d;
+
+      if (d == 0)
+        same++;
+      else if (d != 1 && d != HOG_BINS - 1) {
+        printf("Pixel %d,%d: bin %d, expected %d\n", x + 1, y + 1, bin[y + 1], k);
+        result->errors++;
+      }
+
+      // the magnitude approximation against the integer gradient
+      ix = (img[(x+2)*n+y+2] + 2*img[(x+1)*n+y+2] + img[x*n+y+2]) - (img[(x+2)*n+y] + 2*img[(x+1)*n+y] + img[x*n+y]);
+      iy = (img[(x+2)*n+y] + 2*img[(x+2)*n+y+1] + img[(x+2)*n+y+2]) - (img[x*n+y] + 2*img[x*n+y+1] + img[x*n+y+2]);
+      m  = (int)(sqrtf((float)(ix * ix + iy * iy)) + 0.5f);
+      e  = mag[y + 1] - m;
+
+      if (e * 100 > m + 100 || -e * 100 > 3 * m + 100) {
+        printf("Pixel %d,%d: magnitude %d, expected %d\n", x + 1, y + 1, mag[y + 1], m);
+        result->errors++;
+      }
+    }
+  }
+
+  // quantization to 8 bit only moves a small fraction across a border
+  if (same * 10 < 9 * (n - 2) * (n - 2)) {
+    printf("Only %d of %d bins agree\n", same, (n - 2) * (n - 2));
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// descriptors
+////////////////////////////////////////////////////////////////////////////////
+
+// float HOG the usual way, gradient images, then histograms, then blocks
+static void ref_hog(const uint8_t* img, int width, int height, float clip, uint16_t* out)
+{
+  const int ncx = width / CELL, ncy = height / CELL;
+  float     v[HOG_BLOCK_LEN], s;
+  int       x, y, l, r, u, d, i, j, bx, by;
+
+  for (y = 0; y < height; y++) {
+    u = y > 0 ? y - 1 : 0;
+    d = y < height - 1 ? y + 1 : height - 1;
+
+    for (x = 0; x < width; x++) {
+      l = x > 0 ? x - 1 : 0;
+      r = x < width - 1 ? x + 1 : width - 1;
+
+      gx[y * width + x] = (img[u*width+r] + 2*img[y*width+r] + img[d*width+r])
+                        - (img[u*width+l] + 2*img[y*width+l] + img[d*width+l]);
+      gy[y * width + x] = (img[d*width+l] + 2*img[d*width+x] + img[d*width+r])
+                        - (img[u*width+l] + 2*img[u*width+x] + img[u*width+r]);
+    }
+  }
+
+  for (i = 0; i < ncx * ncy * HOG_BINS; i++)
+    hist[i] = 0.0f;
+
+  for (y = 0; y < ncy * CELL; y++) {
+    for (x = 0; x < ncx * CELL; x++) {
+      float fx = gx[y * width + x], fy = gy[y * width + x];
+
+      hist[((y / CELL) * ncx + x / CELL) * HOG_BINS + ref_bin(fx, fy)] += sqrtf(fx * fx + fy * fy);
+    }
+  }
+
+  for (by = 0; by < ncy - 1; by++) {
+    for (bx = 0; bx < ncx - 1; bx++) {
+      for (j = 0; j < 4; j++)
+        for (i = 0; i < HOG_BINS; i++)
+          v[j * HOG_BINS + i] = hist[((by + j / 2) * ncx + bx + j % 2) * HOG_BINS + i];
+
+      s = 0.0f;
+      for (i = 0; i < HOG_BLOCK_LEN; i++)
+        s += v[i] * v[i];
+      s = s > 0.0f ? 1.0f / sqrtf(s) : 0.0f;
+
+      for (i = 0; i < HOG_BLOCK_LEN; i++) {
+        v[i] *= s;
+        if (clip > 0.0f && v[i] > clip)
+          v[i] = clip;
+      }
+
+      if (clip > 0.0f) {
+        s = 0.0f;
+        for (i = 0; i < HOG_BLOCK_LEN; i++)
+          s += v[i] * v[i];
+        s = s > 0.0f ? 1.0f / sqrtf(s) : 0.0f;
+
+        for (i = 0; i < HOG_BLOCK_LEN; i++)
+          v[i] *= s;
+      }
+
+      for (i = 0; i < HOG_BLOCK_LEN; i++)
+        *out++ = (uint16_t)(v[i] * 32767.0f + 0.5f);
+    }
+  }
+}
+
+// the magnitudes are within 3% and a few pixels sit right on a bin border,
+// an element may be off by 0.02, the whole block by 0.08 in L1
+static int compare(const uint16_t* a, const uint16_t* b, int blocks)
+{
+  int i, k, d, sum, errors = 0;
+
+  for (k = 0; k < blocks; k++, a += HOG_BLOCK_LEN, b += HOG_BLOCK_LEN) {
+    sum = 0;
+    for (i = 0; i < HOG_BLOCK_LEN; i++) {
+      d    = a[i] - b[i];
+      d    = d < 0 ? -d : d;
+      sum += d;
+
+      if (d > 655) {
+        printf("Block %d, value %d: %d, expected %d\n", k, i, a[i], b[i]);
+        errors++;
+      }
+    }
+
+    if (sum > 2621) {
+      printf("Block %d: L1 difference %d\n", k, sum);
+      errors++;
+    }
+  }
+
+  return errors;
+}
+
+void check_desc(testresult_t *result, void (*start)(), void (*stop)()) {
+  init_image();
+
+  start();
+  if (hog_u8(src, W, H, CELL, HOG_CLIP_DEFAULT, desc, stage_mem) != 0) {
+    printf("hog_u8 failed\n");
+    result->errors++;
+  }
+  stop();
+
+  printf("%d x %d image: %d cycles\n", W, H, get_time());
+
+  ref_hog(src, W, H, HOG_CLIP_DEFAULT / 32768.0f, ref);
+  result->errors += compare(desc, ref, NBX * NBY);
+
+  // plain L2
+  hog_u8(src, W, H, CELL, 0, desc, stage_mem);
+  ref_hog(src, W, H, 0.0f, ref);
+  result->errors += compare(desc, ref, NBX * NBY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// streaming
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  uint16_t* desc;
+  int       next;
+} sink_ctx_t;
+
+static void store_blocks(void* ctx, int by, const uint16_t* blocks, int nbx)
+{
+  sink_ctx_t* c = (sink_ctx_t*)ctx;
+
+  if (by != c->next++ || nbx != NBX)
+    return;
+
+  memcpy(c->desc + by * NBX * HOG_BLOCK_LEN, blocks, NBX * HOG_BLOCK_LEN * sizeof(uint16_t));
+}
+
+void check_stream(testresult_t *result, void (*start)(), void (*stop)()) {
+  const int   nby = H2 / CELL - 1;
+  hog_stage_t stage;
+  sink_ctx_t  ctx;
+  int         y, frame;
+
+  init_image();
+
+  if (hog_stage_size(W, CELL) > sizeof(stage_mem)) {
+    printf("Stage needs %u bytes\n", hog_stage_size(W, CELL));
+    result->errors++;
+    return;
+  }
+
+  if (hog_desc_len(W, H2, CELL) != (unsigned int)(NBX * nby * HOG_BLOCK_LEN)) {
+    printf("Descriptor length %u\n", hog_desc_len(W, H2, CELL));
+    result->errors++;
+  }
+
+  ref_hog(src, W, H2, HOG_CLIP_DEFAULT / 32768.0f, ref);
+
+  hog_stage_init(&stage, W, CELL, HOG_CLIP_DEFAULT, stage_mem, store_blocks, &ctx);
+
+  // two frames through the same stage
+  for (frame = 0; frame < 2; frame++) {
+    memset(desc, 0, sizeof(desc));
+    ctx.desc = desc;
+    ctx.next = 0;
+
+    for (y = 0; y < H2; y++)
+      hog_push(&stage, src + y * W);
+    hog_flush(&stage);
+
+    if (ctx.next != nby) {
+      printf("Frame %d: %d block rows, expected %d\n", frame, ctx.next, nby);
+      result->errors++;
+    }
+
+    result->errors += compare(desc, ref, NBX * nby);
+  }
+}
+
+void check_errors(testresult_t *result, void (*start)(), void (*stop)()) {
+  hog_stage_t stage;
+
+  if (hog_stage_init(&stage, W, 1, 0, stage_mem, store_blocks, NULL) != -1 ||
+      hog_stage_init(&stage, W, HOG_MAX_CELL + 1, 0, stage_mem, store_blocks, NULL) != -1 ||
+      hog_stage_init(&stage, W - 1, CELL, 0, stage_mem, store_blocks, NULL) != -1 ||
+      hog_stage_init(&stage, CELL, CELL, 0, stage_mem, store_blocks, NULL) != -1) {
+    printf("Invalid stage accepted\n");
+    result->errors++;
+  }
+
+  if (hog_u8(src, W, CELL, CELL, 0, desc, stage_mem) != -1 || hog_desc_len(W, CELL, CELL) != 0) {
+    printf("Image of a single cell row accepted\n");
+    result->errors++;
+  }
+
+  // borders and the degenerate gradient
+  if (hog_bin(0, 0) != 0 || hog_bin(5, 0) != 0 || hog_bin(-5, 0) != 0 ||
+      hog_bin(0, 5) != 4 || hog_bin(0, -5) != 4 || hog_bin(-5, 5) != 6 || hog_bin(5, -5) != 6) {
+    printf("Wrong bins on the axes\n");
+    result->errors++;
+  }
+}
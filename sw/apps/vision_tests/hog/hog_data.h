@@ -0,0 +1,67 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Core 0 image of ml_tests/mlGradDir, 15x15 in [0, 1], stored column-major
+// like in the original.
+
+#ifndef _HOG_DATA_H_
+#define _HOG_DATA_H_
+
+#define MLGRAD_DIM 15
+
+static const float mlgrad_image[MLGRAD_DIM * MLGRAD_DIM] = {
+  0.359744877F, 0.316170543F, 0.452091426F, 0.590570688F, 0.586605608F,
+  0.523489F, 0.543290794F, 0.527328074F, 0.403460801F, 0.340128243F,
+  0.381245792F, 0.430162311F, 0.370461762F, 0.386241138F, 0.460635F,
+  0.397659332F, 0.439033F, 0.49361226F, 0.5713135F, 0.551353872F,
+  0.518490434F, 0.595287681F, 0.575706661F, 0.489569575F, 0.452162802F,
+  0.354395211F, 0.350517482F, 0.431906879F, 0.469007462F, 0.422861725F,
+  0.485689372F, 0.560106874F, 0.610390663F, 0.652361393F, 0.653856158F,
+  0.582974F, 0.586330235F, 0.555162728F, 0.45782578F, 0.4364748F,
+  0.370872647F, 0.381736338F, 0.482002825F, 0.47906971F, 0.398972303F,
+  0.363796562F, 0.455334306F, 0.630435109F, 0.624384105F, 0.573794901F,
+  0.52452004F, 0.532823205F, 0.566253245F, 0.418366224F, 0.349609107F,
+  0.488572806F, 0.553145885F, 0.520911694F, 0.4965927F, 0.506052852F,
+  0.396263123F, 0.41330108F, 0.55020231F, 0.435176253F, 0.389054865F,
+  0.52217716F, 0.5677194F, 0.55913204F, 0.453172117F, 0.451571643F,
+  0.656952083F, 0.682831705F, 0.544549823F, 0.471098244F, 0.507652342F,
+  0.483957887F, 0.454770386F, 0.506471694F, 0.435213953F, 0.478543669F,
+  0.619635642F, 0.572257221F, 0.496709168F, 0.494582832F, 0.589038432F,
+  0.680636406F, 0.63422817F, 0.529280543F, 0.409155846F, 0.434805572F,
+  0.342859298F, 0.363562196F, 0.471913725F, 0.564506829F, 0.647988141F,
+  0.596142F, 0.469343901F, 0.47322458F, 0.544500351F, 0.617706597F,
+  0.613756597F, 0.52458334F, 0.456200749F, 0.404568434F, 0.521409571F,
+  0.363114178F, 0.332937807F, 0.403004974F, 0.513091862F, 0.576681912F,
+  0.53103292F, 0.495874256F, 0.489585876F, 0.535522163F, 0.576668F,
+  0.509309173F, 0.436213583F, 0.37497282F, 0.361125112F, 0.560448289F,
+  0.54013741F, 0.412295043F, 0.378181398F, 0.443167955F, 0.496370703F,
+  0.588582695F, 0.685308337F, 0.566321492F, 0.490579218F, 0.517662585F,
+  0.359675735F, 0.329475611F, 0.426886559F, 0.394490182F, 0.451499969F,
+  0.514234543F, 0.45206666F, 0.391433F, 0.420451313F, 0.463171571F,
+  0.518679261F, 0.592543304F, 0.493731707F, 0.402859479F, 0.396873742F,
+  0.252072304F, 0.30160287F, 0.510372221F, 0.475035042F, 0.38146171F,
+  0.542696834F, 0.511261523F, 0.388022244F, 0.340856284F, 0.344148815F,
+  0.340408713F, 0.357130229F, 0.371940315F, 0.32694611F, 0.281907976F,
+  0.318291426F, 0.407590896F, 0.479242265F, 0.442820489F, 0.372144639F,
+  0.69410032F, 0.543302357F, 0.386832297F, 0.348201215F, 0.332217604F,
+  0.361774981F, 0.411175549F, 0.458728701F, 0.383065581F, 0.313602954F,
+  0.450667173F, 0.501017928F, 0.466678739F, 0.468793094F, 0.439178973F,
+  0.623307228F, 0.392824769F, 0.332589597F, 0.425064027F, 0.414584845F,
+  0.481115401F, 0.566573381F, 0.549564362F, 0.494270921F, 0.431558043F,
+  0.449673921F, 0.449453086F, 0.468458563F, 0.533500731F, 0.499715835F,
+  0.406595886F, 0.267960519F, 0.310223F, 0.451521397F, 0.482406974F,
+  0.552146375F, 0.560343F, 0.521590769F, 0.576864481F, 0.561121762F,
+  0.452559F, 0.370729625F, 0.473906F, 0.638449669F, 0.578358948F,
+  0.291010827F, 0.27395764F, 0.357628703F, 0.420415282F, 0.461061984F,
+  0.493391424F, 0.464707464F, 0.521313369F, 0.645002484F, 0.651789427F,
+  0.544826925F, 0.439479858F, 0.504653394F, 0.631796896F, 0.599138856F
+};
+
+#endif
@@ -0,0 +1,389 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the projection against ml_tests/mlHom, the minimal solver against a
+// known homography and both RANSAC drivers on correspondences with 30%
+// outliers. The scoring kernels are timed separately, they are where RANSAC
+// spends its time.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "homography.h"
+#include "homography_data.h"
+
+#define N       100
+#define THRESH  2.0f
+
+// Q4 pixel coordinates of a 320x240 image normalized by 4096
+#define Q_CX     (160 * 16)
+#define Q_CY     (120 * 16)
+#define Q_SHIFT  12
+
+static hom_pt_t  src[N]     __attribute__ ((section(".heapsram")));
+static hom_pt_t  dst[N]     __attribute__ ((section(".heapsram")));
+static hom_ptq_t src_q[N]   __attribute__ ((section(".heapsram")));
+static hom_ptq_t dst_q[N]   __attribute__ ((section(".heapsram")));
+static uint8_t   mask[N]    __attribute__ ((section(".heapsram")));
+static uint8_t   outlier[N] __attribute__ ((section(".heapsram")));
+
+static const float h_true[9] = {
+  1.02f,   -0.05f,    6.0f,
+  0.04f,    0.98f,   -4.0f,
+  1.0e-4f, -5.0e-5f,  1.0f
+};
+
+void check_mlhom      (testresult_t *result, void (*start)(), void (*stop)());
+void check_solve4     (testresult_t *result, void (*start)(), void (*stop)());
+void check_iterations (testresult_t *result, void (*start)(), void (*stop)());
+void check_ransac     (testresult_t *result, void (*start)(), void (*stop)());
+void check_ransac_q15 (testresult_t *result, void (*start)(), void (*stop)());
+void check_score      (testresult_t *result, void (*start)(), void (*stop)());
+void check_score_q15  (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "mlhom",      .test = check_mlhom      },
+  { .name = "solve4",     .test = check_solve4     },
+  { .name = "iterations", .test = check_iterations },
+  { .name = "ransac",     .test = check_ransac     },
+  { .name = "ransac_q15", .test = check_ransac_q15 },
+  { .name = "score",      .test = check_score      },
+  { .name = "score_q15",  .test = check_score_q15  },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+static float absf(float x)
+{
+  return x < 0.0f ? -x : x;
+}
+
+// random points in a 320x240 image mapped by h_true with up to a quarter
+// pixel of noise, three in ten are replaced by random points
+static void init_points(void)
+{
+  unsigned int seed = 4711;
+  int i;
+
+  for (i = 0; i < N; i++) {
+    seed = seed * 1103515245 + 12345;
+    src[i].x = (seed >> 8) % 3200 * 0.1f;
+    seed = seed * 1103515245 + 12345;
+    src[i].y = (seed >> 8) % 2400 * 0.1f;
+  }
+
+  hom_project(h_true, src, dst, N);
+
+  for (i = 0; i < N; i++) {
+    outlier[i] = i % 10 < 3;
+
+    seed = seed * 1103515245 + 12345;
+    if (outlier[i]) {
+      dst[i].x = (seed >> 8) % 3200 * 0.1f;
+      seed = seed * 1103515245 + 12345;
+      dst[i].y = (seed >> 8) % 2400 * 0.1f;
+    } else {
+      dst[i].x += ((int)((seed >> 8) % 51) - 25) * 0.01f;
+      seed = seed * 1103515245 + 12345;
+      dst[i].y += ((int)((seed >> 8) % 51) - 25) * 0.01f;
+    }
+  }
+}
+
+static void init_points_q15(void)
+{
+  int i;
+
+  for (i = 0; i < N; i++) {
+    src_q[i].x = (int)(src[i].x * 16.0f + 0.5f);
+    src_q[i].y = (int)(src[i].y * 16.0f + 0.5f);
+    dst_q[i].x = (int)(dst[i].x * 16.0f + 0.5f);
+    dst_q[i].y = (int)(dst[i].y * 16.0f + 0.5f);
+  }
+
+  hom_normalize_q15(src_q, N, Q_CX, Q_CY, Q_SHIFT);
+  hom_normalize_q15(dst_q, N, Q_CX, Q_CY, Q_SHIFT);
+}
+
+// the inlier mask has to match the generated outliers, except for outliers
+// that happen to land close to their true position and, for homographies fit
+// to four noisy points, inliers far from the sample
+static int check_mask(int inliers, int max_missed)
+{
+  int i, missed = 0, wrong = 0;
+
+  for (i = 0; i < N; i++) {
+    missed += !outlier[i] && !mask[i];
+    wrong  += outlier[i] && mask[i];
+  }
+
+  if (missed > max_missed || wrong > 2) {
+    printf("%d inliers, %d true inliers missed, %d outliers accepted\n", inliers, missed, wrong);
+    return 1;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mlHom
+////////////////////////////////////////////////////////////////////////////////
+
+void check_mlhom(testresult_t *result, void (*start)(), void (*stop)()) {
+  hom_pt_t out[MLHOM_POINTS];
+  float    h[9], stat[4], mean;
+  int      i, j;
+
+  // mlHom stores the matrix column by column
+  for (j = 0; j < 3; j++)
+    for (i = 0; i < 3; i++)
+      h[3 * j + i] = mlhom_h[j + 3 * i];
+
+  start();
+  hom_project(h, (const hom_pt_t*)mlhom_points, out, MLHOM_POINTS);
+  stop();
+
+  stat[0] = out[0].x;
+  stat[1] = out[0].y;
+  for (i = 1; i < MLHOM_POINTS; i++) {
+    stat[0] += out[i].x;
+    stat[1] += out[i].y;
+  }
+
+  for (j = 0; j < 2; j++) {
+    mean        = stat[j] * (1.0f / MLHOM_POINTS);
+    stat[2 + j] = 0.0f;
+    for (i = 0; i < MLHOM_POINTS; i++) {
+      float r = (j ? out[i].y : out[i].x) - mean;
+      stat[2 + j] += r * r;
+    }
+    stat[2 + j] *= 1.0f / (MLHOM_POINTS - 1);
+  }
+
+  for (i = 0; i < 4; i++) {
+    if (stat[i] > mlhom_golden[2 * i] || stat[i] < mlhom_golden[2 * i + 1]) {
+      printf("Statistic %d out of bounds: %d, expected %d (x 1e6)\n", i,
+             (int)(stat[i] * 1e6f), (int)(mlhom_golden[2 * i] * 1e6f));
+      result->errors++;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// solver
+////////////////////////////////////////////////////////////////////////////////
+
+void check_solve4(testresult_t *result, void (*start)(), void (*stop)()) {
+  static const int corners[4] = {0, 1, 2, 3};
+  static const int line[4]    = {0, 1, 2, 4};
+  hom_pt_t a[5] = {{10.0f, 20.0f}, {300.0f, 15.0f}, {310.0f, 230.0f}, {5.0f, 220.0f}, {20.0f, 20.0f}};
+  hom_pt_t b[5];
+  float    h[9];
+  int16_t  hq[9];
+  int      i;
+
+  hom_project(h_true, a, b, 5);
+
+  start();
+  if (hom_solve4(a, b, corners, h) != 0) {
+    printf("Solver failed\n");
+    result->errors++;
+  }
+  stop();
+
+  for (i = 0; i < 9; i++) {
+    // the perspective terms are small, compare them at their scale
+    float tol = i < 6 ? 1e-3f * (absf(h_true[i]) + 1.0f) : 1e-7f;
+
+    if (absf(h[i] - h_true[i]) > tol) {
+      printf("h[%d]: %d, expected %d (x 1e6)\n", i, (int)(h[i] * 1e6f), (int)(h_true[i] * 1e6f));
+      result->errors++;
+    }
+  }
+
+  // a[4] halfway between a[0] and a[1]
+  a[4] = (hom_pt_t){155.0f, 17.5f};
+  if (hom_solve4(a, b, line, h) == 0) {
+    printf("Collinear sample not rejected\n");
+    result->errors++;
+  }
+
+  // the same sample mirrored in the destination
+  for (i = 0; i < 4; i++)
+    b[i].x = -b[i].x;
+  if (hom_solve4(a, b, corners, h) == 0) {
+    printf("Mirrored sample not rejected\n");
+    result->errors++;
+  }
+
+  // fixed point, the sample is the corners of the normalized square
+  {
+    hom_ptq_t p[4] = {{-16384, -16384}, {16384, -16384}, {16384, 16384}, {-16384, 16384}};
+    hom_ptq_t q[4] = {{-16384, -16384}, {16384, -16384}, {16384, 16384}, {-16384, 16384}};
+
+    q[2].x = 18432;
+    if (hom_solve4_q15(p, q, corners, hq) != 0) {
+      printf("Fixed-point solver failed\n");
+      result->errors++;
+    } else if (hom_score_q15(hq, p, q, 4, 16, 4) != 4) {
+      printf("Fixed-point solution does not map its own sample\n");
+      result->errors++;
+    }
+  }
+}
+
+void check_iterations(testresult_t *result, void (*start)(), void (*stop)()) {
+  // log(1 - 0.99) / log(1 - w^4) for w = 0.5, 0.7, 0.9
+  static const int w[3]        = {50, 70, 90};
+  static const int expected[3] = {72, 17, 5};
+  int i, n;
+
+  for (i = 0; i < 3; i++) {
+    n = ransac_iterations(w[i], 100, 4, 990, 1000);
+    if (n < expected[i] - 1 || n > expected[i]) {
+      printf("%d%% inliers: %d iterations, expected %d\n", w[i], n, expected[i]);
+      result->errors++;
+    }
+  }
+
+  if (ransac_iterations(10, 100, 4, 990, 500) != 500 || ransac_iterations(100, 100, 4, 990, 500) != 1) {
+    printf("Iteration limits not respected\n");
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RANSAC
+////////////////////////////////////////////////////////////////////////////////
+
+void check_ransac(testresult_t *result, void (*start)(), void (*stop)()) {
+  ransac_cfg_t cfg = { .max_iters = 500, .confidence = 995, .seed = 1 };
+  float        h[9];
+  int          inliers;
+
+  init_points();
+
+  start();
+  inliers = hom_ransac(src, dst, N, THRESH, &cfg, h);
+  stop();
+
+  if (inliers < 0) {
+    printf("No homography found\n");
+    result->errors++;
+    return;
+  }
+
+  if (hom_inliers(h, src, dst, N, THRESH, mask) != inliers || check_mask(inliers, N / 7))
+    result->errors++;
+
+  // with 70% inliers the adaptive count stops far below the limit
+  if (cfg.iters >= cfg.max_iters) {
+    printf("Ran all %d iterations\n", cfg.iters);
+    result->errors++;
+  }
+}
+
+void check_ransac_q15(testresult_t *result, void (*start)(), void (*stop)()) {
+  ransac_cfg_t cfg = { .max_iters = 500, .confidence = 995, .seed = 1 };
+  int          thresh = (int)(THRESH * 16) << (15 - Q_SHIFT);
+  int16_t      h[9];
+  int          inliers;
+
+  init_points();
+  init_points_q15();
+
+  start();
+  inliers = hom_ransac_q15(src_q, dst_q, N, thresh, &cfg, h);
+  stop();
+
+  if (inliers < 0) {
+    printf("No homography found\n");
+    result->errors++;
+    return;
+  }
+
+  if (hom_inliers_q15(h, src_q, dst_q, N, thresh, mask) != inliers || check_mask(inliers, N / 7))
+    result->errors++;
+
+  if (cfg.iters >= cfg.max_iters) {
+    printf("Ran all %d iterations\n", cfg.iters);
+    result->errors++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// scoring kernels
+////////////////////////////////////////////////////////////////////////////////
+
+void check_score(testresult_t *result, void (*start)(), void (*stop)()) {
+  int inliers;
+
+  init_points();
+
+  start();
+  inliers = hom_score(h_true, src, dst, N, THRESH, N);
+  stop();
+
+  hom_inliers(h_true, src, dst, N, THRESH, mask);
+  if (inliers != N * 7 / 10 || check_mask(inliers, 0))
+    result->errors++;
+
+  // a hypothesis that can not beat 70 inliers stops after the first block
+  if (hom_score(h_true, src, dst, N, THRESH, 2) != -1) {
+    printf("No early termination\n");
+    result->errors++;
+  }
+}
+
+void check_score_q15(testresult_t *result, void (*start)(), void (*stop)()) {
+  int     thresh = (int)(THRESH * 16) << (15 - Q_SHIFT);
+  int16_t h[9];
+  int     inliers, i, j;
+
+  init_points();
+  init_points_q15();
+
+  // h_true in normalized coordinates S^-1 h_true S, pixels are 256 x + c
+  {
+    static const float c[2] = {160.0f, 120.0f};
+    float n[9], w;
+
+    for (j = 0; j < 3; j++) {
+      n[3 * j]     = h_true[3 * j] * 256.0f;
+      n[3 * j + 1] = h_true[3 * j + 1] * 256.0f;
+      n[3 * j + 2] = h_true[3 * j] * c[0] + h_true[3 * j + 1] * c[1] + h_true[3 * j + 2];
+    }
+
+    for (i = 0; i < 3; i++) {
+      n[i]     = (n[i]     - c[0] * n[6 + i]) * (1.0f / 256.0f);
+      n[3 + i] = (n[3 + i] - c[1] * n[6 + i]) * (1.0f / 256.0f);
+    }
+
+    w = 1.0f / n[8];
+    for (i = 0; i < 9; i++)
+      h[i] = (int)(n[i] * w * 16384.0f + (n[i] < 0.0f ? -0.5f : 0.5f));
+  }
+
+  start();
+  inliers = hom_score_q15(h, src_q, dst_q, N, thresh, N);
+  stop();
+
+  hom_inliers_q15(h, src_q, dst_q, N, thresh, mask);
+  if (inliers != N * 7 / 10 || check_mask(inliers, 0))
+    result->errors++;
+
+  if (hom_score_q15(h, src_q, dst_q, N, thresh, 2) != -1) {
+    printf("No early termination\n");
+    result->errors++;
+  }
+}
@@ -0,0 +1,56 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Core 0 instance of ml_tests/mlHom: 50 points, the homography in column-major
+// order and the bounds of sum and variance of the projected x and y.
+
+#ifndef _HOMOGRAPHY_DATA_H_
+#define _HOMOGRAPHY_DATA_H_
+
+#define MLHOM_POINTS 50
+
+static const float mlhom_points[2 * MLHOM_POINTS] = {
+  3.72083259F, 4.24274635F, 7.43126869F, 3.60080481F, 6.26489258F,
+  8.52869701F, 1.20024753F, 1.74342656F, 9.50627804F, 9.77501488F,
+  2.52004886F, 2.84620476F, 8.38286304F, 8.02100754F, 3.69961333F,
+  3.62810969F, 2.71741271F, 2.59469318F, 9.94394398F, 0.462633222F,
+  6.76333141F, 5.01684666F, 1.13288009F, 4.61314678F, 7.18630505F,
+  9.6060276F, 5.28900099F, 9.35416698F, 9.89586926F, 4.65715885F,
+  3.63796473F, 0.903358579F, 8.44203758F, 4.13706064F, 7.57358456F,
+  5.54033375F, 4.76240253F, 2.66590452F, 1.35277474F, 0.777007818F,
+  8.46593475F, 3.37042975F, 6.73993826F, 1.0443275F, 5.87365866F,
+  1.14802921F, 2.4934535F, 4.14172697F, 7.15466738F, 8.69670582F,
+  8.15427876F, 2.32449222F, 3.4633522F, 9.60612392F, 3.01312804F,
+  1.54196274F, 7.44436502F, 2.82894826F, 3.28839445F, 0.0133189932F,
+  5.63913488F, 4.44133663F, 1.6136297F, 7.03462076F, 5.44031096F,
+  2.54619718F, 3.93110847F, 2.44619083F, 5.82689F, 0.527434707F,
+  6.02292681F, 0.399708092F, 8.62410164F, 3.4310987F, 1.12233472F,
+  5.93426561F, 6.30076742F, 7.81380415F, 7.36514139F, 7.91597128F,
+  6.48711348F, 9.1190834F, 6.06076097F, 7.3644557F, 7.13251543F,
+  6.89987183F, 9.198699F, 9.69545937F, 3.28926063F, 0.94815737F,
+  8.06532764F, 6.82734823F, 1.7324698F, 4.8100996F, 9.39338493F,
+  1.38072348F, 6.5965395F, 1.94039249F, 6.26483965F, 6.20735073F
+};
+
+static const float mlhom_h[9] = {
+  3.51056075F, 4.4100275F, 3.29407024F,
+  5.72097254F, 9.92353249F, 7.17850828F,
+  3.60995555F, 5.72728539F, 3.80334616F
+};
+
+// upper and lower bound of sum x, sum y, var x and var y
+static const float mlhom_golden[8] = {
+  45.6040497F, 45.6031342F,
+  68.8497696F, 68.8484F,
+  0.00281180278F, 0.00281174644F,
+  6.72560127E-5F, 6.72546739E-5F
+};
+
+#endif
@@ -0,0 +1,259 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Checks the morphology library against a straightforward implementation
+// that visits every pixel of the structuring element, for all operations,
+// both shapes and grey scale as well as binary images. The timed cases show
+// that the cost of a dilation does not grow with the element size.
+
+#include "bench.h"
+#include "string_lib.h"
+#include "morph.h"
+
+#define W   48
+#define H   24
+#define BW  MORPH_BIN_WORDS(W)
+
+static uint8_t  src[W * H] __attribute__ ((section(".heapsram"), aligned(4)));
+static uint8_t  dst[W * H] __attribute__ ((section(".heapsram"), aligned(4)));
+static uint8_t  ref[W * H] __attribute__ ((section(".heapsram"), aligned(4)));
+static uint8_t  tmp0[W * H] __attribute__ ((section(".heapsram")));
+static uint8_t  tmp1[W * H] __attribute__ ((section(".heapsram")));
+static uint32_t bin_src[BW * H] __attribute__ ((section(".heapsram")));
+static uint32_t bin_dst[BW * H] __attribute__ ((section(".heapsram")));
+static uint32_t mem[1024] __attribute__ ((section(".heapsram")));
+
+static const char* op_names[] = { "dilate", "erode", "open", "close", "gradient", "tophat", "blackhat" };
+
+void check_dilate_3x3_naive  (testresult_t *result, void (*start)(), void (*stop)());
+void check_dilate_3x3        (testresult_t *result, void (*start)(), void (*stop)());
+void check_dilate_15x15_naive(testresult_t *result, void (*start)(), void (*stop)());
+void check_dilate_15x15      (testresult_t *result, void (*start)(), void (*stop)());
+void check_gray              (testresult_t *result, void (*start)(), void (*stop)());
+void check_binary            (testresult_t *result, void (*start)(), void (*stop)());
+
+testcase_t testcases[] = {
+  { .name = "dilate_3x3_naive",   .test = check_dilate_3x3_naive   },
+  { .name = "dilate_3x3",         .test = check_dilate_3x3         },
+  { .name = "dilate_15x15_naive", .test = check_dilate_15x15_naive },
+  { .name = "dilate_15x15",       .test = check_dilate_15x15       },
+  { .name = "gray",               .test = check_gray               },
+  { .name = "binary",             .test = check_binary             },
+  {0, 0}
+};
+
+int main()
+{
+  return run_suite(testcases);
+}
+
+static void init_image(int binary)
+{
+  unsigned int seed = 12345;
+  int i;
+
+  for (i = 0; i < W * H; i++) {
+    seed = seed * 1103515245 + 12345;
+    src[i] = seed >> 24;
+
+    if (binary)
+      src[i] = src[i] < 48 ? 255 : 0;
+  }
+}
+
+static void pack(const uint8_t* img, uint32_t* bin)
+{
+  int i, x, y;
+
+  for (i = 0; i < BW * H; i++)
+    bin[i] = 0;
+
+  for (y = 0; y < H; y++)
+    for (x = 0; x < W; x++)
+      if (img[y * W + x])
+        bin[y * BW + (x >> 5)] |= 1u << (x & 31);
+}
+
+static int differs(const uint8_t* a, const uint8_t* b)
+{
+  int i;
+
+  for (i = 0; i < W * H; i++)
+    if (a[i] != b[i])
+      return 1;
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reference
+////////////////////////////////////////////////////////////////////////////////
+
+static void naive(int dilate, const uint8_t* in, uint8_t* out, morph_shape_t shape, int kw, int kh)
+{
+  int x, y, dx, dy, v, p;
+  int rw = kw >> 1;
+  int rh = kh >> 1;
+
+  for (y = 0; y < H; y++) {
+    for (x = 0; x < W; x++) {
+      v = dilate ? 0 : 255;
+
+      for (dy = -rh; dy <= rh; dy++) {
+        for (dx = -rw; dx <= rw; dx++) {
+          if (shape == MORPH_CROSS && dx != 0 && dy != 0)
+            continue;
+
+          if (y + dy < 0 || y + dy >= H || x + dx < 0 || x + dx >= W)
+            continue;
+
+          p = in[(y + dy) * W + x + dx];
+          if (dilate ? p > v : p < v)
+            v = p;
+        }
+      }
+
+      out[y * W + x] = v;
+    }
+  }
+}
+
+static void naive_op(morph_op_t op, morph_shape_t shape, int kw, int kh)
+{
+  int i;
+
+  switch (op) {
+    case MORPH_DILATE:
+      naive(1, src, ref, shape, kw, kh);
+      break;
+    case MORPH_ERODE:
+      naive(0, src, ref, shape, kw, kh);
+      break;
+    case MORPH_OPEN:
+      naive(0, src, tmp0, shape, kw, kh);
+      naive(1, tmp0, ref, shape, kw, kh);
+      break;
+    case MORPH_CLOSE:
+      naive(1, src, tmp0, shape, kw, kh);
+      naive(0, tmp0, ref, shape, kw, kh);
+      break;
+    case MORPH_GRADIENT:
+      naive(1, src, tmp0, shape, kw, kh);
+      naive(0, src, tmp1, shape, kw, kh);
+      for (i = 0; i < W * H; i++)
+        ref[i] = tmp0[i] - tmp1[i];
+      break;
+    case MORPH_TOPHAT:
+      naive(0, src, tmp0, shape, kw, kh);
+      naive(1, tmp0, tmp1, shape, kw, kh);
+      for (i = 0; i < W * H; i++)
+        ref[i] = src[i] - tmp1[i];
+      break;
+    case MORPH_BLACKHAT:
+      naive(1, src, tmp0, shape, kw, kh);
+      naive(0, tmp0, tmp1, shape, kw, kh);
+      for (i = 0; i < W * H; i++)
+        ref[i] = tmp1[i] - src[i];
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// timing
+////////////////////////////////////////////////////////////////////////////////
+
+static void time_dilate(testresult_t *result, void (*start)(), void (*stop)(), int k, int use_naive)
+{
+  init_image(0);
+  naive(1, src, ref, MORPH_RECT, k, k);
+
+  start();
+  if (use_naive)
+    naive(1, src, dst, MORPH_RECT, k, k);
+  else
+    morph_u8(MORPH_DILATE, src, dst, W, H, MORPH_RECT, k, k, mem);
+  stop();
+
+  if (differs(dst, ref))
+    result->errors++;
+}
+
+void check_dilate_3x3_naive(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_dilate(result, start, stop, 3, 1);
+}
+
+void check_dilate_3x3(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_dilate(result, start, stop, 3, 0);
+}
+
+void check_dilate_15x15_naive(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_dilate(result, start, stop, 15, 1);
+}
+
+void check_dilate_15x15(testresult_t *result, void (*start)(), void (*stop)()) {
+  time_dilate(result, start, stop, 15, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// all operations
+////////////////////////////////////////////////////////////////////////////////
+
+static const int sizes[][2] = { {1, 3}, {3, 3}, {5, 1}, {5, 7}, {9, 9}, {15, 5} };
+
+static void check_all(testresult_t *result, int binary)
+{
+  int op, shape, s, kw, kh, x, y, bit;
+
+  init_image(binary);
+  pack(src, bin_src);
+
+  for (op = MORPH_DILATE; op <= MORPH_BLACKHAT; op++) {
+    for (shape = MORPH_RECT; shape <= MORPH_CROSS; shape++) {
+      for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+        kw = sizes[s][0];
+        kh = sizes[s][1];
+
+        if (morph_mem_size(op, W, kw, kh, shape, binary) > sizeof(mem)) {
+          printf("Not enough scratch memory for %s %dx%d\n", op_names[op], kw, kh);
+          result->errors++;
+          continue;
+        }
+
+        naive_op(op, shape, kw, kh);
+
+        if (!binary) {
+          morph_u8(op, src, dst, W, H, shape, kw, kh, mem);
+        } else {
+          morph_bin(op, bin_src, bin_dst, W, H, shape, kw, kh, mem);
+
+          for (y = 0; y < H; y++) {
+            for (x = 0; x < W; x++) {
+              bit = (bin_dst[y * BW + (x >> 5)] >> (x & 31)) & 1;
+              dst[y * W + x] = bit ? 255 : 0;
+            }
+          }
+        }
+
+        if (differs(dst, ref)) {
+          printf("%s %s %dx%d differs\n", op_names[op], shape == MORPH_RECT ? "rect" : "cross", kw, kh);
+          result->errors++;
+        }
+      }
+    }
+  }
+}
+
+void check_gray(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_all(result, 0);
+}
+
+void check_binary(testresult_t *result, void (*start)(), void (*stop)()) {
+  check_all(result, 1);
+}
@@ -32,6 +32,13 @@ GCC_MARCH="IMFDXpulpv2"
 #compile arduino lib
 ARDUINO_LIB=1
 
+# directory for prebuilt library archives, shared between build folders with
+# the same compiler and flags. Leave empty to always build the libraries
+LIB_CACHE_DIR=""
+
+# set this to 1 to only build the ELF files, without simulation stimuli
+ELF_ONLY=0
+
 PULP_GIT_DIRECTORY=../../
 SIM_DIRECTORY="$PULP_GIT_DIRECTORY/vsim"
 #insert here your post-layout netlist if you are using IMPERIO
@@ -49,6 +56,8 @@ cmake "$PULP_GIT_DIRECTORY"/sw/ \
     -DGCC_MARCH="$GCC_MARCH" \
     -DARDUINO_LIB="$ARDUINO_LIB" \
     -DPL_NETLIST="$PL_NETLIST" \
+    -DLIB_CACHE_DIR="$LIB_CACHE_DIR" \
+    -DELF_ONLY="$ELF_ONLY" \
     -DCMAKE_C_FLAGS="$TARGET_C_FLAGS" \
     -DCMAKE_OBJCOPY="$OBJCOPY" \
     -DCMAKE_OBJDUMP="$OBJDUMP"
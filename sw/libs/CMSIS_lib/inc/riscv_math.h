@@ -212,8 +212,10 @@
 extern "C"
 {
 #endif
-/*To use DSP extension*/
+/*To use DSP extension, RISCV_MATH_NO_DSP builds the plain RV32IM paths*/
+#ifndef RISCV_MATH_NO_DSP
 #define USE_DSP_RISCV 
+#endif
 
 
 /*
@@ -1694,6 +1696,21 @@ void riscv_cfft_q15(
     uint8_t ifftFlag,
     uint8_t bitReverseFlag);  
 
+  /**
+   * @brief Processing function for the block floating point Q15 CFFT/CIFFT.
+   * @param[in]      *S    points to an instance of the Q15 CFFT structure.
+   * @param[in, out] *p1   points to the word aligned complex data buffer of size 2*fftLen. Processing occurs in-place.
+   * @param[in]      ifftFlag       flag that selects forward (ifftFlag=0) or inverse (ifftFlag=1) transform.
+   * @param[in]      bitReverseFlag flag that enables (bitReverseFlag=1) or disables (bitReverseFlag=0) bit reversal of output.
+   * @return         block exponent, the unnormalized transform is p1 * 2^exp.
+   */
+
+  int32_t riscv_cfft_bfp_q15(
+  const riscv_cfft_instance_q15 * S,
+  q15_t * p1,
+  uint8_t ifftFlag,
+  uint8_t bitReverseFlag);
+
   /**
    * @brief Instance structure for the fixed-point CFFT/CIFFT function.
    */
@@ -1756,6 +1773,19 @@ void riscv_cfft_q31(
   q15_t * pSrc,
   q15_t * pDst);
 
+  /**
+   * @brief Processing function for the block floating point Q15 RFFT/RIFFT.
+   * @param[in]  *S    points to an instance of the Q15 RFFT/RIFFT structure.
+   * @param[in]  *pSrc points to the word aligned input buffer, the forward transform modifies it.
+   * @param[out] *pDst points to the word aligned output buffer.
+   * @return     block exponent, the unnormalized transform is pDst * 2^exp.
+   */
+
+  int32_t riscv_rfft_bfp_q15(
+  const riscv_rfft_instance_q15 * S,
+  q15_t * pSrc,
+  q15_t * pDst);
+
   /**
    * @brief Instance structure for the Q31 RFFT/RIFFT function.
    */
@@ -1830,6 +1860,168 @@ void riscv_rfft_fast_f32(
   float32_t * p, float32_t * pOut,
   uint8_t ifftFlag);
 
+  /**
+   * @brief Instance structure for the Q15 Goertzel filter bank.
+   */
+
+  typedef struct
+  {
+    uint16_t numTones;                  /**< number of tones. */
+    uint16_t shift;                     /**< input is scaled down by 2^shift. */
+    uint32_t windowLen;                 /**< samples per detection window. */
+    uint32_t count;                     /**< samples of the current window processed so far. */
+    q31_t *pCoeffs;                     /**< points to the coefficients, {2 cos(w), -1} as two 2.14 values per tone. */
+    q31_t *pState;                      /**< points to the states, {s[n-1], s[n-2]} as two 16 bit values per tone. */
+    uint32_t normMul;                   /**< power normalization mantissa. */
+    int32_t normShift;                  /**< power normalization shift. */
+  } riscv_goertzel_instance_q15;
+
+  /**
+   * @brief Instance structure for the Q31 Goertzel filter bank.
+   */
+
+  typedef struct
+  {
+    uint16_t numTones;                  /**< number of tones. */
+    uint16_t shift;                     /**< input is scaled down by 2^shift. */
+    uint32_t windowLen;                 /**< samples per detection window. */
+    uint32_t count;                     /**< samples of the current window processed so far. */
+    q31_t *pCoeffs;                     /**< points to the coefficients, {cos(w), sin(w)} per tone. */
+    q31_t *pState;                      /**< points to the states, {s[n-1], s[n-2]} per tone. */
+    uint32_t normMul;                   /**< power normalization mantissa. */
+    int32_t normShift;                  /**< power normalization shift. */
+  } riscv_goertzel_instance_q31;
+
+  /**
+   * @brief Instance structure for the Q15 sliding DFT.
+   */
+
+  typedef struct
+  {
+    uint16_t numTones;                  /**< number of tones. */
+    uint16_t shift;                     /**< input is scaled down by 2^shift. */
+    uint32_t windowLen;                 /**< length of the sliding window. */
+    uint32_t index;                     /**< position of the oldest sample in the delay line. */
+    q31_t *pCoeffs;                     /**< points to the coefficients, three words per tone. */
+    q31_t *pState;                      /**< points to the bins, {re, im} as two 16 bit values per tone. */
+    q15_t *pDelay;                      /**< points to the delay line of windowLen samples. */
+    uint32_t normMul;                   /**< power normalization mantissa. */
+    int32_t normShift;                  /**< power normalization shift. */
+  } riscv_sdft_instance_q15;
+
+  /**
+   * @brief  Initialization function for the Q15 Goertzel filter bank.
+   * @param[in,out] *S        points to an instance of the Q15 Goertzel structure.
+   * @param[in]     numTones  number of tones.
+   * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+   * @param[in]     *pCoeffs  points to the coefficient buffer of numTones words.
+   * @param[in]     *pState   points to the state buffer of numTones words.
+   * @param[in]     windowLen samples per detection window, 2 to 32768.
+   * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR.
+   */
+
+  riscv_status riscv_goertzel_init_q15(
+  riscv_goertzel_instance_q15 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  uint32_t windowLen);
+
+  /**
+   * @brief Processing function for the Q15 Goertzel filter bank.
+   * @param[in,out] *S         points to an instance of the Q15 Goertzel structure.
+   * @param[in]     *pSrc      points to the block of input data.
+   * @param[in]     blockSize  number of samples to process.
+   * @param[out]    *pPower    points to the power output, numTones values per window that ends in the block.
+   * @return        number of windows that ended in the block.
+   */
+
+  uint32_t riscv_goertzel_q15(
+  riscv_goertzel_instance_q15 * S,
+  q15_t * pSrc,
+  uint32_t blockSize,
+  q31_t * pPower);
+
+  /**
+   * @brief  Initialization function for the Q31 Goertzel filter bank.
+   * @param[in,out] *S        points to an instance of the Q31 Goertzel structure.
+   * @param[in]     numTones  number of tones.
+   * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+   * @param[in]     *pCoeffs  points to the coefficient buffer of 2*numTones words.
+   * @param[in]     *pState   points to the state buffer of 2*numTones words.
+   * @param[in]     windowLen samples per detection window, 2 to 32768.
+   * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR.
+   */
+
+  riscv_status riscv_goertzel_init_q31(
+  riscv_goertzel_instance_q31 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  uint32_t windowLen);
+
+  /**
+   * @brief Processing function for the Q31 Goertzel filter bank.
+   * @param[in,out] *S         points to an instance of the Q31 Goertzel structure.
+   * @param[in]     *pSrc      points to the block of input data.
+   * @param[in]     blockSize  number of samples to process.
+   * @param[out]    *pPower    points to the power output, numTones values per window that ends in the block.
+   * @return        number of windows that ended in the block.
+   */
+
+  uint32_t riscv_goertzel_q31(
+  riscv_goertzel_instance_q31 * S,
+  q31_t * pSrc,
+  uint32_t blockSize,
+  q31_t * pPower);
+
+  /**
+   * @brief  Initialization function for the Q15 sliding DFT.
+   * @param[in,out] *S        points to an instance of the Q15 sliding DFT structure.
+   * @param[in]     numTones  number of tones.
+   * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+   * @param[in]     *pCoeffs  points to the coefficient buffer of 3*numTones words.
+   * @param[in]     *pState   points to the state buffer of numTones words.
+   * @param[in]     *pDelay   points to the delay line of windowLen samples.
+   * @param[in]     windowLen length of the sliding window, 2 to 4096.
+   * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR.
+   */
+
+  riscv_status riscv_sdft_init_q15(
+  riscv_sdft_instance_q15 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  q15_t * pDelay,
+  uint32_t windowLen);
+
+  /**
+   * @brief Processing function for the Q15 sliding DFT.
+   * @param[in,out] *S         points to an instance of the Q15 sliding DFT structure.
+   * @param[in]     *pSrc      points to the block of input data.
+   * @param[in]     blockSize  number of samples to process.
+   * @return none.
+   */
+
+  void riscv_sdft_q15(
+  riscv_sdft_instance_q15 * S,
+  q15_t * pSrc,
+  uint32_t blockSize);
+
+  /**
+   * @brief Power of the tones of the Q15 sliding DFT over the last windowLen samples.
+   * @param[in]  *S       points to an instance of the Q15 sliding DFT structure.
+   * @param[out] *pPower  points to the power output of numTones values.
+   * @return none.
+   */
+
+  void riscv_sdft_power_q15(
+  const riscv_sdft_instance_q15 * S,
+  q31_t * pPower);
+
   /**
    * @brief Instance structure for the floating-point DCT4/IDCT4 function.
    */
@@ -3082,6 +3274,106 @@ void riscv_rfft_fast_f32(
   q31_t * pState,
   uint32_t blockSize);
 
+  /**
+   * @brief Instance structure for the Q15 PDM CIC decimator.
+   */
+
+  typedef struct
+  {
+    uint8_t order;                  /**< number of integrators and combs. */
+    uint16_t count;                 /**< words of the current output sample processed so far. */
+    uint16_t R;                     /**< decimation factor in bits, a multiple of 32. */
+    q31_t *pState;                  /**< points to the integrators followed by the combs, 2*order words. */
+    uint32_t range;                 /**< R^order, the output for a stream of only one bits. */
+    q31_t gain;                     /**< output scaling mantissa. */
+    uint8_t shift;                  /**< output scaling shift. */
+  } riscv_pdm_cic_instance_q15;
+
+  /**
+   * @brief Instance structure for the Q15 PDM to PCM decimator.
+   */
+
+  typedef struct
+  {
+    riscv_pdm_cic_instance_q15 cic;         /**< CIC decimator. */
+    riscv_fir_decimate_instance_q15 fir;    /**< compensation FIR decimator. */
+    q15_t *pBuf;                            /**< points to the CIC samples waiting for the FIR. */
+    uint16_t blockSize;                     /**< number of CIC samples per call of the FIR decimator. */
+    uint16_t fill;                          /**< number of CIC samples in pBuf. */
+  } riscv_pdm_pcm_instance_q15;
+
+  /**
+   * @brief  Initialization function for the Q15 PDM CIC decimator.
+   * @param[in,out] *S      points to an instance of the PDM CIC decimator structure.
+   * @param[in]     order   number of integrators and combs, 1 to 5.
+   * @param[in]     R       decimation factor in bits, a multiple of 32.
+   * @param[in]     *pState points to the state buffer of 2*order words.
+   * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR.
+   */
+
+  riscv_status riscv_pdm_cic_init_q15(
+  riscv_pdm_cic_instance_q15 * S,
+  uint8_t order,
+  uint16_t R,
+  q31_t * pState);
+
+  /**
+   * @brief Processing function for the Q15 PDM CIC decimator.
+   * @param[in,out] *S        points to an instance of the PDM CIC decimator structure.
+   * @param[in]     *pSrc     points to the PDM words, earliest bit first.
+   * @param[out]    *pDst     points to the output, one sample per R / 32 words.
+   * @param[in]     numWords  number of PDM words to process.
+   * @return        number of samples written.
+   */
+
+  uint32_t riscv_pdm_cic_q15(
+  riscv_pdm_cic_instance_q15 * S,
+  const uint32_t * pSrc,
+  q15_t * pDst,
+  uint32_t numWords);
+
+  /**
+   * @brief  Initialization function for the Q15 PDM to PCM decimator.
+   * @param[in,out] *S         points to an instance of the PDM to PCM decimator structure.
+   * @param[in]     order      order of the CIC, 1 to 5.
+   * @param[in]     R          decimation of the CIC in bits, a multiple of 32.
+   * @param[in]     *pCicState points to the CIC state buffer of 2*order words.
+   * @param[in]     numTaps    number of coefficients of the compensation filter.
+   * @param[in]     M          decimation of the compensation filter.
+   * @param[in]     *pCoeffs   points to the compensation filter coefficients.
+   * @param[in]     *pFirState points to the FIR state buffer of numTaps+blockSize-1 samples.
+   * @param[in]     *pBuf      points to the buffer of blockSize CIC samples.
+   * @param[in]     blockSize  number of CIC samples per call of the FIR decimator.
+   * @return        RISCV_MATH_SUCCESS, RISCV_MATH_ARGUMENT_ERROR or RISCV_MATH_LENGTH_ERROR.
+   */
+
+  riscv_status riscv_pdm_pcm_init_q15(
+  riscv_pdm_pcm_instance_q15 * S,
+  uint8_t order,
+  uint16_t R,
+  q31_t * pCicState,
+  uint16_t numTaps,
+  uint8_t M,
+  q15_t * pCoeffs,
+  q15_t * pFirState,
+  q15_t * pBuf,
+  uint16_t blockSize);
+
+  /**
+   * @brief Processing function for the Q15 PDM to PCM decimator.
+   * @param[in,out] *S        points to an instance of the PDM to PCM decimator structure.
+   * @param[in]     *pSrc     points to the PDM words, earliest bit first.
+   * @param[in]     numWords  number of PDM words to process.
+   * @param[out]    *pDst     points to the PCM output.
+   * @return        number of PCM samples written.
+   */
+
+  uint32_t riscv_pdm_pcm_q15(
+  riscv_pdm_pcm_instance_q15 * S,
+  const uint32_t * pSrc,
+  uint32_t numWords,
+  q15_t * pDst);
+
 
 
   /**
@@ -3996,6 +4288,132 @@ void riscv_rfft_fast_f32(
   uint32_t blockSize,
   uint8_t postShift);
 
+  /**
+   * @brief Largest number of coefficients of the QR-RLS filters.
+   */
+#define RISCV_RLS_QR_MAX_TAPS 32
+
+  /**
+   * @brief Instance structure for the floating-point QR-RLS filter.
+   */
+
+  typedef struct
+  {
+    uint16_t numTaps;      /**< number of coefficients in the filter. */
+    float32_t *pState;     /**< points to the state variable array. The array is of length numTaps+blockSize-1. */
+    float32_t *pCoeffs;    /**< points to the coefficient array. The array is of length numTaps. */
+    float32_t *pR;         /**< points to the upper triangular factor, numTaps*(numTaps+1)/2 values row by row. */
+    float32_t *pZ;         /**< points to the rotated reference vector. The array is of length numTaps. */
+    float32_t sqrtLambda;  /**< square root of the forgetting factor. */
+    float32_t sqrtGain;    /**< square root of one minus the forgetting factor, weight of new samples. */
+  } riscv_rls_qr_instance_f32;
+
+  /**
+   * @brief Processing function for floating-point QR-RLS filter.
+   * @param[in]  *S points to an instance of the floating-point QR-RLS filter structure.
+   * @param[in]  *pSrc points to the block of input data.
+   * @param[in]  *pRef points to the block of reference data.
+   * @param[out] *pOut points to the block of output data.
+   * @param[out] *pErr points to the block of error data.
+   * @param[in]  blockSize number of samples to process.
+   * @return     none.
+   */
+
+  void riscv_rls_qr_f32(
+  const riscv_rls_qr_instance_f32 * S,
+  float32_t * pSrc,
+  float32_t * pRef,
+  float32_t * pOut,
+  float32_t * pErr,
+  uint32_t blockSize);
+
+  /**
+   * @brief Initialization function for floating-point QR-RLS filter.
+   * @param[in] *S points to an instance of the floating-point QR-RLS filter structure.
+   * @param[in] numTaps  number of filter coefficients, at most RISCV_RLS_QR_MAX_TAPS.
+   * @param[in] *pCoeffs points to coefficient buffer, holds the initial coefficients.
+   * @param[in] *pState points to state buffer.
+   * @param[in] *pR points to the triangular factor buffer of numTaps * (numTaps + 1) / 2 values.
+   * @param[in] *pZ points to the reference vector buffer of numTaps values.
+   * @param[in] lambda forgetting factor, 0 < lambda < 1.
+   * @param[in] delta initial diagonal of the triangular factor, delta > 0.
+   * @param[in] blockSize number of samples to process.
+   * @return RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+   */
+
+  riscv_status riscv_rls_qr_init_f32(
+  riscv_rls_qr_instance_f32 * S,
+  uint16_t numTaps,
+  float32_t * pCoeffs,
+  float32_t * pState,
+  float32_t * pR,
+  float32_t * pZ,
+  float32_t lambda,
+  float32_t delta,
+  uint32_t blockSize);
+
+  /**
+   * @brief Instance structure for the Q31 QR-RLS filter.
+   */
+
+  typedef struct
+  {
+    uint16_t numTaps;      /**< number of coefficients in the filter. */
+    q31_t *pState;         /**< points to the state variable array. The array is of length numTaps+blockSize-1. */
+    q31_t *pCoeffs;        /**< points to the coefficient array. The array is of length numTaps. */
+    q31_t *pR;             /**< points to the upper triangular factor, numTaps*(numTaps+1)/2 values row by row. */
+    q31_t *pZ;             /**< points to the rotated reference vector. The array is of length numTaps. */
+    q31_t sqrtLambda;      /**< square root of the forgetting factor. */
+    q31_t sqrtGain;        /**< square root of one minus the forgetting factor, weight of new samples. */
+    uint8_t postShift;     /**< bit shift applied to coefficients. */
+  } riscv_rls_qr_instance_q31;
+
+  /**
+   * @brief Processing function for Q31 QR-RLS filter.
+   * @param[in]  *S points to an instance of the Q31 QR-RLS filter structure.
+   * @param[in]  *pSrc points to the block of input data.
+   * @param[in]  *pRef points to the block of reference data.
+   * @param[out] *pOut points to the block of output data.
+   * @param[out] *pErr points to the block of error data.
+   * @param[in]  blockSize number of samples to process.
+   * @return     none.
+   */
+
+  void riscv_rls_qr_q31(
+  const riscv_rls_qr_instance_q31 * S,
+  q31_t * pSrc,
+  q31_t * pRef,
+  q31_t * pOut,
+  q31_t * pErr,
+  uint32_t blockSize);
+
+  /**
+   * @brief Initialization function for Q31 QR-RLS filter.
+   * @param[in] *S points to an instance of the Q31 QR-RLS filter structure.
+   * @param[in] numTaps  number of filter coefficients, at most RISCV_RLS_QR_MAX_TAPS.
+   * @param[in] *pCoeffs points to coefficient buffer, holds the initial coefficients.
+   * @param[in] *pState points to state buffer.
+   * @param[in] *pR points to the triangular factor buffer of numTaps * (numTaps + 1) / 2 values.
+   * @param[in] *pZ points to the reference vector buffer of numTaps values.
+   * @param[in] lambda forgetting factor, 0 < lambda < 1.
+   * @param[in] delta initial diagonal of the triangular factor, delta > 0.
+   * @param[in] blockSize number of samples to process.
+   * @param[in] postShift bit shift applied to coefficients, at most 30.
+   * @return RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+   */
+
+  riscv_status riscv_rls_qr_init_q31(
+  riscv_rls_qr_instance_q31 * S,
+  uint16_t numTaps,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  q31_t * pR,
+  q31_t * pZ,
+  q31_t lambda,
+  q31_t delta,
+  uint32_t blockSize,
+  uint8_t postShift);
+
   /**
    * @brief Correlation of floating-point sequences.
    * @param[in] *pSrcA points to the first input sequence.
@@ -0,0 +1,97 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Multiversioned CMSIS kernels with run time dispatch.
+ *
+ * The hot kernels below are compiled into the image several times: a plain
+ * version that runs on every core, a version using the PULP extensions and,
+ * for the floating point kernels, a version using the FPU of RI5CY. At
+ * startup a constructor probes the core with cpu_features and fills the
+ * dispatch table riscv_mv with the best version of every kernel. A call
+ * through riscv_mv is a single indirect call, nothing is checked per call.
+ *
+ * The plain versions are compiled for RV32IM unless the image itself is
+ * built for RI5CY with FPU, the PULP versions for IMXpulpv2, whatever
+ * GCC_MARCH is set to. An image built with GCC_MARCH=RV32IM therefore runs
+ * on zero-riscy and uses the extensions where RI5CY has them. Images built
+ * for RV32E contain the plain versions only.
+ *
+ */
+#ifndef _RISCV_MV_H
+#define _RISCV_MV_H
+
+#include "riscv_math.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Variants, a subset of the CPU_FEAT_* flags of cpu_features.h */
+#define RISCV_MV_XPULP   0x2
+#define RISCV_MV_FPU     0x4
+
+typedef struct {
+  void (*dot_prod_q7)(q7_t* pSrcA, q7_t* pSrcB, uint32_t blockSize, q31_t* result);
+  void (*dot_prod_q15)(q15_t* pSrcA, q15_t* pSrcB, uint32_t blockSize, q63_t* result);
+  void (*mult_q15)(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+  void (*add_q15)(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+  void (*fir_q15)(const riscv_fir_instance_q15* S, q15_t* pSrc, q15_t* pDst, uint32_t blockSize);
+
+  // only pointers cross the interface, so the FPU versions work in soft
+  // float images as well
+  void (*dot_prod_f32)(float32_t* pSrcA, float32_t* pSrcB, uint32_t blockSize, float32_t* result);
+  void (*mult_f32)(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+  void (*add_f32)(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+} riscv_mv_table_t;
+
+/** The dispatch table, holds the plain versions until the constructor ran */
+extern riscv_mv_table_t riscv_mv;
+
+/** Variants in use, RISCV_MV_* flags */
+extern unsigned int riscv_mv_variants;
+
+/** Fills the dispatch table.
+ *
+ * @param features  CPU_FEAT_* flags, variants the image does not contain or
+ *                  the flags do not allow fall back to the plain versions
+ *
+ * @return the variants now in use
+ */
+unsigned int riscv_mv_select(unsigned int features);
+
+// the individual versions, for tests and benchmarks
+
+void riscv_dot_prod_q7_base(q7_t* pSrcA, q7_t* pSrcB, uint32_t blockSize, q31_t* result);
+void riscv_dot_prod_q15_base(q15_t* pSrcA, q15_t* pSrcB, uint32_t blockSize, q63_t* result);
+void riscv_mult_q15_base(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+void riscv_add_q15_base(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+void riscv_fir_q15_base(const riscv_fir_instance_q15* S, q15_t* pSrc, q15_t* pDst, uint32_t blockSize);
+void riscv_dot_prod_f32_base(float32_t* pSrcA, float32_t* pSrcB, uint32_t blockSize, float32_t* result);
+void riscv_mult_f32_base(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+void riscv_add_f32_base(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+
+void riscv_dot_prod_q7_xpulp(q7_t* pSrcA, q7_t* pSrcB, uint32_t blockSize, q31_t* result);
+void riscv_dot_prod_q15_xpulp(q15_t* pSrcA, q15_t* pSrcB, uint32_t blockSize, q63_t* result);
+void riscv_mult_q15_xpulp(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+void riscv_add_q15_xpulp(q15_t* pSrcA, q15_t* pSrcB, q15_t* pDst, uint32_t blockSize);
+void riscv_fir_q15_xpulp(const riscv_fir_instance_q15* S, q15_t* pSrc, q15_t* pDst, uint32_t blockSize);
+
+void riscv_dot_prod_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, uint32_t blockSize, float32_t* result);
+void riscv_mult_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+void riscv_add_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RISCV_MV_H
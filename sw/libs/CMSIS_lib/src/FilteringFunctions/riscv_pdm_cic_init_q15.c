@@ -0,0 +1,80 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup PDM_decimate
+ * @{
+ */
+
+/**
+ * @brief  Initialization function for the Q15 PDM CIC decimator.
+ * @param[in,out] *S      points to an instance of the PDM CIC decimator structure.
+ * @param[in]     order   number of integrators and combs, 1 to 5.
+ * @param[in]     R       decimation factor in bits, a multiple of 32.
+ * @param[in]     *pState points to the state buffer of 2*order words.
+ * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR if <code>R</code>
+ * is not a multiple of 32 or <code>R^order</code> is not below 2^31.
+ *
+ * \par
+ * <code>pState</code> holds the integrators followed by the combs, all of
+ * them are cleared.
+ */
+
+riscv_status riscv_pdm_cic_init_q15(
+  riscv_pdm_cic_instance_q15 * S,
+  uint8_t order,
+  uint16_t R,
+  q31_t * pState)
+{
+  uint64_t range = 1u;
+  uint32_t i, bits;
+
+  if(order == 0u || order > 5u || R == 0u || (R & 31u) != 0u)
+    return RISCV_MATH_ARGUMENT_ERROR;
+
+  /* checked every step, R^5 can exceed even 64 bits */
+  for (i = 0u; i < order; i++)
+  {
+    range *= R;
+    if(range >= 0x80000000u)
+      return RISCV_MATH_ARGUMENT_ERROR;
+  }
+
+  /* R^N < 2^bits */
+  bits = 0u;
+  while((range >> bits) != 0u)
+  {
+    bits++;
+  }
+
+  S->order = order;
+  S->R = R;
+  S->count = 0u;
+  S->pState = pState;
+  S->range = (uint32_t) range;
+
+  /* out * 2^15 / R^N = (out << shift) * gain / 2^32 */
+  S->shift = (uint8_t) (31u - bits);
+  S->gain = (q31_t) ((((uint64_t) 1u << (bits + 17u)) / range + 1u) >> 1);
+
+  for (i = 0u; i < 2u * order; i++)
+  {
+    pState[i] = 0;
+  }
+
+  return RISCV_MATH_SUCCESS;
+}
+
+/**
+ * @} end of PDM_decimate group
+ */
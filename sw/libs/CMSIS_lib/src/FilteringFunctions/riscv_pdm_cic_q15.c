@@ -0,0 +1,220 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+/**
+ * @ingroup groupFilters
+ */
+
+/**
+ * @defgroup PDM_decimate PDM to PCM Decimator
+ *
+ * Converts the 1 bit stream of a PDM microphone into Q15 PCM. The bit rate is
+ * first reduced by a cascaded integrator comb (CIC) decimator, then a FIR
+ * decimator compensates the droop of the CIC in the pass band, removes what
+ * the CIC lets alias near the output Nyquist frequency and reduces the rate
+ * by its own factor <code>M</code>. A 3.072 MHz stream for example becomes
+ * 16 kHz PCM with a CIC of <code>R = 96</code> and a FIR with
+ * <code>M = 2</code>.
+ *
+ * \par Input format
+ * The PDM stream is read as 32 bit words as captured by the SPI master, the
+ * earliest bit in the most significant bit. A one bit is <code>+1</code>, a
+ * zero bit <code>-1</code>.
+ *
+ * \par CIC decimator
+ * A CIC of order <code>N</code> and decimation <code>R</code> is the filter
+ * <pre>
+ *     H(z) = ((1 - z^-R) / (1 - z^-1))^N
+ * </pre>
+ * built from <code>N</code> integrators at the bit rate followed by
+ * <code>N</code> combs at the output rate. Running the integrators bit by bit
+ * would cost several instructions per bit. Instead they advance a whole word
+ * at a time: after 32 bits every integrator is a fixed combination of the
+ * integrators before the word plus a weighted count of the one bits of the
+ * word,
+ * <pre>
+ *     I_k += sum_(j < k) C(31 + k - j, k - j) I_j + sum_p C(p + k - 1, k - 1) b_p
+ * </pre>
+ * where <code>p</code> is the bit position, that is the age of the bit at
+ * the end of the word. The weighted counts are computed bit plane by bit
+ * plane of the weights, one popcount per plane, 30 popcounts per word for
+ * <code>N = 4</code>. The decimation <code>R</code> has to be a multiple of
+ * 32. The integrators and combs wrap modulo 2^32 as usual for a CIC, the
+ * result is exact as long as <code>R^N < 2^31</code>.
+ *
+ * \par Compensation filter
+ * The FIR stage is a riscv_fir_decimate_instance_q15 with coefficients
+ * designed for the CIC, typically an equiripple lowpass to 0.8 times the
+ * output Nyquist frequency whose pass band follows the inverse of
+ * <code>(sin(pi f R) / (R sin(pi f)))^N</code>.
+ *
+ * \par Streaming
+ * riscv_pdm_pcm_q15 accepts any number of words per call and returns the
+ * number of PCM samples it wrote. The CIC output is collected in a buffer of
+ * <code>blockSize</code> samples that is filtered whenever it is full, so all
+ * memory is allocated by the caller at initialization.
+ */
+
+/**
+ * @addtogroup PDM_decimate
+ * @{
+ */
+
+/*
+ * Bit planes of the weights C(p + k - 1, k - 1) of the one bits of a word
+ * for the integrators k = 2..5. Plane j holds the positions p whose weight
+ * has bit j set.
+ */
+static const uint32_t riscv_pdm_planes[45] = {
+  /* k = 2, weights 1..32 */
+  0x55555555, 0x66666666, 0x78787878, 0x7F807F80, 0x7FFF8000, 0x80000000,
+  /* k = 3, weights 1..528 */
+  0x33333333, 0x1E1E1E1E, 0x0BF40BF4, 0x06A7F958, 0xFE6D5260, 0x54B66380,
+  0x67387C00, 0x783F8000, 0x7FC00000, 0x80000000,
+  /* k = 4, weights 1..5984 */
+  0x11111111, 0x14141414, 0x1F4A1F4A, 0x1BF14EA4, 0x4846A6E8, 0xA1F6E9B0,
+  0xEF731AC0, 0x1A715300, 0xF9259C00, 0xADB9E000, 0xCE3E0000, 0x0FC00000,
+  0xF0000000,
+  /* k = 5, weights 1..52360 */
+  0x0F0F0F0F, 0x03FC03FC, 0x06C9F936, 0xFDA137A4, 0x310C5860, 0x5963C528,
+  0x3B636FF0, 0xAB9D4740, 0x6532FD80, 0x2D4BD600, 0xF3869800, 0xBF54E000,
+  0x6A670000, 0x4C780000, 0x8F800000, 0xF0000000
+};
+
+static const uint8_t riscv_pdm_numPlanes[5] = { 1, 6, 10, 13, 16 };
+
+/* C(31 + d, d), the weight of integrator k - d in integrator k after a word */
+static const uint32_t riscv_pdm_jump[4] = { 32, 528, 5984, 52360 };
+
+#if defined (USE_DSP_RISCV)
+static inline uint32_t riscv_pdm_cnt(uint32_t x)
+{
+  uint32_t n;
+  asm ("p.cnt %0, %1" : "=r" (n) : "r" (x));
+  return n;
+}
+#else
+static inline uint32_t riscv_pdm_cnt(uint32_t x)
+{
+  x = x - ((x >> 1) & 0x55555555);
+  x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+  x = (x + (x >> 4)) & 0x0F0F0F0F;
+  return (x * 0x01010101) >> 24;
+}
+#endif
+
+/**
+ * @brief Processing function for the Q15 PDM CIC decimator.
+ * @param[in,out] *S        points to an instance of the PDM CIC decimator structure.
+ * @param[in]     *pSrc     points to the PDM words.
+ * @param[out]    *pDst     points to the output, one sample per R / 32 words.
+ * @param[in]     numWords  number of PDM words to process.
+ * @return        number of samples written.
+ *
+ * <b>Scaling and Overflow Behavior:</b>
+ * \par
+ * The CIC result in <code>[-R^N, R^N]</code> is scaled to 1.15 format, a
+ * stream of only one bits reads as full scale and is saturated to
+ * <code>0x7FFF</code>. A block may end anywhere in an output sample.
+ */
+
+uint32_t riscv_pdm_cic_q15(
+  riscv_pdm_cic_instance_q15 * S,
+  const uint32_t * pSrc,
+  q15_t * pDst,
+  uint32_t numWords)
+{
+  uint32_t order = S->order;
+  uint32_t words = S->R >> 5;
+  uint32_t count = S->count;
+  uint32_t *pInteg = (uint32_t *) S->pState;
+  uint32_t *pComb = pInteg + order;
+  uint32_t integ[5], weight[5];
+  const uint32_t *pPlane;
+  uint32_t w, acc, y, tmp, k, j, numOut = 0u;
+  q31_t out;
+
+  for (k = 0u; k < order; k++)
+  {
+    integ[k] = pInteg[k];
+  }
+
+  while(numWords > 0u)
+  {
+    w = *pSrc++;
+
+    /* weighted counts of the one bits, one popcount per bit plane */
+    weight[0] = riscv_pdm_cnt(w);
+    pPlane = riscv_pdm_planes;
+    for (k = 1u; k < order; k++)
+    {
+      acc = 0u;
+      for (j = 0u; j < riscv_pdm_numPlanes[k]; j++)
+      {
+        acc += riscv_pdm_cnt(w & *pPlane++) << j;
+      }
+      weight[k] = acc;
+    }
+
+    /* advance the integrators by 32 bits, the last one first */
+    for (k = order - 1u; k > 0u; k--)
+    {
+      acc = integ[k] + weight[k];
+      for (j = 0u; j < k; j++)
+      {
+        acc += riscv_pdm_jump[k - 1u - j] * integ[j];
+      }
+      integ[k] = acc;
+    }
+    integ[0] += weight[0];
+
+    numWords--;
+
+    if(++count == words)
+    {
+      count = 0u;
+
+      /* combs at the output rate */
+      y = integ[order - 1u];
+      for (k = 0u; k < order; k++)
+      {
+        tmp = y - pComb[k];
+        pComb[k] = y;
+        y = tmp;
+      }
+
+      /* the count of ones y in [0, R^N] is the bipolar value 2 y - R^N */
+      out = (q31_t) (2u * y - S->range);
+      out = (q31_t) ((((q63_t) (out * (1 << S->shift))) * S->gain + 0x80000000LL) >> 32);
+
+#if defined (USE_DSP_RISCV)
+      *pDst++ = (q15_t) clip(out, -32768, 32767);
+#else
+      *pDst++ = (q15_t) __SSAT(out, 16);
+#endif
+      numOut++;
+    }
+  }
+
+  for (k = 0u; k < order; k++)
+  {
+    pInteg[k] = integ[k];
+  }
+  S->count = (uint16_t) count;
+
+  return numOut;
+}
+
+/**
+ * @} end of PDM_decimate group
+ */
@@ -0,0 +1,72 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup PDM_decimate
+ * @{
+ */
+
+/**
+ * @brief  Initialization function for the Q15 PDM to PCM decimator.
+ * @param[in,out] *S         points to an instance of the PDM to PCM decimator structure.
+ * @param[in]     order      order of the CIC, 1 to 5.
+ * @param[in]     R          decimation of the CIC in bits, a multiple of 32.
+ * @param[in]     *pCicState points to the CIC state buffer of 2*order words.
+ * @param[in]     numTaps    number of coefficients of the compensation filter.
+ * @param[in]     M          decimation of the compensation filter.
+ * @param[in]     *pCoeffs   points to the compensation filter coefficients, in time reversed order.
+ * @param[in]     *pFirState points to the FIR state buffer of numTaps+blockSize-1 samples.
+ * @param[in]     *pBuf      points to the buffer of blockSize CIC samples.
+ * @param[in]     blockSize  number of CIC samples per call of the FIR decimator.
+ * @return        RISCV_MATH_SUCCESS, RISCV_MATH_ARGUMENT_ERROR for an invalid CIC
+ * or RISCV_MATH_LENGTH_ERROR if <code>blockSize</code> is not a multiple of <code>M</code>.
+ *
+ * \par
+ * The PCM rate is the bit rate divided by <code>R * M</code>.
+ */
+
+riscv_status riscv_pdm_pcm_init_q15(
+  riscv_pdm_pcm_instance_q15 * S,
+  uint8_t order,
+  uint16_t R,
+  q31_t * pCicState,
+  uint16_t numTaps,
+  uint8_t M,
+  q15_t * pCoeffs,
+  q15_t * pFirState,
+  q15_t * pBuf,
+  uint16_t blockSize)
+{
+  riscv_status status;
+
+  status = riscv_pdm_cic_init_q15(&S->cic, order, R, pCicState);
+  if(status != RISCV_MATH_SUCCESS)
+    return status;
+
+  if(M == 0u || blockSize == 0u)
+    return RISCV_MATH_LENGTH_ERROR;
+
+  status = riscv_fir_decimate_init_q15(&S->fir, numTaps, M, pCoeffs, pFirState, blockSize);
+  if(status != RISCV_MATH_SUCCESS)
+    return status;
+
+  S->pBuf = pBuf;
+  S->blockSize = blockSize;
+  S->fill = 0u;
+
+  return RISCV_MATH_SUCCESS;
+}
+
+/**
+ * @} end of PDM_decimate group
+ */
@@ -0,0 +1,69 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup PDM_decimate
+ * @{
+ */
+
+/**
+ * @brief Processing function for the Q15 PDM to PCM decimator.
+ * @param[in,out] *S        points to an instance of the PDM to PCM decimator structure.
+ * @param[in]     *pSrc     points to the PDM words.
+ * @param[in]     numWords  number of PDM words to process.
+ * @param[out]    *pDst     points to the PCM output.
+ * @return        number of PCM samples written.
+ *
+ * \par
+ * Every <code>R / 32</code> words give one CIC sample, every
+ * <code>blockSize</code> CIC samples give <code>blockSize / M</code> PCM
+ * samples at once. A call may complete a FIR block that earlier calls
+ * started, <code>pDst</code> has to hold the output of every block that
+ * ends in the call.
+ */
+
+uint32_t riscv_pdm_pcm_q15(
+  riscv_pdm_pcm_instance_q15 * S,
+  const uint32_t * pSrc,
+  uint32_t numWords,
+  q15_t * pDst)
+{
+  uint32_t words = S->cic.R >> 5;
+  uint32_t n, numOut = 0u;
+
+  while(numWords > 0u)
+  {
+    /* words up to the end of the FIR block or of the input */
+    n = (S->blockSize - S->fill) * words - S->cic.count;
+    if(n > numWords)
+      n = numWords;
+
+    S->fill += (uint16_t) riscv_pdm_cic_q15(&S->cic, pSrc, &S->pBuf[S->fill], n);
+    pSrc += n;
+    numWords -= n;
+
+    if(S->fill == S->blockSize)
+    {
+      riscv_fir_decimate_q15(&S->fir, S->pBuf, pDst, S->blockSize);
+      pDst += S->blockSize / S->fir.M;
+      numOut += S->blockSize / S->fir.M;
+      S->fill = 0u;
+    }
+  }
+
+  return numOut;
+}
+
+/**
+ * @} end of PDM_decimate group
+ */
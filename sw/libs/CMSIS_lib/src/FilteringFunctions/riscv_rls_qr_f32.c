@@ -0,0 +1,228 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/**
+ * @ingroup groupFilters
+ */
+
+/**
+ * @defgroup RLS_QR QR Recursive Least Squares (QR-RLS) Filters
+ *
+ * RLS filters minimize the exponentially weighted sum of all past squared errors
+ * instead of following the instantaneous gradient like LMS filters. They converge in
+ * about 2 * numTaps samples independently of the eigenvalue spread of the input, which
+ * makes them the filters of choice for equalizers and system identification on
+ * coloured signals.
+ *
+ * The QR variant does not propagate the inverse correlation matrix of conventional RLS,
+ * which loses positive definiteness in single precision. It keeps the upper triangular
+ * Cholesky factor <code>R</code> of the weighted input correlation matrix together with
+ * the rotated reference vector <code>z</code>, the filter coefficients solve
+ * <code>R * b = z</code>. Every new sample appends the row <code>[x' d]</code> to
+ * <code>[R z]</code>, <code>numTaps</code> Givens rotations bring the system back to
+ * triangular form. Rotations are orthogonal, so the update is numerically stable.
+ *
+ * \par Algorithm:
+ * The output signal and the error are computed with the coefficients of the previous
+ * sample, as in the LMS filters:
+ * <pre>
+ *     y[n] = b[0] * x[n] + b[1] * x[n-1] + b[2] * x[n-2] + ...+ b[numTaps-1] * x[n-numTaps+1]
+ *     e[n] = d[n] - y[n]
+ * </pre>
+ * \par
+ * The update scales <code>[R z]</code> by <code>sqrt(lambda)</code> and the new row by
+ * <code>sqrt(1 - lambda)</code>, where <code>lambda</code> is the forgetting factor.
+ * For k = 0, 1, ..., numTaps - 1 a rotation with
+ * <pre>
+ *     r = sqrt(R[k][k]^2 + u[k]^2),  c = R[k][k] / r,  s = u[k] / r
+ * </pre>
+ * zeroes element <code>k</code> of the new row <code>u</code> and is applied to the
+ * remaining elements of row <code>k</code>, to <code>z[k]</code> and to the reference.
+ * Back substitution then yields the new coefficients. Rotations and back substitution
+ * each take <code>numTaps * (numTaps + 1) / 2</code> multiply-accumulates, so a sample
+ * costs O(numTaps^2) operations and <code>numTaps</code> square roots and divisions.
+ *
+ * \par
+ * The scaling by <code>sqrt(1 - lambda)</code> does not change the solution, it turns
+ * <code>R' * R</code> into an average instead of a sum. Since rotations preserve the
+ * norm of every column, no element of <code>R</code> and <code>z</code> exceeds the
+ * largest magnitude of the input and reference signals. This is what allows a Q31
+ * implementation without block scaling. <code>lambda</code> must be below 1.
+ *
+ * \par
+ * <code>pCoeffs</code> and <code>pState</code> follow the conventions of the LMS filters,
+ * coefficients are stored in time reversed order and the state buffer has
+ * <code>numTaps + blockSize - 1</code> samples.
+ * <code>pR</code> points to <code>numTaps * (numTaps + 1) / 2</code> values, the upper
+ * triangle of <code>R</code> row by row, and <code>pZ</code> to <code>numTaps</code> values.
+ *
+ * \par Initialization Functions
+ * The initialization functions set <code>R</code> to <code>delta</code> times the identity
+ * and <code>z</code> to <code>delta</code> times the initial coefficients, the initial
+ * coefficients are the solution until the first samples arrive. <code>delta</code>
+ * regularizes the first updates, its weight decays with <code>lambda^n</code>. Small
+ * values converge faster, for example 0.01 of the expected signal amplitude.
+ *
+ * \par Fixed-Point Behavior:
+ * Input, reference, <code>R</code> and <code>z</code> are Q31 values. As in the LMS
+ * filters, coefficients are scaled by <code>2^-postShift</code>, so that they may exceed
+ * the range <code>[-1 +1)</code>. Coefficients that still overflow saturate.
+ */
+
+/**
+ * @addtogroup RLS_QR
+ * @{
+ */
+
+/**
+ * @brief Processing function for floating-point QR-RLS filter.
+ * @param[in]  *S points to an instance of the floating-point QR-RLS filter structure.
+ * @param[in]  *pSrc points to the block of input data.
+ * @param[in]  *pRef points to the block of reference data.
+ * @param[out] *pOut points to the block of output data.
+ * @param[out] *pErr points to the block of error data.
+ * @param[in]  blockSize number of samples to process.
+ * @return     none.
+ */
+
+void riscv_rls_qr_f32(
+  const riscv_rls_qr_instance_f32 * S,
+  float32_t * pSrc,
+  float32_t * pRef,
+  float32_t * pOut,
+  float32_t * pErr,
+  uint32_t blockSize)
+{
+  float32_t *pState = S->pState;                 /* State pointer */
+  float32_t *pCoeffs = S->pCoeffs;               /* Coefficient pointer */
+  float32_t *pStateCurnt;                        /* Points to the current sample of the state */
+  float32_t *pRow;                               /* Points to the diagonal element of the current row of R */
+  float32_t *pZ = S->pZ;                         /* Rotated reference vector */
+  float32_t *px, *pb, *pu;                       /* Temporary pointers */
+  float32_t u[RISCV_RLS_QR_MAX_TAPS];            /* New row of the system, rotated into R */
+  float32_t sqrtLambda = S->sqrtLambda;
+  float32_t sqrtGain = S->sqrtGain;
+  uint32_t numTaps = S->numTaps;                 /* Number of filter coefficients in the filter */
+  uint32_t tapCnt, blkCnt, k, j;                 /* Loop counters */
+  float32_t sum, e, d, a, r, c, s, cl, sl, t;
+
+  /* pStateCurnt points to the location where the new input data should be written */
+  pStateCurnt = &(S->pState[(numTaps - 1u)]);
+
+  blkCnt = blockSize;
+
+  while(blkCnt > 0u)
+  {
+    /* Copy the new input sample into the state buffer */
+    *pStateCurnt++ = *pSrc++;
+
+    /* Filter output with the current coefficients */
+    px = pState;
+    pb = pCoeffs;
+    sum = 0.0f;
+
+    tapCnt = numTaps;
+    while(tapCnt > 0u)
+    {
+      sum += (*px++) * (*pb++);
+      tapCnt--;
+    }
+
+    d = *pRef++;
+    e = d - sum;
+    *pOut++ = sum;
+    *pErr++ = e;
+
+    /* New row of the system, weighted with sqrt(1 - lambda) */
+    for (k = 0u; k < numTaps; k++)
+    {
+      u[k] = sqrtGain * pState[k];
+    }
+    d = sqrtGain * d;
+
+    /* Rotate the new row into R, one column at a time */
+    pRow = S->pR;
+    for (k = 0u; k < numTaps; k++)
+    {
+      a = sqrtLambda * pRow[0];
+      r = sqrtf(a * a + u[k] * u[k]);
+
+      if (r > 0.0f)
+      {
+        c = a / r;
+        s = u[k] / r;
+      }
+      else
+      {
+        c = 1.0f;
+        s = 0.0f;
+      }
+
+      /* c and s including the scaling of the old row by sqrt(lambda) */
+      cl = c * sqrtLambda;
+      sl = s * sqrtLambda;
+
+      pRow[0] = r;
+      pu = &u[k + 1u];
+      for (j = 1u; j < numTaps - k; j++)
+      {
+        t = pRow[j];
+        pRow[j] = cl * t + s * (*pu);
+        *pu = c * (*pu) - sl * t;
+        pu++;
+      }
+
+      t = pZ[k];
+      pZ[k] = cl * t + s * d;
+      d = c * d - sl * t;
+
+      pRow += numTaps - k;
+    }
+
+    /* Back substitution R * b = z, from the last row up */
+    for (k = numTaps; k > 0u; k--)
+    {
+      pRow -= numTaps - k + 1u;
+      sum = pZ[k - 1u];
+
+      for (j = 1u; j < numTaps - k + 1u; j++)
+      {
+        sum -= pRow[j] * pCoeffs[k - 1u + j];
+      }
+
+      /* keep the previous coefficient if the column has not been excited yet */
+      if (pRow[0] > 0.0f)
+      {
+        pCoeffs[k - 1u] = sum / pRow[0];
+      }
+    }
+
+    /* Advance state pointer by 1 for the next sample */
+    pState = pState + 1;
+
+    blkCnt--;
+  }
+
+  /* Copy the last numTaps - 1 samples to the start of the state buffer */
+  pStateCurnt = S->pState;
+
+  tapCnt = (numTaps - 1u);
+  while(tapCnt > 0u)
+  {
+    *pStateCurnt++ = *pState++;
+    tapCnt--;
+  }
+}
+
+/**
+ * @} end of RLS_QR group
+ */
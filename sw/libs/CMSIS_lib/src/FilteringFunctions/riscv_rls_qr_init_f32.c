@@ -0,0 +1,78 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup RLS_QR
+ * @{
+ */
+
+/**
+ * @brief Initialization function for floating-point QR-RLS filter.
+ * @param[in] *S points to an instance of the floating-point QR-RLS filter structure.
+ * @param[in] numTaps  number of filter coefficients, at most RISCV_RLS_QR_MAX_TAPS.
+ * @param[in] *pCoeffs points to coefficient buffer, holds the initial coefficients.
+ * @param[in] *pState points to state buffer.
+ * @param[in] *pR points to the triangular factor buffer of numTaps * (numTaps + 1) / 2 values.
+ * @param[in] *pZ points to the reference vector buffer of numTaps values.
+ * @param[in] lambda forgetting factor, 0 < lambda < 1.
+ * @param[in] delta initial diagonal of the triangular factor, delta > 0.
+ * @param[in] blockSize number of samples to process.
+ * @return RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+ */
+
+riscv_status riscv_rls_qr_init_f32(
+  riscv_rls_qr_instance_f32 * S,
+  uint16_t numTaps,
+  float32_t * pCoeffs,
+  float32_t * pState,
+  float32_t * pR,
+  float32_t * pZ,
+  float32_t lambda,
+  float32_t delta,
+  uint32_t blockSize)
+{
+  uint32_t i, j;
+
+  if (numTaps == 0u || numTaps > RISCV_RLS_QR_MAX_TAPS || !(lambda > 0.0f && lambda < 1.0f) || !(delta > 0.0f))
+  {
+    return (RISCV_MATH_ARGUMENT_ERROR);
+  }
+
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->pR = pR;
+  S->pZ = pZ;
+  S->sqrtLambda = sqrtf(lambda);
+  S->sqrtGain = sqrtf(1.0f - lambda);
+
+  /* Clear state buffer and size is always blockSize + numTaps - 1 */
+  memset(pState, 0, (numTaps + (blockSize - 1u)) * sizeof(float32_t));
+
+  /* R = delta * I and z = delta * b, so that the initial coefficients solve R * b = z */
+  for (i = 0u; i < numTaps; i++)
+  {
+    *pR++ = delta;
+    for (j = i + 1u; j < numTaps; j++)
+    {
+      *pR++ = 0.0f;
+    }
+
+    pZ[i] = delta * pCoeffs[i];
+  }
+
+  return (RISCV_MATH_SUCCESS);
+}
+
+/**
+ * @} end of RLS_QR group
+ */
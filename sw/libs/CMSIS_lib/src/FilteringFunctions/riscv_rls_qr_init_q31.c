@@ -0,0 +1,82 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup RLS_QR
+ * @{
+ */
+
+/**
+ * @brief Initialization function for Q31 QR-RLS filter.
+ * @param[in] *S points to an instance of the Q31 QR-RLS filter structure.
+ * @param[in] numTaps  number of filter coefficients, at most RISCV_RLS_QR_MAX_TAPS.
+ * @param[in] *pCoeffs points to coefficient buffer, holds the initial coefficients.
+ * @param[in] *pState points to state buffer.
+ * @param[in] *pR points to the triangular factor buffer of numTaps * (numTaps + 1) / 2 values.
+ * @param[in] *pZ points to the reference vector buffer of numTaps values.
+ * @param[in] lambda forgetting factor, 0 < lambda < 1.
+ * @param[in] delta initial diagonal of the triangular factor, delta > 0.
+ * @param[in] blockSize number of samples to process.
+ * @param[in] postShift bit shift applied to coefficients, at most 30.
+ * @return RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+ */
+
+riscv_status riscv_rls_qr_init_q31(
+  riscv_rls_qr_instance_q31 * S,
+  uint16_t numTaps,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  q31_t * pR,
+  q31_t * pZ,
+  q31_t lambda,
+  q31_t delta,
+  uint32_t blockSize,
+  uint8_t postShift)
+{
+  uint32_t i, j;
+
+  if (numTaps == 0u || numTaps > RISCV_RLS_QR_MAX_TAPS || lambda <= 0 || lambda == 0x7FFFFFFF || delta <= 0 || postShift > 30u)
+  {
+    return (RISCV_MATH_ARGUMENT_ERROR);
+  }
+
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->pR = pR;
+  S->pZ = pZ;
+  S->postShift = postShift;
+
+  riscv_sqrt_q31(lambda, &S->sqrtLambda);
+  riscv_sqrt_q31((q31_t) (0x80000000u - (uint32_t) lambda), &S->sqrtGain);
+
+  /* Clear state buffer and size is always blockSize + numTaps - 1 */
+  memset(pState, 0, (numTaps + (blockSize - 1u)) * sizeof(q31_t));
+
+  /* R = delta * I and z = delta * b, so that the initial coefficients solve R * b = z */
+  for (i = 0u; i < numTaps; i++)
+  {
+    *pR++ = delta;
+    for (j = i + 1u; j < numTaps; j++)
+    {
+      *pR++ = 0;
+    }
+
+    pZ[i] = clip_q63_to_q31(((q63_t) delta * pCoeffs[i]) >> (31u - postShift));
+  }
+
+  return (RISCV_MATH_SUCCESS);
+}
+
+/**
+ * @} end of RLS_QR group
+ */
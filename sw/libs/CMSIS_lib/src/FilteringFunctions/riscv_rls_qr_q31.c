@@ -0,0 +1,202 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/**
+ * @addtogroup RLS_QR
+ * @{
+ */
+
+/**
+ * @brief Computes the square root of a Q62 value in Q31, exactly rounded down.
+ */
+
+static uint32_t riscv_rls_qr_isqrt(
+  uint64_t in)
+{
+  uint64_t root = 0u;
+  uint64_t bit = (uint64_t) 1u << 62;
+
+  while(bit > in)
+  {
+    bit >>= 2;
+  }
+
+  while(bit != 0u)
+  {
+    if(in >= root + bit)
+    {
+      in -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+
+    bit >>= 2;
+  }
+
+  return (root > 0x7FFFFFFFu) ? 0x7FFFFFFFu : (uint32_t) root;
+}
+
+/**
+ * @brief Processing function for Q31 QR-RLS filter.
+ * @param[in]  *S points to an instance of the Q31 QR-RLS filter structure.
+ * @param[in]  *pSrc points to the block of input data.
+ * @param[in]  *pRef points to the block of reference data.
+ * @param[out] *pOut points to the block of output data.
+ * @param[out] *pErr points to the block of error data.
+ * @param[in]  blockSize number of samples to process.
+ * @return     none.
+ *
+ * <b>Scaling and Overflow Behavior:</b>
+ * \par
+ * Rotations and back substitution use 64-bit intermediates. The Givens rotations need
+ * one 64-bit square root and two 64-bit divisions each, the back substitution one
+ * division per coefficient. Output, error and coefficients saturate.
+ */
+
+void riscv_rls_qr_q31(
+  const riscv_rls_qr_instance_q31 * S,
+  q31_t * pSrc,
+  q31_t * pRef,
+  q31_t * pOut,
+  q31_t * pErr,
+  uint32_t blockSize)
+{
+  q31_t *pState = S->pState;                     /* State pointer */
+  q31_t *pCoeffs = S->pCoeffs;                   /* Coefficient pointer */
+  q31_t *pStateCurnt;                            /* Points to the current sample of the state */
+  q31_t *pRow;                                   /* Points to the diagonal element of the current row of R */
+  q31_t *pZ = S->pZ;                             /* Rotated reference vector */
+  q31_t *px, *pb, *pu;                           /* Temporary pointers */
+  q31_t u[RISCV_RLS_QR_MAX_TAPS];                /* New row of the system, rotated into R */
+  q31_t sqrtLambda = S->sqrtLambda;
+  q31_t sqrtGain = S->sqrtGain;
+  uint32_t numTaps = S->numTaps;                 /* Number of filter coefficients in the filter */
+  uint32_t shift = 31u - S->postShift;           /* Shift from the 2.62 accumulator to the output */
+  uint32_t tapCnt, blkCnt, k, j;                 /* Loop counters */
+  q63_t acc;                                     /* Accumulator */
+  q31_t y, e, d, a, r, c, s, cl, sl, t;
+
+  /* pStateCurnt points to the location where the new input data should be written */
+  pStateCurnt = &(S->pState[(numTaps - 1u)]);
+
+  blkCnt = blockSize;
+
+  while(blkCnt > 0u)
+  {
+    /* Copy the new input sample into the state buffer */
+    *pStateCurnt++ = *pSrc++;
+
+    /* Filter output with the current coefficients */
+    px = pState;
+    pb = pCoeffs;
+    acc = 0;
+
+    tapCnt = numTaps;
+    while(tapCnt > 0u)
+    {
+      acc += ((q63_t) (*px++)) * (*pb++);
+      tapCnt--;
+    }
+
+    y = clip_q63_to_q31(acc >> shift);
+    d = *pRef++;
+    e = clip_q63_to_q31((q63_t) d - y);
+    *pOut++ = y;
+    *pErr++ = e;
+
+    /* New row of the system, weighted with sqrt(1 - lambda) */
+    for (k = 0u; k < numTaps; k++)
+    {
+      u[k] = (q31_t) (((q63_t) sqrtGain * pState[k]) >> 31);
+    }
+    d = (q31_t) (((q63_t) sqrtGain * d) >> 31);
+
+    /* Rotate the new row into R, one column at a time */
+    pRow = S->pR;
+    for (k = 0u; k < numTaps; k++)
+    {
+      a = (q31_t) (((q63_t) sqrtLambda * pRow[0]) >> 31);
+      r = (q31_t) riscv_rls_qr_isqrt((uint64_t) ((q63_t) a * a) + (uint64_t) ((q63_t) u[k] * u[k]));
+
+      if (r > 0)
+      {
+        c = clip_q63_to_q31(((q63_t) a * 0x80000000LL) / r);
+        s = clip_q63_to_q31(((q63_t) u[k] * 0x80000000LL) / r);
+      }
+      else
+      {
+        c = 0x7FFFFFFF;
+        s = 0;
+      }
+
+      /* c and s including the scaling of the old row by sqrt(lambda) */
+      cl = (q31_t) (((q63_t) c * sqrtLambda) >> 31);
+      sl = (q31_t) (((q63_t) s * sqrtLambda) >> 31);
+
+      pRow[0] = r;
+      pu = &u[k + 1u];
+      for (j = 1u; j < numTaps - k; j++)
+      {
+        t = pRow[j];
+        pRow[j] = clip_q63_to_q31(((q63_t) cl * t + (q63_t) s * (*pu)) >> 31);
+        *pu = clip_q63_to_q31(((q63_t) c * (*pu) - (q63_t) sl * t) >> 31);
+        pu++;
+      }
+
+      t = pZ[k];
+      pZ[k] = clip_q63_to_q31(((q63_t) cl * t + (q63_t) s * d) >> 31);
+      d = clip_q63_to_q31(((q63_t) c * d - (q63_t) sl * t) >> 31);
+
+      pRow += numTaps - k;
+    }
+
+    /* Back substitution R * b = z in 2.62 format, from the last row up */
+    for (k = numTaps; k > 0u; k--)
+    {
+      pRow -= numTaps - k + 1u;
+      acc = (q63_t) pZ[k - 1u] * ((q63_t) 1 << shift);
+
+      for (j = 1u; j < numTaps - k + 1u; j++)
+      {
+        acc -= (q63_t) pRow[j] * pCoeffs[k - 1u + j];
+      }
+
+      /* keep the previous coefficient if the column has not been excited yet */
+      if (pRow[0] > 0)
+      {
+        pCoeffs[k - 1u] = clip_q63_to_q31(acc / pRow[0]);
+      }
+    }
+
+    /* Advance state pointer by 1 for the next sample */
+    pState = pState + 1;
+
+    blkCnt--;
+  }
+
+  /* Copy the last numTaps - 1 samples to the start of the state buffer */
+  pStateCurnt = S->pState;
+
+  tapCnt = (numTaps - 1u);
+  while(tapCnt > 0u)
+  {
+    *pStateCurnt++ = *pState++;
+    tapCnt--;
+  }
+}
+
+/**
+ * @} end of RLS_QR group
+ */
@@ -0,0 +1,80 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Dispatch table of the multiversioned kernels.
+
+#include "riscv_mv.h"
+#include "cpu_features.h"
+
+// the variants CMakeLists.txt compiled into the image
+#ifdef RISCV_MV_NO_XPULP
+#define RISCV_MV_BUILT_XPULP  0
+#else
+#define RISCV_MV_BUILT_XPULP  RISCV_MV_XPULP
+#endif
+
+#ifdef RISCV_MV_NO_FPU
+#define RISCV_MV_BUILT_FPU    0
+#else
+#define RISCV_MV_BUILT_FPU    RISCV_MV_FPU
+#endif
+
+riscv_mv_table_t riscv_mv = {
+  .dot_prod_q7  = riscv_dot_prod_q7_base,
+  .dot_prod_q15 = riscv_dot_prod_q15_base,
+  .mult_q15     = riscv_mult_q15_base,
+  .add_q15      = riscv_add_q15_base,
+  .fir_q15      = riscv_fir_q15_base,
+  .dot_prod_f32 = riscv_dot_prod_f32_base,
+  .mult_f32     = riscv_mult_f32_base,
+  .add_f32      = riscv_add_f32_base,
+};
+
+unsigned int riscv_mv_variants;
+
+unsigned int riscv_mv_select(unsigned int features) {
+  unsigned int v = features & (RISCV_MV_BUILT_XPULP | RISCV_MV_BUILT_FPU);
+
+  riscv_mv.dot_prod_q7  = riscv_dot_prod_q7_base;
+  riscv_mv.dot_prod_q15 = riscv_dot_prod_q15_base;
+  riscv_mv.mult_q15     = riscv_mult_q15_base;
+  riscv_mv.add_q15      = riscv_add_q15_base;
+  riscv_mv.fir_q15      = riscv_fir_q15_base;
+  riscv_mv.dot_prod_f32 = riscv_dot_prod_f32_base;
+  riscv_mv.mult_f32     = riscv_mult_f32_base;
+  riscv_mv.add_f32      = riscv_add_f32_base;
+
+#ifndef RISCV_MV_NO_XPULP
+  if (v & RISCV_MV_XPULP) {
+    riscv_mv.dot_prod_q7  = riscv_dot_prod_q7_xpulp;
+    riscv_mv.dot_prod_q15 = riscv_dot_prod_q15_xpulp;
+    riscv_mv.mult_q15     = riscv_mult_q15_xpulp;
+    riscv_mv.add_q15      = riscv_add_q15_xpulp;
+    riscv_mv.fir_q15      = riscv_fir_q15_xpulp;
+  }
+#endif
+
+#ifndef RISCV_MV_NO_FPU
+  if (v & RISCV_MV_FPU) {
+    riscv_mv.dot_prod_f32 = riscv_dot_prod_f32_fpu;
+    riscv_mv.mult_f32     = riscv_mult_f32_fpu;
+    riscv_mv.add_f32      = riscv_add_f32_fpu;
+  }
+#endif
+
+  riscv_mv_variants = v;
+  return v;
+}
+
+// runs from __libc_init_array before main, whenever the table is linked in
+__attribute__((constructor))
+static void riscv_mv_init(void) {
+  riscv_mv_select(cpu_features());
+}
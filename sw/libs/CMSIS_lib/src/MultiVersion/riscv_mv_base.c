@@ -0,0 +1,28 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Plain versions of the multiversioned kernels, they run on every core. The
+// floating point kernels use the soft float routines of libgcc, unless the
+// whole image is built with FPU.
+
+#ifndef RISCV_MATH_NO_DSP
+#define RISCV_MATH_NO_DSP
+#endif
+#define RISCV_MV_VARIANT base
+
+#define riscv_dot_prod_f32  RISCV_MV_NAME(riscv_dot_prod_f32, RISCV_MV_VARIANT)
+#define riscv_mult_f32      RISCV_MV_NAME(riscv_mult_f32,     RISCV_MV_VARIANT)
+#define riscv_add_f32       RISCV_MV_NAME(riscv_add_f32,      RISCV_MV_VARIANT)
+
+#include "riscv_mv_variant.h"
+
+#include "../BasicMathFunctions/riscv_dot_prod_f32.c"
+#include "../BasicMathFunctions/riscv_mult_f32.c"
+#include "../BasicMathFunctions/riscv_add_f32.c"
@@ -0,0 +1,80 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// FPU versions of the floating point kernels of riscv_mv.h.
+//
+// The file is compiled with the flags of the image and only the assembler
+// accepts the F extension, so the versions are written in inline assembly and
+// work in soft float images. They use ft0 to ft2, which are temporaries in
+// the hard float calling convention as well. Products and sums are rounded
+// separately, in the order of the plain versions, so results are identical.
+
+#include "riscv_mv.h"
+
+void riscv_dot_prod_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, uint32_t blockSize, float32_t* result)
+{
+  asm volatile (
+    "  fmv.s.x ft0, zero\n"
+    "  beqz    %[n], 2f\n"
+    "1:\n"
+    "  flw     ft1, 0(%[a])\n"
+    "  flw     ft2, 0(%[b])\n"
+    "  addi    %[a], %[a], 4\n"
+    "  addi    %[b], %[b], 4\n"
+    "  fmul.s  ft1, ft1, ft2\n"
+    "  addi    %[n], %[n], -1\n"
+    "  fadd.s  ft0, ft0, ft1\n"
+    "  bnez    %[n], 1b\n"
+    "2:\n"
+    "  fsw     ft0, 0(%[r])\n"
+    : [a] "+r" (pSrcA), [b] "+r" (pSrcB), [n] "+r" (blockSize)
+    : [r] "r" (result)
+    : "memory");
+}
+
+void riscv_mult_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize)
+{
+  asm volatile (
+    "  beqz    %[n], 2f\n"
+    "1:\n"
+    "  flw     ft1, 0(%[a])\n"
+    "  flw     ft2, 0(%[b])\n"
+    "  addi    %[a], %[a], 4\n"
+    "  addi    %[b], %[b], 4\n"
+    "  fmul.s  ft0, ft1, ft2\n"
+    "  addi    %[n], %[n], -1\n"
+    "  fsw     ft0, 0(%[d])\n"
+    "  addi    %[d], %[d], 4\n"
+    "  bnez    %[n], 1b\n"
+    "2:\n"
+    : [a] "+r" (pSrcA), [b] "+r" (pSrcB), [d] "+r" (pDst), [n] "+r" (blockSize)
+    :
+    : "memory");
+}
+
+void riscv_add_f32_fpu(float32_t* pSrcA, float32_t* pSrcB, float32_t* pDst, uint32_t blockSize)
+{
+  asm volatile (
+    "  beqz    %[n], 2f\n"
+    "1:\n"
+    "  flw     ft1, 0(%[a])\n"
+    "  flw     ft2, 0(%[b])\n"
+    "  addi    %[a], %[a], 4\n"
+    "  addi    %[b], %[b], 4\n"
+    "  fadd.s  ft0, ft1, ft2\n"
+    "  addi    %[n], %[n], -1\n"
+    "  fsw     ft0, 0(%[d])\n"
+    "  addi    %[d], %[d], 4\n"
+    "  bnez    %[n], 1b\n"
+    "2:\n"
+    : [a] "+r" (pSrcA), [b] "+r" (pSrcB), [d] "+r" (pDst), [n] "+r" (blockSize)
+    :
+    : "memory");
+}
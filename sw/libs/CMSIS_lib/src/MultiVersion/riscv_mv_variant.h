@@ -0,0 +1,32 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Compiles the integer kernels of riscv_mv.h once more, with _<variant>
+// appended to their names. The including file sets RISCV_MV_VARIANT, the
+// instruction set comes from the flags CMakeLists.txt gives it.
+
+#ifndef RISCV_MV_VARIANT
+#error "RISCV_MV_VARIANT has to be defined"
+#endif
+
+#define RISCV_MV_PASTE(name, variant)  name ## _ ## variant
+#define RISCV_MV_NAME(name, variant)   RISCV_MV_PASTE(name, variant)
+
+#define riscv_dot_prod_q7   RISCV_MV_NAME(riscv_dot_prod_q7,  RISCV_MV_VARIANT)
+#define riscv_dot_prod_q15  RISCV_MV_NAME(riscv_dot_prod_q15, RISCV_MV_VARIANT)
+#define riscv_mult_q15      RISCV_MV_NAME(riscv_mult_q15,     RISCV_MV_VARIANT)
+#define riscv_add_q15       RISCV_MV_NAME(riscv_add_q15,      RISCV_MV_VARIANT)
+#define riscv_fir_q15       RISCV_MV_NAME(riscv_fir_q15,      RISCV_MV_VARIANT)
+
+#include "../BasicMathFunctions/riscv_dot_prod_q7.c"
+#include "../BasicMathFunctions/riscv_dot_prod_q15.c"
+#include "../BasicMathFunctions/riscv_mult_q15.c"
+#include "../BasicMathFunctions/riscv_add_q15.c"
+#include "../FilteringFunctions/riscv_fir_q15.c"
@@ -0,0 +1,16 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Versions using the PULP extensions, compiled for IMXpulpv2 even if the rest
+// of the library takes the plain paths.
+
+#undef RISCV_MATH_NO_DSP
+#define RISCV_MV_VARIANT xpulp
+#include "riscv_mv_variant.h"
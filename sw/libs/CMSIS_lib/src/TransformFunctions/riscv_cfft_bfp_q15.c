@@ -0,0 +1,308 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/*
+ * A radix-2 butterfly grows a component by at most 1 + 2 * sqrt(2) / 2 < 2.83,
+ * so a block whose largest magnitude fits in RISCV_BFP_BITS bits can not
+ * overflow in the next stage.
+ */
+#define RISCV_BFP_BITS  13
+
+/**
+ * @brief  Number of bits of the largest magnitude in a block of Q15 values.
+ * @param[in]  *pSrc points to the block.
+ * @param[in]  blockSize number of values.
+ * @return     0 for an all zero block, up to 15.
+ *
+ * The magnitudes are taken as one's complement, x ^ (x >> 15), and ORed, so
+ * the scan needs neither compares nor branches. -32768 counts as 15 bits.
+ */
+
+uint32_t riscv_bfp_bits_q15(
+  const q15_t * pSrc,
+  uint32_t blockSize)
+{
+  uint32_t acc = 0u;
+  int32_t in;
+
+  while(blockSize > 0u)
+  {
+    in = *pSrc++;
+    acc |= (uint32_t) (in ^ (in >> 31));
+    blockSize--;
+  }
+
+  return (acc == 0u) ? 0u : 32u - __builtin_clz(acc);
+}
+
+/**
+ * @brief  In place bit reversal of a block of complex Q15 values.
+ */
+
+static void riscv_bfp_bitreversal_q15(
+  q15_t * pSrc,
+  uint32_t fftLen)
+{
+  uint32_t i, j, k;
+  q31_t *pWord = (q31_t *) pSrc;
+  q31_t tmp;
+
+  j = 0u;
+  for (i = 0u; i < fftLen - 1u; i++)
+  {
+    if(i < j)
+    {
+      /* one complex value is one word */
+      tmp = pWord[i];
+      pWord[i] = pWord[j];
+      pWord[j] = tmp;
+    }
+
+    k = fftLen >> 1;
+    while(k <= j)
+    {
+      j -= k;
+      k >>= 1;
+    }
+    j += k;
+  }
+}
+
+/**
+ * @addtogroup ComplexFFT
+ * @{
+ */
+
+/**
+ * @brief Processing function for the block floating point Q15 complex FFT.
+ * @param[in]      *S    points to an instance of the Q15 CFFT structure.
+ * @param[in, out] *p1   points to the word aligned complex data buffer of size <code>2*fftLen</code>. Processing occurs in-place.
+ * @param[in]     ifftFlag       flag that selects forward (ifftFlag=0) or inverse (ifftFlag=1) transform.
+ * @param[in]     bitReverseFlag flag that enables (bitReverseFlag=1) or disables (bitReverseFlag=0) bit reversal of output.
+ * @return        block exponent of the result.
+ *
+ * \par
+ * riscv_cfft_q15 halves the data in every stage whatever the signal level is,
+ * small signals lose one bit of precision per stage. This version keeps the
+ * block in Q15 with a common exponent instead. The input is first scaled up
+ * until its largest magnitude has 13 bits. Every stage then shifts its inputs
+ * right only as far as needed to keep them within 13 bits. The butterflies
+ * collect the headroom of their outputs on the fly, so no extra pass over
+ * the data is needed.
+ *
+ * \par
+ * The result is the unnormalized transform, <code>X[k] = p1[k] * 2^exp</code>
+ * for the returned <code>exp</code>. The inverse transform is not divided
+ * by <code>fftLen</code>. Without bit reversal the result is left in
+ * bit reversed order.
+ *
+ * \par
+ * The same instances as for riscv_cfft_q15 are used, only the twiddle table
+ * is read.
+ *
+ * \par
+ * With the PULP extensions a complex value is one {re, im} word. The scaling,
+ * the sum and the difference of a butterfly are packed adds, subtracts and
+ * shifts on these words, the twiddle multiply is one dot product per
+ * component, and the headroom is collected in a packed OR. The results are
+ * bit identical to the plain version.
+ */
+
+int32_t riscv_cfft_bfp_q15(
+  const riscv_cfft_instance_q15 * S,
+  q15_t * p1,
+  uint8_t ifftFlag,
+  uint8_t bitReverseFlag)
+{
+  uint32_t fftLen = S->fftLen;
+  const q15_t *pCoef = S->pTwiddle;
+  uint32_t n, h, j, k, m, step, bits;
+  uint32_t acc;                                  /* OR of the output magnitudes of a stage */
+  int32_t exp = 0;
+  int32_t shift;
+  q31_t cosVal, sinVal;
+#if defined (USE_DSP_RISCV)
+  shortV A, B, T, W1, W2, vShift, vHalf, vOne, vAcc;
+  q31_t yr, yi;
+#else
+  int32_t round;
+  q31_t ar, ai, br, bi, tr, ti, yr, yi;
+#endif
+
+  bits = riscv_bfp_bits_q15(p1, 2u * fftLen);
+
+  if(bits == 0u)
+  {
+    /* the transform of zero is zero in any order */
+    return 0;
+  }
+
+  if(bits < RISCV_BFP_BITS)
+  {
+    shift = RISCV_BFP_BITS - bits;
+    riscv_shift_q15(p1, (int8_t) shift, p1, 2u * fftLen);
+    exp = -shift;
+    bits = RISCV_BFP_BITS;
+  }
+
+  /* decimation in frequency, n is the length of the sub transforms */
+  step = 1u;
+  for (n = fftLen; n > 1u; n >>= 1)
+  {
+    h = n >> 1;
+
+    shift = (bits > RISCV_BFP_BITS) ? (int32_t) (bits - RISCV_BFP_BITS) : 0;
+    exp += shift;
+
+#if defined (USE_DSP_RISCV)
+
+    /* round(x / 2^shift) = (x >> shift) + bit shift - 1 of x, no lane can
+       overflow as x + round could */
+    vShift = pack2(shift, shift);
+    vHalf = pack2(shift > 0 ? shift - 1 : 0, shift > 0 ? shift - 1 : 0);
+    vOne = pack2(shift > 0 ? 1 : 0, shift > 0 ? 1 : 0);
+    vAcc = pack2(0, 0);
+
+    /* the first butterfly of every group has a twiddle factor of one */
+    for (k = 0u; k < fftLen; k += n)
+    {
+      m = k + h;
+
+      A = *(shortV *) &p1[2u * k];
+      B = *(shortV *) &p1[2u * m];
+      A = add2v(sra2(A, vShift), sra2(A, vHalf) & vOne);
+      B = add2v(sra2(B, vShift), sra2(B, vHalf) & vOne);
+
+      T = sub2(A, B);
+      A = add2v(A, B);
+
+      *(shortV *) &p1[2u * k] = A;
+      *(shortV *) &p1[2u * m] = T;
+
+      vAcc |= (A ^ sra2(A, pack2(15, 15))) | (T ^ sra2(T, pack2(15, 15)));
+    }
+
+    for (j = 1u; j < h; j++)
+    {
+      /* (cos, sin) of 2*pi*j/n, the inverse takes the conjugate */
+      cosVal = pCoef[2u * j * step];
+      sinVal = pCoef[2u * j * step + 1u];
+      if(ifftFlag)
+        sinVal = -sinVal;
+
+      /* (tr + j ti) * (cos - j sin) as two dot products */
+      W1 = pack2(cosVal, sinVal);
+      W2 = pack2(-sinVal, cosVal);
+
+      for (k = j; k < fftLen; k += n)
+      {
+        m = k + h;
+
+        A = *(shortV *) &p1[2u * k];
+        B = *(shortV *) &p1[2u * m];
+        A = add2v(sra2(A, vShift), sra2(A, vHalf) & vOne);
+        B = add2v(sra2(B, vShift), sra2(B, vHalf) & vOne);
+
+        T = sub2(A, B);
+        A = add2v(A, B);
+
+        yr = sumdotpv2(T, W1, 0x4000) >> 15;
+        yi = sumdotpv2(T, W2, 0x4000) >> 15;
+        T = pack2(yr, yi);
+
+        *(shortV *) &p1[2u * k] = A;
+        *(shortV *) &p1[2u * m] = T;
+
+        vAcc |= (A ^ sra2(A, pack2(15, 15))) | (T ^ sra2(T, pack2(15, 15)));
+      }
+    }
+
+    acc = (uint16_t) vAcc[0] | (uint16_t) vAcc[1];
+
+#else
+
+    round = (shift > 0) ? (1 << (shift - 1)) : 0;
+    acc = 0u;
+
+    /* the first butterfly of every group has a twiddle factor of one */
+    for (k = 0u; k < fftLen; k += n)
+    {
+      m = k + h;
+
+      ar = (p1[2u * k] + round) >> shift;
+      ai = (p1[2u * k + 1u] + round) >> shift;
+      br = (p1[2u * m] + round) >> shift;
+      bi = (p1[2u * m + 1u] + round) >> shift;
+
+      tr = ar + br;
+      ti = ai + bi;
+      yr = ar - br;
+      yi = ai - bi;
+
+      p1[2u * k] = (q15_t) tr;
+      p1[2u * k + 1u] = (q15_t) ti;
+      p1[2u * m] = (q15_t) yr;
+      p1[2u * m + 1u] = (q15_t) yi;
+
+      acc |= (tr ^ (tr >> 31)) | (ti ^ (ti >> 31)) | (yr ^ (yr >> 31)) | (yi ^ (yi >> 31));
+    }
+
+    for (j = 1u; j < h; j++)
+    {
+      /* (cos, sin) of 2*pi*j/n, the inverse takes the conjugate */
+      cosVal = pCoef[2u * j * step];
+      sinVal = pCoef[2u * j * step + 1u];
+      if(ifftFlag)
+        sinVal = -sinVal;
+
+      for (k = j; k < fftLen; k += n)
+      {
+        m = k + h;
+
+        ar = (p1[2u * k] + round) >> shift;
+        ai = (p1[2u * k + 1u] + round) >> shift;
+        br = (p1[2u * m] + round) >> shift;
+        bi = (p1[2u * m + 1u] + round) >> shift;
+
+        tr = ar - br;
+        ti = ai - bi;
+        ar = ar + br;
+        ai = ai + bi;
+
+        /* (tr + j ti) * (cos - j sin) */
+        yr = (tr * cosVal + ti * sinVal + 0x4000) >> 15;
+        yi = (ti * cosVal - tr * sinVal + 0x4000) >> 15;
+
+        p1[2u * k] = (q15_t) ar;
+        p1[2u * k + 1u] = (q15_t) ai;
+        p1[2u * m] = (q15_t) yr;
+        p1[2u * m + 1u] = (q15_t) yi;
+
+        acc |= (ar ^ (ar >> 31)) | (ai ^ (ai >> 31)) | (yr ^ (yr >> 31)) | (yi ^ (yi >> 31));
+      }
+    }
+
+#endif
+
+    bits = 32u - __builtin_clz(acc | 1u);
+    step <<= 1;
+  }
+
+  if(bitReverseFlag)
+    riscv_bfp_bitreversal_q15(p1, fftLen);
+
+  return exp;
+}
+
+/**
+ * @} end of ComplexFFT group
+ */
@@ -0,0 +1,129 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+extern void riscv_tone_norm(
+  int32_t exponent,
+  uint64_t den,
+  uint32_t * pMul,
+  int32_t * pShift);
+
+/**
+ * @brief  Input scaling that keeps the states of a Goertzel bank bounded.
+ *
+ * The resonator of frequency w has the impulse response sin((n+1) w) / sin(w),
+ * a window of N samples therefore grows the input by at most
+ * min(N / |sin(w)|, N (N + 1) / 2). The shift is the smallest one with
+ * 2^shift at least the largest growth of all tones.
+ */
+
+uint32_t riscv_goertzel_shift(
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  uint32_t windowLen)
+{
+  uint64_t gain, worst = 1u;
+  uint64_t dc = (uint64_t) windowLen * (windowLen + 1u) / 2u;
+  q31_t sinVal;
+  uint32_t i, shift = 0u;
+
+  for (i = 0u; i < numTones; i++)
+  {
+    sinVal = riscv_sin_q31(pFreqs[i]);
+    if(sinVal < 0)
+      sinVal = -sinVal;
+
+    gain = (sinVal == 0) ? dc : ((uint64_t) windowLen << 31) / (uint32_t) sinVal;
+    if(gain > dc)
+      gain = dc;
+
+    if(gain > worst)
+      worst = gain;
+  }
+
+  while(((uint64_t) 1u << shift) < worst)
+  {
+    shift++;
+  }
+
+  return shift;
+}
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief  Initialization function for the Q15 Goertzel filter bank.
+ * @param[in,out] *S        points to an instance of the Q15 Goertzel structure.
+ * @param[in]     numTones  number of tones.
+ * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+ * @param[in]     *pCoeffs  points to the coefficient buffer of numTones words.
+ * @param[in]     *pState   points to the state buffer of numTones words.
+ * @param[in]     windowLen samples per detection window, 2 to 32768.
+ * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+ *
+ * \par
+ * Every coefficient word holds <code>{2 * cos(w), -1}</code>, every state
+ * word <code>{s[n-1], s[n-2]}</code>, both as two 2.14 or 1.15 values.
+ * The input shift is chosen such that no state can overflow, see riscv_goertzel_q15.
+ */
+
+riscv_status riscv_goertzel_init_q15(
+  riscv_goertzel_instance_q15 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  uint32_t windowLen)
+{
+  q31_t cosVal;
+  uint32_t i;
+
+  if(numTones == 0u || windowLen < 2u || windowLen > 32768u)
+    return RISCV_MATH_ARGUMENT_ERROR;
+
+  for (i = 0u; i < numTones; i++)
+  {
+    if(pFreqs[i] <= 0 || pFreqs[i] >= 0x40000000)
+      return RISCV_MATH_ARGUMENT_ERROR;
+  }
+
+  S->numTones = numTones;
+  S->windowLen = windowLen;
+  S->count = 0u;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->shift = (uint16_t) riscv_goertzel_shift(numTones, pFreqs, windowLen);
+
+  for (i = 0u; i < numTones; i++)
+  {
+    /* cos(w) in 1.31 is 2 * cos(w) in 2.30 */
+    cosVal = (riscv_cos_q31(pFreqs[i]) >> 15) + 1;
+    cosVal >>= 1;
+    if(cosVal > 0x7FFF)
+      cosVal = 0x7FFF;
+
+    pCoeffs[i] = (cosVal & 0xFFFF) | (q31_t) 0xC0000000;
+    pState[i] = 0;
+  }
+
+  /* the power is (s1^2 + s2^2 - 2 cos(w) s1 s2) * 2^(2 * shift + 1) / windowLen^2 */
+  riscv_tone_norm(2 * S->shift + 1, (uint64_t) windowLen * windowLen,
+                  &S->normMul, &S->normShift);
+
+  return RISCV_MATH_SUCCESS;
+}
+
+/**
+ * @} end of Goertzel group
+ */
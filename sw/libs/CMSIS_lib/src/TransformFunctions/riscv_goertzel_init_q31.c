@@ -0,0 +1,89 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+extern uint32_t riscv_goertzel_shift(
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  uint32_t windowLen);
+
+extern void riscv_tone_norm(
+  int32_t exponent,
+  uint64_t den,
+  uint32_t * pMul,
+  int32_t * pShift);
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief  Initialization function for the Q31 Goertzel filter bank.
+ * @param[in,out] *S        points to an instance of the Q31 Goertzel structure.
+ * @param[in]     numTones  number of tones.
+ * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+ * @param[in]     *pCoeffs  points to the coefficient buffer of 2*numTones words.
+ * @param[in]     *pState   points to the state buffer of 2*numTones words.
+ * @param[in]     windowLen samples per detection window, 2 to 32768.
+ * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+ *
+ * \par
+ * The coefficients of a tone are <code>{cos(w), sin(w)}</code>, the states
+ * <code>{s[n-1], s[n-2]}</code>, all in 1.31 format. The input shift is the
+ * same as for riscv_goertzel_init_q15.
+ */
+
+riscv_status riscv_goertzel_init_q31(
+  riscv_goertzel_instance_q31 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  uint32_t windowLen)
+{
+  uint32_t i;
+
+  if(numTones == 0u || windowLen < 2u || windowLen > 32768u)
+    return RISCV_MATH_ARGUMENT_ERROR;
+
+  for (i = 0u; i < numTones; i++)
+  {
+    if(pFreqs[i] <= 0 || pFreqs[i] >= 0x40000000)
+      return RISCV_MATH_ARGUMENT_ERROR;
+  }
+
+  S->numTones = numTones;
+  S->windowLen = windowLen;
+  S->count = 0u;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->shift = (uint16_t) riscv_goertzel_shift(numTones, pFreqs, windowLen);
+
+  for (i = 0u; i < numTones; i++)
+  {
+    pCoeffs[2u * i] = riscv_cos_q31(pFreqs[i]);
+    pCoeffs[2u * i + 1u] = riscv_sin_q31(pFreqs[i]);
+    pState[2u * i] = 0;
+    pState[2u * i + 1u] = 0;
+  }
+
+  /* the power is ((s1 - cos(w) s2)^2 + (sin(w) s2)^2) / 16 * 2^(2 * shift - 31) / windowLen^2 */
+  riscv_tone_norm(2 * S->shift - 27, (uint64_t) windowLen * windowLen,
+                  &S->normMul, &S->normShift);
+
+  return RISCV_MATH_SUCCESS;
+}
+
+/**
+ * @} end of Goertzel group
+ */
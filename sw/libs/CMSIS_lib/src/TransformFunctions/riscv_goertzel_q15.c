@@ -0,0 +1,218 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+extern q31_t riscv_tone_power(
+  uint64_t p,
+  uint32_t mul,
+  int32_t shift);
+
+/**
+ * @ingroup groupTransforms
+ */
+
+/**
+ * @defgroup Goertzel Goertzel and Sliding DFT Tone Detection
+ *
+ * Tone detectors for a handful of known frequencies on a continuous stream,
+ * such as DTMF digits, pilot tones or the harmonics of a rotating machine. A
+ * full FFT computes every bin of a block, these compute only the bins asked
+ * for, at a cost per sample that is linear in the number of tones.
+ *
+ * \par Goertzel filter bank
+ * Every tone of frequency <code>w</code> is a second order resonator
+ * <pre>
+ *     s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2]
+ * </pre>
+ * that runs over a window of <code>windowLen</code> samples. At the end of
+ * the window the squared magnitude of the DFT at <code>w</code> is
+ * <pre>
+ *     |X(w)|^2 = s[N-1]^2 + s[N-2]^2 - 2 cos(w) s[N-1] s[N-2]
+ * </pre>
+ * after which the states restart from zero. The frequencies do not have to
+ * be integer bins of the window. Input blocks and windows are independent,
+ * a block may end anywhere in a window or span several windows.
+ *
+ * \par Sliding DFT
+ * The sliding DFT updates the bins of the last <code>windowLen</code> samples
+ * with every new sample,
+ * <pre>
+ *     X[n] = r e^(-jw) X[n-1] + x[n] - (r e^(-jw))^N x[n-N]
+ * </pre>
+ * so the power can be read at any time and not only at the end of a window.
+ * It needs the last <code>windowLen</code> samples as delay line and costs
+ * about twice as much per tone and sample as the Goertzel bank. The damping
+ * <code>r = 1 - 2^-14</code> keeps the rounding errors of the recursion from
+ * accumulating, it weights the window with <code>r^m</code>.
+ *
+ * \par Power
+ * All detectors report the power of a tone as <code>(|X(w)| / N)^2</code> in
+ * 1.31 format, where <code>N</code> is the window length. A full scale sine
+ * at a tone frequency reads 0.25 independent of the window length.
+ */
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief Runs the Goertzel resonators of two tones over a part of a window.
+ */
+
+static void riscv_goertzel_pair_q15(
+  q15_t * pSrc,
+  uint32_t blockSize,
+  uint32_t shift,
+  q31_t * pCoeffs,
+  q31_t * pState)
+{
+#if defined (USE_DSP_RISCV)
+
+  shortV cA = *(shortV *) &pCoeffs[0];           /* {2 cos(wa), -1} */
+  shortV cB = *(shortV *) &pCoeffs[1];           /* {2 cos(wb), -1} */
+  shortV sA = *(shortV *) &pState[0];            /* {s[n-1], s[n-2]} of tone a */
+  shortV sB = *(shortV *) &pState[1];            /* {s[n-1], s[n-2]} of tone b */
+  q31_t xs, accA, accB;
+
+  while(blockSize > 0u)
+  {
+    /* input in 2.14 units of the states, with the rounding of the result */
+    xs = ((((q31_t) *pSrc++) * 16384) >> shift) + 0x2000;
+
+    /* s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2], one dot product per tone */
+    accA = sumdotpv2(sA, cA, xs);
+    accB = sumdotpv2(sB, cB, xs);
+
+    sA = pack2(accA >> 14, sA[0]);
+    sB = pack2(accB >> 14, sB[0]);
+
+    blockSize--;
+  }
+
+  *(shortV *) &pState[0] = sA;
+  *(shortV *) &pState[1] = sB;
+
+#else
+
+  q31_t cA = (q15_t) pCoeffs[0];
+  q31_t cB = (q15_t) pCoeffs[1];
+  q31_t a1 = (q15_t) pState[0], a2 = pState[0] >> 16;
+  q31_t b1 = (q15_t) pState[1], b2 = pState[1] >> 16;
+  q31_t xs, acc;
+
+  while(blockSize > 0u)
+  {
+    xs = ((((q31_t) *pSrc++) * 16384) >> shift) + 0x2000;
+
+    acc = (xs + cA * a1 - a2 * 16384) >> 14;
+    a2 = a1;
+    a1 = acc;
+
+    acc = (xs + cB * b1 - b2 * 16384) >> 14;
+    b2 = b1;
+    b1 = acc;
+
+    blockSize--;
+  }
+
+  pState[0] = (q31_t) (((uint32_t) a1 & 0xFFFFu) | ((uint32_t) a2 << 16));
+  pState[1] = (q31_t) (((uint32_t) b1 & 0xFFFFu) | ((uint32_t) b2 << 16));
+
+#endif
+}
+
+/**
+ * @brief Processing function for the Q15 Goertzel filter bank.
+ * @param[in,out] *S         points to an instance of the Q15 Goertzel structure.
+ * @param[in]     *pSrc      points to the block of input data.
+ * @param[in]     blockSize  number of samples to process.
+ * @param[out]    *pPower    points to the power output, numTones values per window
+ *                           that ends in the block.
+ * @return        number of windows that ended in the block.
+ *
+ * <b>Scaling and Overflow Behavior:</b>
+ * \par
+ * States and coefficients are 16 bit, so the recursion of a tone is a single
+ * packed dot product, and the tones are processed in pairs that share the
+ * input samples. The input is scaled down by <code>2^shift</code>, where
+ * riscv_goertzel_init_q15 chose <code>shift</code> such that the states can not
+ * overflow for any input. A window of 205 samples with tones at or above
+ * 0.08 fs uses a shift of 9. The states are rounded to 16 bit after every
+ * sample, which limits the dynamic range: with this shift a tone 40 dB below
+ * full scale reads within a few dB, much weaker tones read as zero. Use
+ * riscv_goertzel_q31 for more dynamic range.
+ */
+
+uint32_t riscv_goertzel_q15(
+  riscv_goertzel_instance_q15 * S,
+  q15_t * pSrc,
+  uint32_t blockSize,
+  q31_t * pPower)
+{
+  uint32_t numTones = S->numTones;
+  q31_t *pCoeffs = S->pCoeffs;
+  q31_t *pState = S->pState;
+  uint32_t shift = S->shift;
+  uint32_t windows = 0u;
+  uint32_t n, t;
+  q63_t s1, s2, p;
+  q31_t pair[2], coef[2];
+
+  while(blockSize > 0u)
+  {
+    /* samples up to the end of the window or of the block */
+    n = S->windowLen - S->count;
+    if(n > blockSize)
+      n = blockSize;
+
+    for (t = 0u; t + 1u < numTones; t += 2u)
+    {
+      riscv_goertzel_pair_q15(pSrc, n, shift, &pCoeffs[t], &pState[t]);
+    }
+
+    if(t < numTones)
+    {
+      /* an odd tone runs against a copy of itself */
+      pair[0] = pair[1] = pState[t];
+      coef[0] = coef[1] = pCoeffs[t];
+      riscv_goertzel_pair_q15(pSrc, n, shift, coef, pair);
+      pState[t] = pair[0];
+    }
+
+    pSrc += n;
+    blockSize -= n;
+    S->count += n;
+
+    if(S->count == S->windowLen)
+    {
+      for (t = 0u; t < numTones; t++)
+      {
+        s1 = (q15_t) pState[t];
+        s2 = pState[t] >> 16;
+
+        p = s1 * s1 + s2 * s2 - ((((q15_t) pCoeffs[t]) * s1 * s2) >> 14);
+        *pPower++ = (p > 0) ? riscv_tone_power((uint64_t) p, S->normMul, S->normShift) : 0;
+
+        pState[t] = 0;
+      }
+
+      S->count = 0u;
+      windows++;
+    }
+  }
+
+  return windows;
+}
+
+/**
+ * @} end of Goertzel group
+ */
@@ -0,0 +1,135 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+extern q31_t riscv_tone_power(
+  uint64_t p,
+  uint32_t mul,
+  int32_t shift);
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief Processing function for the Q31 Goertzel filter bank.
+ * @param[in,out] *S         points to an instance of the Q31 Goertzel structure.
+ * @param[in]     *pSrc      points to the block of input data.
+ * @param[in]     blockSize  number of samples to process.
+ * @param[out]    *pPower    points to the power output, numTones values per window
+ *                           that ends in the block.
+ * @return        number of windows that ended in the block.
+ *
+ * <b>Scaling and Overflow Behavior:</b>
+ * \par
+ * The input is scaled down by <code>2^shift</code> as in riscv_goertzel_q15,
+ * which keeps the states in 1.31 format. <code>2 cos(w) s[n-1]</code> alone
+ * may exceed this range, the recursion is therefore computed modulo 2^32,
+ * which gives the exact state as long as the state itself fits. The
+ * multiplication by <code>cos(w)</code> is the only rounding, weak tones are
+ * resolved far below the noise floor of the Q15 version. The tones are
+ * processed in pairs that share the input samples.
+ */
+
+uint32_t riscv_goertzel_q31(
+  riscv_goertzel_instance_q31 * S,
+  q31_t * pSrc,
+  uint32_t blockSize,
+  q31_t * pPower)
+{
+  uint32_t numTones = S->numTones;
+  q31_t *pCoeffs = S->pCoeffs;
+  q31_t *pState = S->pState;
+  uint32_t shift = S->shift;
+  uint32_t windows = 0u;
+  uint32_t n, i, t;
+  q31_t *pIn;
+  q31_t cA, cB, a1, a2, b1, b2, x, re, im;
+  uint32_t acc;
+
+  while(blockSize > 0u)
+  {
+    /* samples up to the end of the window or of the block */
+    n = S->windowLen - S->count;
+    if(n > blockSize)
+      n = blockSize;
+
+    for (t = 0u; t < numTones; t += 2u)
+    {
+      /* an odd last tone runs twice */
+      cA = pCoeffs[2u * t];
+      a1 = pState[2u * t];
+      a2 = pState[2u * t + 1u];
+      cB = (t + 1u < numTones) ? pCoeffs[2u * t + 2u] : cA;
+      b1 = (t + 1u < numTones) ? pState[2u * t + 2u] : a1;
+      b2 = (t + 1u < numTones) ? pState[2u * t + 3u] : a2;
+
+      pIn = pSrc;
+      for (i = 0u; i < n; i++)
+      {
+        x = *pIn++ >> shift;
+
+        /* s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2] */
+        acc = (uint32_t) (q31_t) (((q63_t) cA * a1) >> 31);
+        acc = acc + acc - (uint32_t) a2 + (uint32_t) x;
+        a2 = a1;
+        a1 = (q31_t) acc;
+
+        acc = (uint32_t) (q31_t) (((q63_t) cB * b1) >> 31);
+        acc = acc + acc - (uint32_t) b2 + (uint32_t) x;
+        b2 = b1;
+        b1 = (q31_t) acc;
+      }
+
+      pState[2u * t] = a1;
+      pState[2u * t + 1u] = a2;
+      if(t + 1u < numTones)
+      {
+        pState[2u * t + 2u] = b1;
+        pState[2u * t + 3u] = b2;
+      }
+    }
+
+    pSrc += n;
+    blockSize -= n;
+    S->count += n;
+
+    if(S->count == S->windowLen)
+    {
+      for (t = 0u; t < numTones; t++)
+      {
+        a1 = pState[2u * t];
+        a2 = pState[2u * t + 1u];
+
+        /* |X|^2 = (s1 - cos(w) s2)^2 + (sin(w) s2)^2, with two guard bits */
+        re = (q31_t) ((((q63_t) a1 * 0x80000000LL) - (q63_t) pCoeffs[2u * t] * a2) >> 33);
+        im = (q31_t) (((q63_t) pCoeffs[2u * t + 1u] * a2) >> 33);
+
+        *pPower++ = riscv_tone_power((uint64_t) ((q63_t) re * re + (q63_t) im * im),
+                                     S->normMul, S->normShift);
+
+        pState[2u * t] = 0;
+        pState[2u * t + 1u] = 0;
+      }
+
+      S->count = 0u;
+      windows++;
+    }
+  }
+
+  return windows;
+}
+
+/**
+ * @} end of Goertzel group
+ */
@@ -0,0 +1,86 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/*--------------------------------------------------------------------
+*		Internal functions prototypes
+--------------------------------------------------------------------*/
+
+extern void riscv_split_rfft_q15(
+  q15_t * pSrc,
+  uint32_t fftLen,
+  q15_t * pATable,
+  q15_t * pBTable,
+  q15_t * pDst,
+  uint32_t modifier);
+
+extern void riscv_split_rifft_q15(
+  q15_t * pSrc,
+  uint32_t fftLen,
+  q15_t * pATable,
+  q15_t * pBTable,
+  q15_t * pDst,
+  uint32_t modifier);
+
+/**
+ * @addtogroup RealFFT
+ * @{
+ */
+
+/**
+ * @brief Processing function for the block floating point Q15 RFFT/RIFFT.
+ * @param[in]  *S    points to an instance of the Q15 RFFT/RIFFT structure.
+ * @param[in]  *pSrc points to the word aligned input buffer, the forward transform modifies it.
+ * @param[out] *pDst points to the word aligned output buffer.
+ * @return     block exponent of the result.
+ *
+ * \par
+ * Uses riscv_cfft_bfp_q15 for the complex transform, see there. The split
+ * steps of riscv_rfft_q15 halve their result, which is all the headroom they
+ * need, so they are shared unchanged.
+ *
+ * \par
+ * The forward transform returns the unnormalized spectrum,
+ * <code>X[k] = pDst[k] * 2^exp</code>, in the layout of riscv_rfft_q15. The
+ * inverse returns <code>fftLenReal * x[n] = pDst[n] * 2^exp</code>. As for
+ * riscv_rfft_q15 the instance has to enable bit reversal.
+ */
+
+int32_t riscv_rfft_bfp_q15(
+  const riscv_rfft_instance_q15 * S,
+  q15_t * pSrc,
+  q15_t * pDst)
+{
+  uint32_t L2 = S->fftLenReal >> 1;
+  int32_t exp;
+
+  if(S->ifftFlagR == 1u)
+  {
+    riscv_split_rifft_q15(pSrc, L2, S->pTwiddleAReal,
+                          S->pTwiddleBReal, pDst, S->twidCoefRModifier);
+
+    /* the split step halves, the half length inverse halves once more */
+    exp = 2 + riscv_cfft_bfp_q15(S->pCfft, pDst, 1u, S->bitReverseFlagR);
+  }
+  else
+  {
+    exp = 1 + riscv_cfft_bfp_q15(S->pCfft, pSrc, 0u, S->bitReverseFlagR);
+
+    riscv_split_rfft_q15(pSrc, L2, S->pTwiddleAReal,
+                         S->pTwiddleBReal, pDst, S->twidCoefRModifier);
+  }
+
+  return exp;
+}
+
+/**
+ * @} end of RealFFT group
+ */
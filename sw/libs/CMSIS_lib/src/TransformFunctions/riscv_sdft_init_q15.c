@@ -0,0 +1,170 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+extern void riscv_tone_norm(
+  int32_t exponent,
+  uint64_t den,
+  uint32_t * pMul,
+  int32_t * pShift);
+
+/* damping r = 1 - 2^-14 of the sliding DFT in 1.31 format */
+#define RISCV_SDFT_R_Q31  0x7FFE0000
+
+/**
+ * @brief  Rounds a 1.31 value to 1.15 with saturation.
+ */
+
+static q31_t riscv_sdft_round_q15(
+  q63_t in)
+{
+  q63_t out = (in + 0x8000) >> 16;
+
+  return (out > 0x7FFF) ? 0x7FFF : (q31_t) out;
+}
+
+/**
+ * @brief  Packs two 1.15 values into a word, lo in the lower half.
+ */
+
+static q31_t riscv_sdft_pack_q15(
+  q31_t lo,
+  q31_t hi)
+{
+  return (q31_t) (((uint32_t) lo & 0xFFFFu) | ((uint32_t) hi << 16));
+}
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief  Initialization function for the Q15 sliding DFT.
+ * @param[in,out] *S        points to an instance of the Q15 sliding DFT structure.
+ * @param[in]     numTones  number of tones.
+ * @param[in]     *pFreqs   points to the tone frequencies, f / fs in 1.31 format, 0 < f / fs < 0.5.
+ * @param[in]     *pCoeffs  points to the coefficient buffer of 3*numTones words.
+ * @param[in]     *pState   points to the state buffer of numTones words.
+ * @param[in]     *pDelay   points to the delay line of windowLen samples.
+ * @param[in]     windowLen length of the sliding window, 2 to 4096.
+ * @return        RISCV_MATH_SUCCESS or RISCV_MATH_ARGUMENT_ERROR for invalid parameters.
+ *
+ * \par
+ * With <code>W = r e^(-jw)</code> the coefficients of a tone are the words
+ * <code>{Re W, -Im W}</code> and <code>{Im W, Re W}</code>, which give the
+ * real and imaginary part of <code>W X</code> as one dot product each, and
+ * <code>-W^N</code>. <code>W^N</code> is the power of the rounded
+ * <code>W</code>, so that the samples that leave the window cancel their
+ * contribution as far as the rounding of the states allows. The bins and
+ * the delay line are cleared.
+ *
+ * \par
+ * The input is scaled down by <code>2^shift</code> with
+ * <code>shift = ceil(log2(windowLen)) + 1</code>, a bin of the window can
+ * not exceed half of the Q15 range.
+ */
+
+riscv_status riscv_sdft_init_q15(
+  riscv_sdft_instance_q15 * S,
+  uint16_t numTones,
+  const q31_t * pFreqs,
+  q31_t * pCoeffs,
+  q31_t * pState,
+  q15_t * pDelay,
+  uint32_t windowLen)
+{
+  q31_t wr, wi, vr, vi, pr, pi, tmp, rN, r;
+  uint32_t i, e, shift;
+
+  if(numTones == 0u || windowLen < 2u || windowLen > 4096u)
+    return RISCV_MATH_ARGUMENT_ERROR;
+
+  for (i = 0u; i < numTones; i++)
+  {
+    if(pFreqs[i] <= 0 || pFreqs[i] >= 0x40000000)
+      return RISCV_MATH_ARGUMENT_ERROR;
+  }
+
+  shift = 1u;
+  while((1u << (shift - 1u)) < windowLen)
+  {
+    shift++;
+  }
+
+  S->numTones = numTones;
+  S->shift = (uint16_t) shift;
+  S->windowLen = windowLen;
+  S->index = 0u;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->pDelay = pDelay;
+
+  for (i = 0u; i < numTones; i++)
+  {
+    /* W = r (cos(w) - j sin(w)), rounded to 1.15 */
+    wr = riscv_sdft_round_q15((q31_t) (((q63_t) RISCV_SDFT_R_Q31 * riscv_cos_q31(pFreqs[i])) >> 31));
+    wi = -riscv_sdft_round_q15((q31_t) (((q63_t) RISCV_SDFT_R_Q31 * riscv_sin_q31(pFreqs[i])) >> 31));
+
+    /* W^N by repeated squaring, in 1.31 */
+    vr = 0x7FFFFFFF;
+    vi = 0;
+    pr = (q31_t) ((uint32_t) wr << 16);
+    pi = (q31_t) ((uint32_t) wi << 16);
+    for (e = windowLen; e > 0u; e >>= 1)
+    {
+      if(e & 1u)
+      {
+        tmp = (q31_t) (((q63_t) vr * pr - (q63_t) vi * pi) >> 31);
+        vi = (q31_t) (((q63_t) vr * pi + (q63_t) vi * pr) >> 31);
+        vr = tmp;
+      }
+
+      tmp = (q31_t) (((q63_t) pr * pr - (q63_t) pi * pi) >> 31);
+      pi = (q31_t) (((q63_t) 2 * pr * pi) >> 31);
+      pr = tmp;
+    }
+
+    pCoeffs[3u * i] = riscv_sdft_pack_q15(wr, -wi);
+    pCoeffs[3u * i + 1u] = riscv_sdft_pack_q15(wi, wr);
+    pCoeffs[3u * i + 2u] = riscv_sdft_pack_q15(riscv_sdft_round_q15(-(q63_t) vr), riscv_sdft_round_q15(-(q63_t) vi));
+    pState[i] = 0;
+  }
+
+  for (i = 0u; i < windowLen; i++)
+  {
+    pDelay[i] = 0;
+  }
+
+  /* r^N in 1.31 */
+  rN = 0x7FFFFFFF;
+  r = RISCV_SDFT_R_Q31;
+  for (e = windowLen; e > 0u; e >>= 1)
+  {
+    if(e & 1u)
+      rN = (q31_t) (((q63_t) rN * r) >> 31);
+    r = (q31_t) (((q63_t) r * r) >> 31);
+  }
+
+  /*
+   * an on bin tone grows by G = (1 - r^N) / (1 - r) instead of N, with G in
+   * 16.16 format the power is (re^2 + im^2) * 2^(2 * shift + 33) / G^2
+   */
+  riscv_tone_norm(2 * (int32_t) shift + 33, (uint64_t) (((uint32_t) 0x80000000u - (uint32_t) rN) >> 1)
+                  * (((uint32_t) 0x80000000u - (uint32_t) rN) >> 1), &S->normMul, &S->normShift);
+
+  return RISCV_MATH_SUCCESS;
+}
+
+/**
+ * @} end of Goertzel group
+ */
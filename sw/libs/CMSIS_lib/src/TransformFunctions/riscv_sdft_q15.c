@@ -0,0 +1,163 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "riscv_math.h"
+
+extern q31_t riscv_tone_power(
+  uint64_t p,
+  uint32_t mul,
+  int32_t shift);
+
+/**
+ * @addtogroup Goertzel
+ * @{
+ */
+
+/**
+ * @brief Processing function for the Q15 sliding DFT.
+ * @param[in,out] *S         points to an instance of the Q15 sliding DFT structure.
+ * @param[in]     *pSrc      points to the block of input data.
+ * @param[in]     blockSize  number of samples to process.
+ * @return none.
+ *
+ * <b>Scaling and Overflow Behavior:</b>
+ * \par
+ * The samples are rounded to <code>x / 2^shift</code> when they enter and
+ * again when they leave the window, so both see the same value. A bin is one
+ * word <code>{re, im}</code>, and <code>W X</code> is one packed dot product
+ * per component, the new and the leaving sample are added to the same
+ * accumulator. The block is processed in runs that end where the delay line
+ * wraps, within a run the old samples are contiguous.
+ */
+
+void riscv_sdft_q15(
+  riscv_sdft_instance_q15 * S,
+  q15_t * pSrc,
+  uint32_t blockSize)
+{
+  uint32_t numTones = S->numTones;
+  q31_t *pCoeffs = S->pCoeffs;
+  q31_t *pState = S->pState;
+  q15_t *pDelay = S->pDelay;
+  uint32_t shift = S->shift;
+  q31_t round = 1 << (shift - 1u);
+  uint32_t n, i, t;
+  q15_t *pIn, *pOld;
+  q31_t xs, xo, re, im;
+
+#if defined (USE_DSP_RISCV)
+  shortV X, Wa, Wb;
+  q31_t vr, vi;
+#else
+  q31_t Xr, Xi, war, wai, vr, vi;
+#endif
+
+  while(blockSize > 0u)
+  {
+    /* samples up to the wrap of the delay line or the end of the block */
+    n = S->windowLen - S->index;
+    if(n > blockSize)
+      n = blockSize;
+
+    for (t = 0u; t < numTones; t++)
+    {
+      pIn = pSrc;
+      pOld = &pDelay[S->index];
+
+#if defined (USE_DSP_RISCV)
+
+      Wa = *(shortV *) &pCoeffs[3u * t];         /* {Re W, -Im W} */
+      Wb = *(shortV *) &pCoeffs[3u * t + 1u];    /* {Im W, Re W} */
+      vr = (q15_t) pCoeffs[3u * t + 2u];         /* -Re W^N */
+      vi = pCoeffs[3u * t + 2u] >> 16;           /* -Im W^N */
+      X = *(shortV *) &pState[t];
+
+      for (i = 0u; i < n; i++)
+      {
+        xs = ((*pIn++ + round) >> shift) * 32768 + 0x4000;
+        xo = (*pOld++ + round) >> shift;
+
+        /* X = W X + x[n] - W^N x[n-N], x is real */
+        re = sumdotpv2(X, Wa, xs) + vr * xo;
+        im = sumdotpv2(X, Wb, 0x4000) + vi * xo;
+
+        X = pack2(re >> 15, im >> 15);
+      }
+
+      *(shortV *) &pState[t] = X;
+
+#else
+
+      war = (q15_t) pCoeffs[3u * t];
+      wai = (q15_t) pCoeffs[3u * t + 1u];
+      vr = (q15_t) pCoeffs[3u * t + 2u];
+      vi = pCoeffs[3u * t + 2u] >> 16;
+      Xr = (q15_t) pState[t];
+      Xi = pState[t] >> 16;
+
+      for (i = 0u; i < n; i++)
+      {
+        xs = ((*pIn++ + round) >> shift) * 32768 + 0x4000;
+        xo = (*pOld++ + round) >> shift;
+
+        re = Xr * war - Xi * wai + xs + vr * xo;
+        im = Xr * wai + Xi * war + 0x4000 + vi * xo;
+
+        Xr = re >> 15;
+        Xi = im >> 15;
+      }
+
+      pState[t] = (q31_t) (((uint32_t) Xr & 0xFFFFu) | ((uint32_t) Xi << 16));
+
+#endif
+    }
+
+    /* the new samples replace the ones that left the window */
+    for (i = 0u; i < n; i++)
+    {
+      pDelay[S->index + i] = pSrc[i];
+    }
+
+    pSrc += n;
+    blockSize -= n;
+    S->index += n;
+    if(S->index == S->windowLen)
+      S->index = 0u;
+  }
+}
+
+/**
+ * @brief Power of the tones of the Q15 sliding DFT over the last windowLen samples.
+ * @param[in]  *S       points to an instance of the Q15 sliding DFT structure.
+ * @param[out] *pPower  points to the power output of numTones values.
+ * @return none.
+ */
+
+void riscv_sdft_power_q15(
+  const riscv_sdft_instance_q15 * S,
+  q31_t * pPower)
+{
+  uint32_t t;
+  q31_t re, im;
+
+  for (t = 0u; t < S->numTones; t++)
+  {
+    re = (q15_t) S->pState[t];
+    im = S->pState[t] >> 16;
+
+    *pPower++ = riscv_tone_power((uint64_t) (re * re + im * im),
+                                 S->normMul, S->normShift);
+  }
+}
+
+/**
+ * @} end of Goertzel group
+ */
@@ -0,0 +1,90 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "riscv_math.h"
+
+/*
+ * Power normalization shared by the Goertzel and sliding DFT tone detectors.
+ * Their states give the squared bin magnitude as an integer that has to be
+ * multiplied by 2^exponent / den to become a Q31 power. The factor is kept
+ * as a 32 bit mantissa and a shift, so that a window costs one 32 x 32 bit
+ * multiplication per tone and no division.
+ */
+
+/**
+ * @brief  Computes mantissa and shift of 2^exponent / den.
+ * @param[in]  exponent power of two of the numerator.
+ * @param[in]  den      denominator, not zero.
+ * @param[out] *pMul    mantissa, in [2^31, 2^32).
+ * @param[out] *pShift  the factor is *pMul * 2^-*pShift.
+ */
+
+void riscv_tone_norm(
+  int32_t exponent,
+  uint64_t den,
+  uint32_t * pMul,
+  int32_t * pShift)
+{
+  uint64_t mul;
+  int32_t bits = 0;
+
+  while((den >> bits) > 1u)
+  {
+    bits++;
+  }
+  bits++;
+
+  /* den = d * 2^(bits - 32) with d in [2^31, 2^32) */
+  den = (bits > 32) ? (den >> (bits - 32)) : (den << (32 - bits));
+
+  mul = ((uint64_t) 1u << 63) / den;
+  *pMul = (mul > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t) mul;
+  *pShift = 31 + bits - exponent;
+}
+
+/**
+ * @brief  Scales a squared magnitude to a Q31 power.
+ * @param[in]  p      squared magnitude.
+ * @param[in]  mul    mantissa from riscv_tone_norm.
+ * @param[in]  shift  shift from riscv_tone_norm.
+ * @return     power, saturated to 0x7FFFFFFF.
+ */
+
+q31_t riscv_tone_power(
+  uint64_t p,
+  uint32_t mul,
+  int32_t shift)
+{
+  while((p >> 32) != 0u)
+  {
+    p >>= 1;
+    shift--;
+  }
+
+  p = p * mul;
+
+  if(shift >= 64)
+  {
+    return 0;
+  }
+  else if(shift >= 0)
+  {
+    p >>= shift;
+  }
+  else
+  {
+    if(shift <= -32 || (p >> (63 + shift)) != 0u)
+      return 0x7FFFFFFF;
+
+    p <<= -shift;
+  }
+
+  return (p > 0x7FFFFFFFu) ? 0x7FFFFFFF : (q31_t) p;
+}
@@ -17,6 +17,9 @@
 #include <stdint.h>
 #include "cpu_hal.h"
 
+/** Number of test results run_suite publishes in the results region */
+#define BENCH_MAX_RESULTS 32
+
 typedef struct _testresult_t {
   int time;
   int errors;
@@ -47,6 +50,8 @@ void run_benchmark(testcase_t *test, testresult_t *result);
 
 /**
  * @brief Runs a series of benchmarks and prints the results.
+ * The results of the first BENCH_MAX_RESULTS tests are also published as an
+ * array of testresult_t in the results region (see results.h).
  * @param[in] tests an array with the benchmarks to run.
  */
 unsigned int run_suite(testcase_t *tests);
@@ -58,6 +63,18 @@ unsigned int run_suite(testcase_t *tests);
  */
 void check_uint32(testresult_t* result, const char* fail_msg, uint32_t actual, uint32_t expected);
 
+/**
+ * @brief Fills the free part of the stack with a pattern, the start of a
+ * stack usage measurement.
+ */
+void stack_paint(void);
+
+/**
+ * @brief Returns how many bytes of stack below the caller of stack_paint
+ * were used since then, at least 64.
+ */
+unsigned int stack_used(void);
+
 /**
  * @brief Starts all performance counters
  */
@@ -11,6 +11,12 @@
 #include "uart.h"
 #include "gpio.h"
 #include "spr-defs.h"
+#include "results.h"
+#include "cpu_features.h"
+
+// results of the last run_suite, published to the host through the results
+// region so they can be collected without parsing the UART output
+static testresult_t bench_results[BENCH_MAX_RESULTS];
 
 void bench_timer_start(void) {
   set_gpio_pin_value(0, 1);
@@ -83,9 +89,14 @@ unsigned int run_suite(testcase_t *tests)
     run_benchmark(&tests[i], &result);
     print_result(&tests[i], &result);
 
+    if (i < BENCH_MAX_RESULTS)
+      bench_results[i] = result;
+
     errors += result.errors;
   }
 
+  results_publish(bench_results, (num < BENCH_MAX_RESULTS ? num : BENCH_MAX_RESULTS) * sizeof(testresult_t));
+
   print_summary(errors);
 
   return errors;
@@ -99,6 +110,40 @@ void check_uint32(testresult_t* result, const char* fail_msg, uint32_t actual, u
   }
 }
 
+// stack limits from the linker script
+extern char _stack_start[];
+extern char _stack_len[];
+
+#define STACK_PATTERN  0xA5A5A5A5
+
+// stack pointer of the caller of stack_paint
+static uint32_t* stack_top;
+
+void stack_paint(void)
+{
+  uint32_t* p = (uint32_t*)(_stack_start - (unsigned int)_stack_len);
+  uint32_t* end;
+
+  // the frame of this function is not painted, usage below 64 bytes can not
+  // be told apart
+  stack_top = (uint32_t*)__builtin_frame_address(0);
+  end       = stack_top - 16;
+
+  while (p < end)
+    *p++ = STACK_PATTERN;
+}
+
+unsigned int stack_used(void)
+{
+  uint32_t* p   = (uint32_t*)(_stack_start - (unsigned int)_stack_len);
+  uint32_t* end = stack_top - 16;
+
+  while (p < end && *p == STACK_PATTERN)
+    p++;
+
+  return (char*)stack_top - (char*)p;
+}
+
 void perf_print_all(void) {
 #ifdef __riscv__
   printf("Perf CYCLES:   %d\n", cpu_perf_get(0));
@@ -136,6 +181,9 @@ void illegal_insn_handler_c(void)
 {
   unsigned int exception_address, insn;
 #ifdef __riscv__
+  if (cpu_probe_trap())
+    return;
+
   asm("csrr %0, 0x341" : "=r" (exception_address) : );
 #else
   exception_address = mfspr(SPR_EPCR_BASE);
@@ -0,0 +1,128 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Bit-parallel constraint search.
+ *
+ * Finite domain constraint solver for small assignment problems like sudoku,
+ * slot or register allocation. Every variable has up to 32 values kept as a
+ * bitmask, constraints are all-different groups of variables. A group can be
+ * exact, then every value of the group has to be taken by one of its
+ * variables.
+ *
+ * Fixing a variable removes its value from the other members of its groups,
+ * variables left with one value are fixed in turn. In exact groups a value
+ * that only one member can still take fixes that member. The search picks
+ * the variable with the fewest values left and tries them lowest first.
+ *
+ * The search keeps its decisions and the domains it changed on an explicit
+ * stack inside csp_t, so its machine stack usage does not depend on the
+ * problem. Counting values and finding the lowest one use p.cnt and p.ff1
+ * with the PULP extensions.
+ *
+ */
+#ifndef _CSP_H_
+#define _CSP_H_
+
+#include <stdint.h>
+
+#define CSP_MAX_VARS     128
+#define CSP_MAX_GROUPS   64
+/** sum of the group sizes */
+#define CSP_MAX_MEMBERS  512
+/** domain changes along the current search path */
+#define CSP_MAX_TRAIL    1024
+
+#define CSP_SAT     1
+#define CSP_UNSAT   0
+/** the trail overflowed, the problem is too large for this build */
+#define CSP_ERROR  -1
+
+typedef struct {
+  uint32_t nodes;      ///< values tried
+  uint32_t fails;      ///< values that led to a contradiction
+  uint32_t max_depth;  ///< deepest decision stack
+  uint32_t max_trail;  ///< longest trail
+} csp_stats_t;
+
+typedef struct {
+  uint8_t  var;
+  uint8_t  pad;
+  uint16_t mark;  ///< trail length before the decision
+  uint32_t todo;  ///< values not tried yet
+} csp_frame_t;
+
+typedef struct {
+  int         nvars;
+  int         ngroups;
+  int         nmembers;
+  int         depth;     ///< decisions on the stack, -1 before the first solve
+  uint32_t    dom[CSP_MAX_VARS];
+  uint32_t    stamp[CSP_MAX_VARS];   ///< node that last saved the domain
+
+  // groups, members of group g are member[group_start[g] .. group_start[g + 1]]
+  uint16_t    group_start[CSP_MAX_GROUPS + 1];
+  uint8_t     member[CSP_MAX_MEMBERS];
+  uint32_t    group_values[CSP_MAX_GROUPS];  ///< values of exact groups, 0 otherwise
+
+  // groups of each variable, built by the first solve
+  uint16_t    var_start[CSP_MAX_VARS + 1];
+  uint8_t     var_group[CSP_MAX_MEMBERS];
+
+  uint8_t     queue[CSP_MAX_VARS];
+  csp_frame_t frame[CSP_MAX_VARS];
+  uint8_t     trail_var[CSP_MAX_TRAIL];
+  uint32_t    trail_dom[CSP_MAX_TRAIL];
+  int         trail;
+
+  csp_stats_t stats;
+} csp_t;
+
+/**
+ * @brief Sets up nvars variables which can all take the values in domain.
+ * @return -1 if there are too many variables
+ */
+int csp_init(csp_t* c, int nvars, uint32_t domain);
+
+/**
+ * @brief Restricts the values of a variable, e.g. to the given digit of a
+ * sudoku.
+ */
+void csp_restrict(csp_t* c, int var, uint32_t domain);
+
+/**
+ * @brief Adds an all-different group.
+ * @param exact every value the members can take at the first solve has to be
+ *              used by one of them
+ * @return index of the group, -1 if the group limits are exceeded
+ */
+int csp_add_group(csp_t* c, const uint8_t* vars, int n, int exact);
+
+/**
+ * @brief Searches the first solution, afterwards every domain holds exactly
+ * one value.
+ * @return CSP_SAT, CSP_UNSAT or CSP_ERROR
+ */
+int csp_solve(csp_t* c);
+
+/**
+ * @brief Continues the search after a solution, e.g. to check that a puzzle
+ * has only one.
+ */
+int csp_next(csp_t* c);
+
+/**
+ * @brief Bit index of the lowest value of a variable, the value of a solved
+ * variable.
+ */
+int csp_value(const csp_t* c, int var);
+
+#endif
@@ -0,0 +1,332 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "csp.h"
+
+#ifdef PULP_EXT
+static inline int popcount(uint32_t x) {
+  int n;
+  asm ("p.cnt %0, %1" : "=r" (n) : "r" (x));
+  return n;
+}
+
+static inline int ff1(uint32_t x) {
+  int n;
+  asm ("p.ff1 %0, %1" : "=r" (n) : "r" (x));
+  return n;
+}
+#else
+static inline int popcount(uint32_t x) {
+  x = x - ((x >> 1) & 0x55555555);
+  x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+  x = (x + (x >> 4)) & 0x0F0F0F0F;
+  return (x * 0x01010101) >> 24;
+}
+
+static inline int ff1(uint32_t x) {
+  return __builtin_ctz(x);
+}
+#endif
+
+static inline int single(uint32_t d) {
+  return (d & (d - 1)) == 0;
+}
+
+int csp_init(csp_t* c, int nvars, uint32_t domain) {
+  int i;
+
+  if (nvars > CSP_MAX_VARS)
+    return -1;
+
+  c->nvars    = nvars;
+  c->ngroups  = 0;
+  c->nmembers = 0;
+  c->depth    = -1;
+  c->trail    = 0;
+  c->group_start[0] = 0;
+
+  for (i = 0; i < nvars; i++)
+    c->dom[i] = domain;
+
+  return 0;
+}
+
+void csp_restrict(csp_t* c, int var, uint32_t domain) {
+  c->dom[var] &= domain;
+}
+
+int csp_add_group(csp_t* c, const uint8_t* vars, int n, int exact) {
+  int g = c->ngroups;
+  int i;
+
+  if (g == CSP_MAX_GROUPS || c->nmembers + n > CSP_MAX_MEMBERS)
+    return -1;
+
+  for (i = 0; i < n; i++)
+    c->member[c->nmembers++] = vars[i];
+
+  // the values are filled in by csp_solve from the domains at that time
+  c->group_values[g] = exact ? ~0u : 0;
+  c->group_start[++c->ngroups] = c->nmembers;
+
+  return g;
+}
+
+int csp_value(const csp_t* c, int var) {
+  return ff1(c->dom[var]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// propagation
+////////////////////////////////////////////////////////////////////////////////
+
+// changes a domain, saving the old one once per search node
+static int set_dom(csp_t* c, int var, uint32_t d) {
+  if (c->depth > 0 && c->stamp[var] != c->stats.nodes) {
+    if (c->trail == CSP_MAX_TRAIL)
+      return -1;
+
+    c->trail_var[c->trail] = var;
+    c->trail_dom[c->trail] = c->dom[var];
+    c->trail++;
+    c->stamp[var] = c->stats.nodes;
+  }
+
+  c->dom[var] = d;
+  return 0;
+}
+
+static void undo(csp_t* c, int mark) {
+  while (c->trail > mark) {
+    c->trail--;
+    c->dom[c->trail_var[c->trail]] = c->trail_dom[c->trail];
+  }
+}
+
+// removes the value of every queued variable from its peers until nothing
+// changes, returns 0 on a contradiction and -1 on a trail overflow
+static int propagate(csp_t* c, int qt) {
+  const uint8_t* member = c->member;
+  uint32_t* dom = c->dom;
+  uint32_t once, twice, hidden, d;
+  int qh = 0;
+  int x, y, g, i, j;
+
+  for (;;) {
+    while (qh < qt) {
+      x = c->queue[qh++];
+
+      for (i = c->var_start[x]; i < c->var_start[x + 1]; i++) {
+        g = c->var_group[i];
+
+        for (j = c->group_start[g]; j < c->group_start[g + 1]; j++) {
+          y = member[j];
+          if (y == x || (dom[y] & dom[x]) == 0)
+            continue;
+
+          d = dom[y] & ~dom[x];
+          if (d == 0)
+            return 0;
+          if (set_dom(c, y, d))
+            return -1;
+          if (single(d))
+            c->queue[qt++] = y;
+        }
+      }
+    }
+
+    // values only one member of an exact group can still take
+    for (g = 0; g < c->ngroups; g++) {
+      if (c->group_values[g] == 0)
+        continue;
+
+      once  = 0;
+      twice = 0;
+      for (j = c->group_start[g]; j < c->group_start[g + 1]; j++) {
+        d      = dom[member[j]];
+        twice |= once & d;
+        once  |= d;
+      }
+
+      if (once != c->group_values[g])
+        return 0;
+
+      hidden = once & ~twice;
+      if (hidden == 0)
+        continue;
+
+      for (j = c->group_start[g]; j < c->group_start[g + 1]; j++) {
+        y = member[j];
+        d = dom[y] & hidden;
+        if (d == 0 || d == dom[y])
+          continue;
+
+        if (!single(d))
+          return 0;
+        if (set_dom(c, y, d))
+          return -1;
+        c->queue[qt++] = y;
+      }
+    }
+
+    if (qh == qt)
+      return 1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// search
+////////////////////////////////////////////////////////////////////////////////
+
+// unfixed variable with the fewest values, -1 if all are fixed
+static int select_var(csp_t* c) {
+  int best = -1, best_n = 33;
+  int i, n;
+
+  for (i = 0; i < c->nvars; i++) {
+    n = popcount(c->dom[i]);
+
+    if (n > 1 && n < best_n) {
+      best   = i;
+      best_n = n;
+      if (n == 2)
+        break;
+    }
+  }
+
+  return best;
+}
+
+static int search(csp_t* c, int backtrack) {
+  csp_frame_t* f;
+  uint32_t v;
+  int var, r;
+
+  for (;;) {
+    if (!backtrack) {
+      var = select_var(c);
+      if (var < 0)
+        return CSP_SAT;
+
+      f = &c->frame[c->depth++];
+      f->var  = var;
+      f->todo = c->dom[var];
+      f->mark = c->trail;
+
+      if ((uint32_t)c->depth > c->stats.max_depth)
+        c->stats.max_depth = c->depth;
+    }
+    backtrack = 0;
+
+    // next value of the innermost decision, popping exhausted ones
+    for (;;) {
+      if (c->depth == 0) {
+        c->depth = -1;
+        return CSP_UNSAT;
+      }
+
+      f = &c->frame[c->depth - 1];
+      undo(c, f->mark);
+
+      if (f->todo == 0) {
+        c->depth--;
+        continue;
+      }
+
+      v = 1u << ff1(f->todo);
+      f->todo &= ~v;
+
+      c->stats.nodes++;
+      if (set_dom(c, f->var, v))
+        return CSP_ERROR;
+
+      c->queue[0] = f->var;
+      r = propagate(c, 1);
+
+      if ((uint32_t)c->trail > c->stats.max_trail)
+        c->stats.max_trail = c->trail;
+
+      if (r < 0)
+        return CSP_ERROR;
+      if (r > 0)
+        break;
+
+      c->stats.fails++;
+    }
+  }
+}
+
+int csp_solve(csp_t* c) {
+  uint32_t values;
+  int qt = 0;
+  int g, i, j, r;
+
+  // variable to group index, counted first and then filled
+  for (i = 0; i <= c->nvars; i++)
+    c->var_start[i] = 0;
+
+  for (j = 0; j < c->nmembers; j++)
+    c->var_start[c->member[j] + 1]++;
+
+  for (i = 0; i < c->nvars; i++)
+    c->var_start[i + 1] += c->var_start[i];
+
+  for (g = 0; g < c->ngroups; g++) {
+    values = 0;
+
+    for (j = c->group_start[g]; j < c->group_start[g + 1]; j++) {
+      i = c->member[j];
+      c->var_group[c->var_start[i]++] = g;
+      values |= c->dom[i];
+    }
+
+    if (c->group_values[g])
+      c->group_values[g] = values;
+  }
+
+  // filling moved every start to the start of the next variable
+  for (i = c->nvars; i > 0; i--)
+    c->var_start[i] = c->var_start[i - 1];
+  c->var_start[0] = 0;
+
+  c->stats.nodes     = 0;
+  c->stats.fails     = 0;
+  c->stats.max_depth = 0;
+  c->stats.max_trail = 0;
+  c->depth = 0;
+  c->trail = 0;
+
+  for (i = 0; i < c->nvars; i++) {
+    c->stamp[i] = 0;
+
+    if (c->dom[i] == 0) {
+      c->depth = -1;
+      return CSP_UNSAT;
+    }
+
+    if (single(c->dom[i]))
+      c->queue[qt++] = i;
+  }
+
+  r = propagate(c, qt);
+  if (r <= 0) {
+    c->depth = -1;
+    return r < 0 ? CSP_ERROR : CSP_UNSAT;
+  }
+
+  return search(c, 0);
+}
+
+int csp_next(csp_t* c) {
+  if (c->depth < 0)
+    return CSP_UNSAT;
+
+  return search(c, 1);
+}
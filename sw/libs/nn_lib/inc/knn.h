@@ -0,0 +1,73 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief k nearest neighbour classifier on q15 or q7 vectors.
+ *
+ * Squared distances to the reference vectors are expanded the same way as
+ * in svm.h, one packed dot product per reference vector with the norms
+ * computed once by knn_init_*. The k nearest references are kept in a top-k
+ * heap (topk.h) and vote for their labels, a tie goes to the class with the
+ * nearest reference among the tied ones. A batch of feature vectors is
+ * processed two at a time.
+ *
+ * All vectors have to have a norm below 1.0.
+ *
+ */
+#ifndef _KNN_H_
+#define _KNN_H_
+
+#include <stdint.h>
+
+#include "topk.h"
+
+/** Most classes, votes are counted on the stack */
+#define KNN_MAX_CLASS  32
+
+typedef struct {
+  const void*    ref;     // n x dim reference vectors, q15 or q7
+  const uint8_t* label;   // n labels
+  int32_t*       norm;    // half squared norms of the references
+  topk_item_t*   heap;    // 2 x k nearest references
+  int            n;
+  int            dim;
+  int            nclass;
+  int            k;
+  int            q7;
+} knn_t;
+
+unsigned int knn_size(int n, int k);
+
+/**
+ * @brief Sets up a classifier, which keeps pointers to ref and label.
+ * @param ref    word aligned, n x dim
+ * @param dim    features per vector, a multiple of 2 (q15) or 4 (q7)
+ * @param nclass labels are below nclass, at most KNN_MAX_CLASS
+ * @param k      neighbours that vote, 1 to n and at most 65535
+ * @param mem    word aligned memory of knn_size bytes
+ * @return 0 on success, -1 for invalid sizes or a reference with a norm of
+ * 1.0 or above
+ */
+int knn_init_q15(knn_t* c, const int16_t* ref, const uint8_t* label, int n, int dim,
+                 int nclass, int k, void* mem);
+int knn_init_q7(knn_t* c, const int8_t* ref, const uint8_t* label, int n, int dim,
+                int nclass, int k, void* mem);
+
+/**
+ * @brief Classifies nx feature vectors of the element type the classifier
+ * was set up with.
+ * @param x word aligned, nx x dim
+ * @return 0 on success, -1 if the element type does not match
+ */
+int knn_classify_q15(const knn_t* c, const int16_t* x, int nx, uint8_t* labels);
+int knn_classify_q7(const knn_t* c, const int8_t* x, int nx, uint8_t* labels);
+
+#endif
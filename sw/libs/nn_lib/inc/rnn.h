@@ -0,0 +1,132 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Quantized LSTM and GRU cells on q15 or q7 vectors.
+ *
+ * The cells follow the usual (PyTorch) equations, gates i, f, g, o for the
+ * LSTM and r, z, n for the GRU:
+ *
+ *   LSTM  c = f * c + i * g           GRU  n = tanh(W_in x + b_in + r * (W_hn h + b_hn))
+ *         h = o * tanh(c)                  h = (1 - z) * n + z * h
+ *
+ * The input and recurrent weights of all gates of a hidden unit are packed
+ * by rnn_pack_* into one stream, so a time step computes the gates of a unit
+ * in one pass over x and h: every word of x and h is loaded once and feeds
+ * one packed dot product (sdotsp2 for q15, sdotsp4 for q7) per gate. Right
+ * after the gates of a unit are known its cell state is updated in place
+ * and its new hidden value goes to a scratch row, which replaces h at the
+ * end of the step. No gate vector is ever stored.
+ *
+ * sigmoid and tanh come from one 193 entry tanh table over [0, 6) with
+ * linear interpolation, sigmoid(x) = (1 + tanh(x / 2)) / 2. Both are within
+ * 4 LSB of Q15.
+ *
+ * Formats: x and h are Q15 (q15 cells) or Q7 (q7 cells), the LSTM cell
+ * state is Q11 in 16 bit for both. A weight w is stored as w * 2^(15 - wexp)
+ * (q15) or w * 2^(7 - wexp) (q7), so |w| has to stay below 2^wexp. The
+ * biases are int32 in Q12, the format of the gate pre-activations.
+ *
+ * wexp also has to bound the pre-activations. The dot products of a gate,
+ * W x + U h without the bias, add up in an int32 at 2^(30 - wexp) (q15) or
+ * 2^(14 - wexp) (q7) and wrap without notice once |W x + U h| reaches
+ * 2^(wexp + 1) (q15) or 2^(wexp + 17) (q7). As |x| and |h| stay below 1, a
+ * sum of |w| over every weight row below that limit is enough. The GRU keeps
+ * W_hn h apart from W_in x, each has to stay in range. After the bias the
+ * pre-activations saturate at +-16.
+ *
+ * Cost: a unit takes one load of x or h and one weight load and dot product
+ * per gate for every word of x and h, plus about 40 instructions for the
+ * activations and the state update. With nw = nx / 2 + nh / 2 words (q15)
+ * or nx / 4 + nh / 4 words (q7), an LSTM step is about nh (9 nw + 40)
+ * instructions and a GRU step about nh (7 nw + 40). nn_tests/rnn prints the
+ * cycles per time step for a range of hidden sizes.
+ *
+ */
+#ifndef _RNN_H_
+#define _RNN_H_
+
+#include <stdint.h>
+
+typedef struct {
+  const void*    w;       // packed weights from rnn_pack_*
+  const int32_t* bias;    // 4 x nh, gate major, Q12
+  void*          h;       // nh hidden values, q15 or q7
+  int16_t*       c;       // nh LSTM cell states, Q11, NULL for a GRU
+  void*          hnew;    // nh new hidden values of the current step
+  int            nx;
+  int            nh;
+  int            gru;     // 1 for a GRU, 0 for an LSTM
+  int            q7;      // 1 for q7 vectors, 0 for q15
+  int            shift;   // dot products right shifted by this are Q12
+} rnn_t;
+
+/** Elements of the packed weights of a cell, 4 (LSTM) or 3 (GRU) x nh x (nx + nh) */
+unsigned int rnn_packed_len(int gru, int nx, int nh);
+
+unsigned int rnn_size(int nh);
+
+/**
+ * @brief Packs the weights of a cell for rnn_step_*.
+ *
+ * w_ih and w_hh are the row major input and recurrent weight matrices with
+ * the gates stacked as in PyTorch, i f g o (LSTM) or r z n (GRU), so w_ih
+ * has 4 nh (or 3 nh) rows of nx weights and w_hh as many rows of nh weights.
+ *
+ * @param packed word aligned, rnn_packed_len elements
+ * @return 0 on success, -1 if nx or nh is not a multiple of 2 (q15) or 4 (q7)
+ */
+int rnn_pack_lstm_q15(const int16_t* w_ih, const int16_t* w_hh, int nx, int nh, int16_t* packed);
+int rnn_pack_lstm_q7(const int8_t* w_ih, const int8_t* w_hh, int nx, int nh, int8_t* packed);
+int rnn_pack_gru_q15(const int16_t* w_ih, const int16_t* w_hh, int nx, int nh, int16_t* packed);
+int rnn_pack_gru_q7(const int8_t* w_ih, const int8_t* w_hh, int nx, int nh, int8_t* packed);
+
+/**
+ * @brief Sets up a cell, which keeps pointers to its weights, biases and state.
+ *
+ * The LSTM biases are b_ih + b_hh of the gates i, f, g and o. The GRU biases
+ * are b_ir + b_hr, b_iz + b_hz, b_in and b_hn, the last two are separate
+ * because r only scales the recurrent part of n. The state is not cleared,
+ * see rnn_reset.
+ *
+ * @param w    packed weights
+ * @param bias 4 x nh, gate major
+ * @param wexp weight exponent, 0 to 7
+ * @param h    word aligned, nh
+ * @param c    nh
+ * @param mem  word aligned memory of rnn_size bytes
+ * @return 0 on success, -1 for invalid sizes or exponents
+ */
+int lstm_init_q15(rnn_t* r, const int16_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                  int16_t* h, int16_t* c, void* mem);
+int lstm_init_q7(rnn_t* r, const int8_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                 int8_t* h, int16_t* c, void* mem);
+int gru_init_q15(rnn_t* r, const int16_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                 int16_t* h, void* mem);
+int gru_init_q7(rnn_t* r, const int8_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                int8_t* h, void* mem);
+
+/** Clears the hidden and cell state */
+void rnn_reset(rnn_t* r);
+
+/**
+ * @brief Advances a cell by n time steps, updating its state in place.
+ * @param x n x nx inputs, every row word aligned
+ * @return 0 on success, -1 if the element type does not match
+ */
+int rnn_step_q15(rnn_t* r, const int16_t* x, int n);
+int rnn_step_q7(rnn_t* r, const int8_t* x, int n);
+
+/** tanh and sigmoid of a Q12 value, in Q15 */
+int16_t rnn_tanh(int32_t x);
+int16_t rnn_sigmoid(int32_t x);
+
+#endif
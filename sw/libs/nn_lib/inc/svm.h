@@ -0,0 +1,86 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief RBF support vector machine on q15 or q7 vectors.
+ *
+ * The support vectors are stored packed, two q15 or four q7 values per word,
+ * and the squared distance to a feature vector is expanded into
+ * |x|^2 + |s|^2 - 2 x.s. The norms of the support vectors are computed once
+ * by svm_init_*, so classifying only takes one dot product per support
+ * vector, done with the packed dot product instructions where available.
+ * exp(-gamma d^2) comes from a 257 entry table with linear interpolation
+ * that covers gamma d^2 < 8, the kernel is 0 beyond.
+ *
+ * A batch of feature vectors is classified two at a time, every word of a
+ * support vector is loaded once for both.
+ *
+ * Vectors are fractions. The features have to be scaled so that every
+ * feature and support vector has a norm below 1.0, and gamma scaled by the
+ * inverse square of that factor. The dual coefficients and the biases are
+ * scaled by a common factor so that sum |coef| + |bias| stays below 1.0 for
+ * every class, which changes neither the sign nor the order of the
+ * decision values.
+ *
+ */
+#ifndef _SVM_H_
+#define _SVM_H_
+
+#include <stdint.h>
+
+typedef struct {
+  const void*    sv;      // nsv x dim support vectors, q15 or q7
+  const int16_t* coef;    // nclass x nsv dual coefficients y_i alpha_i, Q15
+  const int32_t* bias;    // nclass biases, Q30
+  int32_t*       norm;    // half squared norms of the support vectors
+  int16_t*       kern;    // kernel values of two feature vectors
+  int            nsv;
+  int            dim;
+  int            nclass;
+  int            q7;      // 1 for q7 vectors, 0 for q15
+  uint32_t       gamma;   // Q16
+} svm_t;
+
+unsigned int svm_size(int nsv);
+
+/**
+ * @brief Sets up a classifier, which keeps pointers to sv, coef and bias.
+ *
+ * nclass is 1 for a binary classifier, whose label is 1 for a non-negative
+ * decision value and 0 otherwise, or the number of one-vs-rest classes,
+ * whose label is the class with the largest decision value.
+ *
+ * @param sv    word aligned, nsv x dim
+ * @param nsv   number of support vectors, even
+ * @param coef  word aligned, nclass x nsv
+ * @param dim   features per vector, a multiple of 2 (q15) or 4 (q7)
+ * @param gamma kernel width in Q16, for vectors scaled as described above
+ * @param mem   word aligned memory of svm_size bytes
+ * @return 0 on success, -1 for invalid sizes or a support vector with a
+ * norm of 1.0 or above
+ */
+int svm_init_q15(svm_t* s, const int16_t* sv, int nsv, int dim, const int16_t* coef,
+                 const int32_t* bias, int nclass, uint32_t gamma, void* mem);
+int svm_init_q7(svm_t* s, const int8_t* sv, int nsv, int dim, const int16_t* coef,
+                const int32_t* bias, int nclass, uint32_t gamma, void* mem);
+
+/**
+ * @brief Classifies n feature vectors of the element type the classifier was
+ * set up with.
+ * @param x        word aligned, n x dim
+ * @param labels   n labels
+ * @param decision n x nclass decision values in Q30, or NULL
+ * @return 0 on success, -1 if the element type does not match
+ */
+int svm_classify_q15(const svm_t* s, const int16_t* x, int n, uint8_t* labels, int32_t* decision);
+int svm_classify_q7(const svm_t* s, const int8_t* x, int n, uint8_t* labels, int32_t* decision);
+
+#endif
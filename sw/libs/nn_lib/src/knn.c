@@ -0,0 +1,147 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "knn.h"
+#include "nn_dot.h"
+
+unsigned int knn_size(int n, int k)
+{
+  return n * sizeof(int32_t) + 2 * k * sizeof(topk_item_t);
+}
+
+static int knn_init(knn_t* c, const void* ref, int q7, const uint8_t* label, int n, int dim,
+                    int nclass, int k, void* mem)
+{
+  if (n <= 0 || dim <= 0 || (dim & (q7 ? 3 : 1)) || nclass < 1 || nclass > KNN_MAX_CLASS ||
+      k < 1 || k > n || k > 0xFFFF)
+    return -1;
+
+  c->ref    = ref;
+  c->label  = label;
+  c->norm   = (int32_t*)mem;
+  c->heap   = (topk_item_t*)(c->norm + n);
+  c->n      = n;
+  c->dim    = dim;
+  c->nclass = nclass;
+  c->k      = k;
+  c->q7     = q7;
+
+  return nn_norms(ref, q7, n, dim, c->norm);
+}
+
+int knn_init_q15(knn_t* c, const int16_t* ref, const uint8_t* label, int n, int dim,
+                 int nclass, int k, void* mem)
+{
+  return knn_init(c, ref, 0, label, n, dim, nclass, k, mem);
+}
+
+int knn_init_q7(knn_t* c, const int8_t* ref, const uint8_t* label, int n, int dim,
+                int nclass, int k, void* mem)
+{
+  return knn_init(c, ref, 1, label, n, dim, nclass, k, mem);
+}
+
+// the heap keeps the largest values, so distances go in negated; they are at
+// most 2.0 and halved once more to fit
+static inline void knn_push(topk_t* t, uint32_t h, int j)
+{
+  int32_t v = -(int32_t)(h >> 1);
+
+  if (t->count < t->k || v > t->heap[0].value)
+    topk_push(t, v, j);
+}
+
+static uint8_t knn_vote(const knn_t* c, topk_t* t)
+{
+  uint16_t votes[KNN_MAX_CLASS];
+  int     i, n, l, best = 0;
+
+  for (i = 0; i < c->nclass; i++)
+    votes[i] = 0;
+
+  n = topk_sort(t);
+  for (i = 0; i < n; i++)
+    votes[c->label[t->heap[i].index]]++;
+
+  // nearest first, so among tied classes the one seen first wins
+  best = c->label[t->heap[0].index];
+  for (i = 1; i < n; i++) {
+    l = c->label[t->heap[i].index];
+    if (votes[l] > votes[best])
+      best = l;
+  }
+
+  return best;
+}
+
+static void knn_classify(const knn_t* c, const void* x, int nx, int size, uint8_t* labels)
+{
+  const uint8_t* p      = (const uint8_t*)x;
+  int            stride = c->dim * size;
+  const void*    x0;
+  const void*    x1;
+  topk_t         t0, t1;
+  int32_t        n0, n1, d0, d1;
+  int            i, j;
+
+  for (i = 0; i < nx; i += 2, p += 2 * stride) {
+    x0 = p;
+    x1 = i + 1 < nx ? p + stride : p;
+
+    topk_init(&t0, c->heap, c->k);
+    topk_init(&t1, c->heap + c->k, c->k);
+
+    if (c->q7) {
+      const int8_t* r = (const int8_t*)c->ref;
+
+      n0 = nn_dot_q7(x0, x0, c->dim) >> 1;
+      n1 = nn_dot_q7(x1, x1, c->dim) >> 1;
+
+      for (j = 0; j < c->n; j++, r += c->dim) {
+        nn_dot2_q7(x0, x1, r, c->dim, &d0, &d1);
+        knn_push(&t0, nn_half_dist(n0, c->norm[j], d0), j);
+        knn_push(&t1, nn_half_dist(n1, c->norm[j], d1), j);
+      }
+    } else {
+      const int16_t* r = (const int16_t*)c->ref;
+
+      n0 = nn_dot_q15(x0, x0, c->dim) >> 1;
+      n1 = nn_dot_q15(x1, x1, c->dim) >> 1;
+
+      for (j = 0; j < c->n; j++, r += c->dim) {
+        nn_dot2_q15(x0, x1, r, c->dim, &d0, &d1);
+        knn_push(&t0, nn_half_dist(n0, c->norm[j], d0), j);
+        knn_push(&t1, nn_half_dist(n1, c->norm[j], d1), j);
+      }
+    }
+
+    labels[i] = knn_vote(c, &t0);
+    if (i + 1 < nx)
+      labels[i + 1] = knn_vote(c, &t1);
+  }
+}
+
+int knn_classify_q15(const knn_t* c, const int16_t* x, int nx, uint8_t* labels)
+{
+  if (c->q7)
+    return -1;
+
+  knn_classify(c, x, nx, sizeof(int16_t), labels);
+  return 0;
+}
+
+int knn_classify_q7(const knn_t* c, const int8_t* x, int nx, uint8_t* labels)
+{
+  if (!c->q7)
+    return -1;
+
+  knn_classify(c, x, nx, sizeof(int8_t), labels);
+  return 0;
+}
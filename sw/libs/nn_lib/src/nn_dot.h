@@ -0,0 +1,160 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Dot products and distances shared by the classifiers. Squared distances
+// are expanded into |x|^2 + |s|^2 - 2 x.s, norms and dot products are in the
+// product format of the elements (Q30 for q15, Q14 for q7).
+
+#ifndef _NN_DOT_H_
+#define _NN_DOT_H_
+
+#include <stdint.h>
+
+#ifdef PULP_EXT
+typedef short       nn_v2s __attribute__((vector_size (4)));
+typedef signed char nn_v4s __attribute__((vector_size (4)));
+#endif
+
+// a.b, n a multiple of 2
+static inline int32_t nn_dot_q15(const int16_t* a, const int16_t* b, int n)
+{
+  int32_t s = 0;
+  int     i;
+
+#ifdef PULP_EXT
+  const nn_v2s* va = (const nn_v2s*)a;
+  const nn_v2s* vb = (const nn_v2s*)b;
+
+  for (i = 0; i < n / 2; i++)
+    s = __builtin_pulp_sdotsp2(va[i], vb[i], s);
+#else
+  for (i = 0; i < n; i++)
+    s += a[i] * b[i];
+#endif
+
+  return s;
+}
+
+// a.b, n a multiple of 4
+static inline int32_t nn_dot_q7(const int8_t* a, const int8_t* b, int n)
+{
+  int32_t s = 0;
+  int     i;
+
+#ifdef PULP_EXT
+  const nn_v4s* va = (const nn_v4s*)a;
+  const nn_v4s* vb = (const nn_v4s*)b;
+
+  for (i = 0; i < n / 4; i++)
+    s = __builtin_pulp_sdotsp4(va[i], vb[i], s);
+#else
+  for (i = 0; i < n; i++)
+    s += a[i] * b[i];
+#endif
+
+  return s;
+}
+
+// x0.r and x1.r with every word of r loaded once
+static inline void nn_dot2_q15(const int16_t* x0, const int16_t* x1, const int16_t* r, int n,
+                               int32_t* d0, int32_t* d1)
+{
+  int32_t s0 = 0, s1 = 0;
+  int     i;
+
+#ifdef PULP_EXT
+  const nn_v2s* v0 = (const nn_v2s*)x0;
+  const nn_v2s* v1 = (const nn_v2s*)x1;
+  const nn_v2s* vr = (const nn_v2s*)r;
+  nn_v2s        w;
+
+  for (i = 0; i < n / 2; i++) {
+    w  = vr[i];
+    s0 = __builtin_pulp_sdotsp2(v0[i], w, s0);
+    s1 = __builtin_pulp_sdotsp2(v1[i], w, s1);
+  }
+#else
+  int32_t w;
+
+  for (i = 0; i < n; i++) {
+    w   = r[i];
+    s0 += x0[i] * w;
+    s1 += x1[i] * w;
+  }
+#endif
+
+  *d0 = s0;
+  *d1 = s1;
+}
+
+static inline void nn_dot2_q7(const int8_t* x0, const int8_t* x1, const int8_t* r, int n,
+                              int32_t* d0, int32_t* d1)
+{
+  int32_t s0 = 0, s1 = 0;
+  int     i;
+
+#ifdef PULP_EXT
+  const nn_v4s* v0 = (const nn_v4s*)x0;
+  const nn_v4s* v1 = (const nn_v4s*)x1;
+  const nn_v4s* vr = (const nn_v4s*)r;
+  nn_v4s        w;
+
+  for (i = 0; i < n / 4; i++) {
+    w  = vr[i];
+    s0 = __builtin_pulp_sdotsp4(v0[i], w, s0);
+    s1 = __builtin_pulp_sdotsp4(v1[i], w, s1);
+  }
+#else
+  int32_t w;
+
+  for (i = 0; i < n; i++) {
+    w   = r[i];
+    s0 += x0[i] * w;
+    s1 += x1[i] * w;
+  }
+#endif
+
+  *d0 = s0;
+  *d1 = s1;
+}
+
+// half norms of n vectors, -1 if one of them is 1.0 or above
+static inline int nn_norms(const void* v, int q7, int n, int dim, int32_t* norm)
+{
+  const int32_t one = q7 ? (1 << 14) : (1 << 30);
+  int32_t       s;
+  int           i;
+
+  for (i = 0; i < n; i++) {
+    if (q7)
+      s = nn_dot_q7((const int8_t*)v + i * dim, (const int8_t*)v + i * dim, dim);
+    else
+      s = nn_dot_q15((const int16_t*)v + i * dim, (const int16_t*)v + i * dim, dim);
+
+    // a wrapped sum shows up as negative
+    if (s < 0 || s >= one)
+      return -1;
+
+    norm[i] = s >> 1;
+  }
+
+  return 0;
+}
+
+// |x - r|^2 / 2 from the half norms and x.r, in [0, 2.0]; the rounding of the
+// half norms could make it slightly negative
+static inline uint32_t nn_half_dist(int32_t nx, int32_t nr, int32_t dot)
+{
+  int32_t s = nx + nr;
+
+  return s > dot ? (uint32_t)s - (uint32_t)dot : 0;
+}
+
+#endif
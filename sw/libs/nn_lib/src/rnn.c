@@ -0,0 +1,464 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "rnn.h"
+#include "nn_dot.h"
+
+#define RNN_TANH_LEN  193
+
+// pre-activations are clipped to +-16, where both functions have saturated
+#define RNN_PRE_MAX   65535
+
+// tanh(i / 32) in Q15
+static const int16_t rnn_tanh_lut[RNN_TANH_LEN] = {
+      0,  1024,  2045,  3063,  4075,  5079,  6073,  7056,  8025,  8980,
+   9919, 10840, 11743, 12625, 13486, 14326, 15143, 15936, 16706, 17452,
+  18173, 18870, 19542, 20189, 20813, 21411, 21986, 22538, 23066, 23571,
+  24054, 24516, 24956, 25376, 25776, 26157, 26519, 26864, 27191, 27502,
+  27797, 28076, 28341, 28592, 28830, 29055, 29268, 29470, 29660, 29840,
+  30010, 30170, 30322, 30465, 30600, 30727, 30847, 30960, 31067, 31167,
+  31262, 31351, 31435, 31515, 31589, 31659, 31726, 31788, 31846, 31901,
+  31953, 32002, 32048, 32091, 32132, 32170, 32206, 32240, 32271, 32301,
+  32329, 32356, 32381, 32404, 32426, 32447, 32466, 32484, 32501, 32517,
+  32532, 32547, 32560, 32573, 32584, 32596, 32606, 32616, 32625, 32634,
+  32642, 32649, 32657, 32663, 32670, 32676, 32681, 32686, 32691, 32696,
+  32700, 32704, 32708, 32712, 32715, 32718, 32721, 32724, 32727, 32729,
+  32732, 32734, 32736, 32738, 32740, 32741, 32743, 32745, 32746, 32747,
+  32749, 32750, 32751, 32752, 32753, 32754, 32755, 32755, 32756, 32757,
+  32758, 32758, 32759, 32759, 32760, 32760, 32761, 32761, 32762, 32762,
+  32762, 32763, 32763, 32763, 32764, 32764, 32764, 32764, 32765, 32765,
+  32765, 32765, 32765, 32766, 32766, 32766, 32766, 32766, 32766, 32766,
+  32766, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+  32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+  32767, 32767, 32767
+};
+
+// tanh(t) in Q15 for t >= 0 in Q13, the table step is 256
+static inline int32_t rnn_lut(uint32_t t)
+{
+  uint32_t i = t >> 8;
+  int32_t  a, b;
+
+  if (i >= RNN_TANH_LEN - 1)
+    return 32767;
+
+  a = rnn_tanh_lut[i];
+  b = rnn_tanh_lut[i + 1];
+
+  return a + (((b - a) * (int32_t)(t & 0xFF) + 128) >> 8);
+}
+
+int16_t rnn_tanh(int32_t x)
+{
+  if (x < -RNN_PRE_MAX) x = -RNN_PRE_MAX;
+  if (x >  RNN_PRE_MAX) x =  RNN_PRE_MAX;
+
+  return x < 0 ? -rnn_lut(-x * 2) : rnn_lut(x * 2);
+}
+
+// (1 + tanh(x / 2)) / 2, x / 2 in Q13 is x in Q12
+int16_t rnn_sigmoid(int32_t x)
+{
+  if (x < -RNN_PRE_MAX) x = -RNN_PRE_MAX;
+  if (x >  RNN_PRE_MAX) x =  RNN_PRE_MAX;
+
+  return (32768 + (x < 0 ? -rnn_lut(-x) : rnn_lut(x))) >> 1;
+}
+
+// four gates of a unit over nw words of v, the weights advance with them
+static inline const int16_t* rnn_dot4_q15(const int16_t* v, const int16_t* w, int nw, int32_t* acc)
+{
+  int32_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+  int     k;
+
+#ifdef PULP_EXT
+  const nn_v2s* vv = (const nn_v2s*)v;
+  const nn_v2s* vw = (const nn_v2s*)w;
+  nn_v2s        x;
+
+  for (k = 0; k < nw; k++, vw += 4) {
+    x  = vv[k];
+    a0 = __builtin_pulp_sdotsp2(x, vw[0], a0);
+    a1 = __builtin_pulp_sdotsp2(x, vw[1], a1);
+    a2 = __builtin_pulp_sdotsp2(x, vw[2], a2);
+    a3 = __builtin_pulp_sdotsp2(x, vw[3], a3);
+  }
+#else
+  const int16_t* p = w;
+
+  for (k = 0; k < nw; k++, v += 2, p += 8) {
+    a0 += v[0] * p[0] + v[1] * p[1];
+    a1 += v[0] * p[2] + v[1] * p[3];
+    a2 += v[0] * p[4] + v[1] * p[5];
+    a3 += v[0] * p[6] + v[1] * p[7];
+  }
+#endif
+
+  acc[0] = a0; acc[1] = a1; acc[2] = a2; acc[3] = a3;
+  return w + 8 * nw;
+}
+
+static inline const int8_t* rnn_dot4_q7(const int8_t* v, const int8_t* w, int nw, int32_t* acc)
+{
+  int32_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+  int     k;
+
+#ifdef PULP_EXT
+  const nn_v4s* vv = (const nn_v4s*)v;
+  const nn_v4s* vw = (const nn_v4s*)w;
+  nn_v4s        x;
+
+  for (k = 0; k < nw; k++, vw += 4) {
+    x  = vv[k];
+    a0 = __builtin_pulp_sdotsp4(x, vw[0], a0);
+    a1 = __builtin_pulp_sdotsp4(x, vw[1], a1);
+    a2 = __builtin_pulp_sdotsp4(x, vw[2], a2);
+    a3 = __builtin_pulp_sdotsp4(x, vw[3], a3);
+  }
+#else
+  const int8_t* p = w;
+  int           e;
+
+  for (k = 0; k < nw; k++, v += 4, p += 16) {
+    for (e = 0; e < 4; e++) {
+      a0 += v[e] * p[e];
+      a1 += v[e] * p[4 + e];
+      a2 += v[e] * p[8 + e];
+      a3 += v[e] * p[12 + e];
+    }
+  }
+#endif
+
+  acc[0] = a0; acc[1] = a1; acc[2] = a2; acc[3] = a3;
+  return w + 16 * nw;
+}
+
+// three gates of a unit, the first two into a01, the third into a2
+static inline const int16_t* rnn_dot3_q15(const int16_t* v, const int16_t* w, int nw,
+                                          int32_t* a01, int32_t* a2)
+{
+  int32_t s0 = a01[0], s1 = a01[1], s2 = *a2;
+  int     k;
+
+#ifdef PULP_EXT
+  const nn_v2s* vv = (const nn_v2s*)v;
+  const nn_v2s* vw = (const nn_v2s*)w;
+  nn_v2s        x;
+
+  for (k = 0; k < nw; k++, vw += 3) {
+    x  = vv[k];
+    s0 = __builtin_pulp_sdotsp2(x, vw[0], s0);
+    s1 = __builtin_pulp_sdotsp2(x, vw[1], s1);
+    s2 = __builtin_pulp_sdotsp2(x, vw[2], s2);
+  }
+#else
+  const int16_t* p = w;
+
+  for (k = 0; k < nw; k++, v += 2, p += 6) {
+    s0 += v[0] * p[0] + v[1] * p[1];
+    s1 += v[0] * p[2] + v[1] * p[3];
+    s2 += v[0] * p[4] + v[1] * p[5];
+  }
+#endif
+
+  a01[0] = s0; a01[1] = s1; *a2 = s2;
+  return w + 6 * nw;
+}
+
+static inline const int8_t* rnn_dot3_q7(const int8_t* v, const int8_t* w, int nw,
+                                        int32_t* a01, int32_t* a2)
+{
+  int32_t s0 = a01[0], s1 = a01[1], s2 = *a2;
+  int     k;
+
+#ifdef PULP_EXT
+  const nn_v4s* vv = (const nn_v4s*)v;
+  const nn_v4s* vw = (const nn_v4s*)w;
+  nn_v4s        x;
+
+  for (k = 0; k < nw; k++, vw += 3) {
+    x  = vv[k];
+    s0 = __builtin_pulp_sdotsp4(x, vw[0], s0);
+    s1 = __builtin_pulp_sdotsp4(x, vw[1], s1);
+    s2 = __builtin_pulp_sdotsp4(x, vw[2], s2);
+  }
+#else
+  const int8_t* p = w;
+  int           e;
+
+  for (k = 0; k < nw; k++, v += 4, p += 12) {
+    for (e = 0; e < 4; e++) {
+      s0 += v[e] * p[e];
+      s1 += v[e] * p[4 + e];
+      s2 += v[e] * p[8 + e];
+    }
+  }
+#endif
+
+  a01[0] = s0; a01[1] = s1; *a2 = s2;
+  return w + 12 * nw;
+}
+
+// dot product to Q12 pre-activation
+static inline int32_t rnn_pre(int32_t acc, int shift, int32_t bias)
+{
+  int32_t v = shift > 0 ? (acc + (1 << (shift - 1))) >> shift : acc * (1 << -shift);
+
+  v += bias;
+  if (v < -RNN_PRE_MAX) v = -RNN_PRE_MAX;
+  if (v >  RNN_PRE_MAX) v =  RNN_PRE_MAX;
+
+  return v;
+}
+
+// updates the cell state of unit j, returns its hidden value in Q15
+static inline int32_t rnn_lstm_unit(const rnn_t* r, const int32_t* acc, int j)
+{
+  const int32_t* b  = r->bias + j;
+  int            nh = r->nh;
+  int32_t        i, f, g, o, c;
+
+  i = rnn_sigmoid(rnn_pre(acc[0], r->shift, b[0]));
+  f = rnn_sigmoid(rnn_pre(acc[1], r->shift, b[nh]));
+  g = rnn_tanh(rnn_pre(acc[2], r->shift, b[2 * nh]));
+  o = rnn_sigmoid(rnn_pre(acc[3], r->shift, b[3 * nh]));
+
+  // Q15 x Q11 and Q15 x Q15 products to Q11
+  c = (f * r->c[j] + ((i * g) >> 4) + (1 << 14)) >> 15;
+  if (c < -32768) c = -32768;
+  if (c >  32767) c =  32767;
+  r->c[j] = c;
+
+  return (o * rnn_tanh(c * 2) + (1 << 14)) >> 15;
+}
+
+// hidden value of unit j in Q15 from its previous one
+static inline int32_t rnn_gru_unit(const rnn_t* r, const int32_t* acc, int j, int32_t h)
+{
+  const int32_t* b  = r->bias + j;
+  int            nh = r->nh;
+  int32_t        rg, z, n;
+
+  rg = rnn_sigmoid(rnn_pre(acc[0], r->shift, b[0]));
+  z  = rnn_sigmoid(rnn_pre(acc[1], r->shift, b[nh]));
+  n  = rnn_pre(acc[3], r->shift, b[3 * nh]);
+  n  = rnn_tanh(rnn_pre(acc[2], r->shift, b[2 * nh]) + ((rg * n) >> 15));
+
+  // (1 - z) n + z h
+  return n + ((z * (h - n) + (1 << 14)) >> 15);
+}
+
+static void rnn_step_cell_q15(rnn_t* r, const int16_t* x)
+{
+  const int16_t* w  = (const int16_t*)r->w;
+  int16_t*       h  = (int16_t*)r->h;
+  int16_t*       hn = (int16_t*)r->hnew;
+  int32_t        acc[4];
+  int            j;
+
+  for (j = 0; j < r->nh; j++) {
+    acc[0] = acc[1] = acc[2] = acc[3] = 0;
+
+    if (r->gru) {
+      w = rnn_dot3_q15(x, w, r->nx / 2, acc, &acc[2]);
+      w = rnn_dot3_q15(h, w, r->nh / 2, acc, &acc[3]);
+      hn[j] = rnn_gru_unit(r, acc, j, h[j]);
+    } else {
+      w = rnn_dot4_q15(x, w, r->nx / 2, acc);
+      w = rnn_dot4_q15(h, w, r->nh / 2, acc);
+      hn[j] = rnn_lstm_unit(r, acc, j);
+    }
+  }
+
+  for (j = 0; j < r->nh; j++)
+    h[j] = hn[j];
+}
+
+static void rnn_step_cell_q7(rnn_t* r, const int8_t* x)
+{
+  const int8_t* w  = (const int8_t*)r->w;
+  int8_t*       h  = (int8_t*)r->h;
+  int8_t*       hn = (int8_t*)r->hnew;
+  int32_t       acc[4], v;
+  int           j;
+
+  for (j = 0; j < r->nh; j++) {
+    acc[0] = acc[1] = acc[2] = acc[3] = 0;
+
+    if (r->gru) {
+      w = rnn_dot3_q7(x, w, r->nx / 4, acc, &acc[2]);
+      w = rnn_dot3_q7(h, w, r->nh / 4, acc, &acc[3]);
+      v = rnn_gru_unit(r, acc, j, h[j] * 256);
+    } else {
+      w = rnn_dot4_q7(x, w, r->nx / 4, acc);
+      w = rnn_dot4_q7(h, w, r->nh / 4, acc);
+      v = rnn_lstm_unit(r, acc, j);
+    }
+
+    // Q15 to Q7, 1.0 rounds to the largest q7 value
+    v = (v + 128) >> 8;
+    hn[j] = v > 127 ? 127 : v;
+  }
+
+  for (j = 0; j < r->nh; j++)
+    h[j] = hn[j];
+}
+
+unsigned int rnn_packed_len(int gru, int nx, int nh)
+{
+  return (gru ? 3 : 4) * nh * (nx + nh);
+}
+
+unsigned int rnn_size(int nh)
+{
+  // one row of new hidden values, at most q15
+  return (nh * sizeof(int16_t) + 3) & ~3;
+}
+
+// per unit, the words of x and then of h, every word of all ng gates in a row
+static int rnn_pack(const void* w_ih, const void* w_hh, int nx, int nh, int ng, int q7,
+                    void* packed)
+{
+  const int     vlen = q7 ? 4 : 2;
+  const int     size = q7 ? sizeof(int8_t) : sizeof(int16_t);
+  const uint8_t *src, *row;
+  uint8_t*      dst = (uint8_t*)packed;
+  int           j, part, len, k, g, e;
+
+  if (nx <= 0 || nh <= 0 || nx % vlen || nh % vlen)
+    return -1;
+
+  for (j = 0; j < nh; j++) {
+    for (part = 0; part < 2; part++) {
+      src = (const uint8_t*)(part ? w_hh : w_ih);
+      len = part ? nh : nx;
+
+      for (k = 0; k < len; k += vlen) {
+        for (g = 0; g < ng; g++) {
+          row = src + ((g * nh + j) * len + k) * size;
+
+          for (e = 0; e < vlen * size; e++)
+            *dst++ = row[e];
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int rnn_pack_lstm_q15(const int16_t* w_ih, const int16_t* w_hh, int nx, int nh, int16_t* packed)
+{
+  return rnn_pack(w_ih, w_hh, nx, nh, 4, 0, packed);
+}
+
+int rnn_pack_lstm_q7(const int8_t* w_ih, const int8_t* w_hh, int nx, int nh, int8_t* packed)
+{
+  return rnn_pack(w_ih, w_hh, nx, nh, 4, 1, packed);
+}
+
+int rnn_pack_gru_q15(const int16_t* w_ih, const int16_t* w_hh, int nx, int nh, int16_t* packed)
+{
+  return rnn_pack(w_ih, w_hh, nx, nh, 3, 0, packed);
+}
+
+int rnn_pack_gru_q7(const int8_t* w_ih, const int8_t* w_hh, int nx, int nh, int8_t* packed)
+{
+  return rnn_pack(w_ih, w_hh, nx, nh, 3, 1, packed);
+}
+
+static int rnn_init(rnn_t* r, const void* w, const int32_t* bias, int nx, int nh, int wexp,
+                    int gru, int q7, void* h, int16_t* c, void* mem)
+{
+  const int vlen = q7 ? 4 : 2;
+
+  if (nx <= 0 || nh <= 0 || nx % vlen || nh % vlen || wexp < 0 || wexp > 7)
+    return -1;
+
+  r->w     = w;
+  r->bias  = bias;
+  r->h     = h;
+  r->c     = c;
+  r->hnew  = mem;
+  r->nx    = nx;
+  r->nh    = nh;
+  r->gru   = gru;
+  r->q7    = q7;
+
+  // products are Q30 (q15) or Q14 (q7) times 2^wexp
+  r->shift = (q7 ? 2 : 18) - wexp;
+
+  return 0;
+}
+
+int lstm_init_q15(rnn_t* r, const int16_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                  int16_t* h, int16_t* c, void* mem)
+{
+  return rnn_init(r, w, bias, nx, nh, wexp, 0, 0, h, c, mem);
+}
+
+int lstm_init_q7(rnn_t* r, const int8_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                 int8_t* h, int16_t* c, void* mem)
+{
+  return rnn_init(r, w, bias, nx, nh, wexp, 0, 1, h, c, mem);
+}
+
+int gru_init_q15(rnn_t* r, const int16_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                 int16_t* h, void* mem)
+{
+  return rnn_init(r, w, bias, nx, nh, wexp, 1, 0, h, 0, mem);
+}
+
+int gru_init_q7(rnn_t* r, const int8_t* w, const int32_t* bias, int nx, int nh, int wexp,
+                int8_t* h, void* mem)
+{
+  return rnn_init(r, w, bias, nx, nh, wexp, 1, 1, h, 0, mem);
+}
+
+void rnn_reset(rnn_t* r)
+{
+  int j;
+
+  for (j = 0; j < r->nh; j++) {
+    if (r->q7)
+      ((int8_t*)r->h)[j] = 0;
+    else
+      ((int16_t*)r->h)[j] = 0;
+
+    if (r->c)
+      r->c[j] = 0;
+  }
+}
+
+int rnn_step_q15(rnn_t* r, const int16_t* x, int n)
+{
+  int t;
+
+  if (r->q7)
+    return -1;
+
+  for (t = 0; t < n; t++, x += r->nx)
+    rnn_step_cell_q15(r, x);
+
+  return 0;
+}
+
+int rnn_step_q7(rnn_t* r, const int8_t* x, int n)
+{
+  int t;
+
+  if (!r->q7)
+    return -1;
+
+  for (t = 0; t < n; t++, x += r->nx)
+    rnn_step_cell_q7(r, x);
+
+  return 0;
+}
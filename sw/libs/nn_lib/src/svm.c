@@ -0,0 +1,192 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "svm.h"
+#include "nn_dot.h"
+
+#define SVM_EXP_LEN  257
+
+// exp(-i / 32) in Q15
+static const int16_t svm_exp_lut[SVM_EXP_LEN] = {
+  32767, 31760, 30783, 29836, 28918, 28028, 27166, 26330, 25520, 24735,
+  23974, 23236, 22521, 21828, 21157, 20506, 19875, 19263, 18671, 18096,
+  17539, 17000, 16477, 15970, 15479, 15002, 14541, 14093, 13660, 13239,
+  12832, 12437, 12055, 11684, 11324, 10976, 10638, 10311,  9994,  9686,
+   9388,  9099,  8819,  8548,  8285,  8030,  7783,  7544,  7312,  7087,
+   6869,  6657,  6452,  6254,  6061,  5875,  5694,  5519,  5349,  5185,
+   5025,  4871,  4721,  4575,  4435,  4298,  4166,  4038,  3914,  3793,
+   3676,  3563,  3454,  3347,  3244,  3145,  3048,  2954,  2863,  2775,
+   2690,  2607,  2527,  2449,  2374,  2301,  2230,  2161,  2095,  2030,
+   1968,  1907,  1849,  1792,  1737,  1683,  1631,  1581,  1533,  1485,
+   1440,  1395,  1352,  1311,  1271,  1231,  1194,  1157,  1121,  1087,
+   1053,  1021,   990,   959,   930,   901,   873,   846,   820,   795,
+    771,   747,   724,   702,   680,   659,   639,   619,   600,   582,
+    564,   546,   530,   513,   498,   482,   467,   453,   439,   426,
+    412,   400,   387,   376,   364,   353,   342,   331,   321,   311,
+    302,   292,   283,   275,   266,   258,   250,   242,   235,   228,
+    221,   214,   207,   201,   195,   189,   183,   177,   172,   167,
+    162,   157,   152,   147,   143,   138,   134,   130,   126,   122,
+    118,   115,   111,   108,   104,   101,    98,    95,    92,    89,
+     86,    84,    81,    79,    76,    74,    72,    69,    67,    65,
+     63,    61,    59,    58,    56,    54,    52,    51,    49,    48,
+     46,    45,    43,    42,    41,    40,    38,    37,    36,    35,
+     34,    33,    32,    31,    30,    29,    28,    27,    26,    26,
+     25,    24,    23,    23,    22,    21,    21,    20,    19,    19,
+     18,    18,    17,    17,    16,    16,    15,    15,    14,    14,
+     13,    13,    12,    12,    12,    11,    11
+};
+
+unsigned int svm_size(int nsv)
+{
+  // norms and two rows of kernel values
+  return nsv * sizeof(int32_t) + 2 * nsv * sizeof(int16_t);
+}
+
+static int svm_init(svm_t* s, const void* sv, int q7, int nsv, int dim, const int16_t* coef,
+                    const int32_t* bias, int nclass, uint32_t gamma, void* mem)
+{
+  if (nsv <= 0 || (nsv & 1) || dim <= 0 || (dim & (q7 ? 3 : 1)) || nclass < 1)
+    return -1;
+
+  s->sv     = sv;
+  s->coef   = coef;
+  s->bias   = bias;
+  s->norm   = (int32_t*)mem;
+  s->kern   = (int16_t*)(s->norm + nsv);
+  s->nsv    = nsv;
+  s->dim    = dim;
+  s->nclass = nclass;
+  s->q7     = q7;
+  s->gamma  = gamma;
+
+  return nn_norms(sv, q7, nsv, dim, s->norm);
+}
+
+int svm_init_q15(svm_t* s, const int16_t* sv, int nsv, int dim, const int16_t* coef,
+                 const int32_t* bias, int nclass, uint32_t gamma, void* mem)
+{
+  return svm_init(s, sv, 0, nsv, dim, coef, bias, nclass, gamma, mem);
+}
+
+int svm_init_q7(svm_t* s, const int8_t* sv, int nsv, int dim, const int16_t* coef,
+                const int32_t* bias, int nclass, uint32_t gamma, void* mem)
+{
+  return svm_init(s, sv, 1, nsv, dim, coef, bias, nclass, gamma, mem);
+}
+
+// exp(-gamma d^2) in Q15 for h = d^2 / 2 in Q30
+static inline int16_t svm_kernel(uint32_t h, uint32_t gamma)
+{
+  // table position in Q8, gamma d^2 * 32 * 256
+  uint32_t p = ((uint64_t)h * gamma) >> 32;
+  uint32_t i = p >> 8;
+  int32_t  a, b;
+
+  if (i >= SVM_EXP_LEN - 1)
+    return 0;
+
+  a = svm_exp_lut[i];
+  b = svm_exp_lut[i + 1];
+
+  return a - (((a - b) * (int32_t)(p & 0xFF)) >> 8);
+}
+
+// kernel values of x0 and x1 against all support vectors
+static void svm_kernels(const svm_t* s, const void* x0, const void* x1)
+{
+  int16_t* k0 = s->kern;
+  int16_t* k1 = s->kern + s->nsv;
+  int32_t  n0, n1, d0, d1;
+  int      j;
+
+  if (s->q7) {
+    const int8_t* sv = (const int8_t*)s->sv;
+
+    // the kernel table expects Q30, q7 products are Q14
+    n0 = nn_dot_q7(x0, x0, s->dim) >> 1;
+    n1 = nn_dot_q7(x1, x1, s->dim) >> 1;
+
+    for (j = 0; j < s->nsv; j++, sv += s->dim) {
+      nn_dot2_q7(x0, x1, sv, s->dim, &d0, &d1);
+      k0[j] = svm_kernel(nn_half_dist(n0, s->norm[j], d0) << 16, s->gamma);
+      k1[j] = svm_kernel(nn_half_dist(n1, s->norm[j], d1) << 16, s->gamma);
+    }
+  } else {
+    const int16_t* sv = (const int16_t*)s->sv;
+
+    n0 = nn_dot_q15(x0, x0, s->dim) >> 1;
+    n1 = nn_dot_q15(x1, x1, s->dim) >> 1;
+
+    for (j = 0; j < s->nsv; j++, sv += s->dim) {
+      nn_dot2_q15(x0, x1, sv, s->dim, &d0, &d1);
+      k0[j] = svm_kernel(nn_half_dist(n0, s->norm[j], d0), s->gamma);
+      k1[j] = svm_kernel(nn_half_dist(n1, s->norm[j], d1), s->gamma);
+    }
+  }
+}
+
+static uint8_t svm_decide(const svm_t* s, const int16_t* k, int32_t* decision)
+{
+  const int16_t* coef = s->coef;
+  int32_t        v, best = 0;
+  int            c, label = 0;
+
+  for (c = 0; c < s->nclass; c++, coef += s->nsv) {
+    v = s->bias[c] + nn_dot_q15(coef, k, s->nsv);
+
+    if (decision)
+      decision[c] = v;
+
+    if (c == 0 || v > best) {
+      best  = v;
+      label = c;
+    }
+  }
+
+  if (s->nclass == 1)
+    label = best >= 0;
+
+  return label;
+}
+
+static void svm_classify(const svm_t* s, const void* x, int n, int size, uint8_t* labels,
+                         int32_t* decision)
+{
+  const uint8_t* p      = (const uint8_t*)x;
+  int            stride = s->dim * size;
+  int            i;
+
+  for (i = 0; i < n; i += 2, p += 2 * stride) {
+    // an odd last vector is paired with itself
+    svm_kernels(s, p, i + 1 < n ? p + stride : p);
+
+    labels[i] = svm_decide(s, s->kern, decision ? decision + i * s->nclass : 0);
+    if (i + 1 < n)
+      labels[i + 1] = svm_decide(s, s->kern + s->nsv, decision ? decision + (i + 1) * s->nclass : 0);
+  }
+}
+
+int svm_classify_q15(const svm_t* s, const int16_t* x, int n, uint8_t* labels, int32_t* decision)
+{
+  if (s->q7)
+    return -1;
+
+  svm_classify(s, x, n, sizeof(int16_t), labels, decision);
+  return 0;
+}
+
+int svm_classify_q7(const svm_t* s, const int8_t* x, int n, uint8_t* labels, int32_t* decision)
+{
+  if (!s->q7)
+    return -1;
+
+  svm_classify(s, x, n, sizeof(int8_t), labels, decision);
+  return 0;
+}
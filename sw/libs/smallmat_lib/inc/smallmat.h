@@ -0,0 +1,419 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Small matrices with dimensions known at compile time.
+ *
+ * Header only, C++11. All loops run over template parameters and are
+ * unrolled through template recursion, so a 4x4 product compiles to 64
+ * multiply-accumulates with constant offsets and no loop or bounds code.
+ *
+ * Sums, differences, products and transposes build expression objects that
+ * are only evaluated on assignment, element by element. D = A * B + C
+ * therefore adds C into the accumulator of the product, without a temporary
+ * matrix and, for fixed point, with a single rounding step. Operands of a
+ * product that are no plain matrices (or transposed plain matrices) are
+ * evaluated into a temporary first. Expressions refer to their operands, so
+ * they must not outlive the statement that builds them.
+ *
+ * Element types:
+ *  - float, accumulated in float (fused multiply-add with an FPU)
+ *  - q15, accumulated in Q30 in 32 bits; with PULP_EXT the products go
+ *    through the packed dot product two at a time. Sums of products have to
+ *    stay within (-2, 2) before they are saturated to Q15.
+ *  - q31, accumulated in Q62 in 64 bits (there is no 32 bit dot product),
+ *    same range limit.
+ *
+ * operator= evaluates into a temporary, so the destination may appear on
+ * the right side (A = A * B). assign() writes the destination directly and
+ * saves the copy when it does not.
+ *
+ */
+#ifndef _SMALLMAT_H_
+#define _SMALLMAT_H_
+
+#include <stdint.h>
+
+#define SMALLMAT_INLINE inline __attribute__((always_inline))
+
+namespace smallmat {
+
+/** Fixed-point element types, only used as tags */
+struct q15 {};
+struct q31 {};
+
+template<typename T> struct traits;
+
+template<> struct traits<float> {
+  typedef float elem_t;
+  typedef float acc_t;
+
+  static SMALLMAT_INLINE elem_t one()                      { return 1.0f; }
+  static SMALLMAT_INLINE acc_t  widen(elem_t x)            { return x; }
+  static SMALLMAT_INLINE acc_t  mul(elem_t a, elem_t b)    { return a * b; }
+  static SMALLMAT_INLINE elem_t narrow(acc_t x)            { return x; }
+};
+
+template<> struct traits<q15> {
+  typedef int16_t elem_t;
+  typedef int32_t acc_t;
+
+  static SMALLMAT_INLINE elem_t one()                      { return 0x7FFF; }
+  static SMALLMAT_INLINE acc_t  widen(elem_t x)            { return (acc_t)x * 32768; }
+  static SMALLMAT_INLINE acc_t  mul(elem_t a, elem_t b)    { return (acc_t)a * b; }
+  static SMALLMAT_INLINE elem_t narrow(acc_t x) {
+#ifdef PULP_EXT
+    return __builtin_pulp_clip(x >> 15, -32768, 32767);
+#else
+    x >>= 15;
+    return x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+#endif
+  }
+};
+
+template<> struct traits<q31> {
+  typedef int32_t elem_t;
+  typedef int64_t acc_t;
+
+  static SMALLMAT_INLINE elem_t one()                      { return 0x7FFFFFFF; }
+  static SMALLMAT_INLINE acc_t  widen(elem_t x)            { return (acc_t)x * 0x80000000LL; }
+  static SMALLMAT_INLINE acc_t  mul(elem_t a, elem_t b)    { return (acc_t)a * b; }
+  static SMALLMAT_INLINE elem_t narrow(acc_t x) {
+    x >>= 31;
+    return x > 0x7FFFFFFFLL ? 0x7FFFFFFF : (x < -0x80000000LL ? (elem_t)0x80000000 : (elem_t)x);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// compile-time loops
+////////////////////////////////////////////////////////////////////////////////
+
+// calls f(0) .. f(N - 1)
+template<int N> struct unroll {
+  template<typename F> static SMALLMAT_INLINE void run(F& f) {
+    unroll<N - 1>::run(f);
+    f(N - 1);
+  }
+};
+
+template<> struct unroll<0> {
+  template<typename F> static SMALLMAT_INLINE void run(F&) {}
+};
+
+// sum of a(i, k) b(k, j) for k < K, in the accumulator of T
+template<typename T, int K> struct dot {
+  template<typename EA, typename EB>
+  static SMALLMAT_INLINE typename traits<T>::acc_t run(const EA& a, int i, const EB& b, int j) {
+    return dot<T, K - 1>::run(a, i, b, j) + traits<T>::mul(a.elem(i, K - 1), b.elem(K - 1, j));
+  }
+};
+
+template<typename T> struct dot<T, 0> {
+  template<typename EA, typename EB>
+  static SMALLMAT_INLINE typename traits<T>::acc_t run(const EA&, int, const EB&, int) {
+    return 0;
+  }
+};
+
+#ifdef PULP_EXT
+typedef short v2s __attribute__((vector_size (4)));
+
+// two products per packed dot product; the packs of a column of B are the
+// same for every row of A and are shared once the loops are unrolled
+template<int K, bool odd = (K % 2 != 0)> struct dot_q15;
+
+template<int K> struct dot_q15<K, true> {
+  template<typename EA, typename EB>
+  static SMALLMAT_INLINE int32_t run(const EA& a, int i, const EB& b, int j) {
+    return dot_q15<K - 1>::run(a, i, b, j) + (int32_t)a.elem(i, K - 1) * b.elem(K - 1, j);
+  }
+};
+
+template<int K> struct dot_q15<K, false> {
+  template<typename EA, typename EB>
+  static SMALLMAT_INLINE int32_t run(const EA& a, int i, const EB& b, int j) {
+    return __builtin_pulp_sdotsp2((v2s){a.elem(i, K - 2), a.elem(i, K - 1)},
+                                  (v2s){b.elem(K - 2, j), b.elem(K - 1, j)},
+                                  dot_q15<K - 2>::run(a, i, b, j));
+  }
+};
+
+template<> struct dot_q15<0, false> {
+  template<typename EA, typename EB>
+  static SMALLMAT_INLINE int32_t run(const EA&, int, const EB&, int) {
+    return 0;
+  }
+};
+
+template<int K> struct dot<q15, K> : dot_q15<K> {};
+template<>      struct dot<q15, 0> : dot_q15<0> {};
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// expressions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Base of all expressions. E provides acc(i, j), the element in the
+ * accumulator format, plain matrices and their transposes also elem(i, j).
+ */
+template<typename E, typename T, int R, int C> struct expr {
+  typedef T type;
+  static constexpr int rows = R;
+  static constexpr int cols = C;
+
+  SMALLMAT_INLINE const E& self() const { return static_cast<const E&>(*this); }
+};
+
+template<typename T, int R, int C> struct mat;
+template<typename E> struct trans;
+
+// how a product keeps an operand: plain matrices and their transposes by
+// reference, anything else evaluated
+template<typename E> struct operand {
+  typedef mat<typename E::type, E::rows, E::cols> type;
+};
+
+template<typename T, int R, int C> struct operand<mat<T, R, C> > {
+  typedef const mat<T, R, C>& type;
+};
+
+template<typename T, int R, int C> struct operand<trans<mat<T, R, C> > > {
+  typedef trans<mat<T, R, C> > type;
+};
+
+template<typename T, int R, int C> struct mat : expr<mat<T, R, C>, T, R, C> {
+  typedef typename traits<T>::elem_t elem_t;
+  typedef typename traits<T>::acc_t  acc_t;
+
+  elem_t v[R * C] __attribute__((aligned (4)));
+
+  mat() = default;
+
+  template<typename E> mat(const expr<E, T, R, C>& e) { assign(e); }
+
+  SMALLMAT_INLINE elem_t&       operator()(int i, int j)       { return v[i * C + j]; }
+  SMALLMAT_INLINE const elem_t& operator()(int i, int j) const { return v[i * C + j]; }
+
+  SMALLMAT_INLINE elem_t elem(int i, int j) const { return v[i * C + j]; }
+  SMALLMAT_INLINE acc_t  acc(int i, int j)  const { return traits<T>::widen(v[i * C + j]); }
+
+  template<typename E> struct assigner {
+    mat* m;
+    const E* e;
+    SMALLMAT_INLINE void operator()(int n) { m->v[n] = traits<T>::narrow(e->acc(n / C, n % C)); }
+  };
+
+  /** Evaluates e straight into this matrix, which e must not refer to */
+  template<typename E> SMALLMAT_INLINE mat& assign(const expr<E, T, R, C>& e) {
+    assigner<E> f = { this, &e.self() };
+    unroll<R * C>::run(f);
+    return *this;
+  }
+
+  template<typename E> SMALLMAT_INLINE mat& operator=(const expr<E, T, R, C>& e) {
+    mat t;
+    t.assign(e);
+    return *this = t;
+  }
+
+  mat& operator=(const mat& m) = default;
+
+  template<typename E> SMALLMAT_INLINE mat& operator+=(const expr<E, T, R, C>& e) { return *this = *this + e; }
+  template<typename E> SMALLMAT_INLINE mat& operator-=(const expr<E, T, R, C>& e) { return *this = *this - e; }
+
+  struct filler {
+    mat* m;
+    elem_t x, d;
+    SMALLMAT_INLINE void operator()(int n) { m->v[n] = (n / C == n % C) ? d : x; }
+  };
+
+  /** Sets all elements to x and the diagonal to d */
+  SMALLMAT_INLINE mat& fill(elem_t x, elem_t d) {
+    filler f = { this, x, d };
+    unroll<R * C>::run(f);
+    return *this;
+  }
+
+  SMALLMAT_INLINE mat& zero() { return fill(0, 0); }
+};
+
+template<typename E> struct trans : expr<trans<E>, typename E::type, E::cols, E::rows> {
+  typedef typename traits<typename E::type>::elem_t elem_t;
+  typedef typename traits<typename E::type>::acc_t  acc_t;
+
+  typename operand<E>::type e;
+
+  SMALLMAT_INLINE trans(const E& e) : e(e) {}
+
+  SMALLMAT_INLINE elem_t elem(int i, int j) const { return e.elem(j, i); }
+  SMALLMAT_INLINE acc_t  acc(int i, int j)  const { return e.acc(j, i); }
+};
+
+template<typename EA, typename EB> struct sum : expr<sum<EA, EB>, typename EA::type, EA::rows, EA::cols> {
+  typedef typename traits<typename EA::type>::acc_t acc_t;
+
+  const EA& a;
+  const EB& b;
+
+  SMALLMAT_INLINE sum(const EA& a, const EB& b) : a(a), b(b) {}
+
+  SMALLMAT_INLINE acc_t acc(int i, int j) const { return a.acc(i, j) + b.acc(i, j); }
+};
+
+template<typename EA, typename EB> struct difference : expr<difference<EA, EB>, typename EA::type, EA::rows, EA::cols> {
+  typedef typename traits<typename EA::type>::acc_t acc_t;
+
+  const EA& a;
+  const EB& b;
+
+  SMALLMAT_INLINE difference(const EA& a, const EB& b) : a(a), b(b) {}
+
+  SMALLMAT_INLINE acc_t acc(int i, int j) const { return a.acc(i, j) - b.acc(i, j); }
+};
+
+template<typename EA, typename EB> struct product : expr<product<EA, EB>, typename EA::type, EA::rows, EB::cols> {
+  typedef typename EA::type T;
+  typedef typename traits<T>::acc_t acc_t;
+
+  typename operand<EA>::type a;
+  typename operand<EB>::type b;
+
+  SMALLMAT_INLINE product(const EA& a, const EB& b) : a(a), b(b) {}
+
+  SMALLMAT_INLINE acc_t acc(int i, int j) const { return dot<T, EA::cols>::run(a, i, b, j); }
+};
+
+template<typename EA, typename EB, typename T, int R, int C>
+SMALLMAT_INLINE sum<EA, EB> operator+(const expr<EA, T, R, C>& a, const expr<EB, T, R, C>& b) {
+  return sum<EA, EB>(a.self(), b.self());
+}
+
+template<typename EA, typename EB, typename T, int R, int C>
+SMALLMAT_INLINE difference<EA, EB> operator-(const expr<EA, T, R, C>& a, const expr<EB, T, R, C>& b) {
+  return difference<EA, EB>(a.self(), b.self());
+}
+
+template<typename EA, typename EB, typename T, int R, int K, int C>
+SMALLMAT_INLINE product<EA, EB> operator*(const expr<EA, T, R, K>& a, const expr<EB, T, K, C>& b) {
+  return product<EA, EB>(a.self(), b.self());
+}
+
+template<typename E, typename T, int R, int C>
+SMALLMAT_INLINE trans<E> transpose(const expr<E, T, R, C>& e) {
+  return trans<E>(e.self());
+}
+
+template<typename T, int N> SMALLMAT_INLINE mat<T, N, N> identity() {
+  mat<T, N, N> m;
+  m.fill(0, traits<T>::one());
+  return m;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// inverse, float only
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Inverts a, closed form up to 3x3, Gauss-Jordan with partial pivoting
+ * above.
+ * @return false if a is singular
+ */
+template<int N> bool inverse(const mat<float, N, N>& a, mat<float, N, N>& out)
+{
+  mat<float, N, N> m = a;
+  int   i, j, k, p;
+  float t, f;
+
+  out.fill(0.0f, 1.0f);
+
+  for (k = 0; k < N; k++) {
+    p = k;
+    for (i = k + 1; i < N; i++)
+      if ((m(i, k) < 0.0f ? -m(i, k) : m(i, k)) > (m(p, k) < 0.0f ? -m(p, k) : m(p, k)))
+        p = i;
+
+    if (m(p, k) == 0.0f)
+      return false;
+
+    if (p != k) {
+      for (j = 0; j < N; j++) {
+        t = m(k, j);   m(k, j)   = m(p, j);   m(p, j)   = t;
+        t = out(k, j); out(k, j) = out(p, j); out(p, j) = t;
+      }
+    }
+
+    f = 1.0f / m(k, k);
+    for (j = 0; j < N; j++) {
+      m(k, j)   *= f;
+      out(k, j) *= f;
+    }
+
+    for (i = 0; i < N; i++) {
+      if (i == k)
+        continue;
+
+      f = m(i, k);
+      for (j = 0; j < N; j++) {
+        m(i, j)   -= f * m(k, j);
+        out(i, j) -= f * out(k, j);
+      }
+    }
+  }
+
+  return true;
+}
+
+template<> inline bool inverse<2>(const mat<float, 2, 2>& a, mat<float, 2, 2>& out)
+{
+  float det = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+  float f;
+
+  if (det == 0.0f)
+    return false;
+
+  f = 1.0f / det;
+  out(0, 0) =  a(1, 1) * f;
+  out(0, 1) = -a(0, 1) * f;
+  out(1, 0) = -a(1, 0) * f;
+  out(1, 1) =  a(0, 0) * f;
+
+  return true;
+}
+
+template<> inline bool inverse<3>(const mat<float, 3, 3>& a, mat<float, 3, 3>& out)
+{
+  float c00 = a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1);
+  float c01 = a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2);
+  float c02 = a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0);
+  float det = a(0, 0) * c00 + a(0, 1) * c01 + a(0, 2) * c02;
+  float f;
+
+  if (det == 0.0f)
+    return false;
+
+  f = 1.0f / det;
+  out(0, 0) = c00 * f;
+  out(1, 0) = c01 * f;
+  out(2, 0) = c02 * f;
+  out(0, 1) = (a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2)) * f;
+  out(1, 1) = (a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0)) * f;
+  out(2, 1) = (a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1)) * f;
+  out(0, 2) = (a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1)) * f;
+  out(1, 2) = (a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2)) * f;
+  out(2, 2) = (a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)) * f;
+
+  return true;
+}
+
+} // namespace smallmat
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Running median over a sliding window.
+ *
+ * The window is split into a max-heap of the lower half and a min-heap of the
+ * upper half that share one array with the median in the middle. Every sample
+ * replaces the oldest one in place and is moved up or down its heap, or
+ * across to the other one, so an update takes O(log w) instead of sorting
+ * the window.
+ *
+ */
+#ifndef _RUNNING_MEDIAN_H_
+#define _RUNNING_MEDIAN_H_
+
+#include <stdint.h>
+
+/** Largest window, positions are stored in 16 bits */
+#define RMED_MAX_WINDOW  32767
+
+typedef struct {
+  int32_t*  data;   // ring buffer with the window
+  int16_t*  pos;    // heap position of every sample
+  int16_t*  heap;   // sample indices, heap[0] is the median
+  int       w;
+  int       idx;    // oldest sample
+  int       min_ct; // size of the min-heap, positions 1..min_ct
+  int       max_ct; // size of the max-heap, positions -1..-max_ct
+} rmed_t;
+
+unsigned int rmed_size(int w);
+
+/**
+ * @param mem word aligned memory of rmed_size bytes
+ * @return 0 on success, -1 if w is out of range
+ */
+int rmed_init(rmed_t* m, int w, void* mem);
+
+/**
+ * @brief Adds a sample and returns the median of the last w samples, of all
+ * samples while there are less than w. For an even number of samples it is
+ * the mean of the two middle ones, rounded down.
+ */
+int32_t rmed_push(rmed_t* m, int32_t v);
+
+/**
+ * @brief Median filters n samples, out[i] is the median of in[i - w + 1..i].
+ * @param mem word aligned memory of rmed_size bytes
+ */
+int rmed_filter_i32(const int32_t* in, int32_t* out, int n, int w, void* mem);
+int rmed_filter_i16(const int16_t* in, int16_t* out, int n, int w, void* mem);
+
+#endif
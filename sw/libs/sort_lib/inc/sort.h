@@ -0,0 +1,63 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Sorting and selection of integer arrays.
+ *
+ * radix_sort_* sorts in place, most significant byte first (American flag
+ * sort). Each byte is one pass that counts the keys per bucket and then moves
+ * every key straight into its bucket, buckets are sorted recursively on the
+ * next byte. The only extra memory is one 256 entry histogram on the stack
+ * shared by all levels, small buckets are finished with insertion sort.
+ * Arrays of 65536 or more elements, for which the 16 bit histogram is too
+ * small, are sorted by intro_sort_* instead.
+ *
+ * intro_sort_* is a quicksort with median of three pivots that switches to
+ * heapsort when the recursion gets deeper than 2 log2(n), so it stays
+ * O(n log n) on any input and its stack is bounded by recursing into the
+ * smaller partition only.
+ *
+ * select_* rearranges the array such that element k is the one that would be
+ * there after sorting, with no larger elements before and no smaller elements
+ * after it (nth_element). It partitions like intro_sort but only follows the
+ * side containing k, O(n) on average.
+ *
+ */
+#ifndef _SORT_H_
+#define _SORT_H_
+
+#include <stdint.h>
+
+void radix_sort_u8 (uint8_t*  a, int n);
+void radix_sort_u16(uint16_t* a, int n);
+void radix_sort_i16(int16_t*  a, int n);
+void radix_sort_u32(uint32_t* a, int n);
+void radix_sort_i32(int32_t*  a, int n);
+
+void intro_sort_u8 (uint8_t*  a, int n);
+void intro_sort_u16(uint16_t* a, int n);
+void intro_sort_i16(int16_t*  a, int n);
+void intro_sort_u32(uint32_t* a, int n);
+void intro_sort_i32(int32_t*  a, int n);
+
+/**
+ * @brief Sorts n elements of size bytes with a comparison function like the
+ * one of qsort, for records that are no plain integers.
+ */
+void intro_sort(void* a, int n, int size, int (*cmp)(const void*, const void*));
+
+uint8_t  select_u8 (uint8_t*  a, int n, int k);
+uint16_t select_u16(uint16_t* a, int n, int k);
+int16_t  select_i16(int16_t*  a, int n, int k);
+uint32_t select_u32(uint32_t* a, int n, int k);
+int32_t  select_i32(int32_t*  a, int n, int k);
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Streaming top-k selection.
+ *
+ * Keeps the k largest values seen so far in a min-heap, so a new value that
+ * does not make it into the top k costs one comparison and one that does
+ * costs O(log k). Every value carries an index, e.g. the bin of a spectral
+ * peak.
+ *
+ */
+#ifndef _TOPK_H_
+#define _TOPK_H_
+
+#include <stdint.h>
+
+typedef struct {
+  int32_t value;
+  int32_t index;
+} topk_item_t;
+
+typedef struct {
+  topk_item_t* heap;
+  int          k;
+  int          count;
+} topk_t;
+
+/**
+ * @param heap memory for k items
+ */
+void topk_init(topk_t* t, topk_item_t* heap, int k);
+
+void topk_push(topk_t* t, int32_t value, int32_t index);
+
+/**
+ * @brief Pushes n values, their indices are first, first + 1, ...
+ */
+void topk_push_i32(topk_t* t, const int32_t* a, int n, int32_t first);
+void topk_push_i16(topk_t* t, const int16_t* a, int n, int32_t first);
+
+/**
+ * @brief Sorts the items largest first, afterwards the heap has to be
+ * initialized again.
+ * @return number of items, at most k
+ */
+int topk_sort(topk_t* t);
+
+#endif
@@ -0,0 +1,192 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "running_median.h"
+
+// Positions in heap are relative to the median at 0: the min-heap of the
+// upper half uses 1..min_ct with the children of i at 2i and 2i + 1, the
+// max-heap of the lower half uses -1..-max_ct with the children of i at 2i
+// and 2i - 1. In both the parent of i is i / 2, so the median is the parent
+// of both roots.
+
+static inline int rmed_less(rmed_t* m, int i, int j)
+{
+  return m->data[m->heap[i]] < m->data[m->heap[j]];
+}
+
+// swaps the samples at positions i and j if the one at i is smaller
+static inline int rmed_cmp_exch(rmed_t* m, int i, int j)
+{
+  int16_t t;
+
+  if (!rmed_less(m, i, j))
+    return 0;
+
+  t          = m->heap[i];
+  m->heap[i] = m->heap[j];
+  m->heap[j] = t;
+  m->pos[m->heap[i]] = i;
+  m->pos[m->heap[j]] = j;
+
+  return 1;
+}
+
+static void rmed_min_down(rmed_t* m, int i)
+{
+  for (i *= 2; i <= m->min_ct; i *= 2) {
+    if (i < m->min_ct && rmed_less(m, i + 1, i))
+      i++;
+
+    if (!rmed_cmp_exch(m, i, i / 2))
+      break;
+  }
+}
+
+static void rmed_max_down(rmed_t* m, int i)
+{
+  for (i *= 2; i >= -m->max_ct; i *= 2) {
+    if (i > -m->max_ct && rmed_less(m, i, i - 1))
+      i--;
+
+    if (!rmed_cmp_exch(m, i / 2, i))
+      break;
+  }
+}
+
+// returns 1 if the sample went all the way up to the median
+static int rmed_min_up(rmed_t* m, int i)
+{
+  while (i > 0 && rmed_cmp_exch(m, i, i / 2))
+    i /= 2;
+
+  return i == 0;
+}
+
+static int rmed_max_up(rmed_t* m, int i)
+{
+  while (i < 0 && rmed_cmp_exch(m, i / 2, i))
+    i /= 2;
+
+  return i == 0;
+}
+
+unsigned int rmed_size(int w)
+{
+  return w * sizeof(int32_t) + 2 * ((w * sizeof(int16_t) + 3) & ~3);
+}
+
+int rmed_init(rmed_t* m, int w, void* mem)
+{
+  int i;
+
+  if (w < 1 || w > RMED_MAX_WINDOW)
+    return -1;
+
+  m->data   = (int32_t*)mem;
+  m->pos    = (int16_t*)(m->data + w);
+  m->heap   = (int16_t*)((char*)m->pos + ((w * sizeof(int16_t) + 3) & ~3));
+  m->w      = w;
+  m->idx    = 0;
+  m->min_ct = 0;
+  m->max_ct = 0;
+
+  // centre the heap array on the median
+  m->heap += w / 2;
+
+  // samples take positions 0, -1, 1, -2, 2, ... while the window fills up
+  for (i = w - 1; i >= 0; i--) {
+    m->pos[i]          = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+    m->heap[m->pos[i]] = i;
+    m->data[i]         = 0;
+  }
+
+  return 0;
+}
+
+int32_t rmed_push(rmed_t* m, int32_t v)
+{
+  int     p   = m->pos[m->idx];
+  int32_t old = m->data[m->idx];
+  int32_t med, lo;
+
+  m->data[m->idx] = v;
+  if (++m->idx == m->w)
+    m->idx = 0;
+
+  if (p > 0) {
+    // in the min-heap
+    if (m->min_ct < (m->w - 1) / 2)
+      m->min_ct++;
+    else if (v > old) {
+      rmed_min_down(m, p);
+      goto done;
+    }
+
+    if (rmed_min_up(m, p) && rmed_cmp_exch(m, 0, -1))
+      rmed_max_down(m, -1);
+  } else if (p < 0) {
+    // in the max-heap
+    if (m->max_ct < m->w / 2)
+      m->max_ct++;
+    else if (v < old) {
+      rmed_max_down(m, p);
+      goto done;
+    }
+
+    if (rmed_max_up(m, p) && m->min_ct && rmed_cmp_exch(m, 1, 0))
+      rmed_min_down(m, 1);
+  } else {
+    // the median itself
+    if (m->max_ct && rmed_max_up(m, -1))
+      rmed_max_down(m, -1);
+
+    if (m->min_ct && rmed_min_up(m, 1))
+      rmed_min_down(m, 1);
+  }
+
+done:
+  med = m->data[m->heap[0]];
+
+  // one more sample in the lower half, the median is between two samples
+  if (m->min_ct < m->max_ct) {
+    lo  = m->data[m->heap[-1]];
+    med = (med >> 1) + (lo >> 1) + (med & lo & 1);
+  }
+
+  return med;
+}
+
+int rmed_filter_i32(const int32_t* in, int32_t* out, int n, int w, void* mem)
+{
+  rmed_t m;
+  int    i;
+
+  if (rmed_init(&m, w, mem) != 0)
+    return -1;
+
+  for (i = 0; i < n; i++)
+    out[i] = rmed_push(&m, in[i]);
+
+  return 0;
+}
+
+int rmed_filter_i16(const int16_t* in, int16_t* out, int n, int w, void* mem)
+{
+  rmed_t m;
+  int    i;
+
+  if (rmed_init(&m, w, mem) != 0)
+    return -1;
+
+  for (i = 0; i < n; i++)
+    out[i] = rmed_push(&m, in[i]);
+
+  return 0;
+}
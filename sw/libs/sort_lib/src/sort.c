@@ -0,0 +1,196 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include "sort.h"
+
+// partitions below are finished with insertion sort
+#define SORT_INSERTION  16
+// radix buckets below are finished with insertion sort
+#define SORT_RADIX_MIN  32
+
+#define SORT_CAT2(a, b)  a##b
+#define SORT_CAT(a, b)   SORT_CAT2(a, b)
+
+static int sort_log2(int n)
+{
+  int l = 0;
+
+  while (n >>= 1)
+    l++;
+
+  return l;
+}
+
+#define SORT_T          uint8_t
+#define SORT_U          uint8_t
+#define SORT_BITS       8
+#define SORT_FLIP       0
+#define SORT_NAME(f)    SORT_CAT(f, u8)
+#include "sort_template.h"
+#undef SORT_T
+#undef SORT_U
+#undef SORT_BITS
+#undef SORT_FLIP
+#undef SORT_NAME
+
+#define SORT_T          uint16_t
+#define SORT_U          uint16_t
+#define SORT_BITS       16
+#define SORT_FLIP       0
+#define SORT_NAME(f)    SORT_CAT(f, u16)
+#include "sort_template.h"
+#undef SORT_T
+#undef SORT_U
+#undef SORT_BITS
+#undef SORT_FLIP
+#undef SORT_NAME
+
+#define SORT_T          int16_t
+#define SORT_U          uint16_t
+#define SORT_BITS       16
+#define SORT_FLIP       0x8000
+#define SORT_NAME(f)    SORT_CAT(f, i16)
+#include "sort_template.h"
+#undef SORT_T
+#undef SORT_U
+#undef SORT_BITS
+#undef SORT_FLIP
+#undef SORT_NAME
+
+#define SORT_T          uint32_t
+#define SORT_U          uint32_t
+#define SORT_BITS       32
+#define SORT_FLIP       0
+#define SORT_NAME(f)    SORT_CAT(f, u32)
+#include "sort_template.h"
+#undef SORT_T
+#undef SORT_U
+#undef SORT_BITS
+#undef SORT_FLIP
+#undef SORT_NAME
+
+#define SORT_T          int32_t
+#define SORT_U          uint32_t
+#define SORT_BITS       32
+#define SORT_FLIP       0x80000000
+#define SORT_NAME(f)    SORT_CAT(f, i32)
+#include "sort_template.h"
+#undef SORT_T
+#undef SORT_U
+#undef SORT_BITS
+#undef SORT_FLIP
+#undef SORT_NAME
+
+////////////////////////////////////////////////////////////////////////////////
+// records with a comparison function
+////////////////////////////////////////////////////////////////////////////////
+
+static void sort_swap(char* a, char* b, int size)
+{
+  char t;
+
+  while (size--) {
+    t    = *a;
+    *a++ = *b;
+    *b++ = t;
+  }
+}
+
+static void sort_insertion(char* a, int n, int size, int (*cmp)(const void*, const void*))
+{
+  int i, j;
+
+  for (i = 1; i < n; i++)
+    for (j = i; j > 0 && cmp(a + (j - 1) * size, a + j * size) > 0; j--)
+      sort_swap(a + (j - 1) * size, a + j * size, size);
+}
+
+static void sort_sift_down(char* a, int root, int n, int size, int (*cmp)(const void*, const void*))
+{
+  int child;
+
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n && cmp(a + (child + 1) * size, a + child * size) > 0)
+      child++;
+
+    if (cmp(a + child * size, a + root * size) <= 0)
+      break;
+
+    sort_swap(a + child * size, a + root * size, size);
+    root = child;
+  }
+}
+
+// the pivot is swapped to the front, so it stays put while partitioning
+static int sort_partition(char* a, int n, int size, int (*cmp)(const void*, const void*))
+{
+  char* lo = a;
+  char* mid = a + (n / 2) * size;
+  char* hi = a + (n - 1) * size;
+  int   i = 0, j = n;
+
+  if (cmp(mid, lo) < 0) sort_swap(mid, lo, size);
+  if (cmp(hi, mid) < 0) sort_swap(hi, mid, size);
+  if (cmp(mid, lo) < 0) sort_swap(mid, lo, size);
+
+  sort_swap(lo, mid, size);
+
+  for (;;) {
+    while (++i < n && cmp(a + i * size, a) < 0);
+    while (cmp(a + (--j) * size, a) > 0);
+
+    if (i >= j)
+      break;
+
+    sort_swap(a + i * size, a + j * size, size);
+  }
+
+  sort_swap(a, a + j * size, size);
+  return j;
+}
+
+static void sort_intro(char* a, int n, int size, int depth, int (*cmp)(const void*, const void*))
+{
+  int i, p;
+
+  while (n > SORT_INSERTION) {
+    if (depth-- == 0) {
+      for (i = n / 2 - 1; i >= 0; i--)
+        sort_sift_down(a, i, n, size, cmp);
+
+      for (i = n - 1; i > 0; i--) {
+        sort_swap(a, a + i * size, size);
+        sort_sift_down(a, 0, i, size, cmp);
+      }
+      return;
+    }
+
+    // the pivot ends up at p and is in its final place
+    p = sort_partition(a, n, size, cmp);
+
+    if (p < n - p) {
+      sort_intro(a, p, size, depth, cmp);
+      a += (p + 1) * size;
+      n -= p + 1;
+    } else {
+      sort_intro(a + (p + 1) * size, n - p - 1, size, depth, cmp);
+      n = p;
+    }
+  }
+
+  sort_insertion(a, n, size, cmp);
+}
+
+void intro_sort(void* a, int n, int size, int (*cmp)(const void*, const void*))
+{
+  sort_intro((char*)a, n, size, 2 * sort_log2(n), cmp);
+}
@@ -0,0 +1,230 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Sorting and selection for one key type, included by sort.c once per type
+// with
+//   SORT_T      the key type
+//   SORT_U      the unsigned type of the same width
+//   SORT_BITS   its width
+//   SORT_FLIP   the sign bit for signed types, 0 otherwise
+//   SORT_NAME() appends the type suffix to a function name
+
+// unsigned image of a key that sorts in the same order
+#define SORT_KEY(x)       ((SORT_U)((SORT_U)(x) ^ SORT_FLIP))
+#define SORT_DIGIT(x, s)  ((int)((SORT_KEY(x) >> (s)) & 0xFF))
+
+static void SORT_NAME(insertion_sort_)(SORT_T* a, int n)
+{
+  int i, j;
+
+  for (i = 1; i < n; i++) {
+    SORT_T v = a[i];
+
+    for (j = i; j > 0 && a[j - 1] > v; j--)
+      a[j] = a[j - 1];
+
+    a[j] = v;
+  }
+}
+
+static void SORT_NAME(sift_down_)(SORT_T* a, int root, int n)
+{
+  SORT_T v = a[root];
+  int    child;
+
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n && a[child + 1] > a[child])
+      child++;
+
+    if (a[child] <= v)
+      break;
+
+    a[root] = a[child];
+    root    = child;
+  }
+
+  a[root] = v;
+}
+
+static void SORT_NAME(heap_sort_)(SORT_T* a, int n)
+{
+  SORT_T t;
+  int    i;
+
+  for (i = n / 2 - 1; i >= 0; i--)
+    SORT_NAME(sift_down_)(a, i, n);
+
+  for (i = n - 1; i > 0; i--) {
+    t    = a[0];
+    a[0] = a[i];
+    a[i] = t;
+    SORT_NAME(sift_down_)(a, 0, i);
+  }
+}
+
+// Hoare partition around the median of first, middle and last element, which
+// also act as sentinels for the scans. Returns p with a[0..p-1] <= a[p..n-1],
+// both parts not empty. n has to be at least 3.
+static int SORT_NAME(partition_)(SORT_T* a, int n)
+{
+  SORT_T t, pivot;
+  int    m = n / 2;
+  int    i = 0, j = n - 1;
+
+  if (a[m] < a[0])     { t = a[m];     a[m]     = a[0]; a[0] = t; }
+  if (a[n - 1] < a[m]) { t = a[n - 1]; a[n - 1] = a[m]; a[m] = t; }
+  if (a[m] < a[0])     { t = a[m];     a[m]     = a[0]; a[0] = t; }
+
+  pivot = a[m];
+
+  for (;;) {
+    while (a[++i] < pivot);
+    while (a[--j] > pivot);
+
+    if (i >= j)
+      return i;
+
+    t    = a[i];
+    a[i] = a[j];
+    a[j] = t;
+  }
+}
+
+static void SORT_NAME(intro_)(SORT_T* a, int n, int depth)
+{
+  int p;
+
+  while (n > SORT_INSERTION) {
+    if (depth-- == 0) {
+      SORT_NAME(heap_sort_)(a, n);
+      return;
+    }
+
+    p = SORT_NAME(partition_)(a, n);
+
+    // recurse into the smaller part, loop on the larger one
+    if (p < n - p) {
+      SORT_NAME(intro_)(a, p, depth);
+      a += p;
+      n -= p;
+    } else {
+      SORT_NAME(intro_)(a + p, n - p, depth);
+      n = p;
+    }
+  }
+
+  SORT_NAME(insertion_sort_)(a, n);
+}
+
+void SORT_NAME(intro_sort_)(SORT_T* a, int n)
+{
+  SORT_NAME(intro_)(a, n, 2 * sort_log2(n));
+}
+
+SORT_T SORT_NAME(select_)(SORT_T* a, int n, int k)
+{
+  int depth = 2 * sort_log2(n);
+  int lo = 0, hi = n;
+  int p;
+
+  while (hi - lo > SORT_INSERTION) {
+    if (depth-- == 0) {
+      SORT_NAME(heap_sort_)(a + lo, hi - lo);
+      return a[k];
+    }
+
+    p = lo + SORT_NAME(partition_)(a + lo, hi - lo);
+
+    if (k < p)
+      hi = p;
+    else
+      lo = p;
+  }
+
+  SORT_NAME(insertion_sort_)(a + lo, hi - lo);
+  return a[k];
+}
+
+// one American flag pass on the byte at shift, then the buckets on the next
+// byte; the histogram is only used before recursing, so all levels share it
+static void SORT_NAME(radix_)(SORT_T* a, int n, int shift, uint16_t* count, uint16_t* head)
+{
+  SORT_T v, t;
+  int    b, d, i, j, sum;
+
+  for (b = 0; b < 256; b++)
+    count[b] = 0;
+
+  for (i = 0; i < n; i++)
+    count[SORT_DIGIT(a[i], shift)]++;
+
+  // all keys in one bucket, nothing to move on this byte
+  if (count[SORT_DIGIT(a[0], shift)] != n) {
+    // head is where the next key of a bucket goes, count becomes its end
+    for (b = 0, sum = 0; b < 256; b++) {
+      head[b]  = sum;
+      sum     += count[b];
+      count[b] = sum;
+    }
+
+    for (b = 0; b < 256; b++) {
+      while (head[b] < count[b]) {
+        v = a[head[b]];
+        d = SORT_DIGIT(v, shift);
+
+        // follow the cycle until a key for bucket b turns up
+        while (d != b) {
+          t = a[head[d]];
+          a[head[d]++] = v;
+          v = t;
+          d = SORT_DIGIT(v, shift);
+        }
+
+        a[head[b]++] = v;
+      }
+    }
+  }
+
+  if (shift == 0)
+    return;
+
+  // the bucket bounds are gone with the next level, find them again
+  for (i = 0; i < n; i = j) {
+    d = SORT_DIGIT(a[i], shift);
+
+    for (j = i + 1; j < n && SORT_DIGIT(a[j], shift) == d; j++);
+
+    if (j - i > SORT_RADIX_MIN)
+      SORT_NAME(radix_)(a + i, j - i, shift - 8, count, head);
+    else
+      SORT_NAME(insertion_sort_)(a + i, j - i);
+  }
+}
+
+void SORT_NAME(radix_sort_)(SORT_T* a, int n)
+{
+  uint16_t count[256];
+  uint16_t head[256];
+
+  if (n >= 65536) {
+    SORT_NAME(intro_sort_)(a, n);
+    return;
+  }
+
+  if (n <= SORT_RADIX_MIN) {
+    SORT_NAME(insertion_sort_)(a, n);
+    return;
+  }
+
+  SORT_NAME(radix_)(a, n, SORT_BITS - 8, count, head);
+}
+
+#undef SORT_KEY
+#undef SORT_DIGIT
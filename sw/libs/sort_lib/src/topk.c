@@ -0,0 +1,122 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "topk.h"
+
+void topk_init(topk_t* t, topk_item_t* heap, int k)
+{
+  t->heap  = heap;
+  t->k     = k;
+  t->count = 0;
+}
+
+// the smallest item is at the root
+static void topk_sift_down(topk_item_t* h, int root, int n)
+{
+  topk_item_t v = h[root];
+  int         child;
+
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n && h[child + 1].value < h[child].value)
+      child++;
+
+    if (h[child].value >= v.value)
+      break;
+
+    h[root] = h[child];
+    root    = child;
+  }
+
+  h[root] = v;
+}
+
+static void topk_insert(topk_t* t, int32_t value, int32_t index)
+{
+  topk_item_t* h = t->heap;
+  int          i, parent;
+
+  if (t->count < t->k) {
+    // still filling up, sift the new item up from the bottom
+    for (i = t->count++; i > 0; i = parent) {
+      parent = (i - 1) / 2;
+      if (h[parent].value <= value)
+        break;
+      h[i] = h[parent];
+    }
+  } else {
+    // replace the root and sift it down
+    h[0].value = value;
+    h[0].index = index;
+    topk_sift_down(h, 0, t->k);
+    return;
+  }
+
+  h[i].value = value;
+  h[i].index = index;
+}
+
+void topk_push(topk_t* t, int32_t value, int32_t index)
+{
+  if (t->k == 0)
+    return;
+
+  if (t->count < t->k || value > t->heap[0].value)
+    topk_insert(t, value, index);
+}
+
+void topk_push_i32(topk_t* t, const int32_t* a, int n, int32_t first)
+{
+  int i;
+
+  for (i = 0; i < n && t->count < t->k; i++)
+    topk_insert(t, a[i], first + i);
+
+  if (t->k == 0)
+    return;
+
+  // the common case only compares against the smallest item kept
+  for (; i < n; i++) {
+    if (a[i] > t->heap[0].value)
+      topk_insert(t, a[i], first + i);
+  }
+}
+
+void topk_push_i16(topk_t* t, const int16_t* a, int n, int32_t first)
+{
+  int i;
+
+  for (i = 0; i < n && t->count < t->k; i++)
+    topk_insert(t, a[i], first + i);
+
+  if (t->k == 0)
+    return;
+
+  for (; i < n; i++) {
+    if (a[i] > t->heap[0].value)
+      topk_insert(t, a[i], first + i);
+  }
+}
+
+int topk_sort(topk_t* t)
+{
+  topk_item_t  v;
+  topk_item_t* h = t->heap;
+  int          i;
+
+  // popping the smallest item to the back leaves the largest in front
+  for (i = t->count - 1; i > 0; i--) {
+    v    = h[0];
+    h[0] = h[i];
+    h[i] = v;
+    topk_sift_down(h, 0, i);
+  }
+
+  return t->count;
+}
@@ -12,6 +12,7 @@
 #define STRING_LIB_H
 
 #include <stddef.h>
+#include <stdarg.h>
 
 #include "pulpino.h"
 
@@ -25,6 +26,9 @@ int  strcmp (const char *s1, const char *s2);
 char* strcpy (char *s1, const char *s2);
 int puts(const char *s);
 int printf(const char *format, ...);
+int vprintf(const char *format, va_list va);
+int snprintf(char *str, size_t size, const char *format, ...);
+int vsnprintf(char *str, size_t size, const char *format, va_list va);
 void * memset (void *dest, int val, size_t len);
 int putchar(int s);
 
@@ -19,6 +19,10 @@
 /* the following should be enough for 32 bit int */
 #define PRINT_BUF_LEN 32
 
+/* printf collects its output in a buffer of this size before handing it to
+ * the UART, a multiple of the FIFO depth makes every burst a full one */
+#define PRINTF_LINE_BUF_LEN UART_FIFO_DEPTH
+
 /* define LONG_MAX for int32 */
 #define LONG_MAX 2147483647L
 
@@ -66,18 +70,48 @@ int putchar(int s)
   return s;
 }
 
-static void qprintchar(char **str, int c)
+// Output sink used by qprint. In string mode characters are written to buf
+// as long as there is room for the terminating NUL, everything beyond is
+// counted but dropped. In UART mode buf is a line buffer which is handed to
+// uart_send in one piece whenever it fills up, so that the UART FIFO is
+// loaded in bursts instead of polling LSR for every single character.
+typedef struct {
+  char  *buf;
+  size_t len;
+  size_t size;
+  int    uart;
+} qprint_out_t;
+
+static void qprintflush(qprint_out_t *out)
+{
+  if (out->uart && out->len) {
+    uart_send(out->buf, out->len);
+    out->len = 0;
+  }
+}
+
+static void qprintchar(qprint_out_t *out, int c)
 {
-  if (str)
+  if (out->uart)
+  {
+    if (out->len == out->size)
+      qprintflush(out);
+
+    out->buf[out->len++] = c;
+  }
+  else if (out->len + 1 < out->size)
   {
-    **str = c;
-    ++(*str);
+    out->buf[out->len++] = c;
   }
   else
-    putchar((char)c);
+  {
+    // string is full, keep counting so that the return value matches the
+    // one of a standard vsnprintf
+    out->len++;
+  }
 }
 
-static int qprints(char **out, const char *string, int width, int pad)
+static int qprints(qprint_out_t *out, const char *string, int width, int pad)
 {
   register int pc = 0, padchar = ' ';
 
@@ -107,7 +141,7 @@ static int qprints(char **out, const char *string, int width, int pad)
   return pc;
 }
 
-static int qprinti(char **out, int i, int b, int sg, int width, int pad, char letbase)
+static int qprinti(qprint_out_t *out, int i, int b, int sg, int width, int pad, char letbase)
 {
   char print_buf[PRINT_BUF_LEN];
   register char *s;
@@ -165,7 +199,7 @@ static int qprinti(char **out, int i, int b, int sg, int width, int pad, char le
   return pc + qprints (out, s, width, pad);
 }
 
-static int qprint(char **out, const char *format, va_list va)
+static int qprint(qprint_out_t *out, const char *format, va_list va)
 {
   register int width, pad;
   register int pc = 0;
@@ -228,11 +262,25 @@ out:
       ++pc;
     }
   }
-  if (out) **out = '\0';
+
+  if (out->uart)
+    qprintflush(out);
+  else if (out->size)
+    out->buf[out->len < out->size ? out->len : out->size - 1] = '\0';
 
   return pc;
 }
 
+int vprintf(const char *format, va_list va)
+{
+  // the line buffer lives on the stack of the caller, so printf stays
+  // reentrant and can be used from interrupt handlers as before
+  char line_buf[PRINTF_LINE_BUF_LEN];
+  qprint_out_t out = { line_buf, 0, PRINTF_LINE_BUF_LEN, 1 };
+
+  return qprint(&out, format, va);
+}
+
 int printf(const char *format, ...)
 {
   int pc;
@@ -240,7 +288,7 @@ int printf(const char *format, ...)
 
   va_start(va, format);
 
-  pc = qprint(0, format, va);
+  pc = vprintf(format, va);
 
   va_end(va);
 
@@ -248,13 +296,32 @@ int printf(const char *format, ...)
 
 }
 
-int puts(const char *s)
+int vsnprintf(char *str, size_t size, const char *format, va_list va)
 {
-  int i=0;
+  qprint_out_t out = { str, 0, size, 0 };
 
-  while(s[i] != '\0')
-    putchar(s[i++]);
+  return qprint(&out, format, va);
+}
+
+int snprintf(char *str, size_t size, const char *format, ...)
+{
+  int pc;
+  va_list va;
+
+  va_start(va, format);
+
+  pc = vsnprintf(str, size, format, va);
+
+  va_end(va);
+
+  return pc;
+}
+
+int puts(const char *s)
+{
+  int i = strlen(s);
 
+  uart_send(s, i);
   putchar('\n');
 
   return i;
@@ -0,0 +1,164 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief FLL driver and run time frequency scaling.
+ *
+ * The SoC clock is either the reference clock from the pad or the output of
+ * the FLL, selected by the clk_sel pin. With the FLL selected, clk_set_freq
+ * changes the frequency while the application runs, so it can sprint through
+ * DSP bursts and slow down between them.
+ *
+ * Every peripheral divisor derived from the SoC clock breaks when the clock
+ * changes. Code that depends on the frequency registers a notifier, which is
+ * called before the change (to drain or pause transfers) and after it (to
+ * recompute divisors). Notifiers for the UART baud rate, the SPI master and
+ * I2C clocks and the timer compare values come with the library, see the
+ * clk_keep_* functions.
+ *
+ * Without the FLL (FPGA, RTL simulation) the library only keeps track of the
+ * fixed frequency given to clk_init and clk_set_freq does nothing.
+ *
+ * Switching from an interrupt handler is not supported. SPI transfers have
+ * to be finished before a switch, the CLKDIV register must not change while
+ * one is in progress.
+ *
+ */
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+#include "pulpino.h"
+
+#define FLL_REG_STATUS  ( FLL_BASE_ADDR + 0x00 ) // current multiplication factor (Read Only)
+#define FLL_REG_CONF1   ( FLL_BASE_ADDR + 0x04 ) // mode, divider, DCO code, target factor
+#define FLL_REG_CONF2   ( FLL_BASE_ADDR + 0x08 ) // loop gain and lock detection
+#define FLL_REG_INTEG   ( FLL_BASE_ADDR + 0x0C ) // integrator state
+
+#define FLL_STATUS REG(FLL_REG_STATUS)
+#define FLL_CONF1  REG(FLL_REG_CONF1)
+#define FLL_CONF2  REG(FLL_REG_CONF2)
+#define FLL_INTEG  REG(FLL_REG_INTEG)
+
+#define FLL_CONF1_MULT_MASK   0x0000FFFF  // target multiplication factor
+#define FLL_CONF1_DCO_MASK    0x03FF0000  // DCO input code for open loop mode
+#define FLL_CONF1_DIV_SHIFT   26          // output divider, 2^(DIV-1)
+#define FLL_CONF1_DIV_MASK    0x3C000000
+#define FLL_CONF1_LOCK_EN     (1u << 30)   // gate the output until locked
+#define FLL_CONF1_MODE_NORMAL (1u << 31)   // closed loop
+
+/** Reference clock of the FLL */
+#ifndef FLL_REF_CLK_HZ
+#define FLL_REF_CLK_HZ  32768
+#endif
+
+/** Maximum DCO frequency, log2 */
+#define FLL_LOG2_MAXDCO 29
+
+/** Status polls until the FLL counts as locked */
+#define FLL_LOCK_TIMEOUT 100000
+
+#define CLK_MAX_NOTIFIERS 8
+
+#define CLK_FIXED 0   ///< the SoC runs from the reference clock
+#define CLK_FLL   1   ///< the SoC runs from the FLL
+
+#define CLK_PRE_CHANGE  0
+#define CLK_POST_CHANGE 1
+
+#define CLK_TIMER_A 0x1   ///< timers for clk_keep_timer_rates
+#define CLK_TIMER_B 0x2
+
+/** Called with CLK_PRE_CHANGE before and CLK_POST_CHANGE after every
+ * frequency change. new_hz of the second call is the frequency the FLL
+ * actually reached, it only differs from the first one if it did not lock.
+ */
+typedef void (*clk_notifier_t)(int event, uint32_t old_hz, uint32_t new_hz, void* arg);
+
+/** Computes the FLL setting closest to a frequency.
+ *
+ * @param hz    wanted frequency
+ * @param mult  multiplication factor for CONF1
+ * @param div   output divider for CONF1
+ *
+ * @return the frequency the setting results in
+ */
+uint32_t fll_freq_cfg(uint32_t hz, uint32_t* mult, uint32_t* div);
+
+/** Frequency the FLL currently runs at, from its status register */
+uint32_t fll_get_freq(void);
+
+/** Programs the FLL and waits until it is locked.
+ *
+ * @return the new frequency, 0 if the FLL did not lock in time
+ */
+uint32_t fll_set_freq(uint32_t hz);
+
+/** Tells the library where the SoC clock comes from, has to be called
+ * before anything else of this file.
+ *
+ * @param source  CLK_FIXED or CLK_FLL
+ * @param hz      frequency of a fixed clock, for CLK_FLL 0 reads the current
+ *                frequency from the FLL, otherwise the FLL is programmed
+ */
+void clk_init(int source, uint32_t hz);
+
+/** Current SoC frequency */
+uint32_t clk_get_freq(void);
+
+/** Changes the SoC frequency and calls the notifiers.
+ *
+ * @return the frequency set, which is the closest the FLL can generate
+ */
+uint32_t clk_set_freq(uint32_t hz);
+
+/** Registers a notifier, they are called in the order of registration.
+ *
+ * @return 0 on success, -1 if all CLK_MAX_NOTIFIERS slots are in use
+ */
+int clk_register(clk_notifier_t notifier, void* arg);
+
+/** Removes a notifier registered with the same arguments. */
+void clk_unregister(clk_notifier_t notifier, void* arg);
+
+/** UART clock counter for a baud rate, see uart_set_cfg */
+uint16_t clk_uart_counter(uint32_t hz, uint32_t baud);
+
+/** SPI master CLKDIV for an SPI clock, rounded to the next slower one */
+uint32_t clk_spi_div(uint32_t hz, uint32_t spi_hz);
+
+/** I2C prescaler for an SCL frequency, rounded to the next slower one */
+uint32_t clk_i2c_pre(uint32_t hz, uint32_t scl_hz);
+
+/** Sets the UART to baud now and after every frequency change. The UART is
+ * drained before each change.
+ */
+int clk_keep_uart_baud(uint32_t baud);
+
+/** Sets the SPI master clock now and after every frequency change. */
+int clk_keep_spi_rate(uint32_t spi_hz);
+
+/** Sets the I2C clock now and after every frequency change, a byte in
+ * transfer is finished first.
+ */
+int clk_keep_i2c_rate(uint32_t scl_hz);
+
+/** Scales the counter and compare value of the given timers with every
+ * frequency change, so their interrupts keep the same rate in seconds.
+ * Timers not in the mask are left alone. A timer used as a time base, timer A
+ * by the bench functions or timer B by gpio_capture and i2c_sched, must not
+ * be given, scaling would move its count.
+ *
+ * @param timers  CLK_TIMER_A, CLK_TIMER_B or both, replaces an earlier mask
+ */
+int clk_keep_timer_rates(uint32_t timers);
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Run time detection of the core and its ISA extensions.
+ *
+ * One image may run on RI5CY, RI5CY with FPU and zero-riscy. The cores of
+ * PULPino do not implement misa, so every extension is detected by executing
+ * one of its instructions with a known result. A core without the extension
+ * raises an illegal instruction exception, illegal_insn_handler_c passes it
+ * to cpu_probe_trap, which skips the instruction and records the fault.
+ *
+ * The result is computed once and cached, probing runs with interrupts
+ * disabled. Applications that replace illegal_insn_handler_c have to call
+ * cpu_probe_trap first if they use cpu_features.
+ *
+ */
+#ifndef _CPU_FEATURES_H_
+#define _CPU_FEATURES_H_
+
+#define CPU_FEAT_M      0x1   ///< multiply and divide
+#define CPU_FEAT_XPULP  0x2   ///< PULP extensions, hardware loops and packed SIMD
+#define CPU_FEAT_F      0x4   ///< single precision floating point
+
+/** Extensions of the core, probed on the first call.
+ *
+ * @return mask of CPU_FEAT_* flags
+ */
+unsigned int cpu_features(void);
+
+/** Called by illegal_insn_handler_c before anything else.
+ *
+ * @return 1 if the exception was raised by a probe and has been handled, the
+ *         handler has to return right away
+ */
+int cpu_probe_trap(void);
+
+#endif // _CPU_FEATURES_H_
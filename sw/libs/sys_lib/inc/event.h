@@ -77,11 +77,55 @@
 
 
 // ISRS
+#define I2C_EVENT               23
+#define UART_EVENT              24
 #define GPIO_EVENT              25
+#define SPIM0_EVENT             26
+#define SPIM1_EVENT             27
 #define TIMER_A_OVERFLOW        0x1C
 #define TIMER_A_OUTPUT_CMP      0x1D
 #define TIMER_B_OVERFLOW        0x1E
 #define TIMER_B_OUTPUT_CMP      0x1F
 
+/** Timer B ticks a driver sleeps at most before it checks its status
+ * register again, in case the peripheral does not raise an event.
+ */
+#ifndef EVENT_POLL_TICKS
+#define EVENT_POLL_TICKS        1024
+#endif
+
+/**
+ * \brief Puts the core to sleep until an event arrives.
+ * \param mask    event lines to wait for
+ * \param timeout maximum time in cycles, timer B counts them without prescaler,
+ *                0 waits forever
+ * \return the pending events of mask, which are cleared, 0 on timeout
+ *
+ * The lines in mask are enabled in EER for the wait. An event that arrived
+ * before the call ends the wait right away, so checking a condition and
+ * then waiting for its event can not miss a wake up. Interrupts wake the
+ * core as well and are handled as usual.
+ *
+ * The timeout borrows timer B while it is stopped: counter, compare value
+ * and control, including the prescaler, are restored afterwards. A running timer B belongs to someone
+ * else (gpio_capture, i2c_sched, Arduino PWM), whose time base a compare
+ * would reset, so a wait with a timeout then only returns the pending
+ * events without sleeping and the caller polls.
+ */
+unsigned int event_wait(unsigned int mask, unsigned int timeout);
+
+/**
+ * Waits until cond is true, sleeping until one of the events in mask in
+ * between. The core wakes up at least every EVENT_POLL_TICKS to check cond
+ * again, so a peripheral that does not raise its event only slows the
+ * driver down. While timer B runs as a time base the loop spins on cond.
+ * Compiling with EVENT_BUSY_POLL always spins on cond.
+ */
+#ifdef EVENT_BUSY_POLL
+#define EVENT_WAIT_UNTIL(cond, mask) while (!(cond))
+#else
+#define EVENT_WAIT_UNTIL(cond, mask) while (!(cond)) event_wait((mask), EVENT_POLL_TICKS)
+#endif
+
 
 #endif
@@ -0,0 +1,214 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Timestamped GPIO edge capture.
+ *
+ * The GPIO interrupt records every level change of a set of pins together
+ * with the value of timer B into a single producer, single consumer ring
+ * buffer. Decoders for quadrature encoders, pulse widths and NEC infrared
+ * frames consume the records in task context, so the CPU is never blocked
+ * counting a pulse like pulseIn does.
+ *
+ * The captured pins use level interrupts armed on the opposite of their
+ * current level. The handler re-arms them and polls PADIN once more before it
+ * returns, so an edge arriving while it runs is recorded by the same
+ * invocation instead of being lost. A pulse shorter than the interrupt
+ * latency is swallowed as a whole, the records of one pin therefore always
+ * alternate in level.
+ *
+ * The capture service provides ISR_GPIO, applications using it must not
+ * define their own GPIO handler. Only one capture can be active at a time.
+ *
+ * Cost per edge, with the ISR_X_ASM register save and restore of crt0
+ * (17 registers and 6 hardware loop CSRs each way) and seven APB accesses in
+ * the handler:
+ *
+ *   core          entry+exit   handler   total   max rate @ 25 MHz
+ *   RI5CY         ~70          ~60       ~130    ~190 kEdges/s
+ *   zero-riscy    ~110         ~75       ~185    ~135 kEdges/s
+ *   micro-riscy   ~110         ~75       ~185    ~135 kEdges/s
+ *
+ * An edge arriving while the handler runs costs only its inner loop, about
+ * 35 cycles, so short bursts can be faster. The sustained rate has to leave
+ * room for the consumer: at half the rates above the decoders still get half
+ * of the CPU. Run the testGpioCapture application to measure the entry and
+ * exit cost on a given configuration.
+ *
+ */
+#ifndef _GPIO_CAPTURE_H_
+#define _GPIO_CAPTURE_H_
+
+#include <stdint.h>
+
+/** One capture record */
+typedef struct {
+  uint32_t time;   ///< timer B value when the change was seen
+  uint32_t pins;   ///< captured pins that changed since the previous record
+  uint32_t level;  ///< level of all captured pins after the change
+} gpio_edge_t;
+
+typedef struct {
+  gpio_edge_t*      buf;
+  uint32_t          mask;     ///< ring size - 1
+  volatile uint32_t head;     ///< free running, written by the producer only
+  volatile uint32_t tail;     ///< free running, written by the consumer only
+  volatile uint32_t dropped;  ///< records lost because the ring was full
+  uint32_t          pins;     ///< captured pins
+  uint32_t          last;     ///< level of the previous record
+  uint32_t          type0;    ///< INTTYPE0 of the pins that are not captured
+} gpio_capture_t;
+
+/** Initializes a capture ring, does not touch the hardware.
+ *
+ * @param cap   capture state
+ * @param buf   storage for size records
+ * @param size  number of records, a power of two
+ * @param pins  mask of the pins to capture
+ *
+ * @return 0 on success, -1 if size is not a power of two
+ */
+int gpio_capture_init(gpio_capture_t* cap, gpio_edge_t* buf, unsigned int size, uint32_t pins);
+
+/** Arms the level interrupts of the captured pins and enables the GPIO
+ * interrupt in the event unit. Timer B becomes the free running time base, see
+ * timer_b_time_base, timestamps are in its ticks. The pins have to be
+ * configured as GPIO inputs beforehand.
+ */
+void gpio_capture_start(gpio_capture_t* cap);
+
+/** Disables the interrupts of the captured pins, records in the ring stay
+ * available.
+ */
+void gpio_capture_stop(gpio_capture_t* cap);
+
+/** Appends a record, called by the GPIO interrupt handler.
+ *
+ * @return 0 if the ring was full and the record was dropped
+ */
+static inline int gpio_capture_put(gpio_capture_t* cap, uint32_t time, uint32_t pins, uint32_t level) {
+  uint32_t head = cap->head;
+  gpio_edge_t* e;
+
+  if (head - cap->tail > cap->mask) {
+    cap->dropped++;
+    return 0;
+  }
+
+  e = &cap->buf[head & cap->mask];
+  e->time  = time;
+  e->pins  = pins;
+  e->level = level;
+
+  // the record has to be complete before the consumer can see it
+  asm volatile ("" : : : "memory");
+  cap->head = head + 1;
+
+  return 1;
+}
+
+/** Takes the oldest record out of the ring.
+ *
+ * @return 0 if the ring was empty
+ */
+static inline int gpio_capture_get(gpio_capture_t* cap, gpio_edge_t* e) {
+  uint32_t tail = cap->tail;
+
+  if (cap->head == tail)
+    return 0;
+
+  *e = cap->buf[tail & cap->mask];
+
+  // the slot may only be reused after it has been copied out
+  asm volatile ("" : : : "memory");
+  cap->tail = tail + 1;
+
+  return 1;
+}
+
+/** Number of records waiting in the ring */
+static inline unsigned int gpio_capture_count(gpio_capture_t* cap) {
+  return cap->head - cap->tail;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// decoders
+////////////////////////////////////////////////////////////////////////////////
+
+/** Quadrature encoder on two captured pins */
+typedef struct {
+  uint32_t a;       ///< mask of channel A
+  uint32_t b;       ///< mask of channel B
+  uint32_t state;   ///< (A << 1) | B
+  int32_t  count;   ///< position in quarter steps, positive if A leads
+  uint32_t errors;  ///< transitions where both channels changed
+} gpio_quad_t;
+
+/** Initializes the encoder state from the current pin levels. */
+void gpio_quad_init(gpio_quad_t* q, int pin_a, int pin_b, uint32_t level);
+
+/** Updates the position with one record, records of other pins are ignored.
+ *
+ * @return the step taken, -1, 0 or 1
+ */
+int gpio_quad_feed(gpio_quad_t* q, const gpio_edge_t* e);
+
+/** Pulse width measurement on one captured pin */
+typedef struct {
+  uint32_t mask;
+  uint32_t time;   ///< time of the previous edge
+  int      valid;  ///< set once the first edge was seen
+} gpio_pulse_t;
+
+void gpio_pulse_init(gpio_pulse_t* p, int pin);
+
+/** Measures the pulse ended by the record.
+ *
+ * @param width  length of the pulse in timer ticks
+ * @param level  level the pin had during the pulse
+ *
+ * @return 1 if a pulse was completed, 0 for the first edge or other pins
+ */
+int gpio_pulse_feed(gpio_pulse_t* p, const gpio_edge_t* e, uint32_t* width, int* level);
+
+#define GPIO_NEC_NONE    0
+#define GPIO_NEC_FRAME   1
+#define GPIO_NEC_REPEAT  2
+
+/** NEC infrared protocol decoder */
+typedef struct {
+  gpio_pulse_t pulse;
+  uint32_t     ticks_per_us;
+  int          mark;     ///< pin level during a burst, 0 for most receivers
+  int          state;
+  int          bits;
+  uint32_t     data;
+  int          valid;    ///< set after the first complete frame
+  uint32_t     addr;     ///< 8 bit address, or 16 bit for extended NEC
+  uint32_t     cmd;
+  uint32_t     errors;   ///< frames aborted by a bad timing or checksum
+} gpio_nec_t;
+
+/** Initializes the decoder.
+ *
+ * @param ticks_per_us  timer B ticks per microsecond
+ * @param mark          pin level during an infrared burst
+ */
+void gpio_nec_init(gpio_nec_t* n, int pin, uint32_t ticks_per_us, int mark);
+
+/** Advances the decoder by one record.
+ *
+ * @return GPIO_NEC_FRAME when addr and cmd hold a new frame, GPIO_NEC_REPEAT
+ *         for a repeat code following a frame, GPIO_NEC_NONE otherwise
+ */
+int gpio_nec_feed(gpio_nec_t* n, const gpio_edge_t* e);
+
+#endif // _GPIO_CAPTURE_H_
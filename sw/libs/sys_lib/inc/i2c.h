@@ -25,6 +25,7 @@
 #define I2C_STOP        0x40
 #define I2C_READ        0x20
 #define I2C_WRITE       0x10
+#define I2C_NACK        0x08 // with I2C_READ, answer the byte with a NACK
 #define I2C_CLR_INT     0x01
 #define I2C_START_READ  0xA0
 #define I2C_STOP_READ   0x60
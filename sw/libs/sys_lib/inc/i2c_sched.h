@@ -0,0 +1,216 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Periodic multi-sensor acquisition on the I2C bus.
+ *
+ * Every sensor is a block of registers read at a fixed period. Registering
+ * a sensor compiles its transaction into a short program of I2C commands:
+ *
+ *   START addr+W, register (1 or 2 bytes), [STOP,] START addr+R,
+ *   READ * (len - 1), READ+NACK+STOP
+ *
+ * i2c_sched_compile spreads the sensors over the slots of the schedule
+ * period, the least common multiple of all sensor periods, such that the
+ * busiest slot carries as few bus clocks as possible. The application calls
+ * i2c_sched_tick once per period tick, usually from a timer handler. A tick
+ * starts the cycle of its slot, after which the I2C interrupt runs one
+ * command of the cycle per byte until the programs of all due sensors are
+ * done, without the CPU waiting for the bus in between.
+ *
+ * Each sensor delivers its samples into a single producer, single consumer
+ * ring of frames, every frame holds the timer B value at the start of the
+ * transaction followed by the register block. A sensor that does not
+ * acknowledge is counted as an error and skipped for the cycle. A tick that
+ * arrives while the previous cycle still runs is counted as an overrun and
+ * its sensors are appended to the running cycle.
+ *
+ * The scheduler registers its handler for the I2C line with int_add, the I2C
+ * interrupt must therefore be left to the interrupt dispatcher. Only one
+ * scheduler can own the bus, the blocking functions of i2c.h must not be
+ * used while it is started.
+ *
+ */
+#ifndef _I2C_SCHED_H_
+#define _I2C_SCHED_H_
+
+#include <stdint.h>
+
+#ifndef I2C_SCHED_MAX_SENSORS
+#define I2C_SCHED_MAX_SENSORS  8    ///< at most 32
+#endif
+
+#ifndef I2C_SCHED_MAX_SLOTS
+#define I2C_SCHED_MAX_SLOTS    32   ///< longest schedule period in ticks
+#endif
+
+#ifndef I2C_SCHED_MAX_OPS
+#define I2C_SCHED_MAX_OPS      128  ///< commands of all sensor programs
+#endif
+
+#define I2C_SENSOR_MAX_LEN     64   ///< longest register block
+
+// sensor flags
+#define I2C_SENSOR_REG8        0x0  ///< 8 bit register address
+#define I2C_SENSOR_REG16       0x1  ///< 16 bit register address, MSB first
+#define I2C_SENSOR_NOREG       0x2  ///< no register address, read only
+#define I2C_SENSOR_STOP        0x4  ///< STOP instead of a repeated START before the read
+
+/** Size of a frame holding len bytes of data, in 32 bit words */
+#define I2C_FRAME_WORDS(len)   (1 + ((len) + 3) / 4)
+
+/** One sample as stored in the ring of a sensor */
+typedef struct {
+  uint32_t time;     ///< timer B value at the start of the transaction
+  uint8_t  data[];   ///< the register block
+} i2c_frame_t;
+
+/** One command of a compiled program */
+typedef struct {
+  uint8_t cmd;       ///< value for I2C_CMD
+  uint8_t data;      ///< value for I2C_TX if cmd writes
+} i2c_op_t;
+
+typedef struct {
+  uint8_t           addr;     ///< 7 bit address
+  uint8_t           flags;
+  uint8_t           len;      ///< bytes per sample
+  uint16_t          reg;      ///< first register of the block
+  uint16_t          period;   ///< in ticks
+  uint16_t          phase;    ///< slot of the first read, set by i2c_sched_compile
+  uint16_t          first;    ///< program in the op pool of the scheduler
+  uint16_t          count;
+  uint16_t          clocks;   ///< SCL clocks of one transaction
+  uint32_t*         buf;
+  uint32_t          words;    ///< frame size in words
+  uint32_t          mask;     ///< ring size - 1
+  volatile uint32_t head;     ///< free running, written by the I2C interrupt only
+  volatile uint32_t tail;     ///< free running, written by the consumer only
+  volatile uint32_t dropped;  ///< samples skipped because the ring was full
+  volatile uint32_t errors;   ///< transactions aborted by a NACK
+} i2c_sensor_t;
+
+typedef struct {
+  i2c_sensor_t*     sensors[I2C_SCHED_MAX_SENSORS];
+  unsigned int      num_sensors;
+  i2c_op_t          ops[I2C_SCHED_MAX_OPS];
+  unsigned int      num_ops;
+
+  uint32_t          slots[I2C_SCHED_MAX_SLOTS];  ///< sensors due in each slot
+  unsigned int      num_slots;
+  unsigned int      max_clocks;  ///< SCL clocks of the busiest slot
+  unsigned int      slot;        ///< slot of the next tick
+
+  // running cycle, owned by the I2C interrupt once started
+  volatile uint32_t due;      ///< sensors of the cycle not yet started
+  volatile int      cur;      ///< sensor on the bus, -1 if idle
+  unsigned int      pc;       ///< next op of the current program
+  unsigned int      pos;      ///< bytes read into the current frame
+  int               abort;    ///< a STOP after a NACK is in flight
+  uint8_t*          data;     ///< data of the current frame
+
+  // statistics
+  volatile uint32_t cycles;
+  volatile uint32_t overruns; ///< ticks that found the previous cycle running
+  volatile uint32_t lost;     ///< cycles cut short by a lost arbitration
+  volatile uint32_t busy;     ///< timer B ticks spent in cycles
+  uint32_t          cycle_start;
+  uint32_t          window;   ///< timer B value the utilization is measured from
+} i2c_sched_t;
+
+/** Initializes a sensor, does not touch the hardware.
+ *
+ * @param sn     sensor state
+ * @param addr   7 bit I2C address
+ * @param reg    first register of the block
+ * @param flags  I2C_SENSOR_* flags
+ * @param len    bytes per sample, 1 to I2C_SENSOR_MAX_LEN
+ * @param buf    storage for depth frames of I2C_FRAME_WORDS(len) words
+ * @param depth  number of frames, a power of two
+ *
+ * @return 0 on success, -1 for a bad length or depth
+ */
+int i2c_sensor_init(i2c_sensor_t* sn, uint8_t addr, uint16_t reg, unsigned int flags,
+                    unsigned int len, uint32_t* buf, unsigned int depth);
+
+/** Takes the oldest frame out of the ring of a sensor.
+ *
+ * @param time  timestamp of the frame, may be NULL
+ * @param data  receives len bytes
+ *
+ * @return 0 if the ring was empty
+ */
+int i2c_sensor_get(i2c_sensor_t* sn, uint32_t* time, uint8_t* data);
+
+/** Number of frames waiting in the ring */
+static inline unsigned int i2c_sensor_count(i2c_sensor_t* sn) {
+  return sn->head - sn->tail;
+}
+
+/** Empties the scheduler, sensors added before are forgotten. */
+void i2c_sched_init(i2c_sched_t* s);
+
+/** Adds a sensor and compiles its program.
+ *
+ * @param period  read period in ticks
+ *
+ * @return index of the sensor, -1 if there is no room for it
+ */
+int i2c_sched_add(i2c_sched_t* s, i2c_sensor_t* sn, unsigned int period);
+
+/** Assigns the sensors to the slots of the schedule, has to be called after
+ * the last i2c_sched_add and before i2c_sched_start.
+ *
+ * @return 0 on success, -1 if the schedule period exceeds I2C_SCHED_MAX_SLOTS
+ */
+int i2c_sched_compile(i2c_sched_t* s);
+
+/** Bus load of the busiest slot.
+ *
+ * @param scl_hz   I2C clock
+ * @param tick_hz  rate of i2c_sched_tick
+ *
+ * @return expected bus utilization of the busiest slot in permille, above
+ *         1000 the cycles overrun
+ */
+unsigned int i2c_sched_load(i2c_sched_t* s, uint32_t scl_hz, uint32_t tick_hz);
+
+/** Enables the I2C interrupt and registers the handler. The prescaler has to
+ * be set up with i2c_setup beforehand. Timer B becomes the free running time
+ * base, see timer_b_time_base, timestamps and utilization are in its ticks.
+ */
+void i2c_sched_start(i2c_sched_t* s);
+
+/** Waits for the running cycle to finish and disables the I2C interrupt,
+ * frames in the rings stay available.
+ */
+void i2c_sched_stop(i2c_sched_t* s);
+
+/** Advances the schedule by one slot and starts its cycle. Has to be called
+ * from an interrupt handler or with interrupts disabled.
+ */
+void i2c_sched_tick(i2c_sched_t* s);
+
+/** Returns 1 while a cycle runs */
+static inline int i2c_sched_busy(i2c_sched_t* s) {
+  return s->cur >= 0;
+}
+
+/** Bus utilization since the previous call, or since i2c_sched_start.
+ *
+ * @return share of the time spent in cycles in permille
+ */
+unsigned int i2c_sched_utilization(i2c_sched_t* s);
+
+/** The I2C interrupt handler, registered by i2c_sched_start. */
+void i2c_sched_isr(void* arg);
+
+#endif // _I2C_SCHED_H_
@@ -31,6 +31,8 @@
 /* Number of interrupt handlers - really depends on PIC width in OR1200*/
 #define MAX_INT_HANDLERS  32
 
+typedef void (*int_handler_t)(void* arg);
+
 
 /**
  * \brief Disables interrupts globally.
@@ -77,8 +79,51 @@ static inline void int_enable(void) {
 
 
 
+/**
+ * \brief Removes all registered interrupt handlers.
+ * \param void
+ * \return void
+ */
+void int_init(void);
+
+/**
+ * \brief Registers a handler for an interrupt line.
+ * \param irq     interrupt line, 0 to MAX_INT_HANDLERS-1
+ * \param handler called with arg, the pending bit is already cleared
+ * \param arg     passed to the handler
+ * \return 0 on success, -1 for an invalid line
+ *
+ * Enables the line in IER. The handler runs from int_dispatch, which is
+ * what the ISR_* functions below default to. An application that defines
+ * its own ISR_* function takes that vector away from the dispatcher, but a
+ * handler registered for the line still runs whenever the dispatcher finds
+ * it pending.
+ */
+int int_add(int irq, int_handler_t handler, void* arg);
+
+/**
+ * \brief Removes the handler of an interrupt line and disables it in IER.
+ * \param irq interrupt line
+ * \return 0 on success, -1 for an invalid line
+ */
+int int_remove(int irq);
+
+/**
+ * \brief Runs the handlers of all pending interrupt lines.
+ * \param void
+ * \return void
+ *
+ * Services the pending and enabled lines that have a handler, higher lines
+ * first. Before it returns it reads IPR again and chains into whatever
+ * became pending in the meantime, so a burst of interrupts pays for the
+ * register save and restore of the interrupt stub only once. An interrupt
+ * without a handler hangs the core, like the default handlers always did.
+ */
+void int_dispatch(void);
+
 //declearing all interrupt handelrs
-//these functions can be redefined by users
+//these functions can be redefined by users, by default they
+//are aliases of int_dispatch
 
 void ISR_I2C (void);	// 23: i2c
 void ISR_UART (void);	// 23: i2c
@@ -87,7 +132,7 @@ void ISR_SPIM0 (void);  // 26: spim end of transmission
 void ISR_SPIM1 (void);  // 27: spim R/T finished
 void ISR_TA_OVF (void); // 28: timer A overflow
 void ISR_TA_CMP (void); // 29: timer A compare
-void ISR_TB_OVR (void); // 30: timer B overflow
+void ISR_TB_OVF (void); // 30: timer B overflow
 void ISR_TB_CMP (void); // 31: timer B compare
 
 
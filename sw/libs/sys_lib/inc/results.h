@@ -0,0 +1,53 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Binary results region.
+ *
+ * Lets applications hand binary results to the host without formatting them
+ * for the UART. The application publishes a buffer through a small descriptor
+ * that the linker places at a fixed address (RESULTS_DESC_ADDR, the last 16
+ * bytes of the data RAM). After the end of computation the host reads the
+ * descriptor over the SPI slave, checks the magic and pulls the buffer in
+ * bulk, see spidump in fpga/sw/apps/spiload.
+ *
+ */
+#ifndef _RESULTS_H_
+#define _RESULTS_H_
+
+#include <stdint.h>
+
+/** Address of the descriptor, has to match the results region in link.common.ld */
+#define RESULTS_DESC_ADDR  0x00105FF0
+
+/** Marks a valid descriptor ("PRES") */
+#define RESULTS_MAGIC      0x50524553
+
+typedef struct {
+  uint32_t magic;   // RESULTS_MAGIC once addr and len are valid
+  uint32_t addr;    // start address of the results buffer
+  uint32_t len;     // length of the results buffer in bytes
+  uint32_t seq;     // incremented on every publish
+} results_desc_t;
+
+extern volatile results_desc_t results_desc;
+
+/**
+ * @brief Publishes a results buffer to the host.
+ * @param buf pointer to the results, should be word aligned for fast reads
+ * @param len length of the results in bytes
+ *
+ * The buffer has to stay valid until the host has read it, which usually
+ * means until after eoc(). Publishing again replaces the previous buffer.
+ */
+void results_publish(const void* buf, unsigned int len);
+
+#endif
@@ -94,4 +94,7 @@ void spi_read_fifo(int *data, int datalen);
 
 int spi_get_status();
 
+/** Waits until the SPI master is idle, the core sleeps in between. */
+void spi_wait_idle(void);
+
 #endif // _SPI_H_
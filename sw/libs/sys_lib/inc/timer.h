@@ -58,6 +58,9 @@
 #define TOCRB __PT__(TIMERB_OUPUT_CMP)
 
 
+/** Compare value of a free running timer, the counter wraps at 2^32 */
+#define TIMER_FREE_RUN      0xFFFFFFFF
+
 void reset_timer(void);
 
 void start_timer(void);
@@ -66,4 +69,12 @@ void stop_timer(void);
 
 int get_time(void);
 
+/** Makes timer B the free running time base of the drivers (gpio_capture,
+ * i2c_sched): its compare value becomes TIMER_FREE_RUN, so the counter only
+ * wraps at 2^32, and a stopped timer is started from 0 without prescaler.
+ * A compare match resets the counter, so timer B can not be a time base and
+ * drive compare events (Arduino PWM) at the same time.
+ */
+void timer_b_time_base(void);
+
 #endif
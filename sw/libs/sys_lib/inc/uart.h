@@ -72,4 +72,13 @@ char uart_getchar();
 
 void uart_wait_tx_done(void);
 
+/**
+ * Sends a binary record over the UART. spiload recognizes these records in
+ * the console stream and stores them separately, so raw data (memory dumps,
+ * performance records) can be mixed with printf output. The record format is
+ *   ESC 'P' 'F' | type | len[7:0] | len[15:8] | payload | sum[7:0] | sum[15:8]
+ * where sum is the 16 bit sum over type, both length bytes and the payload.
+ */
+void uart_send_frame(uint8_t type, const void* data, uint16_t len);
+
 #endif
@@ -0,0 +1,302 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "clock.h"
+#include "uart.h"
+#include "spi.h"
+#include "i2c.h"
+#include "timer.h"
+
+struct clk_notifier {
+  clk_notifier_t notifier;
+  void*          arg;
+};
+
+static struct clk_notifier clk_notifiers[CLK_MAX_NOTIFIERS];
+
+static int      clk_source = CLK_FIXED;
+static uint32_t clk_freq;
+
+static uint32_t clk_uart_baud;
+static uint32_t clk_spi_hz;
+static uint32_t clk_i2c_hz;
+static uint32_t clk_timers;
+
+static inline int fl1(uint32_t x) {
+  return 31 - __builtin_clz(x);
+}
+
+//----------------------------------------------------------------------------
+// FLL
+//----------------------------------------------------------------------------
+
+uint32_t fll_freq_cfg(uint32_t hz, uint32_t* mult, uint32_t* div) {
+  uint32_t fref = FLL_REF_CLK_HZ;
+  uint32_t m;
+  int d;
+
+  if (hz == 0)
+    hz = 1;
+  if (hz >= 1u << (FLL_LOG2_MAXDCO - 1))
+    hz = (1u << (FLL_LOG2_MAXDCO - 1)) - 1;
+
+  // the DCO runs at hz * 2^d, halfway between hz and its maximum in log
+  // scale, which leaves room for the factor without leaving the DCO range
+  d = (FLL_LOG2_MAXDCO - fl1(hz)) >> 1;
+  if (d < 1)
+    d = 1;
+  if (d > 14)
+    d = 14;
+
+  m = ((hz << d) + fref / 2) / fref;
+  if (m < 1)
+    m = 1;
+  if (m > FLL_CONF1_MULT_MASK)
+    m = FLL_CONF1_MULT_MASK;
+
+  *mult = m;
+  *div  = d + 1;
+
+  return (uint32_t)((((uint64_t)fref * m) + (1u << (d - 1))) >> d);
+}
+
+uint32_t fll_get_freq(void) {
+  uint32_t mult = FLL_STATUS & FLL_CONF1_MULT_MASK;
+  uint32_t div  = (FLL_CONF1 & FLL_CONF1_DIV_MASK) >> FLL_CONF1_DIV_SHIFT;
+
+  return (uint32_t)(((uint64_t)FLL_REF_CLK_HZ * mult) >> (div ? div - 1 : 0));
+}
+
+uint32_t fll_set_freq(uint32_t hz) {
+  uint32_t mult, div, tol, status, f;
+  int i;
+
+  f = fll_freq_cfg(hz, &mult, &div);
+
+  // the DCO code only matters in open loop mode, keep it
+  FLL_CONF1 = (FLL_CONF1 & FLL_CONF1_DCO_MASK) | FLL_CONF1_MODE_NORMAL | FLL_CONF1_LOCK_EN
+            | (div << FLL_CONF1_DIV_SHIFT) | mult;
+
+  // the output is gated until the FLL locks, the factor it reports has to
+  // settle as well
+  tol = (mult >> 6) + 1;
+  for (i = 0; i < FLL_LOCK_TIMEOUT; i++) {
+    status = FLL_STATUS & FLL_CONF1_MULT_MASK;
+
+    if (status + tol >= mult && status <= mult + tol)
+      return f;
+  }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+// frequency scaling
+//----------------------------------------------------------------------------
+
+static void clk_notify(int event, uint32_t old_hz, uint32_t new_hz) {
+  int i;
+
+  for (i = 0; i < CLK_MAX_NOTIFIERS; i++)
+    if (clk_notifiers[i].notifier)
+      clk_notifiers[i].notifier(event, old_hz, new_hz, clk_notifiers[i].arg);
+}
+
+void clk_init(int source, uint32_t hz) {
+  clk_source = source;
+
+  if (source != CLK_FLL) {
+    clk_freq = hz;
+    return;
+  }
+
+  CGREG |= (1 << CGFLL); // don't clock gate the FLL interface
+
+  if (hz == 0 || (clk_freq = fll_set_freq(hz)) == 0)
+    clk_freq = fll_get_freq();
+}
+
+uint32_t clk_get_freq(void) {
+  return clk_freq;
+}
+
+uint32_t clk_set_freq(uint32_t hz) {
+  uint32_t old_hz = clk_freq;
+  uint32_t new_hz, mult, div;
+
+  if (clk_source != CLK_FLL)
+    return clk_freq;
+
+  new_hz = fll_freq_cfg(hz, &mult, &div);
+  if (new_hz == old_hz)
+    return clk_freq;
+
+  clk_notify(CLK_PRE_CHANGE, old_hz, new_hz);
+
+  if (fll_set_freq(hz) == 0)
+    new_hz = fll_get_freq();
+  clk_freq = new_hz;
+
+  clk_notify(CLK_POST_CHANGE, old_hz, new_hz);
+
+  return new_hz;
+}
+
+int clk_register(clk_notifier_t notifier, void* arg) {
+  int i;
+
+  for (i = 0; i < CLK_MAX_NOTIFIERS; i++) {
+    if (clk_notifiers[i].notifier == 0) {
+      clk_notifiers[i].notifier = notifier;
+      clk_notifiers[i].arg      = arg;
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+void clk_unregister(clk_notifier_t notifier, void* arg) {
+  int i;
+
+  for (i = 0; i < CLK_MAX_NOTIFIERS; i++) {
+    if (clk_notifiers[i].notifier == notifier && clk_notifiers[i].arg == arg) {
+      clk_notifiers[i].notifier = 0;
+      clk_notifiers[i].arg      = 0;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// peripheral divisors
+//----------------------------------------------------------------------------
+
+uint16_t clk_uart_counter(uint32_t hz, uint32_t baud) {
+  // baud = hz / (16 * (counter + 1)), rounded to the closest rate
+  uint32_t n = (hz + 8 * baud) / (16 * baud);
+
+  if (n < 2)
+    return 1;
+  if (n > 0x10000)
+    return 0xFFFF;
+
+  return n - 1;
+}
+
+uint32_t clk_spi_div(uint32_t hz, uint32_t spi_hz) {
+  // spi_hz = hz / (2 * (div + 1))
+  uint32_t n = (hz + 2 * spi_hz - 1) / (2 * spi_hz);
+
+  if (n < 1)
+    return 0;
+  if (n > 256)
+    return 255;
+
+  return n - 1;
+}
+
+uint32_t clk_i2c_pre(uint32_t hz, uint32_t scl_hz) {
+  // scl_hz = hz / (5 * (pre + 1))
+  uint32_t n = (hz + 5 * scl_hz - 1) / (5 * scl_hz);
+
+  if (n < 1)
+    return 0;
+  if (n > 0x10000)
+    return 0xFFFF;
+
+  return n - 1;
+}
+
+static void clk_uart_notifier(int event, uint32_t old_hz, uint32_t new_hz, void* arg) {
+  // a plain poll for TEMT, the notifier must not need events or a timer
+  if (event == CLK_PRE_CHANGE)
+    while ((*(volatile unsigned int*)(UART_REG_LSR) & 0x40) == 0);
+  else
+    uart_set_cfg(0, clk_uart_counter(new_hz, clk_uart_baud));
+}
+
+static void clk_spi_notifier(int event, uint32_t old_hz, uint32_t new_hz, void* arg) {
+  if (event == CLK_POST_CHANGE)
+    SPI_CLKDIV = clk_spi_div(new_hz, clk_spi_hz);
+}
+
+static void clk_i2c_notifier(int event, uint32_t old_hz, uint32_t new_hz, void* arg) {
+  uint32_t ctr;
+
+  if (event == CLK_PRE_CHANGE) {
+    while (I2C_STATUS & I2C_STATUS_TIP);
+    return;
+  }
+
+  // the prescaler can only be changed while the core is disabled
+  ctr = I2C_CTR;
+  I2C_CTR = ctr & ~I2C_CTR_EN;
+  I2C_PRE = clk_i2c_pre(new_hz, clk_i2c_hz);
+  I2C_CTR = ctr;
+}
+
+static inline uint32_t clk_scale(uint32_t x, uint32_t old_hz, uint32_t new_hz) {
+  return (uint32_t)(((uint64_t)x * new_hz) / old_hz);
+}
+
+static void clk_timer_notifier(int event, uint32_t old_hz, uint32_t new_hz, void* arg) {
+  if (event != CLK_POST_CHANGE || old_hz == 0)
+    return;
+
+  if ((clk_timers & CLK_TIMER_A) && (TPRA & 0x1)) {
+    TOCRA = clk_scale(TOCRA, old_hz, new_hz);
+    TIRA  = clk_scale(TIRA,  old_hz, new_hz);
+  }
+
+  if ((clk_timers & CLK_TIMER_B) && (TPRB & 0x1)) {
+    TOCRB = clk_scale(TOCRB, old_hz, new_hz);
+    TIRB  = clk_scale(TIRB,  old_hz, new_hz);
+  }
+}
+
+// registers a notifier of the library once
+static int clk_keep(clk_notifier_t notifier) {
+  int i;
+
+  for (i = 0; i < CLK_MAX_NOTIFIERS; i++)
+    if (clk_notifiers[i].notifier == notifier)
+      return 0;
+
+  return clk_register(notifier, 0);
+}
+
+int clk_keep_uart_baud(uint32_t baud) {
+  clk_uart_baud = baud;
+  uart_wait_tx_done();
+  uart_set_cfg(0, clk_uart_counter(clk_freq, baud));
+
+  return clk_keep(clk_uart_notifier);
+}
+
+int clk_keep_spi_rate(uint32_t spi_hz) {
+  clk_spi_hz = spi_hz;
+  SPI_CLKDIV = clk_spi_div(clk_freq, spi_hz);
+
+  return clk_keep(clk_spi_notifier);
+}
+
+int clk_keep_i2c_rate(uint32_t scl_hz) {
+  clk_i2c_hz = scl_hz;
+  clk_i2c_notifier(CLK_PRE_CHANGE, clk_freq, clk_freq, 0);
+  clk_i2c_notifier(CLK_POST_CHANGE, clk_freq, clk_freq, 0);
+
+  return clk_keep(clk_i2c_notifier);
+}
+
+int clk_keep_timer_rates(uint32_t timers) {
+  clk_timers = timers;
+
+  return clk_keep(clk_timer_notifier);
+}
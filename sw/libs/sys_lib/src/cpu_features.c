@@ -0,0 +1,101 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "cpu_features.h"
+
+#define CPU_FEAT_VALID  0x80000000
+
+static unsigned int cpu_feat;
+
+// set while a probe instruction executes, and by the trap if it faulted
+static volatile int cpu_probing;
+static volatile int cpu_faulted;
+
+int cpu_probe_trap(void) {
+  unsigned int epc;
+
+  if (!cpu_probing)
+    return 0;
+
+  // probe instructions are never compressed
+  asm volatile ("csrr %0, 0x341" : "=r" (epc));
+  asm volatile ("csrw 0x341, %0" : : "r" (epc + 4));
+
+  cpu_faulted = 1;
+  return 1;
+}
+
+// the instructions are given as words, so this compiles for every -march
+
+static int cpu_probe_m(void) {
+  register int a0 asm("a0") = 6;
+  register int a1 asm("a1") = 7;
+
+  // mul a0, a0, a1
+  asm volatile (".word 0x02B50533" : "+r" (a0) : "r" (a1));
+  return a0 == 42;
+}
+
+static int cpu_probe_xpulp(void) {
+  register int a0 asm("a0") = -5;
+
+  // p.abs a0, a0
+  asm volatile (".word 0x04050533" : "+r" (a0));
+  return a0 == 5;
+}
+
+static int cpu_probe_f(void) {
+  register unsigned int a0 asm("a0") = 0x3F800000;
+  register unsigned int a1 asm("a1") = 0;
+
+  // fmv.s.x ft0, a0; fmv.x.s a1, ft0
+  asm volatile (".word 0xF0050053\n"
+                ".word 0xE00005D3" : "+r" (a1) : "r" (a0));
+  return a1 == 0x3F800000;
+}
+
+static int cpu_probe(int (*probe)(void)) {
+  int ok;
+
+  cpu_faulted = 0;
+  cpu_probing = 1;
+  asm volatile ("" : : : "memory");
+
+  ok = probe();
+
+  asm volatile ("" : : : "memory");
+  cpu_probing = 0;
+
+  return ok && !cpu_faulted;
+}
+
+unsigned int cpu_features(void) {
+  unsigned int mstatus, feat = 0;
+
+  if (cpu_feat & CPU_FEAT_VALID)
+    return cpu_feat & ~CPU_FEAT_VALID;
+
+  asm volatile ("csrr %0, mstatus" : "=r" (mstatus));
+  asm volatile ("csrw mstatus, %0" : : "r" (mstatus & ~0x8));
+
+  if (cpu_probe(cpu_probe_m))
+    feat |= CPU_FEAT_M;
+
+  if (cpu_probe(cpu_probe_xpulp))
+    feat |= CPU_FEAT_XPULP;
+
+  if (cpu_probe(cpu_probe_f))
+    feat |= CPU_FEAT_F;
+
+  asm volatile ("csrw mstatus, %0" : : "r" (mstatus));
+
+  cpu_feat = feat | CPU_FEAT_VALID;
+  return feat;
+}
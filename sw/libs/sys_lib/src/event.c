@@ -0,0 +1,68 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "event.h"
+#include "timer.h"
+#include "utils.h"
+
+unsigned int event_wait(unsigned int mask, unsigned int timeout) {
+  unsigned int eer = EER;
+  unsigned int wake = mask;
+  unsigned int cmp = 0, cnt = 0, ctrl = 0;
+  unsigned int pending;
+
+  if (timeout) {
+    // a running timer B is someone's time base, a compare value would reset
+    // it, so the caller polls instead
+    if (TPRB & 0x1) {
+      pending = EPR & mask;
+      ECP = pending;
+      return pending;
+    }
+
+    // the compare event wakes the core at the deadline, the timer counts
+    // cycles for the wait whatever prescaler the owner has set up
+    cmp   = TOCRB;
+    cnt   = TIRB;
+    ctrl  = TPRB;
+    TIRB  = 0;
+    TOCRB = timeout;
+    ECP   = 1u << TIMER_B_OUTPUT_CMP;
+    wake |= 1u << TIMER_B_OUTPUT_CMP;
+    TPRB  = 0x1;
+  }
+
+  EER = eer | wake;
+
+  for (;;) {
+    pending = EPR & mask;
+    if (pending)
+      break;
+
+    // the counter returns to 0 on the match, only the event tells
+    if (timeout && (EPR & (1u << TIMER_B_OUTPUT_CMP)))
+      break;
+
+    sleep();
+  }
+
+  ECP = pending;
+  EER = eer;
+
+  if (timeout) {
+    TPRB  = 0x0;
+    ECP   = 1u << TIMER_B_OUTPUT_CMP;
+    TOCRB = cmp;
+    TIRB  = cnt;
+    TPRB  = ctrl;
+  }
+
+  return pending;
+}
@@ -11,6 +11,7 @@
 #include <spr-defs.h>
 #include "string_lib.h"
 #include "utils.h"
+#include "cpu_features.h"
 
 // use weak attribute here, so we can overwrite this function to provide custom exception handlers, e.g. for tests
 __attribute__((interrupt)) __attribute__((weak))
@@ -20,9 +21,13 @@ void default_exception_handler_c(void)
 }
 
 // use weak attribute here, so we can overwrite this function to provide custom exception handlers, e.g. for tests
-__attribute__((interrupt)) __attribute__((weak))
+// no interrupt attribute, the handler returns to end_except of crt0 after a cpu_features probe
+__attribute__((weak))
 void illegal_insn_handler_c(void)
 {
+  if (cpu_probe_trap())
+    return;
+
   for(;;);
 }
 // use weak attribute here, so we can overwrite this function to provide custom exception handlers, e.g. for tests
@@ -0,0 +1,281 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "gpio_capture.h"
+#include "gpio.h"
+#include "event.h"
+#include "timer.h"
+
+// NEC timings in microseconds, everything is accepted within +-25%
+#define NEC_LEADER_MARK   9000
+#define NEC_LEADER_SPACE  4500
+#define NEC_REPEAT_SPACE  2250
+#define NEC_BIT_MARK       560
+#define NEC_ZERO_SPACE     560
+#define NEC_ONE_SPACE     1690
+
+#define NEC_IDLE       0
+#define NEC_LEADER     1
+#define NEC_DATA_MARK  2
+#define NEC_DATA_SPACE 3
+
+static gpio_capture_t* volatile g_capture;
+
+int gpio_capture_init(gpio_capture_t* cap, gpio_edge_t* buf, unsigned int size, uint32_t pins) {
+  if (size < 2 || (size & (size - 1)) != 0)
+    return -1;
+
+  cap->buf     = buf;
+  cap->mask    = size - 1;
+  cap->head    = 0;
+  cap->tail    = 0;
+  cap->dropped = 0;
+  cap->pins    = pins;
+  cap->last    = 0;
+  cap->type0   = 0;
+
+  return 0;
+}
+
+void gpio_capture_start(gpio_capture_t* cap) {
+  uint32_t pins = cap->pins;
+
+  timer_b_time_base();
+
+  // level 1 is armed with INTTYPE0 = 0, level 0 with INTTYPE0 = 1, so a pin
+  // at 1 is armed by writing its level
+  cap->last  = *PADIN & pins;
+  cap->type0 = *INTTYPE0 & ~pins;
+
+  *INTTYPE1 &= ~pins;
+  *INTTYPE0  = cap->type0 | cap->last;
+
+  g_capture = cap;
+
+  (void)*INTSTATUS;
+  ICP  = 1 << GPIO_EVENT;
+  IER |= 1 << GPIO_EVENT;
+  *INTEN |= pins;
+}
+
+void gpio_capture_stop(gpio_capture_t* cap) {
+  *INTEN &= ~cap->pins;
+  IER    &= ~(1 << GPIO_EVENT);
+  g_capture = 0;
+}
+
+void ISR_GPIO(void) {
+  gpio_capture_t* cap = g_capture;
+  uint32_t pins, time, level, changed;
+
+  // an interrupt that was already pending when capturing stopped
+  if (cap == 0) {
+    (void)*INTSTATUS;
+    ICP = 1 << GPIO_EVENT;
+    return;
+  }
+
+  pins    = cap->pins;
+  time    = TIRB;
+  level   = *PADIN & pins;
+  changed = level ^ cap->last;
+
+  do {
+    if (changed) {
+      gpio_capture_put(cap, time, changed, level);
+      cap->last = level;
+    }
+
+    // re-arm on the opposite levels, then clear, then look again: a change
+    // after this last read of PADIN raises a new interrupt
+    *INTTYPE0 = cap->type0 | level;
+    (void)*INTSTATUS;
+    ICP = 1 << GPIO_EVENT;
+
+    time    = TIRB;
+    level   = *PADIN & pins;
+    changed = level ^ cap->last;
+  } while (changed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// quadrature encoder
+////////////////////////////////////////////////////////////////////////////////
+
+// indexed by (old state << 2) | new state, 2 marks a skipped state
+static const int8_t g_quad_step[16] = {
+   0, -1,  1,  2,
+   1,  0,  2, -1,
+  -1,  2,  0,  1,
+   2,  1, -1,  0
+};
+
+static uint32_t quad_state(gpio_quad_t* q, uint32_t level) {
+  return ((level & q->a) ? 2 : 0) | ((level & q->b) ? 1 : 0);
+}
+
+void gpio_quad_init(gpio_quad_t* q, int pin_a, int pin_b, uint32_t level) {
+  q->a      = 1 << pin_a;
+  q->b      = 1 << pin_b;
+  q->count  = 0;
+  q->errors = 0;
+  q->state  = quad_state(q, level);
+}
+
+int gpio_quad_feed(gpio_quad_t* q, const gpio_edge_t* e) {
+  uint32_t state;
+  int step;
+
+  if ((e->pins & (q->a | q->b)) == 0)
+    return 0;
+
+  state = quad_state(q, e->level);
+  step  = g_quad_step[(q->state << 2) | state];
+  q->state = state;
+
+  if (step == 2) {
+    // direction unknown, the position is off by two quarter steps
+    q->errors++;
+    return 0;
+  }
+
+  q->count += step;
+  return step;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// pulse width
+////////////////////////////////////////////////////////////////////////////////
+
+void gpio_pulse_init(gpio_pulse_t* p, int pin) {
+  p->mask  = 1 << pin;
+  p->time  = 0;
+  p->valid = 0;
+}
+
+int gpio_pulse_feed(gpio_pulse_t* p, const gpio_edge_t* e, uint32_t* width, int* level) {
+  int done = p->valid;
+
+  if ((e->pins & p->mask) == 0)
+    return 0;
+
+  // records of one pin alternate, so the pulse had the inverse new level
+  *width = e->time - p->time;
+  *level = (e->level & p->mask) == 0;
+
+  p->time  = e->time;
+  p->valid = 1;
+
+  return done;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NEC infrared
+////////////////////////////////////////////////////////////////////////////////
+
+static int nec_near(uint32_t us, uint32_t ref) {
+  return us > ref - ref / 4 && us < ref + ref / 4;
+}
+
+void gpio_nec_init(gpio_nec_t* n, int pin, uint32_t ticks_per_us, int mark) {
+  gpio_pulse_init(&n->pulse, pin);
+  n->ticks_per_us = ticks_per_us;
+  n->mark   = mark;
+  n->state  = NEC_IDLE;
+  n->bits   = 0;
+  n->data   = 0;
+  n->valid  = 0;
+  n->addr   = 0;
+  n->cmd    = 0;
+  n->errors = 0;
+}
+
+static int nec_abort(gpio_nec_t* n) {
+  if (n->state != NEC_IDLE)
+    n->errors++;
+
+  n->state = NEC_IDLE;
+  return GPIO_NEC_NONE;
+}
+
+int gpio_nec_feed(gpio_nec_t* n, const gpio_edge_t* e) {
+  uint32_t width, us;
+  uint32_t cmd, addr;
+  int level;
+
+  if (!gpio_pulse_feed(&n->pulse, e, &width, &level))
+    return GPIO_NEC_NONE;
+
+  us = width / n->ticks_per_us;
+
+  if (level == n->mark) {
+    if (nec_near(us, NEC_LEADER_MARK)) {
+      n->state = NEC_LEADER;
+    } else if (n->state == NEC_DATA_MARK) {
+      if (!nec_near(us, NEC_BIT_MARK))
+        return nec_abort(n);
+      n->state = NEC_DATA_SPACE;
+    }
+    // anything else is the stop burst after a frame or a repeat code
+    return GPIO_NEC_NONE;
+  }
+
+  switch (n->state) {
+    case NEC_LEADER:
+      if (nec_near(us, NEC_LEADER_SPACE)) {
+        n->state = NEC_DATA_MARK;
+        n->bits  = 0;
+        n->data  = 0;
+        return GPIO_NEC_NONE;
+      }
+
+      if (nec_near(us, NEC_REPEAT_SPACE)) {
+        n->state = NEC_IDLE;
+        return n->valid ? GPIO_NEC_REPEAT : GPIO_NEC_NONE;
+      }
+
+      return nec_abort(n);
+
+    case NEC_DATA_SPACE:
+      if (nec_near(us, NEC_ONE_SPACE))
+        n->data |= 1u << n->bits;
+      else if (!nec_near(us, NEC_ZERO_SPACE))
+        return nec_abort(n);
+
+      if (++n->bits < 32) {
+        n->state = NEC_DATA_MARK;
+        return GPIO_NEC_NONE;
+      }
+
+      // bits are sent LSB first: address, inverted address, command,
+      // inverted command
+      n->state = NEC_IDLE;
+      cmd  = (n->data >> 16) & 0xFF;
+      addr = n->data & 0xFFFF;
+
+      if (((n->data >> 24) ^ cmd) != 0xFF) {
+        n->errors++;
+        return GPIO_NEC_NONE;
+      }
+
+      // extended NEC uses all 16 address bits
+      if (((addr >> 8) ^ (addr & 0xFF)) == 0xFF)
+        addr &= 0xFF;
+
+      n->addr  = addr;
+      n->cmd   = cmd;
+      n->valid = 1;
+      return GPIO_NEC_FRAME;
+
+    default:
+      // the pause before a leader
+      return GPIO_NEC_NONE;
+  }
+}
@@ -9,6 +9,7 @@
 // specific language governing permissions and limitations under the License.
 
 #include <i2c.h>
+#include <event.h>
 
 void i2c_setup(int prescaler,int enable) {
     *(volatile int*) (I2C_REG_PRE) = prescaler;
@@ -17,7 +18,7 @@ void i2c_setup(int prescaler,int enable) {
 
 int i2c_get_ack(void) {
     while ((i2c_get_status() & I2C_STATUS_TIP) == 0); // need TIP go to 1
-    while ((i2c_get_status() & I2C_STATUS_TIP) != 0); // and then go back to 0
+    EVENT_WAIT_UNTIL((i2c_get_status() & I2C_STATUS_TIP) == 0, 1u << I2C_EVENT); // and then go back to 0
     return !(i2c_get_status() & I2C_STATUS_RXACK); // invert since signal is active low
 }
 
@@ -0,0 +1,413 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "i2c_sched.h"
+#include "i2c.h"
+#include "int.h"
+#include "event.h"
+#include "timer.h"
+
+// SCL clocks of a byte with its acknowledge, START and STOP take one each
+#define I2C_BYTE_CLOCKS  9
+
+int i2c_sensor_init(i2c_sensor_t* sn, uint8_t addr, uint16_t reg, unsigned int flags,
+                    unsigned int len, uint32_t* buf, unsigned int depth) {
+  if (len == 0 || len > I2C_SENSOR_MAX_LEN)
+    return -1;
+
+  if (depth < 2 || (depth & (depth - 1)) != 0)
+    return -1;
+
+  sn->addr    = addr & 0x7F;
+  sn->flags   = flags;
+  sn->len     = len;
+  sn->reg     = reg;
+  sn->period  = 0;
+  sn->phase   = 0;
+  sn->first   = 0;
+  sn->count   = 0;
+  sn->clocks  = 0;
+  sn->buf     = buf;
+  sn->words   = I2C_FRAME_WORDS(len);
+  sn->mask    = depth - 1;
+  sn->head    = 0;
+  sn->tail    = 0;
+  sn->dropped = 0;
+  sn->errors  = 0;
+
+  return 0;
+}
+
+int i2c_sensor_get(i2c_sensor_t* sn, uint32_t* time, uint8_t* data) {
+  uint32_t tail = sn->tail;
+  i2c_frame_t* f;
+  unsigned int i;
+
+  if (sn->head == tail)
+    return 0;
+
+  f = (i2c_frame_t*)&sn->buf[(tail & sn->mask) * sn->words];
+
+  if (time)
+    *time = f->time;
+
+  for (i = 0; i < sn->len; i++)
+    data[i] = f->data[i];
+
+  // the frame may only be reused after it has been copied out
+  asm volatile ("" : : : "memory");
+  sn->tail = tail + 1;
+
+  return 1;
+}
+
+void i2c_sched_init(i2c_sched_t* s) {
+  unsigned int i;
+
+  s->num_sensors = 0;
+  s->num_ops     = 0;
+  s->num_slots   = 0;
+  s->max_clocks  = 0;
+  s->slot        = 0;
+
+  for (i = 0; i < I2C_SCHED_MAX_SLOTS; i++)
+    s->slots[i] = 0;
+
+  s->due         = 0;
+  s->cur         = -1;
+  s->pc          = 0;
+  s->pos         = 0;
+  s->abort       = 0;
+  s->data        = 0;
+
+  s->cycles      = 0;
+  s->overruns    = 0;
+  s->lost        = 0;
+  s->busy        = 0;
+  s->cycle_start = 0;
+  s->window      = 0;
+}
+
+//-----------------------------------------------------------------------------
+// compilation
+//-----------------------------------------------------------------------------
+
+static void i2c_sched_emit(i2c_sched_t* s, i2c_sensor_t* sn, uint8_t cmd, uint8_t data) {
+  i2c_op_t* op = &s->ops[s->num_ops++];
+
+  op->cmd  = cmd;
+  op->data = data;
+
+  sn->clocks += I2C_BYTE_CLOCKS;
+  if (cmd & I2C_START)
+    sn->clocks++;
+  if (cmd & I2C_STOP)
+    sn->clocks++;
+}
+
+int i2c_sched_add(i2c_sched_t* s, i2c_sensor_t* sn, unsigned int period) {
+  unsigned int ops, i;
+
+  ops = 2 + sn->len;
+  if ((sn->flags & I2C_SENSOR_NOREG) == 0)
+    ops += (sn->flags & I2C_SENSOR_REG16) ? 3 : 2;
+
+  if (period == 0 || period > I2C_SCHED_MAX_SLOTS)
+    return -1;
+
+  if (s->num_sensors == I2C_SCHED_MAX_SENSORS || s->num_ops + ops > I2C_SCHED_MAX_OPS)
+    return -1;
+
+  sn->period = period;
+  sn->first  = s->num_ops;
+  sn->clocks = 0;
+
+  if ((sn->flags & I2C_SENSOR_NOREG) == 0) {
+    i2c_sched_emit(s, sn, I2C_START_WRITE, sn->addr << 1);
+
+    if (sn->flags & I2C_SENSOR_REG16)
+      i2c_sched_emit(s, sn, I2C_WRITE, sn->reg >> 8);
+
+    if (sn->flags & I2C_SENSOR_STOP)
+      i2c_sched_emit(s, sn, I2C_STOP_WRITE, sn->reg & 0xFF);
+    else
+      i2c_sched_emit(s, sn, I2C_WRITE, sn->reg & 0xFF);
+  }
+
+  i2c_sched_emit(s, sn, I2C_START_WRITE, (sn->addr << 1) | 1);
+
+  for (i = 1; i < sn->len; i++)
+    i2c_sched_emit(s, sn, I2C_READ, 0);
+
+  // the last byte is not acknowledged, which ends the burst of the device
+  i2c_sched_emit(s, sn, I2C_STOP_READ | I2C_NACK, 0);
+
+  sn->count = s->num_ops - sn->first;
+
+  s->sensors[s->num_sensors] = sn;
+  return s->num_sensors++;
+}
+
+int i2c_sched_compile(i2c_sched_t* s) {
+  unsigned int clocks[I2C_SCHED_MAX_SLOTS];
+  unsigned int a, b, t, n, i, k, p;
+  unsigned int order[I2C_SCHED_MAX_SENSORS];
+
+  // the schedule period is the least common multiple of all periods
+  n = 1;
+  for (i = 0; i < s->num_sensors; i++) {
+    a = n;
+    b = s->sensors[i]->period;
+    while (b) {
+      t = a % b;
+      a = b;
+      b = t;
+    }
+
+    n = n / a * s->sensors[i]->period;
+    if (n > I2C_SCHED_MAX_SLOTS)
+      return -1;
+  }
+
+  for (k = 0; k < n; k++) {
+    s->slots[k] = 0;
+    clocks[k]   = 0;
+  }
+
+  // short periods leave the least choice, place them first
+  for (i = 0; i < s->num_sensors; i++) {
+    for (k = i; k > 0 && s->sensors[order[k - 1]]->period > s->sensors[i]->period; k--)
+      order[k] = order[k - 1];
+    order[k] = i;
+  }
+
+  // every sensor gets the phase that keeps its busiest slot least loaded
+  for (i = 0; i < s->num_sensors; i++) {
+    i2c_sensor_t* sn = s->sensors[order[i]];
+    unsigned int best = 0, best_max = ~0u;
+
+    for (p = 0; p < sn->period; p++) {
+      unsigned int max = 0;
+
+      for (k = p; k < n; k += sn->period)
+        if (clocks[k] > max)
+          max = clocks[k];
+
+      if (max < best_max) {
+        best_max = max;
+        best     = p;
+      }
+    }
+
+    sn->phase = best;
+    for (k = best; k < n; k += sn->period) {
+      s->slots[k] |= 1u << order[i];
+      clocks[k]   += sn->clocks;
+    }
+  }
+
+  s->max_clocks = 0;
+  for (k = 0; k < n; k++)
+    if (clocks[k] > s->max_clocks)
+      s->max_clocks = clocks[k];
+
+  s->num_slots = n;
+  s->slot      = 0;
+
+  return 0;
+}
+
+unsigned int i2c_sched_load(i2c_sched_t* s, uint32_t scl_hz, uint32_t tick_hz) {
+  // SCL clocks available per tick
+  uint32_t avail = scl_hz / tick_hz;
+
+  if (avail == 0)
+    return ~0u;
+
+  return (s->max_clocks * 1000 + avail - 1) / avail;
+}
+
+//-----------------------------------------------------------------------------
+// execution
+//-----------------------------------------------------------------------------
+
+static inline void i2c_sched_issue(i2c_sched_t* s) {
+  i2c_op_t* op = &s->ops[s->pc];
+
+  if (op->cmd & I2C_WRITE)
+    I2C_TX = op->data;
+
+  // acknowledges the interrupt of the previous command as well
+  I2C_CMD = op->cmd | I2C_CLR_INT;
+}
+
+// starts the next due sensor that has room in its ring, ends the cycle if
+// there is none
+static void i2c_sched_next(i2c_sched_t* s) {
+  uint32_t due = s->due;
+  i2c_sensor_t* sn;
+  i2c_frame_t* f;
+  int i;
+
+  while (due) {
+    i   = __builtin_ctz(due);
+    due = due & (due - 1);
+    sn  = s->sensors[i];
+
+    if (sn->head - sn->tail > sn->mask) {
+      sn->dropped++;
+      continue;
+    }
+
+    f = (i2c_frame_t*)&sn->buf[(sn->head & sn->mask) * sn->words];
+    f->time = TIRB;
+
+    s->due   = due;
+    s->cur   = i;
+    s->pc    = sn->first;
+    s->pos   = 0;
+    s->abort = 0;
+    s->data  = f->data;
+
+    i2c_sched_issue(s);
+    return;
+  }
+
+  I2C_CMD = I2C_CLR_INT;
+
+  s->due   = 0;
+  s->cur   = -1;
+  s->busy += TIRB - s->cycle_start;
+  s->cycles++;
+}
+
+void i2c_sched_isr(void* arg) {
+  i2c_sched_t* s = (i2c_sched_t*)arg;
+  uint32_t status = I2C_STATUS;
+  i2c_sensor_t* sn;
+  i2c_op_t* op;
+
+  if (s->cur < 0) {
+    I2C_CMD = I2C_CLR_INT;
+    return;
+  }
+
+  sn = s->sensors[s->cur];
+  op = &s->ops[s->pc];
+
+  if (status & I2C_STATUS_AL) {
+    // another master took the bus, give up on the whole cycle
+    s->lost++;
+    s->due = 0;
+    i2c_sched_next(s);
+    return;
+  }
+
+  if (s->abort) {
+    // the STOP after a NACK is done
+    i2c_sched_next(s);
+    return;
+  }
+
+  if ((op->cmd & I2C_WRITE) && (status & I2C_STATUS_RXACK)) {
+    sn->errors++;
+
+    if (op->cmd & I2C_STOP) {
+      i2c_sched_next(s);
+    } else {
+      s->abort = 1;
+      I2C_CMD = I2C_STOP | I2C_CLR_INT;
+    }
+    return;
+  }
+
+  if (op->cmd & I2C_READ)
+    s->data[s->pos++] = I2C_RX;
+
+  if (++s->pc == (unsigned int)sn->first + sn->count) {
+    // the frame has to be complete before the consumer can see it
+    asm volatile ("" : : : "memory");
+    sn->head = sn->head + 1;
+
+    i2c_sched_next(s);
+    return;
+  }
+
+  i2c_sched_issue(s);
+}
+
+void i2c_sched_tick(i2c_sched_t* s) {
+  uint32_t due;
+
+  if (s->num_slots == 0)
+    return;
+
+  due = s->slots[s->slot];
+  if (++s->slot == s->num_slots)
+    s->slot = 0;
+
+  if (due == 0)
+    return;
+
+  if (s->cur >= 0) {
+    s->overruns++;
+    s->due |= due;
+    return;
+  }
+
+  s->cycle_start = TIRB;
+  s->due = due;
+  i2c_sched_next(s);
+}
+
+void i2c_sched_start(i2c_sched_t* s) {
+  timer_b_time_base();
+
+  s->slot   = 0;
+  s->busy   = 0;
+  s->window = TIRB;
+
+  I2C_CMD = I2C_CLR_INT;
+  I2C_CTR = I2C_CTR_EN_INTEN;
+
+  ICP = 1 << I2C_EVENT;
+  int_add(I2C_EVENT, i2c_sched_isr, s);
+}
+
+void i2c_sched_stop(i2c_sched_t* s) {
+  EVENT_WAIT_UNTIL(!i2c_sched_busy(s), 1u << I2C_EVENT);
+
+  int_remove(I2C_EVENT);
+  I2C_CTR = I2C_CTR_EN;
+  I2C_CMD = I2C_CLR_INT;
+}
+
+unsigned int i2c_sched_utilization(i2c_sched_t* s) {
+  uint32_t now, busy, elapsed;
+
+  int_disable();
+  now       = TIRB;
+  busy      = s->busy;
+  elapsed   = now - s->window;
+  s->busy   = 0;
+  s->window = now;
+  int_enable();
+
+  if (elapsed == 0)
+    return 0;
+
+  // keep busy * 1000 in 32 bit, busy is never larger than elapsed
+  while (elapsed > ~0u / 1000) {
+    busy    >>= 1;
+    elapsed >>= 1;
+  }
+
+  return busy * 1000 / elapsed;
+}
@@ -15,42 +15,126 @@
 #include "event.h"
 
 
+struct int_handler {
+  int_handler_t handler;
+  void*         arg;
+};
+
+static struct int_handler int_handlers[MAX_INT_HANDLERS];
+
+// lines with a handler, the dispatcher only looks at these
+static volatile unsigned int int_registered;
+
+#ifdef PULP_EXT
+static inline int int_last_one(unsigned int x) {
+  int n;
+  asm ("p.fl1 %0, %1" : "=r" (n) : "r" (x));
+  return n;
+}
+#else
+static inline int int_last_one(unsigned int x) {
+  return 31 - __builtin_clz(x);
+}
+#endif
+
+void int_init(void) {
+  int i;
+
+  IER &= ~int_registered;
+  int_registered = 0;
+
+  for (i = 0; i < MAX_INT_HANDLERS; i++) {
+    int_handlers[i].handler = 0;
+    int_handlers[i].arg     = 0;
+  }
+}
+
+int int_add(int irq, int_handler_t handler, void* arg) {
+  if (irq < 0 || irq >= MAX_INT_HANDLERS || handler == 0)
+    return -1;
+
+  // the dispatcher must never see the line with half an entry
+  int_registered &= ~(1u << irq);
+  int_handlers[irq].handler = handler;
+  int_handlers[irq].arg     = arg;
+  int_registered |= 1u << irq;
+
+  IER |= 1u << irq;
+
+  return 0;
+}
+
+int int_remove(int irq) {
+  if (irq < 0 || irq >= MAX_INT_HANDLERS)
+    return -1;
+
+  IER &= ~(1u << irq);
+  int_registered &= ~(1u << irq);
+  int_handlers[irq].handler = 0;
+
+  return 0;
+}
+
+void int_dispatch(void) {
+  unsigned int pending;
+  int irq;
+
+  pending = IPR & IER & int_registered;
+
+  // nobody handles this interrupt
+  if (pending == 0)
+    for(;;);
+
+  // interrupts are disabled in here, whatever becomes pending while the
+  // handlers run is picked up by the next round instead of a new entry
+  do {
+    do {
+      irq = int_last_one(pending);
+      pending &= ~(1u << irq);
+
+      ICP = 1u << irq;
+      int_handlers[irq].handler(int_handlers[irq].arg);
+    } while (pending);
+
+    pending = IPR & IER & int_registered;
+  } while (pending);
+}
+
 //defining all interrupt handelrs
 //these functions can be redefined by users
 
 // 23: i2c
-__attribute__ ((weak))
-void ISR_I2C (void){ for(;;); }	
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_I2C (void);
 
 // 24: uart
-__attribute__ ((weak))
-void ISR_UART (void){ for(;;); }	
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_UART (void);
 
 // 25: gpio
-__attribute__ ((weak))
-void ISR_GPIO (void){ for(;;); }	
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_GPIO (void);
 
 // 26: spim end of transmission
-__attribute__ ((weak))
-void ISR_SPIM0 (void){ for(;;); }  
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_SPIM0 (void);
 
 // 27: spim R/T finished
-__attribute__ ((weak))
-void ISR_SPIM1 (void){ for(;;); }  
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_SPIM1 (void);
 
 // 28: timer A overflow
-__attribute__ ((weak))
-void ISR_TA_OVF (void){ for(;;); } 
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_TA_OVF (void);
 
 // 29: timer A compare
-__attribute__ ((weak))
-void ISR_TA_CMP (void){ for(;;); } 
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_TA_CMP (void);
 
 // 30: timer B overflow
-__attribute__ ((weak))
-void ISR_TB_OVF (void){ for(;;); } 
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_TB_OVF (void);
 
 // 31: timer B compare
-__attribute__ ((weak))
-void ISR_TB_CMP (void){ for(;;); }
-
+__attribute__ ((weak, alias ("int_dispatch")))
+void ISR_TB_CMP (void);
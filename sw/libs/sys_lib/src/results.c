@@ -0,0 +1,25 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "results.h"
+
+// zero initialized and not in .bss, so the descriptor is part of the loaded
+// image and a stale descriptor of a previous run is always overwritten
+__attribute__ ((section(".results")))
+volatile results_desc_t results_desc = { 0, 0, 0, 0 };
+
+void results_publish(const void* buf, unsigned int len) {
+  // invalidate first, so the host never sees a half updated descriptor
+  results_desc.magic = 0;
+  results_desc.addr  = (uint32_t)buf;
+  results_desc.len   = len;
+  results_desc.seq   = results_desc.seq + 1;
+  results_desc.magic = RESULTS_MAGIC;
+}
@@ -9,6 +9,9 @@
 // specific language governing permissions and limitations under the License.
 #include <spi.h>
 #include <gpio.h>
+#include <event.h>
+
+#define SPI_EVENTS ((1u << SPIM0_EVENT) | (1u << SPIM1_EVENT))
 
 void spi_setup_slave() {
     set_pin_function(PIN_SSPI_SIO0, FUNC_SPI);
@@ -64,6 +67,10 @@ int spi_get_status() {
     return status;
 }
 
+void spi_wait_idle(void) {
+    EVENT_WAIT_UNTIL(((*(volatile int*) (SPI_REG_STATUS)) & 0xFFFF) == 1, SPI_EVENTS);
+}
+
 void spi_write_fifo(int *data, int datalen) {
     volatile int num_words, i;
 
@@ -73,7 +80,7 @@ void spi_write_fifo(int *data, int datalen) {
         num_words++;
 
     for (i = 0; i < num_words; i++) {
-        while ((((*(volatile int*) (SPI_REG_STATUS)) >> 24) & 0xFF) >= 8);
+        EVENT_WAIT_UNTIL((((*(volatile int*) (SPI_REG_STATUS)) >> 24) & 0xFF) < 8, SPI_EVENTS);
         *(volatile int*) (SPI_REG_TXFIFO) = data[i];
     }
 }
@@ -87,7 +94,7 @@ void spi_read_fifo(int *data, int datalen) {
         num_words++;
 
     for (i = 0; i < num_words; i++) {
-        while ((((*(volatile int*) (SPI_REG_STATUS)) >> 16) & 0xFF) == 0);
+        EVENT_WAIT_UNTIL((((*(volatile int*) (SPI_REG_STATUS)) >> 16) & 0xFF) != 0, SPI_EVENTS);
         data[i] = *(volatile int*) (SPI_REG_RXFIFO);
     }
 }
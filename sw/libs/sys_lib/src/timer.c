@@ -25,3 +25,12 @@ void stop_timer(void) {
 int get_time(void) {
   return TIRA;
 }
+
+void timer_b_time_base(void) {
+  TOCRB = TIMER_FREE_RUN;
+
+  if ((TPRB & 0x1) == 0) {
+    TIRB = 0;
+    TPRB = 0x1;
+  }
+}
@@ -12,6 +12,7 @@
 #include "utils.h"
 #include "uart.h"
 #include "pulpino.h"
+#include "event.h"
 /**
  * Setup UART. The UART defaults to 8 bit character mode with 1 stop bit.
  *
@@ -35,6 +36,22 @@ void uart_set_cfg(int parity, uint16_t clk_counter) {
   *(volatile unsigned int*)(UART_REG_IER) = ((*(volatile unsigned int*)(UART_REG_IER)) & 0xF0) | 0x02; // set IER (interrupt enable register) on UART
 }
 
+// waits until one of the lsr bits is set, sleeping until the UART raises its
+// interrupt line for the ier sources in between
+static void uart_wait_lsr(unsigned int lsr, unsigned int ier) {
+  unsigned int old;
+
+  if (*(volatile unsigned int*)(UART_REG_LSR) & lsr)
+    return;
+
+  old = *(volatile unsigned int*)(UART_REG_IER);
+  *(volatile unsigned int*)(UART_REG_IER) = (old & 0xF0) | ier;
+
+  EVENT_WAIT_UNTIL(*(volatile unsigned int*)(UART_REG_LSR) & lsr, 1u << UART_EVENT);
+
+  *(volatile unsigned int*)(UART_REG_IER) = old;
+}
+
 void uart_send(const char* str, unsigned int len) {
   unsigned int i;
 
@@ -42,7 +59,7 @@ void uart_send(const char* str, unsigned int len) {
     // process this in batches of 16 bytes to actually use the FIFO in the UART
 
     // wait until there is space in the fifo
-    while( (*(volatile unsigned int*)(UART_REG_LSR) & 0x20) == 0);
+    uart_wait_lsr(THRE, ETBEI);
 
     for(i = 0; (i < UART_FIFO_DEPTH) && (len > 0); i++) {
       // load FIFO
@@ -54,21 +71,48 @@ void uart_send(const char* str, unsigned int len) {
 }
 
 char uart_getchar() {
-  while((*((volatile int*)UART_REG_LSR) & 0x1) != 0x1);
+  uart_wait_lsr(DR, ERBFI);
 
   return *(volatile int*)UART_REG_RBR;
 }
 
 void uart_sendchar(const char c) {
   // wait until there is space in the fifo
-  while( (*(volatile unsigned int*)(UART_REG_LSR) & 0x20) == 0);
+  uart_wait_lsr(THRE, ETBEI);
 
   // load FIFO
   *(volatile unsigned int*)(UART_REG_THR) = c;
 }
 
+void uart_send_frame(uint8_t type, const void* data, uint16_t len) {
+  const uint8_t* payload = (const uint8_t*)data;
+  uint16_t sum = type + (len & 0xFF) + (len >> 8);
+  char hdr[6];
+  char trailer[2];
+  unsigned int i;
+
+  for (i = 0; i < len; i++)
+    sum += payload[i];
+
+  hdr[0] = 0x1B;
+  hdr[1] = 'P';
+  hdr[2] = 'F';
+  hdr[3] = type;
+  hdr[4] = len & 0xFF;
+  hdr[5] = len >> 8;
+
+  trailer[0] = sum & 0xFF;
+  trailer[1] = sum >> 8;
+
+  uart_send(hdr, sizeof(hdr));
+  uart_send((const char*)payload, len);
+  uart_send(trailer, sizeof(trailer));
+}
+
 void uart_wait_tx_done(void) {
-  // wait until there is space in the fifo
-  while( (*(volatile unsigned int*)(UART_REG_LSR) & 0x40) == 0);
+  // wait until the fifo is empty, then until the last character is out,
+  // which raises no interrupt
+  uart_wait_lsr(THRE, ETBEI);
+  EVENT_WAIT_UNTIL(*(volatile unsigned int*)(UART_REG_LSR) & 0x40, 0);
 }
 
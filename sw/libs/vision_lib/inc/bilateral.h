@@ -0,0 +1,140 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Fixed-point bilateral filter.
+ *
+ * Edge preserving smoothing of 8 bit images without floating point. The
+ * weight of a neighbour is the product of a spatial weight, itself the
+ * product of a horizontal and a vertical weight, and a range weight looked
+ * up by the absolute grey level difference. All weights are 16 bit fractions
+ * (65535 is 1.0) prepared once by bilat_init, so filtering a pixel only takes
+ * table lookups, multiplies and one division.
+ *
+ * The direct filter handles radii up to BILAT_MAX_RADIUS, either on whole
+ * images or row by row through a stage that keeps 2 * radius + 1 rows. For
+ * larger spatial extents bilat_grid_u8 approximates the filter on a
+ * subsampled bilateral grid, whose cost does not depend on the radius.
+ *
+ * Only neighbours inside the image contribute, the weights are normalized
+ * per pixel.
+ *
+ */
+#ifndef _BILATERAL_H_
+#define _BILATERAL_H_
+
+#include <stdint.h>
+
+/** Largest radius of the direct filter, keeps the sums within 32 bit */
+#define BILAT_MAX_RADIUS     7
+#define BILAT_MAX_TAPS       (2 * BILAT_MAX_RADIUS + 1)
+
+/** Limits of the grid cell size in pixels */
+#define BILAT_GRID_MIN_CELL  2
+#define BILAT_GRID_MAX_CELL  16
+
+typedef struct {
+  int      radius;
+  uint16_t wx[BILAT_MAX_TAPS];                    // horizontal weights, index dx + radius
+  uint16_t wy[BILAT_MAX_TAPS];                    // vertical weights, index dy + radius
+  uint16_t wr[256];                               // range weights by grey level difference
+  uint16_t ws[BILAT_MAX_TAPS * BILAT_MAX_TAPS];   // wy * wx, filled by bilat_set_weights
+} bilat_t;
+
+/**
+ * @brief Prepares Gaussian weights.
+ * @param b       filter to set up
+ * @param radius  window radius, at most BILAT_MAX_RADIUS
+ * @param sigma_s spatial standard deviation in pixels, Q8 (256 is one pixel)
+ * @param sigma_r range standard deviation in grey levels, Q8
+ * @return 0 on success, -1 for invalid parameters
+ */
+int bilat_init(bilat_t* b, int radius, uint32_t sigma_s, uint32_t sigma_r);
+
+/**
+ * @brief Sets arbitrary weights.
+ *
+ * wx and wy have 2 * radius + 1 entries and need not be symmetric, wr has
+ * 256 entries. Pixels whose weights all round to zero keep their value.
+ */
+int bilat_set_weights(bilat_t* b, int radius, const uint16_t* wx, const uint16_t* wy, const uint16_t* wr);
+
+/**
+ * @brief Returns exp(-t) as 16 bit fraction for t in Q16, without floats.
+ */
+uint16_t bilat_exp(uint32_t t);
+
+/**
+ * @brief Filters a whole image, src and dst must not overlap.
+ */
+void bilat_u8(const bilat_t* b, const uint8_t* src, uint8_t* dst, int width, int height);
+
+/**
+ * @brief Filters one output row.
+ * @param rows 2 * radius + 1 input rows centred on the output row, NULL for
+ *             rows outside of the image
+ */
+void bilat_row_u8(const bilat_t* b, const uint8_t* const* rows, uint8_t* dst, int width);
+
+typedef void (*bilat_sink_t)(void* ctx, int y, const uint8_t* row);
+
+typedef struct {
+  const bilat_t*  b;
+  int             width;
+  uint8_t*        ring;     // 2 * radius + 1 input rows
+  uint8_t*        out;
+  int             y;        // rows pushed
+  bilat_sink_t    sink;
+  void*           ctx;
+} bilat_stage_t;
+
+/**
+ * @brief Returns the memory in bytes a stage needs.
+ */
+unsigned int bilat_stage_size(int width, int radius);
+
+/**
+ * @brief Sets up a stage that filters images row by row.
+ * @param mem  bilat_stage_size bytes
+ * @param sink called with every output row, radius rows after its input row
+ */
+void bilat_stage_init(bilat_stage_t* st, const bilat_t* b, int width, void* mem, bilat_sink_t sink, void* ctx);
+
+/**
+ * @brief Feeds the next image row into a stage.
+ */
+void bilat_push(bilat_stage_t* st, const uint8_t* row);
+
+/**
+ * @brief Emits the remaining rows after the last row of an image and
+ * prepares the stage for the next one.
+ */
+void bilat_flush(bilat_stage_t* st);
+
+/**
+ * @brief Returns the memory in bytes the grid approximation needs.
+ */
+unsigned int bilat_grid_size(int width, int height, int cell, int range);
+
+/**
+ * @brief Bilateral grid approximation for large spatial extents.
+ * @param cell  grid cell size in pixels, roughly the spatial sigma
+ * @param range grid cell size in grey levels, roughly the range sigma
+ * @param mem   bilat_grid_size bytes, word aligned
+ * @return 0 on success, -1 for invalid parameters
+ *
+ * The image is accumulated into a grid of cell x cell x range bins, blurred
+ * with a [1 2 1] kernel along all three axes and sampled back with trilinear
+ * interpolation.
+ */
+int bilat_grid_u8(const uint8_t* src, uint8_t* dst, int width, int height, int cell, int range, void* mem);
+
+#endif
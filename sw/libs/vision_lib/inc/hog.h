@@ -0,0 +1,137 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Fused gradient, orientation and HOG descriptor pipeline.
+ *
+ * Histograms of oriented gradients of 8 bit images in one pass over the
+ * rows, without floating point and without full-size intermediate images.
+ * Every image row goes through Sobel gradients, an approximate magnitude and
+ * an orientation bin straight into the histograms of the current row of
+ * cells. Once a row of cells is complete, the 2x2 cell blocks it forms with
+ * the previous row are normalized and handed to a sink.
+ *
+ * The orientation is unsigned (0 to 180 degrees) in HOG_BINS bins of 20
+ * degrees. Bins are found by comparing the gradient against the tangents of
+ * the bin borders, starting with the 45 degree octant split, so there is no
+ * atan2. The magnitude is max(M, 7/8 M + 1/2 m) of the larger and smaller
+ * absolute component, within 3% of the Euclidean norm. Every pixel votes
+ * into one bin of one cell, there is no interpolation.
+ *
+ * Pixels outside the image repeat the border pixels. Columns and rows past
+ * the last complete cell are not part of the descriptor.
+ *
+ */
+#ifndef _HOG_H_
+#define _HOG_H_
+
+#include <stdint.h>
+
+#define HOG_BINS       9
+/** Values per block of 2x2 cells */
+#define HOG_BLOCK_LEN  (4 * HOG_BINS)
+
+/** Limits of the cell size in pixels */
+#define HOG_MIN_CELL   2
+#define HOG_MAX_CELL   16
+
+/** L2-Hys clipping threshold used in the literature, 0.2 in Q15 */
+#define HOG_CLIP_DEFAULT  6554
+
+/**
+ * @brief Returns the orientation bin of a gradient.
+ */
+int hog_bin(int gx, int gy);
+
+/**
+ * @brief Gradient magnitudes and orientation bins of one row.
+ * @param r0 row above, r1 the row itself, r2 row below
+ *
+ * Reference kernel of the pipeline, for consumers that want the gradients
+ * themselves.
+ */
+void hog_grad_row(const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                  uint16_t* mag, uint8_t* bin, int width);
+
+/**
+ * @brief Normalizes one block.
+ * @param cells four cell histograms, top left, top right, bottom left,
+ *              bottom right
+ * @param clip  L2-Hys threshold in Q15, 0 for plain L2 normalization
+ * @param out   HOG_BLOCK_LEN values in Q15
+ */
+void hog_block_norm(const uint32_t* const* cells, uint16_t clip, uint16_t* out);
+
+/**
+ * @param by     block row, the blocks cover cell rows by and by + 1
+ * @param blocks nbx blocks of HOG_BLOCK_LEN values, left to right
+ */
+typedef void (*hog_sink_t)(void* ctx, int by, const uint16_t* blocks, int nbx);
+
+typedef struct {
+  int         width;
+  int         cell;
+  int         ncx;      // cells per row
+  uint16_t    clip;
+  int16_t*    ring;     // last three input rows, widened to 16 bit
+  int16_t*    vs;       // vertical [1 2 1] sums of the current row
+  int16_t*    vd;       // vertical [-1 0 1] differences of the current row
+  uint32_t*   hist;     // histograms of the current row of cells
+  uint32_t*   prev;     // histograms of the previous row of cells
+  uint16_t*   out;      // one row of blocks
+  int         y;        // rows pushed
+  int         cy;       // rows accumulated into the current row of cells
+  int         by;       // complete rows of cells
+  hog_sink_t  sink;
+  void*       ctx;
+} hog_stage_t;
+
+/**
+ * @brief Returns the memory in bytes a stage needs.
+ */
+unsigned int hog_stage_size(int width, int cell);
+
+/**
+ * @brief Sets up a stage that computes descriptors row by row.
+ * @param width image width, even and at least two cells
+ * @param cell  cell size in pixels
+ * @param clip  L2-Hys threshold in Q15, 0 for plain L2 normalization
+ * @param mem   hog_stage_size bytes, word aligned
+ * @param sink  called with every row of blocks
+ * @return 0 on success, -1 for invalid parameters
+ */
+int hog_stage_init(hog_stage_t* st, int width, int cell, uint16_t clip, void* mem, hog_sink_t sink, void* ctx);
+
+/**
+ * @brief Feeds the next image row into a stage.
+ */
+void hog_push(hog_stage_t* st, const uint8_t* row);
+
+/**
+ * @brief Finishes the last row of an image and prepares the stage for the
+ * next one.
+ */
+void hog_flush(hog_stage_t* st);
+
+/**
+ * @brief Returns the number of descriptor values of a whole image.
+ */
+unsigned int hog_desc_len(int width, int height, int cell);
+
+/**
+ * @brief Descriptor of a whole image.
+ * @param desc hog_desc_len values, blocks in row-major order
+ * @param mem  hog_stage_size bytes, word aligned
+ * @return 0 on success, -1 for invalid parameters
+ */
+int hog_u8(const uint8_t* img, int width, int height, int cell, uint16_t clip, uint16_t* desc, void* mem);
+
+#endif
@@ -0,0 +1,131 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Homography estimation with RANSAC.
+ *
+ * A minimal solver that fits a homography to four correspondences, a scoring
+ * kernel that counts the inliers of one hypothesis over all correspondences
+ * and a RANSAC driver with an adaptive number of iterations.
+ *
+ * The solver maps the unit square to both quadrilaterals (Heckbert) and
+ * chains the two mappings, which takes a few dozen multiplies instead of
+ * solving an 8x8 system. Samples whose points are collinear or whose
+ * orientation flips between the two images are rejected before solving.
+ *
+ * The scoring kernel compares |H x - w x'|^2 against t^2 w^2 instead of
+ * dividing by w, so the inner loop only has multiplies and adds, and it
+ * stops as soon as a hypothesis can no longer beat the best one so far.
+ *
+ * Homographies are 3x3 row-major matrices normalized to h[8] = 1. There is a
+ * float version for cores with FPU and a fixed-point version for the others:
+ * its points are centred and scaled to Q15 (hom_normalize_q15), its
+ * homographies are Q14 and have to stay within (-2, 2) per entry, which
+ * holds for the moderate motion between two camera frames.
+ *
+ */
+#ifndef _HOMOGRAPHY_H_
+#define _HOMOGRAPHY_H_
+
+#include <stdint.h>
+
+/** Points checked between two early termination tests */
+#define HOM_SCORE_BLOCK  8
+
+typedef struct {
+  float x;
+  float y;
+} hom_pt_t;
+
+// aligned to load both coordinates at once
+typedef struct {
+  int16_t x;
+  int16_t y;
+} __attribute__ ((aligned (4))) hom_ptq_t;
+
+typedef struct {
+  int      max_iters;   // upper bound of the iterations
+  int      confidence;  // probability in permille that the result is outlier free
+  uint32_t seed;        // state of the sample generator, updated
+  int      iters;       // iterations run by the last call
+} ransac_cfg_t;
+
+/**
+ * @brief Returns how many iterations find an outlier free sample with the
+ * requested confidence, given the best inlier count so far.
+ * @param confidence probability in permille
+ *
+ * N = log(1 - confidence) / log(1 - (inliers / n)^sample), in integer
+ * arithmetic and limited to max_iters.
+ */
+int ransac_iterations(int inliers, int n, int sample, int confidence, int max_iters);
+
+/**
+ * @brief Fits a homography to the four correspondences src[idx[i]] -> dst[idx[i]].
+ * @return 0 on success, -1 for degenerate samples
+ */
+int hom_solve4(const hom_pt_t* src, const hom_pt_t* dst, const int idx[4], float h[9]);
+
+/**
+ * @brief Counts the correspondences that h maps within thresh pixels.
+ * @param max_outliers stop once more correspondences than this are off
+ * @return number of inliers or -1 if it stopped early
+ */
+int hom_score(const float h[9], const hom_pt_t* src, const hom_pt_t* dst, int n,
+              float thresh, int max_outliers);
+
+/**
+ * @brief Marks the inliers of h in mask and returns their number.
+ */
+int hom_inliers(const float h[9], const hom_pt_t* src, const hom_pt_t* dst, int n,
+                float thresh, uint8_t* mask);
+
+/**
+ * @brief Applies h to n points.
+ */
+void hom_project(const float h[9], const hom_pt_t* in, hom_pt_t* out, int n);
+
+/**
+ * @brief Robustly fits a homography.
+ * @return number of inliers of h, -1 if no sample could be solved
+ */
+int hom_ransac(const hom_pt_t* src, const hom_pt_t* dst, int n, float thresh,
+               ransac_cfg_t* cfg, float h[9]);
+
+/**
+ * @brief Converts integer coordinates to normalized Q15 in place.
+ *
+ * x becomes (x - cx) / 2^shift in Q15, so |x - cx| has to be below 2^shift.
+ * The coordinates can be in any integer unit, e.g. pixels or Q4 pixels. A
+ * threshold t in the same unit becomes t * 2^(15 - shift).
+ */
+void hom_normalize_q15(hom_ptq_t* pts, int n, int cx, int cy, int shift);
+
+/**
+ * @brief Fixed-point hom_solve4, h in Q14.
+ * @return 0 on success, -1 for degenerate samples and for homographies that
+ * do not fit Q14
+ */
+int hom_solve4_q15(const hom_ptq_t* src, const hom_ptq_t* dst, const int idx[4], int16_t h[9]);
+
+/**
+ * @brief Fixed-point hom_score, thresh is in normalized Q15 and below 1.0.
+ */
+int hom_score_q15(const int16_t h[9], const hom_ptq_t* src, const hom_ptq_t* dst, int n,
+                  int thresh, int max_outliers);
+
+int hom_inliers_q15(const int16_t h[9], const hom_ptq_t* src, const hom_ptq_t* dst, int n,
+                    int thresh, uint8_t* mask);
+
+int hom_ransac_q15(const hom_ptq_t* src, const hom_ptq_t* dst, int n, int thresh,
+                   ransac_cfg_t* cfg, int16_t h[9]);
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+/**
+ * @file
+ * @brief Grey scale and binary morphology.
+ *
+ * Dilation and erosion with rectangular and cross shaped structuring
+ * elements, based on the van Herk/Gil-Werman algorithm: a 1D pass splits the
+ * line into blocks of the element size and combines a running prefix and a
+ * running suffix, which costs three min/max per pixel no matter how large the
+ * element is. Rectangles are separated into a horizontal pass per row and a
+ * vertical pass over whole rows; the vertical pass works on four pixels at
+ * once with the packed max4/min4 instructions when built with PULP_EXT.
+ *
+ * Grey scale images have one byte per pixel, a width that is a multiple of 4
+ * and word aligned rows. Binary images are packed 32 pixels per word, bit i
+ * of word w is pixel 32 * w + i and every row starts with a new word
+ * (MORPH_BIN_WORDS). Pixels outside of the image do not take part, they count
+ * as 0 for dilations and as 255 (set) for erosions.
+ *
+ * Everything works row by row. A stage keeps about kh rows of state and
+ * hands every output row to a sink as soon as the input rows it depends on
+ * have been pushed. Opening, closing, gradient and the top-hats chain stages
+ * through their sinks, so no intermediate image is ever stored. Stages can
+ * also be fed directly, e.g. line by line from the camera interface.
+ *
+ */
+#ifndef _MORPH_H_
+#define _MORPH_H_
+
+#include <stdint.h>
+
+/** Largest supported structuring element width or height */
+#define MORPH_MAX_KSIZE   63
+
+/** Words per row of a packed binary image */
+#define MORPH_BIN_WORDS(width)  (((width) + 31) >> 5)
+
+typedef enum {
+  MORPH_RECT,       // kw x kh rectangle
+  MORPH_CROSS       // horizontal line of kw and vertical line of kh pixels
+} morph_shape_t;
+
+typedef enum {
+  MORPH_DILATE,
+  MORPH_ERODE,
+  MORPH_OPEN,       // erosion followed by dilation
+  MORPH_CLOSE,      // dilation followed by erosion
+  MORPH_GRADIENT,   // dilation - erosion
+  MORPH_TOPHAT,     // image - opening
+  MORPH_BLACKHAT    // closing - image
+} morph_op_t;
+
+/**
+ * Receives the output rows of a stage in its internal format, see
+ * morph_row_u8 and morph_row_bin.
+ */
+typedef void (*morph_sink_t)(void* ctx, int y, const uint32_t* row);
+
+typedef struct {
+  morph_op_t      op;       // MORPH_DILATE or MORPH_ERODE
+  morph_shape_t   shape;
+  int             binary;
+  int             width;    // in pixels
+  int             words;    // words per row
+  int             kw;
+  int             kh;
+  uint32_t        pad;      // word filled with the border value
+  uint32_t*       ring;     // kh rows: current block, suffixes of the last one
+  uint32_t*       gbuf;     // prefix of the current block
+  const uint32_t* g;
+  uint32_t*       out;
+  uint32_t*       hline;    // MORPH_CROSS: kh rows of horizontal results
+  int8_t*         hbuf;     // grey scale horizontal pass, two padded lines
+  int             hlen;
+  int             j;        // rows pushed, including the top border
+  int             slot;     // position of the next row in the current block
+  int             y;        // next image row
+  morph_sink_t    sink;
+  void*           ctx;
+} morph_stage_t;
+
+/**
+ * @brief Returns the memory in bytes a stage needs.
+ */
+unsigned int morph_stage_size(int width, int kw, int kh, morph_shape_t shape, int binary);
+
+/**
+ * @brief Sets up a dilation or erosion stage.
+ * @param st     stage to set up
+ * @param op     MORPH_DILATE or MORPH_ERODE
+ * @param shape  shape of the structuring element
+ * @param kw     width of the element, odd and at most MORPH_MAX_KSIZE
+ * @param kh     height of the element, odd and at most MORPH_MAX_KSIZE
+ * @param width  image width, a multiple of 4 for grey scale images
+ * @param binary non-zero for bit packed images
+ * @param mem    word aligned memory of morph_stage_size bytes
+ * @param sink   called for every output row
+ * @param ctx    passed to the sink
+ * @return 0 on success, -1 for invalid parameters
+ */
+int morph_stage_init(morph_stage_t* st, morph_op_t op, morph_shape_t shape, int kw, int kh,
+                     int width, int binary, void* mem, morph_sink_t sink, void* ctx);
+
+/**
+ * @brief Prepares a stage for the next image.
+ */
+void morph_stage_reset(morph_stage_t* st);
+
+/**
+ * @brief Feeds the next image row into a grey scale stage.
+ */
+void morph_push_u8(morph_stage_t* st, const uint8_t* row);
+
+/**
+ * @brief Feeds the next image row into a binary stage.
+ */
+void morph_push_bin(morph_stage_t* st, const uint32_t* row);
+
+/**
+ * @brief Feeds the output row of another stage into a stage.
+ *
+ * Can be used directly as sink to chain two stages.
+ */
+void morph_push_row(void* st, int y, const uint32_t* row);
+
+/**
+ * @brief Emits the remaining rows after the last row of an image.
+ */
+void morph_flush(morph_stage_t* st);
+
+/**
+ * @brief Converts an output row of a grey scale stage to pixels.
+ */
+void morph_row_u8(uint8_t* dst, const uint32_t* row, int width);
+
+/**
+ * @brief Copies an output row of a binary stage, clears the bits past width.
+ */
+void morph_row_bin(uint32_t* dst, const uint32_t* row, int width);
+
+/**
+ * @brief Returns the memory in bytes morph_u8 or morph_bin need for op.
+ */
+unsigned int morph_mem_size(morph_op_t op, int width, int kw, int kh, morph_shape_t shape, int binary);
+
+/**
+ * @brief Applies a morphological operation to a grey scale image.
+ * @param mem word aligned scratch memory of morph_mem_size bytes
+ * @return 0 on success, -1 for invalid parameters
+ *
+ * src and dst must not overlap.
+ */
+int morph_u8(morph_op_t op, const uint8_t* src, uint8_t* dst, int width, int height,
+             morph_shape_t shape, int kw, int kh, void* mem);
+
+/**
+ * @brief Applies a morphological operation to a bit packed binary image.
+ * @param mem word aligned scratch memory of morph_mem_size bytes
+ * @return 0 on success, -1 for invalid parameters
+ *
+ * src and dst must not overlap.
+ */
+int morph_bin(morph_op_t op, const uint32_t* src, uint32_t* dst, int width, int height,
+              morph_shape_t shape, int kw, int kh, void* mem);
+
+#endif
@@ -0,0 +1,397 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include "bilateral.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// weights
+////////////////////////////////////////////////////////////////////////////////
+
+// exp(-2^(k - 16)) in Q30, exp(-t) is the product of the entries of all bits
+// set in t
+static const uint32_t bilat_exp_bits[20] = {
+  0x3FFFC000, 0x3FFF8000, 0x3FFF0002, 0x3FFE0008, 0x3FFC0020,
+  0x3FF80080, 0x3FF00200, 0x3FE007FF, 0x3FC01FF5, 0x3F807FAB,
+  0x3F01FD58, 0x3E07EAD5, 0x3C1F57F8, 0x387AD44A, 0x31D7DF3D,
+  0x26D165F9, 0x178B5636, 0x08A95552, 0x012C155C, 0x00057F08
+};
+
+uint16_t bilat_exp(uint32_t t)
+{
+  uint32_t e = 1 << 30;
+  int      k;
+
+  // below 1/65536 from exp(-12) on
+  if (t >= (12 << 16))
+    return 0;
+
+  for (k = 0; t; k++, t >>= 1) {
+    if (t & 1)
+      e = ((uint64_t)e * bilat_exp_bits[k]) >> 30;
+  }
+
+  e = (e + (1 << 13)) >> 14;
+  return e > 0xFFFF ? 0xFFFF : e;
+}
+
+// exp(-d^2 / (2 sigma^2)) with sigma in Q8
+static uint16_t bilat_gauss(int d, uint32_t sigma)
+{
+  uint64_t s2 = (uint64_t)sigma * sigma;
+  uint64_t t  = (((uint64_t)(d * d) << 31) + s2 / 2) / s2;
+
+  return bilat_exp(t > (12 << 16) ? (12 << 16) : (uint32_t)t);
+}
+
+int bilat_set_weights(bilat_t* b, int radius, const uint16_t* wx, const uint16_t* wy, const uint16_t* wr)
+{
+  int i, j;
+  int taps = 2 * radius + 1;
+
+  if (radius < 0 || radius > BILAT_MAX_RADIUS)
+    return -1;
+
+  b->radius = radius;
+
+  for (i = 0; i < taps; i++) {
+    b->wx[i] = wx[i];
+    b->wy[i] = wy[i];
+  }
+
+  for (i = 0; i < 256; i++)
+    b->wr[i] = wr[i];
+
+  for (j = 0; j < taps; j++)
+    for (i = 0; i < taps; i++)
+      b->ws[j * BILAT_MAX_TAPS + i] = ((uint32_t)wy[j] * wx[i] + 0x8000) >> 16;
+
+  return 0;
+}
+
+int bilat_init(bilat_t* b, int radius, uint32_t sigma_s, uint32_t sigma_r)
+{
+  uint16_t ws[BILAT_MAX_TAPS];
+  uint16_t wr[256];
+  int      i;
+
+  if (radius < 0 || radius > BILAT_MAX_RADIUS || sigma_s == 0 || sigma_r == 0)
+    return -1;
+
+  for (i = -radius; i <= radius; i++)
+    ws[i + radius] = bilat_gauss(i, sigma_s);
+
+  for (i = 0; i < 256; i++)
+    wr[i] = bilat_gauss(i, sigma_r);
+
+  return bilat_set_weights(b, radius, ws, ws, wr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// direct filter
+////////////////////////////////////////////////////////////////////////////////
+
+void bilat_row_u8(const bilat_t* b, const uint8_t* const* rows, uint8_t* dst, int width)
+{
+  const uint8_t*  centre = rows[b->radius];
+  const uint16_t* wr     = b->wr;
+  int             r      = b->radius;
+  int             taps   = 2 * r + 1;
+  int             x, dx, dy, lo, hi, c, p, d;
+  uint32_t        w, num, den;
+
+  for (x = 0; x < width; x++) {
+    // clip the window at the left and right border
+    lo  = x < r ? -x : -r;
+    hi  = x + r >= width ? width - 1 - x : r;
+    c   = centre[x];
+    num = 0;
+    den = 0;
+
+    for (dy = 0; dy < taps; dy++) {
+      const uint8_t*  row = rows[dy];
+      const uint16_t* ws  = b->ws + dy * BILAT_MAX_TAPS + r;
+
+      if (row == NULL)
+        continue;
+
+      row += x;
+      for (dx = lo; dx <= hi; dx++) {
+        p = row[dx];
+        d = p - c;
+        d = d < 0 ? -d : d;
+        w = ((uint32_t)ws[dx] * wr[d]) >> 16;
+
+        num += w * p;
+        den += w;
+      }
+    }
+
+    dst[x] = den ? (num + (den >> 1)) / den : (uint32_t)c;
+  }
+}
+
+void bilat_u8(const bilat_t* b, const uint8_t* src, uint8_t* dst, int width, int height)
+{
+  const uint8_t* rows[BILAT_MAX_TAPS];
+  int            r = b->radius;
+  int            y, i, yy;
+
+  for (y = 0; y < height; y++) {
+    for (i = 0; i <= 2 * r; i++) {
+      yy      = y + i - r;
+      rows[i] = (yy >= 0 && yy < height) ? src + yy * width : NULL;
+    }
+
+    bilat_row_u8(b, rows, dst + y * width, width);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// streaming
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned int bilat_stage_size(int width, int radius)
+{
+  return (2 * radius + 2) * width;
+}
+
+void bilat_stage_init(bilat_stage_t* st, const bilat_t* b, int width, void* mem, bilat_sink_t sink, void* ctx)
+{
+  st->b     = b;
+  st->width = width;
+  st->ring  = (uint8_t*)mem;
+  st->out   = st->ring + (2 * b->radius + 1) * width;
+  st->y     = 0;
+  st->sink  = sink;
+  st->ctx   = ctx;
+}
+
+// output row y needs input rows y - r to y + r, of which the first `avail`
+// have been pushed
+static void bilat_stage_emit(bilat_stage_t* st, int y, int avail)
+{
+  const uint8_t* rows[BILAT_MAX_TAPS];
+  int            r    = st->b->radius;
+  int            taps = 2 * r + 1;
+  int            i, yy;
+
+  for (i = 0; i < taps; i++) {
+    yy      = y + i - r;
+    rows[i] = (yy >= 0 && yy < avail) ? st->ring + (yy % taps) * st->width : NULL;
+  }
+
+  bilat_row_u8(st->b, rows, st->out, st->width);
+  st->sink(st->ctx, y, st->out);
+}
+
+void bilat_push(bilat_stage_t* st, const uint8_t* row)
+{
+  int r = st->b->radius;
+
+  memcpy(st->ring + (st->y % (2 * r + 1)) * st->width, row, st->width);
+  st->y++;
+
+  if (st->y > r)
+    bilat_stage_emit(st, st->y - 1 - r, st->y);
+}
+
+void bilat_flush(bilat_stage_t* st)
+{
+  int y;
+
+  for (y = st->y - st->b->radius; y < st->y; y++) {
+    if (y >= 0)
+      bilat_stage_emit(st, y, st->y);
+  }
+
+  st->y = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// bilateral grid
+////////////////////////////////////////////////////////////////////////////////
+
+// The grid has one cell of padding on every side, so the [1 2 1] blur and the
+// interpolation never need bounds checks. Every cell holds the sum of the grey
+// levels and the number of pixels that fell into it. After the blur the
+// values have grown by 4^3, for cells of at most 16 x 16 pixels the sums stay
+// below 2^22 and a lerp with 8 bit fractions fits into 32 bit.
+
+typedef struct {
+  int gw;
+  int gh;
+  int gd;
+} bilat_grid_t;
+
+static void bilat_grid_dims(bilat_grid_t* g, int width, int height, int cell, int range)
+{
+  g->gw = (width  - 1) / cell + 3;
+  g->gh = (height - 1) / cell + 3;
+  g->gd = 255 / range + 3;
+}
+
+unsigned int bilat_grid_size(int width, int height, int cell, int range)
+{
+  bilat_grid_t g;
+
+  bilat_grid_dims(&g, width, height, cell, range);
+
+  // cells and the tables for the range axis
+  return g.gw * g.gh * g.gd * 2 * sizeof(uint32_t) + 3 * 256;
+}
+
+static void bilat_grid_blur(uint32_t* p, int n, int stride)
+{
+  uint32_t prev0 = 0, prev1 = 0;
+  uint32_t cur0, cur1;
+  int      i;
+
+  for (i = 0; i < n; i++, p += stride) {
+    cur0 = p[0];
+    cur1 = p[1];
+
+    p[0] = prev0 + 2 * cur0 + (i < n - 1 ? p[stride]     : 0);
+    p[1] = prev1 + 2 * cur1 + (i < n - 1 ? p[stride + 1] : 0);
+
+    prev0 = cur0;
+    prev1 = cur1;
+  }
+}
+
+static inline uint32_t bilat_lerp(uint32_t a, uint32_t b, uint32_t f)
+{
+  return (a * (256 - f) + b * f) >> 8;
+}
+
+int bilat_grid_u8(const uint8_t* src, uint8_t* dst, int width, int height, int cell, int range, void* mem)
+{
+  bilat_grid_t   g;
+  uint32_t*      cells = (uint32_t*)mem;
+  uint8_t*       zsplat;
+  uint8_t*       zlo;
+  uint8_t*       zfrac;
+  uint8_t        xfrac[BILAT_GRID_MAX_CELL];
+  int            x, y, z, i, p;
+  int            gx, gy, fx, fy, rx, ry;
+  int            sx, sy, sz;
+
+  if (cell < BILAT_GRID_MIN_CELL || cell > BILAT_GRID_MAX_CELL || range < 1 || range > 128)
+    return -1;
+
+  bilat_grid_dims(&g, width, height, cell, range);
+
+  sz = 2;
+  sx = g.gd * sz;
+  sy = g.gw * sx;
+
+  memset(cells, 0, g.gh * sy * sizeof(uint32_t));
+
+  zsplat = (uint8_t*)(cells + g.gh * sy);
+  zlo    = zsplat + 256;
+  zfrac  = zlo + 256;
+
+  for (i = 0; i < 256; i++) {
+    zsplat[i] = (i + range / 2) / range + 1;
+    zlo[i]    = i / range + 1;
+    zfrac[i]  = (i % range) * 256 / range;
+  }
+
+  for (i = 0; i < cell; i++)
+    xfrac[i] = i * 256 / cell;
+
+  // splat every pixel into its nearest cell
+  gy = 1;
+  ry = cell / 2;
+  for (y = 0; y < height; y++) {
+    const uint8_t* row = src + y * width;
+
+    gx = 1;
+    rx = cell / 2;
+    for (x = 0; x < width; x++) {
+      uint32_t* c;
+
+      p = row[x];
+      c = cells + gy * sy + gx * sx + zsplat[p] * sz;
+      c[0] += p;
+      c[1] += 1;
+
+      if (++rx == cell) {
+        rx = 0;
+        gx++;
+      }
+    }
+
+    if (++ry == cell) {
+      ry = 0;
+      gy++;
+    }
+  }
+
+  // separable blur along the range, x and y axes
+  for (y = 0; y < g.gh; y++)
+    for (x = 0; x < g.gw; x++)
+      bilat_grid_blur(cells + y * sy + x * sx, g.gd, sz);
+
+  for (y = 0; y < g.gh; y++)
+    for (z = 0; z < g.gd; z++)
+      bilat_grid_blur(cells + y * sy + z * sz, g.gw, sx);
+
+  for (x = 0; x < g.gw; x++)
+    for (z = 0; z < g.gd; z++)
+      bilat_grid_blur(cells + x * sx + z * sz, g.gh, sy);
+
+  // slice with trilinear interpolation
+  gy = 1;
+  ry = 0;
+  for (y = 0; y < height; y++) {
+    const uint8_t* row = src + y * width;
+    uint8_t*       out = dst + y * width;
+
+    fy = xfrac[ry];
+    gx = 1;
+    rx = 0;
+    for (x = 0; x < width; x++) {
+      const uint32_t* c;
+      uint32_t        v[4], n[4], fz, vy, ny;
+
+      p  = row[x];
+      fx = xfrac[rx];
+      fz = zfrac[p];
+      c  = cells + gy * sy + gx * sx + zlo[p] * sz;
+
+      for (i = 0; i < 4; i++) {
+        // corners (y, x), (y, x + 1), (y + 1, x), (y + 1, x + 1)
+        const uint32_t* e = c + (i >> 1) * sy + (i & 1) * sx;
+
+        v[i] = bilat_lerp(e[0], e[sz],     fz);
+        n[i] = bilat_lerp(e[1], e[sz + 1], fz);
+      }
+
+      vy = bilat_lerp(bilat_lerp(v[0], v[1], fx), bilat_lerp(v[2], v[3], fx), fy);
+      ny = bilat_lerp(bilat_lerp(n[0], n[1], fx), bilat_lerp(n[2], n[3], fx), fy);
+
+      out[x] = ny ? (vy + (ny >> 1)) / ny : (uint32_t)p;
+
+      if (++rx == cell) {
+        rx = 0;
+        gx++;
+      }
+    }
+
+    if (++ry == cell) {
+      ry = 0;
+      gy++;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,370 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include "hog.h"
+
+#ifdef PULP_EXT
+typedef short hog_v2s __attribute__((vector_size (4)));
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// gradients
+////////////////////////////////////////////////////////////////////////////////
+
+// tan(20), tan(40), tan(60) and tan(80 degrees) in Q16, the gradient is
+// beyond a bin border when gy * 2^16 > |gx| * tan. Sobel components stay
+// within +-1020, so both sides fit into 32 bit.
+#define HOG_TAN20   23853
+#define HOG_TAN40   54991
+#define HOG_TAN60  113512
+#define HOG_TAN80  371673
+
+static inline int hog_orient(int gx, int gy)
+{
+  int ax, k;
+
+  // unsigned orientation, fold the lower half plane and 180 degrees onto
+  // the upper one
+  if (gy < 0 || (gy == 0 && gx < 0)) {
+    gx = -gx;
+    gy = -gy;
+  }
+
+  // k is the 20 degree sector of the angle to the x axis, 0 to 90 degrees
+  ax = gx < 0 ? -gx : gx;
+  gy <<= 16;
+
+  if (gy <= (ax << 16))
+    k = (gy > ax * HOG_TAN20) + (gy > ax * HOG_TAN40);
+  else
+    k = 2 + (gy > ax * HOG_TAN60) + (gy > ax * HOG_TAN80);
+
+  // mirrored at 90 degrees for gradients pointing to the left
+  return gx < 0 ? (HOG_BINS - 1) - k : k;
+}
+
+// max(M, 7/8 M + 1/2 m), between -3% and +0.7% of sqrt(gx^2 + gy^2)
+static inline int hog_mag(int gx, int gy)
+{
+  int ax = gx < 0 ? -gx : gx;
+  int ay = gy < 0 ? -gy : gy;
+  int mx = ax > ay ? ax : ay;
+  int mn = ax > ay ? ay : ax;
+  int m  = mx - (mx >> 3) + (mn >> 1);
+
+  return m > mx ? m : mx;
+}
+
+int hog_bin(int gx, int gy)
+{
+  return hog_orient(gx, gy);
+}
+
+void hog_grad_row(const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                  uint16_t* mag, uint8_t* bin, int width)
+{
+  int x, l, r, gx, gy;
+
+  for (x = 0; x < width; x++) {
+    l = x > 0 ? x - 1 : 0;
+    r = x < width - 1 ? x + 1 : width - 1;
+
+    gx = (r0[r] + 2 * r1[r] + r2[r]) - (r0[l] + 2 * r1[l] + r2[l]);
+    gy = (r2[l] + 2 * r2[x] + r2[r]) - (r0[l] + 2 * r0[x] + r0[r]);
+
+    mag[x] = hog_mag(gx, gy);
+    bin[x] = hog_orient(gx, gy);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// block normalization
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t hog_isqrt(uint64_t v)
+{
+  uint64_t r   = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > v)
+    bit >>= 2;
+
+  for (; bit; bit >>= 2) {
+    if (v >= r + bit) {
+      v -= r + bit;
+      r  = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+  }
+
+  return r;
+}
+
+// scales v to Q15 of the norm of all values, every value is at most the norm
+// so v * r stays below 2^47
+static void hog_scale(const uint32_t* v, uint16_t* out, uint64_t sum2)
+{
+  uint32_t n = hog_isqrt(sum2);
+  uint64_t r;
+  int      i;
+
+  if (n == 0) {
+    memset(out, 0, HOG_BLOCK_LEN * sizeof(uint16_t));
+    return;
+  }
+
+  r = ((uint64_t)32767 << 32) / n;
+  for (i = 0; i < HOG_BLOCK_LEN; i++)
+    out[i] = (v[i] * r) >> 32;
+}
+
+void hog_block_norm(const uint32_t* const* cells, uint16_t clip, uint16_t* out)
+{
+  uint32_t v[HOG_BLOCK_LEN];
+  uint64_t sum2 = 0;
+  int      i, j;
+
+  for (j = 0; j < 4; j++) {
+    for (i = 0; i < HOG_BINS; i++) {
+      v[j * HOG_BINS + i] = cells[j][i];
+      sum2 += (uint64_t)cells[j][i] * cells[j][i];
+    }
+  }
+
+  hog_scale(v, out, sum2);
+
+  if (clip == 0)
+    return;
+
+  // L2-Hys, clip the large values and normalize again
+  sum2 = 0;
+  for (i = 0; i < HOG_BLOCK_LEN; i++) {
+    v[i]  = out[i] > clip ? clip : out[i];
+    sum2 += v[i] * v[i];
+  }
+
+  hog_scale(v, out, sum2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// streaming
+////////////////////////////////////////////////////////////////////////////////
+
+// The stage keeps the last three input rows as 16 bit values. Sobel is split
+// into a vertical pass over the three rows, two pixels per instruction with
+// the packed SIMD instructions, and a horizontal pass that goes straight into
+// the histograms. vs and vd have two entries of padding on either side, so
+// the vertical pass stays word aligned and the horizontal pass needs no
+// bounds checks.
+
+static inline int hog_align(int n)
+{
+  return (n + 3) & ~3;
+}
+
+unsigned int hog_stage_size(int width, int cell)
+{
+  int ncx = width / cell;
+
+  return 2 * ncx * HOG_BINS * sizeof(uint32_t)
+       + 3 * hog_align(width * sizeof(int16_t))
+       + 2 * hog_align((width + 4) * sizeof(int16_t))
+       + hog_align((ncx - 1) * HOG_BLOCK_LEN * sizeof(uint16_t));
+}
+
+static void hog_stage_reset(hog_stage_t* st)
+{
+  memset(st->hist, 0, st->ncx * HOG_BINS * sizeof(uint32_t));
+
+  st->y  = 0;
+  st->cy = 0;
+  st->by = 0;
+}
+
+int hog_stage_init(hog_stage_t* st, int width, int cell, uint16_t clip, void* mem, hog_sink_t sink, void* ctx)
+{
+  uint8_t* p = (uint8_t*)mem;
+  int      ncx;
+
+  if (cell < HOG_MIN_CELL || cell > HOG_MAX_CELL || (width & 1) || width / cell < 2)
+    return -1;
+
+  ncx       = width / cell;
+  st->width = width;
+  st->cell  = cell;
+  st->ncx   = ncx;
+  st->clip  = clip;
+  st->sink  = sink;
+  st->ctx   = ctx;
+
+  st->hist  = (uint32_t*)p;
+  st->prev  = st->hist + ncx * HOG_BINS;
+  p        += 2 * ncx * HOG_BINS * sizeof(uint32_t);
+  st->ring  = (int16_t*)p;
+  p        += 3 * hog_align(width * sizeof(int16_t));
+  st->vs    = (int16_t*)p;
+  p        += hog_align((width + 4) * sizeof(int16_t));
+  st->vd    = (int16_t*)p;
+  p        += hog_align((width + 4) * sizeof(int16_t));
+  st->out   = (uint16_t*)p;
+
+  hog_stage_reset(st);
+
+  return 0;
+}
+
+static void hog_stage_row(hog_stage_t* st, const int16_t* r0, const int16_t* r1, const int16_t* r2)
+{
+  int16_t* vs = st->vs + 2;
+  int16_t* vd = st->vd + 2;
+  int      w  = st->width;
+  int      x, i, cx, gx, gy;
+
+#ifdef PULP_EXT
+  const hog_v2s* a = (const hog_v2s*)r0;
+  const hog_v2s* b = (const hog_v2s*)r1;
+  const hog_v2s* c = (const hog_v2s*)r2;
+  hog_v2s*       s = (hog_v2s*)vs;
+  hog_v2s*       d = (hog_v2s*)vd;
+
+  for (x = 0; x < w / 2; x++) {
+    s[x] = a[x] + b[x] + b[x] + c[x];
+    d[x] = c[x] - a[x];
+  }
+#else
+  for (x = 0; x < w; x++) {
+    vs[x] = r0[x] + 2 * r1[x] + r2[x];
+    vd[x] = r2[x] - r0[x];
+  }
+#endif
+
+  vs[-1] = vs[0];
+  vd[-1] = vd[0];
+  vs[w]  = vs[w - 1];
+  vd[w]  = vd[w - 1];
+
+  for (cx = 0, x = 0; cx < st->ncx; cx++) {
+    uint32_t* h = st->hist + cx * HOG_BINS;
+
+    for (i = 0; i < st->cell; i++, x++) {
+      gx = vs[x + 1] - vs[x - 1];
+      gy = vd[x - 1] + 2 * vd[x] + vd[x + 1];
+
+      h[hog_orient(gx, gy)] += hog_mag(gx, gy);
+    }
+  }
+}
+
+static void hog_stage_blocks(hog_stage_t* st)
+{
+  const uint32_t* cells[4];
+  int             bx;
+
+  for (bx = 0; bx < st->ncx - 1; bx++) {
+    cells[0] = st->prev + bx * HOG_BINS;
+    cells[1] = cells[0] + HOG_BINS;
+    cells[2] = st->hist + bx * HOG_BINS;
+    cells[3] = cells[2] + HOG_BINS;
+
+    hog_block_norm(cells, st->clip, st->out + bx * HOG_BLOCK_LEN);
+  }
+
+  st->sink(st->ctx, st->by - 1, st->out, st->ncx - 1);
+}
+
+// gradient row y with the input rows up to last in the ring
+static void hog_stage_emit(hog_stage_t* st, int y, int last)
+{
+  int       w = st->width;
+  uint32_t* t;
+
+  hog_stage_row(st,
+                st->ring + ((y > 0 ? y - 1 : 0) % 3) * w,
+                st->ring + (y % 3) * w,
+                st->ring + ((y < last ? y + 1 : last) % 3) * w);
+
+  if (++st->cy < st->cell)
+    return;
+
+  st->cy = 0;
+  if (st->by > 0)
+    hog_stage_blocks(st);
+
+  t        = st->prev;
+  st->prev = st->hist;
+  st->hist = t;
+  memset(st->hist, 0, st->ncx * HOG_BINS * sizeof(uint32_t));
+
+  st->by++;
+}
+
+void hog_push(hog_stage_t* st, const uint8_t* row)
+{
+  int16_t* dst = st->ring + (st->y % 3) * st->width;
+  int      x;
+
+  for (x = 0; x < st->width; x++)
+    dst[x] = row[x];
+
+  st->y++;
+
+  if (st->y > 1)
+    hog_stage_emit(st, st->y - 2, st->y - 1);
+}
+
+void hog_flush(hog_stage_t* st)
+{
+  if (st->y > 0)
+    hog_stage_emit(st, st->y - 1, st->y - 1);
+
+  hog_stage_reset(st);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// whole images
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned int hog_desc_len(int width, int height, int cell)
+{
+  int ncx = width  / cell;
+  int ncy = height / cell;
+
+  if (ncx < 2 || ncy < 2)
+    return 0;
+
+  return (ncx - 1) * (ncy - 1) * HOG_BLOCK_LEN;
+}
+
+static void hog_copy_sink(void* ctx, int by, const uint16_t* blocks, int nbx)
+{
+  uint16_t* desc = (uint16_t*)ctx;
+
+  memcpy(desc + by * nbx * HOG_BLOCK_LEN, blocks, nbx * HOG_BLOCK_LEN * sizeof(uint16_t));
+}
+
+int hog_u8(const uint8_t* img, int width, int height, int cell, uint16_t clip, uint16_t* desc, void* mem)
+{
+  hog_stage_t st;
+  int         y;
+
+  if (hog_desc_len(width, height, cell) == 0 ||
+      hog_stage_init(&st, width, cell, clip, mem, hog_copy_sink, desc) != 0)
+    return -1;
+
+  for (y = 0; y < height; y++)
+    hog_push(&st, img + y * width);
+
+  hog_flush(&st);
+
+  return 0;
+}
@@ -0,0 +1,567 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include "homography.h"
+
+#ifdef PULP_EXT
+typedef short hom_v2s __attribute__((vector_size (4)));
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// adaptive iteration count
+////////////////////////////////////////////////////////////////////////////////
+
+// -log2(x) in Q16 for x in (0, 1] given in Q30
+static uint32_t hom_neg_log2(uint32_t x)
+{
+  uint32_t frac = 0;
+  int      e    = 0;
+  int      i;
+
+  while (x < (1u << 30)) {
+    x <<= 1;
+    e++;
+  }
+
+  // x = m 2^-e with m in [1, 2), the bits of log2(m) come from squaring m
+  for (i = 0; i < 16; i++) {
+    x = ((uint64_t)x * x) >> 30;
+    frac <<= 1;
+    if (x >= (1u << 31)) {
+      x >>= 1;
+      frac |= 1;
+    }
+  }
+
+  return ((uint32_t)e << 16) - frac;
+}
+
+int ransac_iterations(int inliers, int n, int sample, int confidence, int max_iters)
+{
+  uint32_t w, ws, le, lq;
+  uint32_t iters;
+  int      i;
+
+  if (n <= 0 || inliers < sample)
+    return max_iters;
+
+  if (inliers >= n || confidence <= 0)
+    return 1;
+
+  if (confidence >= 1000)
+    return max_iters;
+
+  w  = ((uint64_t)inliers << 30) / n;
+  ws = w;
+  for (i = 1; i < sample; i++)
+    ws = ((uint64_t)ws * w) >> 30;
+
+  if (ws == 0)
+    return max_iters;
+
+  le = hom_neg_log2(((uint64_t)(1000 - confidence) << 30) / 1000);
+  lq = hom_neg_log2((1u << 30) - ws);
+
+  if (lq == 0)
+    return max_iters;
+
+  iters = (le + lq - 1) / lq;
+
+  return iters < (uint32_t)max_iters ? (int)iters : max_iters;
+}
+
+// a random sample of four distinct indices
+static void hom_sample(uint32_t* seed, int n, int idx[4])
+{
+  uint32_t s = *seed;
+  int      i, j;
+
+  for (i = 0; i < 4; i++) {
+    do {
+      s   = s * 1664525 + 1013904223;
+      idx[i] = (s >> 16) % n;
+      for (j = 0; j < i && idx[j] != idx[i]; j++);
+    } while (j < i);
+  }
+
+  *seed = s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// float
+////////////////////////////////////////////////////////////////////////////////
+
+static float hom_area(const hom_pt_t* p, int a, int b, int c)
+{
+  return (p[b].x - p[a].x) * (p[c].y - p[a].y) - (p[b].y - p[a].y) * (p[c].x - p[a].x);
+}
+
+// no three points collinear and the same orientation in both images
+static int hom_check_sample(const hom_pt_t* src, const hom_pt_t* dst, const int idx[4])
+{
+  static const uint8_t tri[4][3] = {{0, 1, 2}, {1, 2, 3}, {2, 3, 0}, {3, 0, 1}};
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    float as = hom_area(src, idx[tri[i][0]], idx[tri[i][1]], idx[tri[i][2]]);
+    float ad = hom_area(dst, idx[tri[i][0]], idx[tri[i][1]], idx[tri[i][2]]);
+
+    if (as == 0.0f || ad == 0.0f || (as < 0.0f) != (ad < 0.0f))
+      return -1;
+  }
+
+  return 0;
+}
+
+// maps the unit square to the quadrilateral p[idx[0..3]]
+static int hom_square_to_quad(const hom_pt_t* p, const int idx[4], float m[9])
+{
+  float x0 = p[idx[0]].x, y0 = p[idx[0]].y;
+  float x1 = p[idx[1]].x, y1 = p[idx[1]].y;
+  float x2 = p[idx[2]].x, y2 = p[idx[2]].y;
+  float x3 = p[idx[3]].x, y3 = p[idx[3]].y;
+  float sx = x0 - x1 + x2 - x3;
+  float sy = y0 - y1 + y2 - y3;
+  float g = 0.0f, h = 0.0f;
+
+  if (sx != 0.0f || sy != 0.0f) {
+    float dx1 = x1 - x2, dx2 = x3 - x2;
+    float dy1 = y1 - y2, dy2 = y3 - y2;
+    float den = dx1 * dy2 - dx2 * dy1;
+
+    if (den == 0.0f)
+      return -1;
+
+    g = (sx * dy2 - dx2 * sy) / den;
+    h = (dx1 * sy - sx * dy1) / den;
+  }
+
+  m[0] = x1 - x0 + g * x1; m[1] = x3 - x0 + h * x3; m[2] = x0;
+  m[3] = y1 - y0 + g * y1; m[4] = y3 - y0 + h * y3; m[5] = y0;
+  m[6] = g;                m[7] = h;                m[8] = 1.0f;
+
+  return 0;
+}
+
+int hom_solve4(const hom_pt_t* src, const hom_pt_t* dst, const int idx[4], float h[9])
+{
+  float s[9], d[9], a[9];
+  float norm;
+  int   i, j;
+
+  if (hom_check_sample(src, dst, idx) != 0)
+    return -1;
+
+  if (hom_square_to_quad(src, idx, s) != 0 || hom_square_to_quad(dst, idx, d) != 0)
+    return -1;
+
+  // adjugate of s, the inverse up to a scale that the normalization removes
+  a[0] = s[4] * s[8] - s[5] * s[7];
+  a[1] = s[2] * s[7] - s[1] * s[8];
+  a[2] = s[1] * s[5] - s[2] * s[4];
+  a[3] = s[5] * s[6] - s[3] * s[8];
+  a[4] = s[0] * s[8] - s[2] * s[6];
+  a[5] = s[2] * s[3] - s[0] * s[5];
+  a[6] = s[3] * s[7] - s[4] * s[6];
+  a[7] = s[1] * s[6] - s[0] * s[7];
+  a[8] = s[0] * s[4] - s[1] * s[3];
+
+  for (j = 0; j < 3; j++)
+    for (i = 0; i < 3; i++)
+      h[3 * j + i] = d[3 * j] * a[i] + d[3 * j + 1] * a[3 + i] + d[3 * j + 2] * a[6 + i];
+
+  if (h[8] == 0.0f)
+    return -1;
+
+  norm = 1.0f / h[8];
+  for (i = 0; i < 8; i++)
+    h[i] *= norm;
+  h[8] = 1.0f;
+
+  return 0;
+}
+
+int hom_score(const float h[9], const hom_pt_t* src, const hom_pt_t* dst, int n,
+              float thresh, int max_outliers)
+{
+  float h0 = h[0], h1 = h[1], h2 = h[2];
+  float h3 = h[3], h4 = h[4], h5 = h[5];
+  float h6 = h[6], h7 = h[7], h8 = h[8];
+  float t2 = thresh * thresh;
+  int   outliers = 0;
+  int   i = 0, end;
+
+  while (i < n) {
+    end = i + HOM_SCORE_BLOCK < n ? i + HOM_SCORE_BLOCK : n;
+
+    // two independent points per iteration keep the FPU pipeline busy, the
+    // comparisons are counted without branches
+    for (; i + 1 < end; i += 2) {
+      float xa = src[i].x,     ya = src[i].y;
+      float xb = src[i + 1].x, yb = src[i + 1].y;
+      float wa = h6 * xa + h7 * ya + h8;
+      float wb = h6 * xb + h7 * yb + h8;
+      float exa = h0 * xa + h1 * ya + h2 - dst[i].x * wa;
+      float eya = h3 * xa + h4 * ya + h5 - dst[i].y * wa;
+      float exb = h0 * xb + h1 * yb + h2 - dst[i + 1].x * wb;
+      float eyb = h3 * xb + h4 * yb + h5 - dst[i + 1].y * wb;
+
+      outliers += (exa * exa + eya * eya > t2 * wa * wa) | (wa <= 0.0f);
+      outliers += (exb * exb + eyb * eyb > t2 * wb * wb) | (wb <= 0.0f);
+    }
+
+    if (i < end) {
+      float x = src[i].x, y = src[i].y;
+      float w  = h6 * x + h7 * y + h8;
+      float ex = h0 * x + h1 * y + h2 - dst[i].x * w;
+      float ey = h3 * x + h4 * y + h5 - dst[i].y * w;
+
+      outliers += (ex * ex + ey * ey > t2 * w * w) | (w <= 0.0f);
+      i++;
+    }
+
+    if (outliers > max_outliers)
+      return -1;
+  }
+
+  return n - outliers;
+}
+
+int hom_inliers(const float h[9], const hom_pt_t* src, const hom_pt_t* dst, int n,
+                float thresh, uint8_t* mask)
+{
+  float t2 = thresh * thresh;
+  int   inliers = 0;
+  int   i;
+
+  for (i = 0; i < n; i++) {
+    float x = src[i].x, y = src[i].y;
+    float w  = h[6] * x + h[7] * y + h[8];
+    float ex = h[0] * x + h[1] * y + h[2] - dst[i].x * w;
+    float ey = h[3] * x + h[4] * y + h[5] - dst[i].y * w;
+
+    mask[i]  = ex * ex + ey * ey <= t2 * w * w && w > 0.0f;
+    inliers += mask[i];
+  }
+
+  return inliers;
+}
+
+void hom_project(const float h[9], const hom_pt_t* in, hom_pt_t* out, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    float x = in[i].x, y = in[i].y;
+    float w = 1.0f / (h[6] * x + h[7] * y + h[8]);
+
+    out[i].x = (h[0] * x + h[1] * y + h[2]) * w;
+    out[i].y = (h[3] * x + h[4] * y + h[5]) * w;
+  }
+}
+
+int hom_ransac(const hom_pt_t* src, const hom_pt_t* dst, int n, float thresh,
+               ransac_cfg_t* cfg, float h[9])
+{
+  float cand[9];
+  int   idx[4];
+  int   best = -1;
+  int   iters = cfg->max_iters;
+  int   it, score;
+
+  if (n < 4) {
+    cfg->iters = 0;
+    return -1;
+  }
+
+  for (it = 0; it < iters; it++) {
+    hom_sample(&cfg->seed, n, idx);
+
+    if (hom_solve4(src, dst, idx, cand) != 0)
+      continue;
+
+    // only hypotheses with more inliers than the best one are of interest
+    score = hom_score(cand, src, dst, n, thresh, best < 0 ? n : n - best - 1);
+    if (score > best) {
+      best = score;
+      memcpy(h, cand, sizeof(cand));
+      iters = ransac_iterations(best, n, 4, cfg->confidence, cfg->max_iters);
+    }
+  }
+
+  cfg->iters = it;
+  return best;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fixed point
+////////////////////////////////////////////////////////////////////////////////
+
+void hom_normalize_q15(hom_ptq_t* pts, int n, int cx, int cy, int shift)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    pts[i].x = ((pts[i].x - cx) * 32768) >> shift;
+    pts[i].y = ((pts[i].y - cy) * 32768) >> shift;
+  }
+}
+
+static int64_t hom_area_q15(const hom_ptq_t* p, int a, int b, int c)
+{
+  return (int64_t)(p[b].x - p[a].x) * (p[c].y - p[a].y) - (int64_t)(p[b].y - p[a].y) * (p[c].x - p[a].x);
+}
+
+static int hom_check_sample_q15(const hom_ptq_t* src, const hom_ptq_t* dst, const int idx[4])
+{
+  static const uint8_t tri[4][3] = {{0, 1, 2}, {1, 2, 3}, {2, 3, 0}, {3, 0, 1}};
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    int64_t as = hom_area_q15(src, idx[tri[i][0]], idx[tri[i][1]], idx[tri[i][2]]);
+    int64_t ad = hom_area_q15(dst, idx[tri[i][0]], idx[tri[i][1]], idx[tri[i][2]]);
+
+    if (as == 0 || ad == 0 || (as < 0) != (ad < 0))
+      return -1;
+  }
+
+  return 0;
+}
+
+// Same as hom_square_to_quad, but without the division: the matrix is scaled
+// by the denominator and then shifted down until all entries are below 2^19.
+// Near degenerate samples have large perspective terms that would not fit a
+// fixed format, scaled like this they only lose bits of the smaller entries.
+static int hom_square_to_quad_q15(const hom_ptq_t* p, const int idx[4], int64_t m[9])
+{
+  int32_t x0 = p[idx[0]].x, y0 = p[idx[0]].y;
+  int32_t x1 = p[idx[1]].x, y1 = p[idx[1]].y;
+  int32_t x2 = p[idx[2]].x, y2 = p[idx[2]].y;
+  int32_t x3 = p[idx[3]].x, y3 = p[idx[3]].y;
+  int32_t sx = x0 - x1 + x2 - x3;
+  int32_t sy = y0 - y1 + y2 - y3;
+  int32_t dx1 = x1 - x2, dx2 = x3 - x2;
+  int32_t dy1 = y1 - y2, dy2 = y3 - y2;
+  int64_t den = (int64_t)dx1 * dy2 - (int64_t)dx2 * dy1;
+  int64_t g   = (int64_t)sx * dy2 - (int64_t)dx2 * sy;
+  int64_t h   = (int64_t)dx1 * sy - (int64_t)sx * dy1;
+  int64_t mag = 0;
+  int     shift = 0;
+  int     i;
+
+  if (den == 0)
+    return -1;
+
+  // Q45, den, g and h are Q30
+  m[0] = (x1 - x0) * den + g * x1; m[1] = (x3 - x0) * den + h * x3; m[2] = x0 * den;
+  m[3] = (y1 - y0) * den + g * y1; m[4] = (y3 - y0) * den + h * y3; m[5] = y0 * den;
+  m[6] = g * 32768;                m[7] = h * 32768;                m[8] = den * 32768;
+
+  for (i = 0; i < 9; i++)
+    mag |= m[i] < 0 ? -m[i] : m[i];
+
+  while ((mag >> shift) >= (1 << 19))
+    shift++;
+
+  for (i = 0; i < 9; i++)
+    m[i] >>= shift;
+
+  return 0;
+}
+
+int hom_solve4_q15(const hom_ptq_t* src, const hom_ptq_t* dst, const int idx[4], int16_t h[9])
+{
+  int64_t s[9], d[9], a[9], r[9];
+  int64_t mag = 0, q;
+  int     shift = 0;
+  int     i, j;
+
+  if (hom_check_sample_q15(src, dst, idx) != 0)
+    return -1;
+
+  if (hom_square_to_quad_q15(src, idx, s) != 0 || hom_square_to_quad_q15(dst, idx, d) != 0)
+    return -1;
+
+  // both matrices have some common scale each, the entries are below 2^19,
+  // the adjugate below 2^39 and the product below 2^60
+  a[0] = s[4] * s[8] - s[5] * s[7];
+  a[1] = s[2] * s[7] - s[1] * s[8];
+  a[2] = s[1] * s[5] - s[2] * s[4];
+  a[3] = s[5] * s[6] - s[3] * s[8];
+  a[4] = s[0] * s[8] - s[2] * s[6];
+  a[5] = s[2] * s[3] - s[0] * s[5];
+  a[6] = s[3] * s[7] - s[4] * s[6];
+  a[7] = s[1] * s[6] - s[0] * s[7];
+  a[8] = s[0] * s[4] - s[1] * s[3];
+
+  for (j = 0; j < 3; j++) {
+    for (i = 0; i < 3; i++) {
+      r[3 * j + i] = d[3 * j] * a[i] + d[3 * j + 1] * a[3 + i] + d[3 * j + 2] * a[6 + i];
+      mag |= r[3 * j + i] < 0 ? -r[3 * j + i] : r[3 * j + i];
+    }
+  }
+
+  // leave room for the Q14 scaling of the division
+  while ((mag >> shift) >= ((int64_t)1 << 46))
+    shift++;
+
+  r[8] >>= shift;
+  if (r[8] == 0)
+    return -1;
+
+  for (i = 0; i < 8; i++) {
+    q = (r[i] >> shift) * 16384 / r[8];
+
+    if (q > 32767 || q < -32768)
+      return -1;
+
+    h[i] = q;
+  }
+  h[8] = 1 << 14;
+
+  return 0;
+}
+
+static inline int32_t hom_clip16(int32_t x)
+{
+#ifdef PULP_EXT
+  return __builtin_pulp_clip(x, -32768, 32767);
+#else
+  return x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+#endif
+}
+
+// the homography as the scoring loops use it
+typedef struct {
+#ifdef PULP_EXT
+  hom_v2s h01, h34, h67;
+#else
+  int32_t h0, h1, h3, h4, h6, h7;
+#endif
+  int32_t h2, h5, h8;
+  int32_t t;
+} hom_q15_t;
+
+static inline void hom_q15_setup(hom_q15_t* k, const int16_t h[9], int thresh)
+{
+#ifdef PULP_EXT
+  k->h01 = (hom_v2s){h[0], h[1]};
+  k->h34 = (hom_v2s){h[3], h[4]};
+  k->h67 = (hom_v2s){h[6], h[7]};
+#else
+  k->h0 = h[0]; k->h1 = h[1];
+  k->h3 = h[3]; k->h4 = h[4];
+  k->h6 = h[6]; k->h7 = h[7];
+#endif
+  k->h2 = h[2];
+  k->h5 = h[5];
+  k->h8 = h[8];
+  k->t  = thresh;
+}
+
+// projection error of one point against t^2 w^2, all in Q14; clipping keeps
+// the squares in range and only affects errors far above any threshold
+static inline int hom_q15_outlier(const hom_q15_t* k, const hom_ptq_t* p, const hom_ptq_t* q)
+{
+  int32_t w, ex, ey, tw;
+
+#ifdef PULP_EXT
+  hom_v2s v = *(const hom_v2s*)p;
+
+  w  = (__builtin_pulp_dotsp2(v, k->h67) >> 15) + k->h8;
+  ex = (__builtin_pulp_dotsp2(v, k->h01) >> 15) + k->h2;
+  ey = (__builtin_pulp_dotsp2(v, k->h34) >> 15) + k->h5;
+#else
+  int32_t x = p->x, y = p->y;
+
+  w  = ((k->h6 * x + k->h7 * y) >> 15) + k->h8;
+  ex = ((k->h0 * x + k->h1 * y) >> 15) + k->h2;
+  ey = ((k->h3 * x + k->h4 * y) >> 15) + k->h5;
+#endif
+
+  ex = hom_clip16(ex - ((q->x * w) >> 15));
+  ey = hom_clip16(ey - ((q->y * w) >> 15));
+  tw = (k->t * w) >> 15;
+
+  return ((uint32_t)(ex * ex) + (uint32_t)(ey * ey) > (uint32_t)(tw * tw)) | (w <= 0);
+}
+
+int hom_score_q15(const int16_t h[9], const hom_ptq_t* src, const hom_ptq_t* dst, int n,
+                  int thresh, int max_outliers)
+{
+  hom_q15_t k;
+  int       outliers = 0;
+  int       i = 0, end;
+
+  hom_q15_setup(&k, h, thresh);
+
+  while (i < n) {
+    end = i + HOM_SCORE_BLOCK < n ? i + HOM_SCORE_BLOCK : n;
+
+    for (; i < end; i++)
+      outliers += hom_q15_outlier(&k, &src[i], &dst[i]);
+
+    if (outliers > max_outliers)
+      return -1;
+  }
+
+  return n - outliers;
+}
+
+int hom_inliers_q15(const int16_t h[9], const hom_ptq_t* src, const hom_ptq_t* dst, int n,
+                    int thresh, uint8_t* mask)
+{
+  hom_q15_t k;
+  int       inliers = 0;
+  int       i;
+
+  hom_q15_setup(&k, h, thresh);
+
+  for (i = 0; i < n; i++) {
+    mask[i]  = !hom_q15_outlier(&k, &src[i], &dst[i]);
+    inliers += mask[i];
+  }
+
+  return inliers;
+}
+
+int hom_ransac_q15(const hom_ptq_t* src, const hom_ptq_t* dst, int n, int thresh,
+                   ransac_cfg_t* cfg, int16_t h[9])
+{
+  int16_t cand[9];
+  int     idx[4];
+  int     best = -1;
+  int     iters = cfg->max_iters;
+  int     it, score;
+
+  if (n < 4) {
+    cfg->iters = 0;
+    return -1;
+  }
+
+  for (it = 0; it < iters; it++) {
+    hom_sample(&cfg->seed, n, idx);
+
+    if (hom_solve4_q15(src, dst, idx, cand) != 0)
+      continue;
+
+    score = hom_score_q15(cand, src, dst, n, thresh, best < 0 ? n : n - best - 1);
+    if (score > best) {
+      best = score;
+      memcpy(h, cand, sizeof(cand));
+      iters = ransac_iterations(best, n, 4, cfg->confidence, cfg->max_iters);
+    }
+  }
+
+  cfg->iters = it;
+  return best;
+}
@@ -0,0 +1,563 @@
+// Copyright 2017 ETH Zurich and University of Bologna.
+// Copyright and related rights are licensed under the Solderpad Hardware
+// License, Version 0.51 (the “License”); you may not use this file except in
+// compliance with the License.  You may obtain a copy of the License at
+// http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+// or agreed to in writing, software, hardware and materials distributed under
+// this License is distributed on an “AS IS” BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+
+#include "morph.h"
+
+// Grey scale rows are stored with the sign bit of every pixel flipped, so
+// that the signed packed max4/min4 order them like unsigned pixels.
+#define MORPH_BIAS   0x80808080
+
+#define ROW(st, buf, i)  ((buf) + (i) * (st)->words)
+
+typedef signed char morph_v4s __attribute__((vector_size (4)));
+
+static inline int8_t max_s8(int8_t a, int8_t b) { return a > b ? a : b; }
+static inline int8_t min_s8(int8_t a, int8_t b) { return a < b ? a : b; }
+
+////////////////////////////////////////////////////////////////////////////////
+// row operations
+////////////////////////////////////////////////////////////////////////////////
+
+static void morph_rowop(const morph_stage_t* st, uint32_t* dst, const uint32_t* a, const uint32_t* b)
+{
+  int i;
+  int n = st->words;
+
+  if (st->binary) {
+    if (st->op == MORPH_DILATE) {
+      for (i = 0; i < n; i++)
+        dst[i] = a[i] | b[i];
+    } else {
+      for (i = 0; i < n; i++)
+        dst[i] = a[i] & b[i];
+    }
+    return;
+  }
+
+#ifdef PULP_EXT
+  if (st->op == MORPH_DILATE) {
+    for (i = 0; i < n; i++)
+      dst[i] = (uint32_t)__builtin_pulp_max4((morph_v4s)a[i], (morph_v4s)b[i]);
+  } else {
+    for (i = 0; i < n; i++)
+      dst[i] = (uint32_t)__builtin_pulp_min4((morph_v4s)a[i], (morph_v4s)b[i]);
+  }
+#else
+  {
+    int8_t*       d  = (int8_t*)dst;
+    const int8_t* a8 = (const int8_t*)a;
+    const int8_t* b8 = (const int8_t*)b;
+
+    n *= 4;
+    if (st->op == MORPH_DILATE) {
+      for (i = 0; i < n; i++)
+        d[i] = max_s8(a8[i], b8[i]);
+    } else {
+      for (i = 0; i < n; i++)
+        d[i] = min_s8(a8[i], b8[i]);
+    }
+  }
+#endif
+}
+
+static void morph_rowfill(const morph_stage_t* st, uint32_t* dst, const uint32_t* src, uint32_t bias)
+{
+  int i;
+
+  if (src == NULL) {
+    for (i = 0; i < st->words; i++)
+      dst[i] = st->pad;
+  } else {
+    for (i = 0; i < st->words; i++)
+      dst[i] = src[i] ^ bias;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// horizontal pass
+////////////////////////////////////////////////////////////////////////////////
+
+// van Herk/Gil-Werman on one line: p holds the line with r border pixels on
+// both sides, g gets the prefix of every block of k pixels and p is turned
+// into the suffixes in place. The window of x then is the suffix at x and the
+// prefix at x + 2r, which lie in the same or in two neighbouring blocks.
+#define MORPH_HPASS_U8(NAME, OP)                                                \
+static void NAME(int8_t* dst, int8_t* p, int8_t* g, int width, int k, int n)   \
+{                                                                               \
+  int b, i;                                                                     \
+  int d = k - 1;                                                                \
+                                                                                \
+  for (b = 0; b < n; b += k) {                                                  \
+    g[b] = p[b];                                                                \
+    for (i = b + 1; i < b + k; i++)                                             \
+      g[i] = OP(g[i - 1], p[i]);                                                \
+                                                                                \
+    for (i = b + k - 2; i >= b; i--)                                            \
+      p[i] = OP(p[i], p[i + 1]);                                                \
+  }                                                                             \
+                                                                                \
+  for (i = 0; i < width; i++)                                                   \
+    dst[i] = OP(p[i], g[i + d]);                                                \
+}
+
+MORPH_HPASS_U8(morph_hpass_max, max_s8)
+MORPH_HPASS_U8(morph_hpass_min, min_s8)
+
+static void morph_hpass_u8(morph_stage_t* st, uint32_t* dst, const uint8_t* src, uint8_t bias)
+{
+  int     i;
+  int     r = st->kw >> 1;
+  int8_t* p = st->hbuf;
+  int8_t* g = st->hbuf + st->hlen;
+  int8_t  pad = (int8_t)st->pad;
+
+  for (i = 0; i < r; i++)
+    p[i] = pad;
+  for (i = 0; i < st->width; i++)
+    p[r + i] = (int8_t)(src[i] ^ bias);
+  for (i = st->width + r; i < st->hlen; i++)
+    p[i] = pad;
+
+  if (st->op == MORPH_DILATE)
+    morph_hpass_max((int8_t*)dst, p, g, st->width, st->kw, st->hlen);
+  else
+    morph_hpass_min((int8_t*)dst, p, g, st->width, st->kw, st->hlen);
+}
+
+// Binary rows are dilated 32 pixels at a time by or-ing shifted copies. Each
+// step doubles the covered distance, so a radius r takes log2(r + 1) steps
+// in both directions, erosion does the same with and.
+static void morph_shift_or(uint32_t* row, int n, int s, int up, uint32_t pad, int dilate)
+{
+  int      i;
+  uint32_t v;
+
+  if (up) {
+    for (i = n - 1; i >= 0; i--) {
+      v = (row[i] << s) | ((i > 0 ? row[i - 1] : pad) >> (32 - s));
+      row[i] = dilate ? row[i] | v : row[i] & v;
+    }
+  } else {
+    for (i = 0; i < n; i++) {
+      v = (row[i] >> s) | ((i < n - 1 ? row[i + 1] : pad) << (32 - s));
+      row[i] = dilate ? row[i] | v : row[i] & v;
+    }
+  }
+}
+
+static void morph_hpass_bin(morph_stage_t* st, uint32_t* row)
+{
+  int      up, s, done;
+  int      r      = st->kw >> 1;
+  int      dilate = st->op == MORPH_DILATE;
+  int      rest   = st->width & 31;
+
+  // pixels past the end of the row count as border
+  if (rest) {
+    if (dilate)
+      row[st->words - 1] &= (1u << rest) - 1;
+    else
+      row[st->words - 1] |= ~((1u << rest) - 1);
+  }
+
+  for (up = 0; up < 2; up++) {
+    for (done = 0; done < r; done += s) {
+      s = done + 1 <= r - done ? done + 1 : r - done;
+      morph_shift_or(row, st->words, s, up, st->pad, dilate);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// vertical pass
+////////////////////////////////////////////////////////////////////////////////
+
+// Same algorithm as the horizontal pass, with rows instead of pixels. The ring
+// holds the rows of the current block; once the block is complete it is turned
+// into suffixes in place, which are read while the next block fills the ring.
+// The output row needs the suffix of slot + 1, which is overwritten only by
+// the next push.
+static void morph_vpush(morph_stage_t* st)
+{
+  int       t;
+  int       k   = st->kh;
+  int       s   = st->slot;
+  uint32_t* row = ROW(st, st->ring, s);
+
+  if (s == 0) {
+    st->g = row;
+  } else {
+    morph_rowop(st, st->gbuf, st->g, row);
+    st->g = st->gbuf;
+  }
+
+  if (s == k - 1) {
+    for (t = k - 2; t >= 0; t--)
+      morph_rowop(st, ROW(st, st->ring, t), ROW(st, st->ring, t), ROW(st, st->ring, t + 1));
+  }
+
+  if (st->j >= k - 1) {
+    int y = st->j - (k - 1);
+
+    morph_rowop(st, st->out, ROW(st, st->ring, s == k - 1 ? 0 : s + 1), st->g);
+
+    if (st->shape == MORPH_CROSS)
+      morph_rowop(st, st->out, st->out, ROW(st, st->hline, y % k));
+
+    st->sink(st->ctx, y, st->out);
+  }
+
+  st->slot = s == k - 1 ? 0 : s + 1;
+  st->j++;
+}
+
+static void morph_push(morph_stage_t* st, const uint32_t* row, uint32_t bias)
+{
+  uint32_t* slot = ROW(st, st->ring, st->slot);
+
+  if (st->shape == MORPH_CROSS) {
+    // the vertical line sees the unfiltered rows
+    uint32_t* h = ROW(st, st->hline, st->y % st->kh);
+
+    morph_rowfill(st, slot, row, bias);
+
+    if (st->binary) {
+      morph_rowfill(st, h, row, 0);
+      morph_hpass_bin(st, h);
+    } else {
+      morph_hpass_u8(st, h, (const uint8_t*)row, (uint8_t)bias);
+    }
+  } else if (st->binary) {
+    morph_rowfill(st, slot, row, 0);
+    morph_hpass_bin(st, slot);
+  } else if (st->kw > 1) {
+    morph_hpass_u8(st, slot, (const uint8_t*)row, (uint8_t)bias);
+  } else {
+    morph_rowfill(st, slot, row, bias);
+  }
+
+  st->y++;
+  morph_vpush(st);
+}
+
+static void morph_push_border(morph_stage_t* st)
+{
+  morph_rowfill(st, ROW(st, st->ring, st->slot), NULL, 0);
+  morph_vpush(st);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stages
+////////////////////////////////////////////////////////////////////////////////
+
+static int morph_words(int width, int binary)
+{
+  return binary ? MORPH_BIN_WORDS(width) : width >> 2;
+}
+
+static int morph_hlen(int width, int kw)
+{
+  // padded line rounded up to whole blocks
+  return (width + kw - 1 + kw - 1) / kw * kw;
+}
+
+static int morph_check(int width, int kw, int kh, int binary)
+{
+  if (width <= 0 || (!binary && (width & 3)))
+    return -1;
+
+  if (kw < 1 || kh < 1 || kw > MORPH_MAX_KSIZE || kh > MORPH_MAX_KSIZE)
+    return -1;
+
+  if (!(kw & 1) || !(kh & 1))
+    return -1;
+
+  return 0;
+}
+
+unsigned int morph_stage_size(int width, int kw, int kh, morph_shape_t shape, int binary)
+{
+  unsigned int rows = kh + 2;
+
+  if (shape == MORPH_CROSS)
+    rows += kh;
+
+  if (binary)
+    return rows * morph_words(width, binary) * 4;
+
+  return rows * morph_words(width, binary) * 4 + ((2 * morph_hlen(width, kw) + 3) & ~3);
+}
+
+void morph_stage_reset(morph_stage_t* st)
+{
+  int i;
+
+  st->j    = 0;
+  st->slot = 0;
+  st->y    = 0;
+
+  // top border
+  for (i = 0; i < st->kh >> 1; i++)
+    morph_push_border(st);
+}
+
+int morph_stage_init(morph_stage_t* st, morph_op_t op, morph_shape_t shape, int kw, int kh,
+                     int width, int binary, void* mem, morph_sink_t sink, void* ctx)
+{
+  uint32_t* buf = (uint32_t*)mem;
+
+  if (morph_check(width, kw, kh, binary) != 0)
+    return -1;
+
+  if (op != MORPH_DILATE && op != MORPH_ERODE)
+    return -1;
+
+  // a cross of a line is the line itself
+  if (kw == 1 || kh == 1)
+    shape = MORPH_RECT;
+
+  st->op     = op;
+  st->shape  = shape;
+  st->binary = binary;
+  st->width  = width;
+  st->words  = morph_words(width, binary);
+  st->kw     = kw;
+  st->kh     = kh;
+  st->sink   = sink;
+  st->ctx    = ctx;
+
+  if (binary)
+    st->pad = op == MORPH_DILATE ? 0x00000000 : 0xFFFFFFFF;
+  else
+    st->pad = op == MORPH_DILATE ? 0x80808080 : 0x7F7F7F7F;
+
+  st->ring = buf;
+  buf += kh * st->words;
+  st->gbuf = buf;
+  buf += st->words;
+  st->out  = buf;
+  buf += st->words;
+
+  st->hline = NULL;
+  if (shape == MORPH_CROSS) {
+    st->hline = buf;
+    buf += kh * st->words;
+  }
+
+  st->hbuf = (int8_t*)buf;
+  st->hlen = morph_hlen(width, kw);
+
+  morph_stage_reset(st);
+
+  return 0;
+}
+
+void morph_push_u8(morph_stage_t* st, const uint8_t* row)
+{
+  morph_push(st, (const uint32_t*)row, MORPH_BIAS);
+}
+
+void morph_push_bin(morph_stage_t* st, const uint32_t* row)
+{
+  morph_push(st, row, 0);
+}
+
+void morph_push_row(void* st, int y, const uint32_t* row)
+{
+  morph_push((morph_stage_t*)st, row, 0);
+}
+
+void morph_flush(morph_stage_t* st)
+{
+  int i;
+
+  // bottom border
+  for (i = 0; i < st->kh >> 1; i++)
+    morph_push_border(st);
+}
+
+void morph_row_u8(uint8_t* dst, const uint32_t* row, int width)
+{
+  int       i;
+  uint32_t* d = (uint32_t*)dst;
+
+  for (i = 0; i < width >> 2; i++)
+    d[i] = row[i] ^ MORPH_BIAS;
+}
+
+void morph_row_bin(uint32_t* dst, const uint32_t* row, int width)
+{
+  int i;
+  int n    = MORPH_BIN_WORDS(width);
+  int rest = width & 31;
+
+  for (i = 0; i < n; i++)
+    dst[i] = row[i];
+
+  if (rest)
+    dst[n - 1] &= (1u << rest) - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// whole images
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  morph_op_t      op;
+  int             binary;
+  int             width;
+  int             words;
+  const uint32_t* src;
+  uint32_t*       dst;
+  uint32_t*       tmp;    // MORPH_GRADIENT: dilated row
+} morph_job_t;
+
+// Final sink, combines the result row with the source image or with the
+// dilated row for the gradient. Grey scale rows are converted first; all
+// differences are non-negative per pixel, so whole words can be subtracted.
+static void morph_store(void* ctx, int y, const uint32_t* row)
+{
+  morph_job_t*    job = (morph_job_t*)ctx;
+  uint32_t*       dst = job->dst + y * job->words;
+  const uint32_t* src = job->src + y * job->words;
+  int             i;
+
+  if (job->binary)
+    morph_row_bin(dst, row, job->width);
+  else
+    morph_row_u8((uint8_t*)dst, row, job->width);
+
+  switch (job->op) {
+    case MORPH_GRADIENT:
+      for (i = 0; i < job->words; i++)
+        dst[i] = job->binary ? job->tmp[i] & ~dst[i] : job->tmp[i] - dst[i];
+      break;
+
+    case MORPH_TOPHAT:
+      for (i = 0; i < job->words; i++)
+        dst[i] = job->binary ? src[i] & ~dst[i] : src[i] - dst[i];
+      break;
+
+    case MORPH_BLACKHAT:
+      for (i = 0; i < job->words; i++)
+        dst[i] = job->binary ? dst[i] & ~src[i] : dst[i] - src[i];
+      break;
+
+    default:
+      break;
+  }
+
+  // source pixels past the end of the row must not leak into the result
+  if (job->binary && (job->width & 31))
+    dst[job->words - 1] &= (1u << (job->width & 31)) - 1;
+}
+
+static void morph_store_tmp(void* ctx, int y, const uint32_t* row)
+{
+  morph_job_t* job = (morph_job_t*)ctx;
+
+  if (job->binary)
+    morph_row_bin(job->tmp, row, job->width);
+  else
+    morph_row_u8((uint8_t*)job->tmp, row, job->width);
+}
+
+unsigned int morph_mem_size(morph_op_t op, int width, int kw, int kh, morph_shape_t shape, int binary)
+{
+  unsigned int size = morph_stage_size(width, kw, kh, shape, binary);
+
+  if (op == MORPH_DILATE || op == MORPH_ERODE)
+    return size;
+
+  if (op == MORPH_GRADIENT)
+    return 2 * size + morph_words(width, binary) * 4;
+
+  return 2 * size;
+}
+
+static int morph_image(morph_op_t op, const uint32_t* src, uint32_t* dst, int width, int height,
+                       morph_shape_t shape, int kw, int kh, void* mem, int binary)
+{
+  morph_stage_t first, second;
+  morph_job_t   job;
+  morph_op_t    op1, op2;
+  uint8_t*      buf  = (uint8_t*)mem;
+  unsigned int  size = morph_stage_size(width, kw, kh, shape, binary);
+  int           y;
+
+  if (morph_check(width, kw, kh, binary) != 0 || height <= 0)
+    return -1;
+
+  job.op     = op;
+  job.binary = binary;
+  job.width  = width;
+  job.words  = morph_words(width, binary);
+  job.src    = src;
+  job.dst    = dst;
+  job.tmp    = NULL;
+
+  switch (op) {
+    case MORPH_DILATE:
+    case MORPH_ERODE:
+      morph_stage_init(&first, op, shape, kw, kh, width, binary, buf, morph_store, &job);
+      break;
+
+    case MORPH_GRADIENT:
+      // both stages have the same latency, the dilated row of y is always
+      // emitted right before the eroded one
+      job.tmp = (uint32_t*)(buf + 2 * size);
+      morph_stage_init(&first,  MORPH_DILATE, shape, kw, kh, width, binary, buf,        morph_store_tmp, &job);
+      morph_stage_init(&second, MORPH_ERODE,  shape, kw, kh, width, binary, buf + size, morph_store,     &job);
+      break;
+
+    default:
+      op1 = (op == MORPH_OPEN || op == MORPH_TOPHAT) ? MORPH_ERODE  : MORPH_DILATE;
+      op2 = (op == MORPH_OPEN || op == MORPH_TOPHAT) ? MORPH_DILATE : MORPH_ERODE;
+      morph_stage_init(&second, op2, shape, kw, kh, width, binary, buf + size, morph_store, &job);
+      morph_stage_init(&first,  op1, shape, kw, kh, width, binary, buf, morph_push_row, &second);
+      break;
+  }
+
+  for (y = 0; y < height; y++) {
+    const uint32_t* row = src + y * job.words;
+
+    morph_push(&first, row, binary ? 0 : MORPH_BIAS);
+    if (op == MORPH_GRADIENT)
+      morph_push(&second, row, binary ? 0 : MORPH_BIAS);
+  }
+
+  if (op == MORPH_GRADIENT) {
+    // keep the two stages in lockstep for the bottom border as well
+    for (y = 0; y < kh >> 1; y++) {
+      morph_push_border(&first);
+      morph_push_border(&second);
+    }
+  } else {
+    morph_flush(&first);
+    if (op != MORPH_DILATE && op != MORPH_ERODE)
+      morph_flush(&second);
+  }
+
+  return 0;
+}
+
+int morph_u8(morph_op_t op, const uint8_t* src, uint8_t* dst, int width, int height,
+             morph_shape_t shape, int kw, int kh, void* mem)
+{
+  return morph_image(op, (const uint32_t*)src, (uint32_t*)dst, width, height, shape, kw, kh, mem, 0);
+}
+
+int morph_bin(morph_op_t op, const uint32_t* src, uint32_t* dst, int width, int height,
+              morph_shape_t shape, int kw, int kh, void* mem)
+{
+  return morph_image(op, src, dst, width, height, shape, kw, kh, mem, 1);
+}
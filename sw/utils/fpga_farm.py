@@ -0,0 +1,361 @@
+#!/usr/bin/env python
+
+# Copyright 2017 ETH Zurich and University of Bologna.
+# Copyright and related rights are licensed under the Solderpad Hardware
+# License, Version 0.51 (the License); you may not use this file except in
+# compliance with the License.  You may obtain a copy of the License at
+# http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+# or agreed to in writing, software, hardware and materials distributed under
+# this License is distributed on an AS IS BASIS, WITHOUT WARRANTIES OR
+# CONDITIONS OF ANY KIND, either express or implied. See the License for the
+# specific language governing permissions and limitations under the License.
+
+# Runs applications on a farm of PULPino FPGA boards.
+#
+# The boards are described in a config file, one section per board:
+#
+#   [farm]
+#   timeout   = 60     # seconds until a missing EOC counts as a hang
+#   retries   = 2      # how often a job is retried after a hang
+#   max_hangs = 3      # consecutive hangs after which a board is taken out
+#
+#   [board zed0]
+#   host    = zed0.example.org
+#   user    = root
+#   spidev  = /dev/spidev32766.0
+#   tty     = /dev/ttyPS0
+#   spiload = /root/spiload
+#   spidump = /root/spidump   # optional, pulls the results region
+#
+# Boards without a host run spiload (and spidump) on the local machine, which
+# is also how the self test fakes boards.
+#
+# Every job is an application build directory, its ELF file or directly a
+# spi_stim.txt file. Jobs are handed out to the boards in parallel, each board
+# runs one job at a time. Console output and results end up in
+# <outdir>/<job>/, a summary is written to <outdir>/summary.txt.
+#
+#   fpga_farm.py -c farm.cfg build/apps/helloworld build/apps/sequential_tests/*
+
+import os
+import re
+import sys
+import shlex
+import shutil
+import threading
+import subprocess
+from optparse import OptionParser
+
+try:
+    import ConfigParser as configparser
+except ImportError:
+    import configparser
+
+try:
+    import Queue as queue
+except ImportError:
+    import queue
+
+# has to match SPILOAD_EXIT_TIMEOUT in fpga/sw/apps/spiload/spiloader.h
+SPILOAD_EXIT_TIMEOUT = 2
+
+# grace period on top of the EOC timeout before the host gives up on spiload
+HOST_TIMEOUT_SLACK = 30
+
+STATUS_PASS  = "pass"
+STATUS_FAIL  = "fail"
+STATUS_HANG  = "hang"
+STATUS_ERROR = "error"
+STATUS_NORUN = "not run"
+
+
+class Board(object):
+    def __init__(self, name, opts):
+        self.name     = name
+        self.host     = opts.get("host")
+        self.user     = opts.get("user", "root")
+        self.spidev   = opts.get("spidev", "/dev/spidev32766.0")
+        self.tty      = opts.get("tty", "/dev/ttyPS0")
+        self.spiload  = opts.get("spiload", "/root/spiload" if self.host else "spiload")
+        self.spidump  = opts.get("spidump")
+        self.hangs    = 0
+        self.disabled = False
+        self.jobs     = 0
+
+    def remote(self):
+        return "%s@%s" % (self.user, self.host)
+
+    def command(self, tool, args):
+        cmd = shlex.split(tool) + args
+        if self.host:
+            cmd = ["ssh", "-o", "BatchMode=yes", self.remote()] + cmd
+        return cmd
+
+    def copy_to(self, local, remote):
+        return ["scp", "-q", "-o", "BatchMode=yes", local, "%s:%s" % (self.remote(), remote)]
+
+    def copy_from(self, remote, local):
+        return ["scp", "-q", "-o", "BatchMode=yes", "%s:%s" % (self.remote(), remote), local]
+
+
+class Job(object):
+    def __init__(self, name, stim):
+        self.name     = name
+        self.stim     = stim
+        self.attempts = 0
+        self.status   = STATUS_NORUN
+        self.board    = None
+
+
+def find_stim(path):
+    """Returns (name, stim) for an application directory, ELF or stim file."""
+    if os.path.isdir(path):
+        name = os.path.basename(os.path.normpath(path))
+        return name, os.path.join(path, "slm_files", "spi_stim.txt")
+
+    base, ext = os.path.splitext(os.path.basename(path))
+    if ext == ".elf":
+        return base, os.path.join(os.path.dirname(path), "slm_files", "spi_stim.txt")
+
+    return base, path
+
+
+def read_config(filename):
+    config = configparser.RawConfigParser()
+    if not config.read(filename):
+        raise IOError("Unable to read config file %s" % filename)
+
+    farm = {"timeout": 60, "retries": 2, "max_hangs": 3}
+    if config.has_section("farm"):
+        for key in farm:
+            if config.has_option("farm", key):
+                farm[key] = config.getint("farm", key)
+
+    boards = []
+    for section in config.sections():
+        m = re.match(r"board\s+(\S+)$", section)
+        if m:
+            boards.append(Board(m.group(1), dict(config.items(section))))
+
+    if not boards:
+        raise ValueError("No boards configured in %s" % filename)
+
+    return farm, boards
+
+
+def run(cmd, log, timeout):
+    """Runs cmd, appends its output to log, returns (returncode, output)."""
+    p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+
+    # python 2 has no timeout for communicate, so kill from a timer instead
+    timer = threading.Timer(timeout, p.kill)
+    timer.start()
+    try:
+        out, _ = p.communicate()
+    finally:
+        timer.cancel()
+
+    out = out.decode("utf-8", "replace")
+    log.write(out)
+    log.flush()
+
+    if p.returncode < 0:
+        # killed by the watchdog, spiload itself got stuck
+        return SPILOAD_EXIT_TIMEOUT, out
+
+    return p.returncode, out
+
+
+class Farm(object):
+    def __init__(self, boards, outdir, timeout=60, retries=2, max_hangs=3, verbose=True):
+        self.boards    = boards
+        self.outdir    = outdir
+        self.timeout   = timeout
+        self.retries   = retries
+        self.max_hangs = max_hangs
+        self.verbose   = verbose
+
+        self.queue     = queue.Queue()
+        self.lock      = threading.Lock()
+        self.pending   = 0
+        self.jobs      = []
+
+    def message(self, msg):
+        if self.verbose:
+            with self.lock:
+                print(msg)
+                sys.stdout.flush()
+
+    def add(self, path):
+        name, stim = find_stim(path)
+
+        # application names are unique, but stim files might not be
+        names = [job.name for job in self.jobs]
+        unique, n = name, 1
+        while unique in names:
+            unique = "%s_%d" % (name, n)
+            n += 1
+
+        job = Job(unique, stim)
+        self.jobs.append(job)
+        return job
+
+    def execute(self, board, job):
+        jobdir = os.path.join(self.outdir, job.name)
+        if not os.path.isdir(jobdir):
+            os.makedirs(jobdir)
+
+        if not os.path.isfile(job.stim):
+            job.status = STATUS_ERROR
+            self.message("%s: stimuli %s not found" % (job.name, job.stim))
+            return job.status
+
+        log = open(os.path.join(jobdir, "console.log"), "a")
+        log.write("==== attempt %d on board %s\n" % (job.attempts, board.name))
+
+        stim = job.stim
+        if board.host:
+            stim = "/tmp/farm_%s.spi" % job.name
+            rc, _ = run(board.copy_to(job.stim, stim), log, HOST_TIMEOUT_SLACK)
+            if rc != 0:
+                log.close()
+                return STATUS_ERROR
+
+        args = ["--timeout=%d" % self.timeout, "--tty=%s" % board.tty,
+                "--spidev=%s" % board.spidev, stim]
+        rc, out = run(board.command(board.spiload, args), log, self.timeout + HOST_TIMEOUT_SLACK)
+
+        if rc == SPILOAD_EXIT_TIMEOUT:
+            status = STATUS_HANG
+        elif rc != 0:
+            status = STATUS_ERROR
+        elif "SUMMARY: FAIL" in out:
+            status = STATUS_FAIL
+        else:
+            status = STATUS_PASS
+
+        if board.spidump and status in (STATUS_PASS, STATUS_FAIL):
+            local = os.path.join(jobdir, "results.bin")
+            remote = "/tmp/farm_%s.res" % job.name if board.host else local
+            rc, _ = run(board.command(board.spidump, ["--dev=%s" % board.spidev,
+                                                      "--results", "--out=%s" % remote]),
+                        log, HOST_TIMEOUT_SLACK)
+            if rc == 0 and board.host:
+                run(board.copy_from(remote, local), log, HOST_TIMEOUT_SLACK)
+
+        log.close()
+        return status
+
+    def worker(self, board):
+        while True:
+            with self.lock:
+                if self.pending == 0:
+                    return
+
+            try:
+                job = self.queue.get(timeout=0.1)
+            except queue.Empty:
+                continue
+
+            job.attempts += 1
+            job.board = board.name
+            board.jobs += 1
+            self.message("%s: running on %s (attempt %d)" % (job.name, board.name, job.attempts))
+
+            status = self.execute(board, job)
+
+            if status in (STATUS_HANG, STATUS_ERROR) and os.path.isfile(job.stim):
+                # the board is suspect, not necessarily the job
+                board.hangs += 1
+
+                if job.attempts <= self.retries:
+                    self.message("%s: %s on %s, retrying" % (job.name, status, board.name))
+                    self.queue.put(job)
+                else:
+                    job.status = status
+                    self.finish(job)
+
+                if board.hangs >= self.max_hangs:
+                    board.disabled = True
+                    self.message("%s: %d consecutive hangs, taking board out" % (board.name, board.hangs))
+                    return
+            else:
+                board.hangs = 0
+                job.status = status
+                self.finish(job)
+
+    def finish(self, job):
+        with self.lock:
+            self.pending -= 1
+        self.message("%s: %s" % (job.name, job.status))
+
+    def run(self):
+        if not os.path.isdir(self.outdir):
+            os.makedirs(self.outdir)
+
+        self.pending = len(self.jobs)
+        for job in self.jobs:
+            self.queue.put(job)
+
+        threads = []
+        for board in self.boards:
+            t = threading.Thread(target=self.worker, args=(board,))
+            t.daemon = True
+            t.start()
+            threads.append(t)
+
+        for t in threads:
+            t.join()
+
+        # all boards were taken out, whatever is left in the queue is not run
+        while not self.queue.empty():
+            self.queue.get().status = STATUS_NORUN
+
+        self.write_summary()
+
+        return all(job.status == STATUS_PASS for job in self.jobs)
+
+    def write_summary(self):
+        summary = open(os.path.join(self.outdir, "summary.txt"), "w")
+        for job in self.jobs:
+            summary.write("%-40s %-8s %-16s %d\n" % (job.name, job.status, job.board, job.attempts))
+        summary.close()
+
+        if self.verbose:
+            print("==== FARM SUMMARY")
+            for job in self.jobs:
+                print("%-40s %-8s board %-16s attempts %d" % (job.name, job.status, job.board, job.attempts))
+            for board in self.boards:
+                print("board %-16s jobs %3d%s" % (board.name, board.jobs, " (taken out)" if board.disabled else ""))
+
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog -c CONFIG [options] APP...")
+    parser.add_option("-c", "--config",  dest="config", help="board config file")
+    parser.add_option("-o", "--outdir",  dest="outdir", default="farm_results",
+                      help="directory for console logs and results [default: %default]")
+    parser.add_option("-t", "--timeout", dest="timeout", type="int",
+                      help="EOC timeout in seconds, overrides the config file")
+    parser.add_option("-r", "--retries", dest="retries", type="int",
+                      help="retries after a hang, overrides the config file")
+    (options, args) = parser.parse_args(argv)
+
+    if not options.config or not args:
+        parser.error("a config file and at least one application are needed")
+
+    farm_cfg, boards = read_config(options.config)
+
+    if options.timeout is not None:
+        farm_cfg["timeout"] = options.timeout
+    if options.retries is not None:
+        farm_cfg["retries"] = options.retries
+
+    farm = Farm(boards, options.outdir, **farm_cfg)
+    for app in args:
+        farm.add(app)
+
+    return 0 if farm.run() else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
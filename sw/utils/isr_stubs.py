@@ -0,0 +1,299 @@
+#!/usr/bin/env python
+
+# Copyright 2017 ETH Zurich and University of Bologna.
+# Copyright and related rights are licensed under the Solderpad Hardware
+# License, Version 0.51 (the License); you may not use this file except in
+# compliance with the License.  You may obtain a copy of the License at
+# http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+# or agreed to in writing, software, hardware and materials distributed under
+# this License is distributed on an AS IS BASIS, WITHOUT WARRANTIES OR
+# CONDITIONS OF ANY KIND, either express or implied. See the License for the
+# specific language governing permissions and limitations under the License.
+
+# Generates interrupt entry stubs that save less than the ones in crt0.
+#
+# The ISR_*_ASM stubs of crt0 save all caller-saved registers, gp, tp and both
+# hardware loops before they call the C handler. A handler declared here gets
+# its own stub, which overrides the weak one of crt0 and saves only:
+#
+#   GPIO                  all caller-saved registers, no hardware loops
+#   GPIO:caller,hwloop    the same as crt0 without gp and tp
+#   GPIO:a0-a5,t0         only the given registers, the handler has to be a
+#                         leaf function that uses nothing else
+#
+# Handlers that do not save the hardware loops must not use them, neither
+# directly nor in anything they call.
+#
+#   isr_stubs.py gen [--rv32e] -o isr_stubs.S GPIO TB_CMP:a0-a5
+#
+# The check command disassembles the linked application and verifies that
+# the handlers keep to what they declared, add_application runs it after
+# every build of an application with ISR stubs. The objdump flags have to
+# name the architecture, Xpulp hardware loops are not decoded otherwise and
+# would go unnoticed.
+#
+#   isr_stubs.py check [--objdump riscv32-unknown-elf-objdump]
+#                      [--objdump-flags "-Mmarch=IMXpulpv2 -d"] app.elf GPIO TB_CMP:a0-a5
+
+import re
+import sys
+import subprocess
+from optparse import OptionParser
+
+# handler name and the C function the stub calls
+HANDLERS = ["I2C", "UART", "GPIO", "SPIM0", "SPIM1", "TA_OVF", "TA_CMP", "TB_OVF", "TB_CMP"]
+
+CALLER_SAVED    = ["t0", "t1", "t2", "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7",
+                   "t3", "t4", "t5", "t6"]
+# RV32E has no x16 to x31
+CALLER_SAVED_E  = ["t0", "t1", "t2", "a0", "a1", "a2", "a3", "a4", "a5"]
+
+# lpstart, lpend and lpcount of both hardware loops
+HWLOOP_CSRS     = [0x7B0, 0x7B1, 0x7B2, 0x7B4, 0x7B5, 0x7B6]
+
+REG_RE = re.compile(r"\b(ra|t[0-6]|a[0-7])\b")
+
+
+class Spec(object):
+    def __init__(self, name, regs, hwloop, leaf):
+        self.name   = name
+        self.regs   = regs    # caller-saved registers in save order
+        self.hwloop = hwloop
+        self.leaf   = leaf    # not all caller-saved registers are saved
+
+    def stub(self):
+        return "ISR_%s_ASM" % self.name
+
+    def handler(self):
+        return "ISR_%s" % self.name
+
+
+def expand(item):
+    """a0-a5 -> [a0, ..., a5]"""
+    m = re.match(r"([at])(\d)-([at])(\d)$", item)
+    if not m:
+        return [item]
+
+    if m.group(1) != m.group(3) or int(m.group(2)) > int(m.group(4)):
+        raise ValueError("bad register range %s" % item)
+
+    return ["%s%d" % (m.group(1), i) for i in range(int(m.group(2)), int(m.group(4)) + 1)]
+
+
+def parse_spec(text, rv32e=False):
+    caller = CALLER_SAVED_E if rv32e else CALLER_SAVED
+
+    name, _, rest = text.partition(":")
+    if name not in HANDLERS:
+        raise ValueError("unknown interrupt %s, one of %s" % (name, ", ".join(HANDLERS)))
+
+    items = []
+    for item in (rest.split(",") if rest else ["caller"]):
+        items += expand(item.strip())
+
+    regs, hwloop = set(), False
+    for item in items:
+        if item == "caller":
+            regs |= set(caller)
+        elif item == "hwloop":
+            hwloop = True
+        elif item in caller:
+            regs.add(item)
+        else:
+            raise ValueError("%s: %s is not a caller-saved register%s"
+                             % (name, item, " of RV32E" if rv32e else ""))
+
+    if hwloop and rv32e:
+        raise ValueError("%s: RV32E cores have no hardware loops" % name)
+
+    ordered = [r for r in caller if r in regs]
+    return Spec(name, ordered, hwloop, len(ordered) < len(caller))
+
+
+################################################################################
+# generator
+################################################################################
+
+def generate(specs):
+    out = ["// generated by isr_stubs.py, do not edit", "",
+           "  .section .text", ""]
+
+    for spec in specs:
+        # ra, the registers and the loop CSRs, rounded up to 16 bytes
+        words = 1 + len(spec.regs) + (len(HWLOOP_CSRS) if spec.hwloop else 0)
+        frame = (words * 4 + 15) & ~15
+
+        save    = ["  sw %s, 0x%02X(sp)" % (r, 4 * i) for i, r in enumerate(["ra"] + spec.regs)]
+        restore = ["  lw %s, 0x%02X(sp)" % (r, 4 * i) for i, r in enumerate(["ra"] + spec.regs)]
+
+        if spec.hwloop:
+            # ra is saved first and restored last, so it is free in between
+            base = 4 * (1 + len(spec.regs))
+            for i, csr in enumerate(HWLOOP_CSRS):
+                save.append("  csrr ra, 0x%03X" % csr)
+                save.append("  sw ra, 0x%02X(sp)" % (base + 4 * i))
+                restore[0:0] = ["  lw ra, 0x%02X(sp)" % (base + 4 * i),
+                                "  csrw 0x%03X, ra" % csr]
+
+        out += ["// %s: %s%s" % (spec.name, ", ".join(spec.regs) or "no registers",
+                                 ", hardware loops" if spec.hwloop else ""),
+                "  .global %s" % spec.stub(),
+                "%s:" % spec.stub(),
+                "  addi sp, sp, -%d" % frame]
+        out += save
+        out += ["  jal ra, %s" % spec.handler()]
+        out += restore
+        out += ["  addi sp, sp, %d" % frame,
+                "  mret",
+                ""]
+
+    return "\n".join(out)
+
+
+################################################################################
+# checker
+################################################################################
+
+def parse_objdump(text):
+    """Returns {function: [(mnemonic, operands)]}."""
+    funcs = {}
+    current = None
+
+    for line in text.splitlines():
+        m = re.match(r"^[0-9a-f]+ <([^>]+)>:$", line)
+        if m:
+            current = funcs.setdefault(m.group(1), [])
+            continue
+
+        # "  1c0:	00f12623          	sw	a5,12(sp)"
+        parts = line.split("\t")
+        if current is None or len(parts) < 3 or not re.match(r"^\s*[0-9a-f]+:$", parts[0]):
+            continue
+
+        ops = parts[3] if len(parts) > 3 else ""
+        current.append((parts[2].strip(), ops.strip()))
+
+    return funcs
+
+
+def call_target(func, mnemonic, ops):
+    """Function an instruction of func calls or tail calls, "" for a call
+    through a register, None if it is no call."""
+    m = re.search(r"<([^+>]+)(\+0x[0-9a-f]+)?>", ops)
+    target = m.group(1) if m and not m.group(2) else None
+
+    if mnemonic in ("jal", "call"):
+        if ops.startswith("zero,"):
+            return target if target and target != func else None
+        return m.group(1) if m else ""
+
+    if mnemonic in ("j", "tail"):
+        return target if target and target != func else None
+
+    if mnemonic in ("jalr", "jr"):
+        if re.match(r"^(zero,\s*)?ra(,\s*0)?$", ops):
+            return None
+        return m.group(1) if m else ""
+
+    return None
+
+
+def check(funcs, spec):
+    errors = []
+
+    if spec.handler() not in funcs:
+        return ["%s: handler %s not found" % (spec.name, spec.handler())]
+
+    # everything reachable through direct calls
+    todo, seen = [spec.handler()], set()
+    while todo:
+        name = todo.pop()
+        if name in seen:
+            continue
+        seen.add(name)
+
+        for mnemonic, ops in funcs.get(name, []):
+            if mnemonic.startswith("lp.") and not spec.hwloop:
+                errors.append("%s: %s uses hardware loops (%s %s), declare hwloop"
+                              % (spec.name, name, mnemonic, ops))
+
+            if spec.leaf:
+                for reg in REG_RE.findall(re.sub(r"<[^>]*>", "", ops)):
+                    if reg != "ra" and reg not in spec.regs:
+                        errors.append("%s: %s uses %s which the stub does not save (%s %s)"
+                                      % (spec.name, name, reg, mnemonic, ops))
+
+            target = call_target(name, mnemonic, ops)
+            if target is None:
+                continue
+
+            if spec.leaf:
+                errors.append("%s: %s calls %s, only leaf handlers may save a subset"
+                              % (spec.name, name, target or "through a register"))
+            elif target == "":
+                if not spec.hwloop:
+                    errors.append("%s: %s calls through a register, its hardware loop "
+                                  "use can not be checked" % (spec.name, name))
+            elif target not in funcs:
+                errors.append("%s: %s calls unknown %s" % (spec.name, name, target))
+            else:
+                todo.append(target)
+
+    return errors
+
+
+################################################################################
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog gen|check [options] [ELF] HANDLER[:REGS]...")
+    parser.add_option("-o", "--output", dest="output", help="generated assembly file")
+    parser.add_option("--rv32e", dest="rv32e", action="store_true", default=False,
+                      help="only x1 to x15, no hardware loops")
+    parser.add_option("--objdump", dest="objdump", default="objdump",
+                      help="objdump of the toolchain [default: %default]")
+    parser.add_option("--objdump-flags", dest="objdump_flags", default="-d",
+                      help="objdump flags, blank separated [default: %default]")
+    (options, args) = parser.parse_args(argv)
+
+    if len(args) < 2 or args[0] not in ("gen", "check"):
+        parser.error("a command and at least one handler are needed")
+
+    try:
+        if args[0] == "gen":
+            specs = [parse_spec(a, options.rv32e) for a in args[1:]]
+            text  = generate(specs) + "\n"
+
+            if options.output:
+                with open(options.output, "w") as f:
+                    f.write(text)
+            else:
+                sys.stdout.write(text)
+            return 0
+
+        if len(args) < 3:
+            parser.error("check needs an ELF file and at least one handler")
+
+        specs = [parse_spec(a, options.rv32e) for a in args[2:]]
+    except ValueError as e:
+        sys.stderr.write("isr_stubs.py: %s\n" % e)
+        return 1
+
+    flags = options.objdump_flags.split()
+    if "-d" not in flags:
+        flags.append("-d")
+
+    dump = subprocess.check_output([options.objdump] + flags + [args[1]]).decode("utf-8", "replace")
+    funcs = parse_objdump(dump)
+
+    errors = []
+    for spec in specs:
+        errors += check(funcs, spec)
+
+    for e in errors:
+        sys.stderr.write("isr_stubs.py: %s\n" % e)
+
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
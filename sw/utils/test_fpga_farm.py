@@ -0,0 +1,185 @@
+#!/usr/bin/env python
+
+# Copyright 2017 ETH Zurich and University of Bologna.
+# Copyright and related rights are licensed under the Solderpad Hardware
+# License, Version 0.51 (the License); you may not use this file except in
+# compliance with the License.  You may obtain a copy of the License at
+# http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+# or agreed to in writing, software, hardware and materials distributed under
+# this License is distributed on an AS IS BASIS, WITHOUT WARRANTIES OR
+# CONDITIONS OF ANY KIND, either express or implied. See the License for the
+# specific language governing permissions and limitations under the License.
+
+# Self test for fpga_farm.py, runs the scheduler against fake boards. The fake
+# spiload decides from the content of the stimuli file (and the tty it is
+# given, which names the board) whether the "application" passes, fails or
+# hangs.
+
+import os
+import sys
+import shutil
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fpga_farm
+
+FAKE_SPILOAD = r'''
+import os, sys, time
+args  = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--"))
+stim  = [a for a in sys.argv[1:] if not a.startswith("--")][0]
+board = args["tty"]
+kind  = open(stim).read().strip()
+
+print("Device has been reset")
+time.sleep(0.2)
+
+if board == "fake_dead" or (kind == "hang-once" and not os.path.exists(stim + ".hung")):
+    open(stim + ".hung", "w").close()
+    print("Timeout reached!")
+    sys.exit(2)
+
+print("[   0.000100] PULPino: running %s on %s" % (os.path.basename(stim), board))
+print("EOC received!")
+print("==== SUMMARY: %s" % ("FAIL" if kind == "fail" else "SUCCESS"))
+'''
+
+# accepts only the options of spidump and writes the results it was asked for
+FAKE_SPIDUMP = r'''
+import sys
+known = ("dev", "addr", "len", "out", "expect", "results", "max-report")
+args  = dict((a[2:].split("=", 1) + [""])[:2] for a in sys.argv[1:])
+for a in sys.argv[1:]:
+    if not a.startswith("--") or a[2:].split("=", 1)[0] not in known:
+        sys.stderr.write("spidump: unrecognized option '%s'\n" % a)
+        sys.exit(64)
+open(args["out"], "w").write("results of %s" % args["dev"])
+'''
+
+
+def read(path):
+    with open(path) as f:
+        return f.read()
+
+
+class FarmTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+        self.outdir = os.path.join(self.tmp, "out")
+
+        self.fake = os.path.join(self.tmp, "fake_spiload.py")
+        with open(self.fake, "w") as f:
+            f.write(FAKE_SPILOAD)
+
+        self.fake_dump = os.path.join(self.tmp, "fake_spidump.py")
+        with open(self.fake_dump, "w") as f:
+            f.write(FAKE_SPIDUMP)
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+    def board(self, name):
+        return fpga_farm.Board(name, {"tty": "fake_%s" % name,
+                                      "spiload": "%s %s" % (sys.executable, self.fake)})
+
+    def app(self, name, kind="pass"):
+        appdir = os.path.join(self.tmp, "apps", name)
+        os.makedirs(os.path.join(appdir, "slm_files"))
+        with open(os.path.join(appdir, "slm_files", "spi_stim.txt"), "w") as f:
+            f.write(kind)
+        return appdir
+
+    def farm(self, boards, **kwargs):
+        return fpga_farm.Farm(boards, self.outdir, timeout=1, verbose=False, **kwargs)
+
+    def test_parallel(self):
+        boards = [self.board("b%d" % i) for i in range(3)]
+        farm = self.farm(boards)
+        for i in range(9):
+            farm.add(self.app("app%d" % i))
+
+        self.assertTrue(farm.run())
+
+        for job in farm.jobs:
+            self.assertEqual(job.status, fpga_farm.STATUS_PASS)
+            self.assertEqual(job.attempts, 1)
+            log = read(os.path.join(self.outdir, job.name, "console.log"))
+            self.assertIn("PULPino: running spi_stim.txt on fake_%s" % job.board, log)
+
+        # every board got a share of the work
+        for board in boards:
+            self.assertTrue(board.jobs > 0)
+
+        summary = read(os.path.join(self.outdir, "summary.txt"))
+        self.assertEqual(len(summary.splitlines()), 9)
+
+    def test_retry_after_hang(self):
+        farm = self.farm([self.board("b0"), self.board("b1")])
+        job = farm.add(self.app("flaky", "hang-once"))
+
+        self.assertTrue(farm.run())
+        self.assertEqual(job.status, fpga_farm.STATUS_PASS)
+        self.assertEqual(job.attempts, 2)
+
+    def test_dead_board_taken_out(self):
+        dead = self.board("dead")
+        farm = self.farm([dead, self.board("b0")], retries=3, max_hangs=2)
+        for i in range(6):
+            farm.add(self.app("app%d" % i))
+
+        self.assertTrue(farm.run())
+        self.assertTrue(dead.disabled)
+        self.assertTrue(all(job.board == "b0" for job in farm.jobs))
+
+    def test_all_boards_dead(self):
+        farm = self.farm([self.board("dead")], retries=5, max_hangs=2)
+        for i in range(3):
+            farm.add(self.app("app%d" % i))
+
+        self.assertFalse(farm.run())
+        self.assertTrue(all(job.status != fpga_farm.STATUS_PASS for job in farm.jobs))
+
+    def test_failing_test_not_retried(self):
+        farm = self.farm([self.board("b0")])
+        job = farm.add(self.app("broken", "fail"))
+
+        self.assertFalse(farm.run())
+        self.assertEqual(job.status, fpga_farm.STATUS_FAIL)
+        self.assertEqual(job.attempts, 1)
+
+    def test_missing_stimuli(self):
+        farm = self.farm([self.board("b0")])
+        job = farm.add(os.path.join(self.tmp, "nothing", "app.elf"))
+
+        self.assertFalse(farm.run())
+        self.assertEqual(job.status, fpga_farm.STATUS_ERROR)
+
+    def test_results(self):
+        board = self.board("b0")
+        board.spidump = "%s %s" % (sys.executable, self.fake_dump)
+        board.spidev = "/dev/spidev_b0"
+        farm = self.farm([board])
+        job = farm.add(self.app("dumped"))
+
+        self.assertTrue(farm.run())
+        self.assertEqual(job.status, fpga_farm.STATUS_PASS)
+        results = read(os.path.join(self.outdir, job.name, "results.bin"))
+        self.assertEqual(results, "results of /dev/spidev_b0")
+
+    def test_config(self):
+        cfg = os.path.join(self.tmp, "farm.cfg")
+        with open(cfg, "w") as f:
+            f.write("[farm]\ntimeout = 5\n\n"
+                    "[board zed0]\nhost = zed0\nspidev = /dev/spidev1.0\n\n"
+                    "[board zed1]\nhost = zed1\ntty = /dev/ttyPS1\n")
+
+        farm_cfg, boards = fpga_farm.read_config(cfg)
+        self.assertEqual(farm_cfg["timeout"], 5)
+        self.assertEqual([b.name for b in boards], ["zed0", "zed1"])
+        self.assertEqual(boards[0].spidev, "/dev/spidev1.0")
+        self.assertEqual(boards[1].tty, "/dev/ttyPS1")
+        self.assertEqual(boards[1].command("/root/spiload", ["x"])[:3], ["ssh", "-o", "BatchMode=yes"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+
+# Copyright 2017 ETH Zurich and University of Bologna.
+# Copyright and related rights are licensed under the Solderpad Hardware
+# License, Version 0.51 (the License); you may not use this file except in
+# compliance with the License.  You may obtain a copy of the License at
+# http://solderpad.org/licenses/SHL-0.51. Unless required by applicable law
+# or agreed to in writing, software, hardware and materials distributed under
+# this License is distributed on an AS IS BASIS, WITHOUT WARRANTIES OR
+# CONDITIONS OF ANY KIND, either express or implied. See the License for the
+# specific language governing permissions and limitations under the License.
+
+# Self test for isr_stubs.py, checks the generated stubs and runs the checker
+# on a hand written disassembly.
+
+import os
+import sys
+import shutil
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import isr_stubs
+
+OBJDUMP = """
+00000100 <ISR_SPIM0>:
+ 100:	1a103737          	lui	a4,0x1a103
+ 104:	4318                	lw	a4,0(a4)
+ 106:	00e02023          	sw	a4,0(zero) # 0 <t_enter>
+ 10a:	8082                	ret
+
+00000110 <ISR_GPIO>:
+ 110:	1141                	addi	sp,sp,-16
+ 112:	c606                	sw	ra,12(sp)
+ 114:	2021                	jal	11c <helper>
+ 116:	40b2                	lw	ra,12(sp)
+ 118:	0141                	addi	sp,sp,16
+ 11a:	8082                	ret
+
+0000011c <helper>:
+ 11c:	00a5007b          	lp.setupi	x0,10,124 <helper+0x8>
+ 120:	0285                	addi	t0,t0,1
+ 122:	bfed                	j	11c <helper>
+ 124:	8082                	ret
+
+00000130 <ISR_TB_CMP>:
+ 130:	87aa                	mv	a5,a0
+ 132:	00078067          	jr	a5
+"""
+
+
+class StubTest(unittest.TestCase):
+    def test_spec(self):
+        spec = isr_stubs.parse_spec("TB_CMP:a0-a2,t0")
+        self.assertEqual(spec.regs, ["t0", "a0", "a1", "a2"])
+        self.assertTrue(spec.leaf)
+        self.assertFalse(spec.hwloop)
+
+        spec = isr_stubs.parse_spec("GPIO")
+        self.assertEqual(len(spec.regs), 15)
+        self.assertFalse(spec.leaf)
+
+        spec = isr_stubs.parse_spec("GPIO", rv32e=True)
+        self.assertEqual(len(spec.regs), 9)
+        self.assertFalse(spec.leaf)
+
+        for bad in ("FOO", "GPIO:s0", "GPIO:a5-a2"):
+            self.assertRaises(ValueError, isr_stubs.parse_spec, bad)
+        self.assertRaises(ValueError, isr_stubs.parse_spec, "GPIO:t6", True)
+        self.assertRaises(ValueError, isr_stubs.parse_spec, "GPIO:hwloop", True)
+
+    def test_generate(self):
+        text = isr_stubs.generate([isr_stubs.parse_spec("GPIO:a0,hwloop")]).splitlines()
+
+        self.assertIn("ISR_GPIO_ASM:", text)
+        self.assertIn("  addi sp, sp, -32", text)
+        self.assertIn("  jal ra, ISR_GPIO", text)
+        self.assertEqual(text[-1], "  mret")
+
+        # every saved slot is restored, ra last
+        saves    = [l for l in text if l.startswith("  sw ")]
+        restores = [l for l in text if l.startswith("  lw ")]
+        self.assertEqual(len(saves), 8)
+        self.assertEqual(len(restores), 8)
+        self.assertEqual(len([l for l in text if "csrw" in l]), 6)
+        self.assertTrue(text.index("  lw ra, 0x00(sp)") > max(i for i, l in enumerate(text) if "csrw" in l))
+
+    def test_check(self):
+        funcs = isr_stubs.parse_objdump(OBJDUMP)
+        self.assertEqual(len(funcs["ISR_SPIM0"]), 4)
+
+        check = lambda s: isr_stubs.check(funcs, isr_stubs.parse_spec(s))
+
+        self.assertEqual(check("SPIM0:a4"), [])
+        self.assertEqual(len(check("SPIM0:a0-a3")), 4)
+
+        # the callee uses a hardware loop
+        errors = check("GPIO")
+        self.assertEqual(len(errors), 1)
+        self.assertIn("helper uses hardware loops", errors[0])
+        self.assertEqual(check("GPIO:caller,hwloop"), [])
+        self.assertIn("calls helper", check("GPIO:a0-a7,hwloop")[0])
+
+        # a jump through a register can not be followed
+        self.assertEqual(len(check("TB_CMP")), 1)
+        self.assertEqual(check("TB_CMP:caller,hwloop"), [])
+
+        self.assertIn("not found", check("UART")[0])
+
+    def test_objdump_flags(self):
+        # a fake objdump that only disassembles for the architecture flag
+        tmp = tempfile.mkdtemp()
+        try:
+            fake = os.path.join(tmp, "objdump")
+            with open(fake, "w") as f:
+                f.write("#!%s\nimport sys\n" % sys.executable)
+                f.write("sys.stdout.write(%r if '-Mmarch=IMXpulpv2' in sys.argv else '')\n" % OBJDUMP)
+            os.chmod(fake, 0o755)
+
+            args = ["check", "--objdump", fake, "app.elf", "GPIO:a0-a7"]
+            self.assertEqual(isr_stubs.main(args[:3] + ["--objdump-flags=-Mmarch=IMXpulpv2"] + args[3:]), 1)
+            self.assertEqual(isr_stubs.main(args[:3] + ["--objdump-flags=-Mmarch=IMXpulpv2 -d",
+                                                        "app.elf", "GPIO:caller,hwloop"]), 0)
+        finally:
+            shutil.rmtree(tmp)
+
+
+if __name__ == "__main__":
+    unittest.main()